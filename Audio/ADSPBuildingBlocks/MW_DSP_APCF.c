@@ -26,6 +26,70 @@
 
 
 #include "MW_DSP_APCF.h"
+#include "MW_DSP_DelayLine.h"
+
+
+/*
+ *  Find the next run of samples that can be processed as one block.  The run never wraps around either the read or the write
+ *  pointer and is at most MW_DSP_APCF_BLOCK_SIZE samples long.  Callers make sure that N >= MW_DSP_APCF_BLOCK_SIZE, so every
+ *  delayed sample in the run was written before the run started
+ */
+static size_t MW_DSP_APCF_nextSegment(int32_t currentPtr, int32_t N, int32_t mask, size_t numSamples, int32_t *readPtr)
+{
+    size_t length = numSamples;
+    if (length > MW_DSP_APCF_BLOCK_SIZE)
+        length = MW_DSP_APCF_BLOCK_SIZE;
+
+    if (mask)
+    {
+        *readPtr = (currentPtr - N) & mask;
+
+        if (length > (size_t)(mask + 1 - currentPtr))
+            length = mask + 1 - currentPtr;
+
+        if (length > (size_t)(mask + 1 - *readPtr))
+            length = mask + 1 - *readPtr;
+    }
+    else
+    {
+        *readPtr = currentPtr;
+
+        if (length > (size_t)(N - currentPtr))
+            length = N - currentPtr;
+    }
+
+    return length;
+}
+
+
+//  Returns the delayed samples of a segment.  Q15 delay lines are converted into scratch
+static float32_t* MW_DSP_APCF_readSegment(float32_t *delayLine, q15_t *delayLineQ15, int32_t readPtr, float32_t *scratch, size_t numSamples)
+{
+    if (delayLineQ15 == NULL)
+        return &delayLine[readPtr];
+
+    arm_q15_to_float(&delayLineQ15[readPtr], scratch, numSamples);
+    return scratch;
+}
+
+
+static void MW_DSP_APCF_writeSegment(float32_t *delayLine, q15_t *delayLineQ15, int32_t writePtr, float32_t *x, size_t numSamples)
+{
+    if (delayLineQ15)
+        arm_float_to_q15(x, &delayLineQ15[writePtr], numSamples);
+    else
+        arm_copy_f32(x, &delayLine[writePtr], numSamples);
+}
+
+
+static int32_t MW_DSP_APCF_advance(int32_t currentPtr, int32_t N, int32_t mask, size_t numSamples)
+{
+    if (mask)
+        return (currentPtr + numSamples) & mask;
+
+    return (currentPtr + numSamples) % N;
+}
+
 
 
 int32_t MW_DSP_APCF_init(MW_DSP_APCF *filter, float32_t *delayLineBuffer, int32_t N, float32_t gain)
@@ -37,9 +101,56 @@ int32_t MW_DSP_APCF_init(MW_DSP_APCF *filter, float32_t *delayLineBuffer, int32_
         return 0;
 
     filter->delayLine = delayLineBuffer;
+    filter->delayLineQ15 = NULL;
+    filter->N = N;
+    filter->gain = gain;
+    filter->currentPtr = 0;
+    filter->mask = 0;
+
+    return 1;
+}
+
+
+/*
+ *  Same as MW_DSP_APCF_init() except that the delay line buffer size is a power of two (and at least N samples long)
+ *  so that wrapping the delay line pointer is a bitwise AND instead of an integer divide.
+ *  Use MW_DSP_DelayLine_nextPowerOfTwo() to find bufferSize for a given N
+ */
+int32_t MW_DSP_APCF_init_pow2(MW_DSP_APCF *filter, float32_t *delayLineBuffer, int32_t bufferSize, int32_t N, float32_t gain)
+{
+    if (bufferSize < N || (bufferSize & (bufferSize - 1)) != 0)
+        return 0;
+
+    if (!MW_DSP_APCF_init(filter, delayLineBuffer, N, gain))
+        return 0;
+
+    filter->mask = bufferSize - 1;
+
+    return 1;
+}
+
+
+/*
+ *  Same as MW_DSP_APCF_init() except that the delay line is stored as Q15 (see MW_DSP_DelayLine_init_q15()) which halves
+ *  its memory.  The delay line holds the internal APCF state (x - gain * delayed) which can exceed the input level, so leave
+ *  headroom to avoid saturation.  The delay line buffer is cleared
+ */
+int32_t MW_DSP_APCF_init_q15(MW_DSP_APCF *filter, q15_t *delayLineBuffer, int32_t N, float32_t gain)
+{
+    if (filter == NULL || delayLineBuffer == NULL)
+        return 0;
+
+    if (N <= 0 || gain >= 1.f)
+        return 0;
+
+    filter->delayLine = NULL;
+    filter->delayLineQ15 = delayLineBuffer;
     filter->N = N;
     filter->gain = gain;
     filter->currentPtr = 0;
+    filter->mask = 0;
+
+    arm_fill_q15(0, delayLineBuffer, N);
 
     return 1;
 }
@@ -52,16 +163,87 @@ float32_t MW_DSP_APCF_tick(MW_DSP_APCF *filter, float32_t x)
     if (filter == NULL) while(1);
     #endif
 
-    float32_t nextDelayOutput = filter->delayLine[filter->currentPtr];
+    int32_t readPtr = filter->currentPtr;
+    if (filter->mask)
+        readPtr = (filter->currentPtr - filter->N) & filter->mask;
+
+    float32_t nextDelayOutput;
+    if (filter->delayLineQ15)
+        nextDelayOutput = MW_DSP_DelayLine_q15ToFloat(filter->delayLineQ15[readPtr]);
+    else
+        nextDelayOutput = filter->delayLine[readPtr];
+
     float32_t v = (nextDelayOutput * -filter->gain) + x;
-    filter->delayLine[filter->currentPtr] = v;
 
-    filter->currentPtr = (filter->currentPtr + 1) % filter->N;
+    if (filter->delayLineQ15)
+        filter->delayLineQ15[filter->currentPtr] = MW_DSP_DelayLine_floatToQ15(v);
+    else
+        filter->delayLine[filter->currentPtr] = v;
+
+    if (filter->mask)
+        filter->currentPtr = (filter->currentPtr + 1) & filter->mask;
+    else
+        filter->currentPtr = (filter->currentPtr + 1) % filter->N;
 
     return nextDelayOutput + (v * filter->gain);
 }
 
 
+/*
+ *  Block version of MW_DSP_APCF_tick().  Since the delay is at least MW_DSP_APCF_BLOCK_SIZE samples, the delayed samples
+ *  for a whole block are already in the delay line and the block can be computed with vector operations.  Filters with
+ *  a shorter delay are run through MW_DSP_APCF_tick()
+ *
+ *  Q15 delay lines (see MW_DSP_APCF_init_q15()) are converted with arm_q15_to_float()/arm_float_to_q15() which round instead
+ *  of truncating, so the output can differ from MW_DSP_APCF_tick() by the Q15 quantization error
+ *
+ *  Inputs:
+ *    filter:       Pointer to the APCF
+ *    in:           Input samples
+ *    out:          Output samples (can be the same as in)
+ *    numSamples:   Number of samples to process
+ */
+void MW_DSP_APCF_process(MW_DSP_APCF *filter, float32_t *in, float32_t *out, size_t numSamples)
+{
+    #ifdef NO_OPTIMIZE
+    if (filter == NULL || in == NULL || out == NULL) while(1);
+    #endif
+
+    if (filter->N < MW_DSP_APCF_BLOCK_SIZE)
+    {
+        for (size_t i = 0; i < numSamples; ++i)
+            out[i] = MW_DSP_APCF_tick(filter, in[i]);
+
+        return;
+    }
+
+    float32_t v[MW_DSP_APCF_BLOCK_SIZE];
+    float32_t scratch[MW_DSP_APCF_BLOCK_SIZE];
+
+    while (numSamples > 0)
+    {
+        int32_t readPtr;
+        size_t length = MW_DSP_APCF_nextSegment(filter->currentPtr, filter->N, filter->mask, numSamples, &readPtr);
+        float32_t *delayed = MW_DSP_APCF_readSegment(filter->delayLine, filter->delayLineQ15, readPtr, scratch, length);
+
+        //  v = x - gain * delayed
+        arm_scale_f32(delayed, -filter->gain, v, length);
+        arm_add_f32(v, in, v, length);
+
+        //  y = delayed + gain * v.  This has to happen before v is written back since the read and write segments can be the same
+        arm_scale_f32(v, filter->gain, out, length);
+        arm_add_f32(out, delayed, out, length);
+
+        MW_DSP_APCF_writeSegment(filter->delayLine, filter->delayLineQ15, filter->currentPtr, v, length);
+        filter->currentPtr = MW_DSP_APCF_advance(filter->currentPtr, filter->N, filter->mask, length);
+
+        in += length;
+        out += length;
+        numSamples -= length;
+    }
+}
+
+
 
 // ============================================================================================================== //
 
@@ -79,7 +261,54 @@ int32_t MW_DSP_NestedAPCF_init(MW_DSP_NestedAPCF *filter, float32_t *delayLineBu
     filter->numInnerAPCFs = numInnerAPCFs;
     filter->innerAPCFs = innerAPCFs;
     filter->currentPtr = 0;
+    filter->mask = 0;
     filter->delayLine = delayLineBuffer;
+    filter->delayLineQ15 = NULL;
+
+    return 1;
+}
+
+
+/*
+ *  Same as MW_DSP_NestedAPCF_init() except that the outer delay line buffer size is a power of two (see MW_DSP_APCF_init_pow2())
+ *  The inner APCFs may use either type of delay line
+ */
+int32_t MW_DSP_NestedAPCF_init_pow2(MW_DSP_NestedAPCF *filter, float32_t *delayLineBuffer, int32_t bufferSize, int32_t N, float32_t gain, MW_DSP_APCF *innerAPCFs, int32_t numInnerAPCFs)
+{
+    if (bufferSize < N || (bufferSize & (bufferSize - 1)) != 0)
+        return 0;
+
+    if (!MW_DSP_NestedAPCF_init(filter, delayLineBuffer, N, gain, innerAPCFs, numInnerAPCFs))
+        return 0;
+
+    filter->mask = bufferSize - 1;
+
+    return 1;
+}
+
+
+/*
+ *  Same as MW_DSP_NestedAPCF_init() except that the outer delay line is stored as Q15 (see MW_DSP_APCF_init_q15())
+ *  The inner APCFs may use either type of delay line
+ */
+int32_t MW_DSP_NestedAPCF_init_q15(MW_DSP_NestedAPCF *filter, q15_t *delayLineBuffer, int32_t N, float32_t gain, MW_DSP_APCF *innerAPCFs, int32_t numInnerAPCFs)
+{
+    if (filter == NULL || delayLineBuffer == NULL || innerAPCFs == NULL)
+        return 0;
+
+    if (N <= 0 || gain >= 1.f || numInnerAPCFs <= 0)
+        return 0;
+
+    filter->N = N;
+    filter->gain = gain;
+    filter->numInnerAPCFs = numInnerAPCFs;
+    filter->innerAPCFs = innerAPCFs;
+    filter->currentPtr = 0;
+    filter->mask = 0;
+    filter->delayLine = NULL;
+    filter->delayLineQ15 = delayLineBuffer;
+
+    arm_fill_q15(0, delayLineBuffer, N);
 
     return 1;
 }
@@ -91,16 +320,253 @@ float32_t MW_DSP_NestedAPCF_tick(MW_DSP_NestedAPCF *filter, float32_t x)
 if (filter == NULL) while(1);
 #endif
 
-    float32_t nextOuterDelayLineOut = filter->delayLine[filter->currentPtr];
-    float32_t v = x + (-filter->gain);
+    int32_t readPtr = filter->currentPtr;
+    if (filter->mask)
+        readPtr = (filter->currentPtr - filter->N) & filter->mask;
+
+    float32_t nextOuterDelayLineOut;
+    if (filter->delayLineQ15)
+        nextOuterDelayLineOut = MW_DSP_DelayLine_q15ToFloat(filter->delayLineQ15[readPtr]);
+    else
+        nextOuterDelayLineOut = filter->delayLine[readPtr];
+
+    float32_t v = (nextOuterDelayLineOut * -filter->gain) + x;
     float32_t temp = v;
 
     for (int32_t i = 0; i < filter->numInnerAPCFs; ++i)
         temp = MW_DSP_APCF_tick(&filter->innerAPCFs[i], temp);
     
-    filter->delayLine[filter->currentPtr] = temp;
+    if (filter->delayLineQ15)
+        filter->delayLineQ15[filter->currentPtr] = MW_DSP_DelayLine_floatToQ15(temp);
+    else
+        filter->delayLine[filter->currentPtr] = temp;
 
-    filter->currentPtr = (filter->currentPtr + 1) % filter->N;
+    if (filter->mask)
+        filter->currentPtr = (filter->currentPtr + 1) & filter->mask;
+    else
+        filter->currentPtr = (filter->currentPtr + 1) % filter->N;
 
     return nextOuterDelayLineOut + (v * filter->gain);
-}
\ No newline at end of file
+}
+
+
+/*
+ *  Block version of MW_DSP_NestedAPCF_tick() (see MW_DSP_APCF_process()).  Each block runs through the whole chain of inner
+ *  APCFs with MW_DSP_APCF_process() before the outer delay line is updated.  Filters with an outer delay shorter than
+ *  MW_DSP_APCF_BLOCK_SIZE samples are run through MW_DSP_NestedAPCF_tick()
+ *
+ *  Inputs:
+ *    filter:       Pointer to the nested APCF
+ *    in:           Input samples
+ *    out:          Output samples (can be the same as in)
+ *    numSamples:   Number of samples to process
+ */
+void MW_DSP_NestedAPCF_process(MW_DSP_NestedAPCF *filter, float32_t *in, float32_t *out, size_t numSamples)
+{
+#ifdef NO_OPTIMIZE
+if (filter == NULL || in == NULL || out == NULL) while(1);
+#endif
+
+    if (filter->N < MW_DSP_APCF_BLOCK_SIZE)
+    {
+        for (size_t i = 0; i < numSamples; ++i)
+            out[i] = MW_DSP_NestedAPCF_tick(filter, in[i]);
+
+        return;
+    }
+
+    float32_t v[MW_DSP_APCF_BLOCK_SIZE];
+    float32_t temp[MW_DSP_APCF_BLOCK_SIZE];
+    float32_t scratch[MW_DSP_APCF_BLOCK_SIZE];
+
+    while (numSamples > 0)
+    {
+        int32_t readPtr;
+        size_t length = MW_DSP_APCF_nextSegment(filter->currentPtr, filter->N, filter->mask, numSamples, &readPtr);
+        float32_t *delayed = MW_DSP_APCF_readSegment(filter->delayLine, filter->delayLineQ15, readPtr, scratch, length);
+
+        arm_scale_f32(delayed, -filter->gain, v, length);
+        arm_add_f32(v, in, v, length);
+
+        MW_DSP_APCF_process(&filter->innerAPCFs[0], v, temp, length);
+        for (int32_t i = 1; i < filter->numInnerAPCFs; ++i)
+            MW_DSP_APCF_process(&filter->innerAPCFs[i], temp, temp, length);
+
+        arm_scale_f32(v, filter->gain, out, length);
+        arm_add_f32(out, delayed, out, length);
+
+        MW_DSP_APCF_writeSegment(filter->delayLine, filter->delayLineQ15, filter->currentPtr, temp, length);
+        filter->currentPtr = MW_DSP_APCF_advance(filter->currentPtr, filter->N, filter->mask, length);
+
+        in += length;
+        out += length;
+        numSamples -= length;
+    }
+}
+
+
+
+// ============================================================================================================== //
+
+
+/*
+ *  Inputs:
+ *    lfo:          Pointer to the LFO
+ *    frequency:    LFO frequency (Hz)
+ *    fs:           Sampling frequency (Hz)
+ *
+ *  Returns:
+ *    0 if the frequency is negative or fs is not positive.  1 otherwise
+ */
+int32_t MW_DSP_ModAPCF_LFO_init(MW_DSP_ModAPCF_LFO *lfo, float32_t frequency, float32_t fs)
+{
+    if (lfo == NULL)
+        return 0;
+
+    if (frequency < 0.f || fs <= 0.f)
+        return 0;
+
+    lfo->phase = 0.f;
+    lfo->phaseIncrement = frequency / fs;
+
+    return 1;
+}
+
+
+void MW_DSP_ModAPCF_LFO_advance(MW_DSP_ModAPCF_LFO *lfo, size_t numSamples)
+{
+    lfo->phase += lfo->phaseIncrement * numSamples;
+    lfo->phase -= (int32_t)lfo->phase;
+}
+
+
+static float32_t MW_DSP_ModAPCF_delayAt(MW_DSP_ModAPCF *filter, float32_t phase)
+{
+    return filter->M + (filter->depth * arm_sin_f32(2.f * PI * (phase + filter->phaseOffset)));
+}
+
+
+/*
+ *  Inputs:
+ *    filter:           Pointer to the modulated APCF
+ *    delayLineBuffer:  Delay line memory of MW_DSP_RINGBUFFER_MEMORY_SIZE(bufferSize, MW_DSP_MODAPCF_GUARD_SIZE) samples.
+ *                      It is cleared
+ *    bufferSize:       Delay line length.  Must be more than M + depth + 1
+ *    M:                Centre delay length (samples)
+ *    depth:            Modulation depth (samples).  M - depth must be at least 1
+ *    phaseOffset:      Offset added to the LFO phase (in cycles)
+ *    gain:             APCF gain
+ *
+ *  Returns:
+ *    0 if the delay range does not fit the buffer or the gain is invalid.  1 otherwise
+ */
+int32_t MW_DSP_ModAPCF_init(MW_DSP_ModAPCF *filter, float32_t *delayLineBuffer, int32_t bufferSize, float32_t M, float32_t depth, float32_t phaseOffset, float32_t gain)
+{
+    if (filter == NULL || delayLineBuffer == NULL)
+        return 0;
+
+    if (depth < 0.f || M - depth < 1.f || M + depth + 1.f >= bufferSize || gain >= 1.f)
+        return 0;
+
+    if (!MW_DSP_RingBuffer_init(&filter->ringBuffer, delayLineBuffer, bufferSize, MW_DSP_MODAPCF_GUARD_SIZE))
+        return 0;
+
+    filter->minDelay = (int32_t)(M - depth);
+    filter->M = M;
+    filter->depth = depth;
+    filter->phaseOffset = phaseOffset;
+    filter->gain = gain;
+
+    MW_DSP_ModAPCF_reset(filter);
+
+    return 1;
+}
+
+
+/*
+ *  Runs a block through the filter.  The delay is ramped from where the last block ended to its value at the LFO phase
+ *  reached at the end of this block.  The LFO is not advanced (see MW_DSP_ModAPCF_LFO)
+ *
+ *  Each sub-block is no longer than minDelay, so the delayed samples it needs are all older than the sub-block.  They are
+ *  gathered, interpolated and run through the APCF in one pass, then the sub-block is written back with one copy on each
+ *  side of the wrap.  The older tap is wrapped once and the newer tap is the sample after it, which the guard zone covers
+ *  at the end of the buffer
+ *
+ *  Inputs:
+ *    filter:       Pointer to the modulated APCF
+ *    lfo:          Shared LFO, at its phase for the start of the block
+ *    in:           Input samples
+ *    out:          Output samples (can be the same as in)
+ *    numSamples:   Number of samples to process
+ */
+void MW_DSP_ModAPCF_process(MW_DSP_ModAPCF *filter, const MW_DSP_ModAPCF_LFO *lfo, float32_t *in, float32_t *out, size_t numSamples)
+{
+    #ifdef NO_OPTIMIZE
+    if (filter == NULL || lfo == NULL || in == NULL || out == NULL) while(1);
+    #endif
+
+    if (numSamples == 0)
+        return;
+
+    float32_t v[MW_DSP_APCF_BLOCK_SIZE];
+
+    float32_t endDelay = MW_DSP_ModAPCF_delayAt(filter, lfo->phase + (lfo->phaseIncrement * numSamples));
+    float32_t delayIncrement = (endDelay - filter->currentDelay) / numSamples;
+    float32_t delay = filter->currentDelay;
+
+    size_t maxBlockSize = MW_DSP_APCF_BLOCK_SIZE;
+    if (maxBlockSize > (size_t)filter->minDelay)
+        maxBlockSize = filter->minDelay;
+
+    float32_t *delayLine = filter->ringBuffer.buffer;
+    int32_t bufferSize = filter->ringBuffer.N;
+    float32_t minDelay = (float32_t)filter->minDelay;
+    float32_t gain = filter->gain;
+
+    while (numSamples > 0)
+    {
+        size_t blockSize = numSamples < maxBlockSize ? numSamples : maxBlockSize;
+        int32_t ptr = filter->currentPtr;
+
+        for (size_t i = 0; i < blockSize; ++i)
+        {
+            delay += delayIncrement;
+
+            //  Rounding in the ramp or the sine can land just under M - depth
+            float32_t clampedDelay = delay < minDelay ? minDelay : delay;
+            int32_t delayInt = (int32_t)clampedDelay;
+            float32_t delayFrac = clampedDelay - delayInt;
+
+            //  i < minDelay <= delayInt, so older is in [-bufferSize, bufferSize - 2] before the wrap
+            int32_t older = ptr + (int32_t)i - delayInt - 1;
+            older += (older < 0) * bufferSize;
+
+            float32_t newerSample = delayLine[older + 1];
+            float32_t delayed = newerSample + (delayFrac * (delayLine[older] - newerSample));
+
+            v[i] = in[i] - (gain * delayed);
+            out[i] = delayed + (gain * v[i]);
+        }
+
+        MW_DSP_RingBuffer_writeBlock(&filter->ringBuffer, ptr, v, (int32_t)blockSize);
+
+        ptr += (int32_t)blockSize;
+        ptr -= (ptr >= bufferSize) * bufferSize;
+        filter->currentPtr = ptr;
+        in += blockSize;
+        out += blockSize;
+        numSamples -= blockSize;
+    }
+
+    filter->currentDelay = endDelay;
+}
+
+
+//  Clears the delay line and sets the delay to its value at an LFO phase of 0
+void MW_DSP_ModAPCF_reset(MW_DSP_ModAPCF *filter)
+{
+    MW_DSP_RingBuffer_reset(&filter->ringBuffer);
+
+    filter->currentPtr = 0;
+    filter->currentDelay = MW_DSP_ModAPCF_delayAt(filter, 0.f);
+}
@@ -28,13 +28,26 @@
 #define MW_DSP_APCF_H_
 
 #include "arm_math.h"
+#include "MW_DSP_RingBuffer.h"
 
+//  MW_DSP_APCF_process() and MW_DSP_NestedAPCF_process() work on blocks of up to this many samples at a time.
+//  Filters with a delay shorter than this fall back to the tick functions
+#define MW_DSP_APCF_BLOCK_SIZE 32
+
+/*
+ *  mask is 0 unless the APCF was initialized with MW_DSP_APCF_init_pow2()
+ *  In that case the delay line buffer holds (mask + 1) samples (a power of two) while N is the delay length
+ *
+ *  delayLineQ15 is NULL unless the APCF was initialized with MW_DSP_APCF_init_q15() (delayLine is NULL in that case)
+ */
 typedef struct
 {
     float32_t   *delayLine;
+    q15_t       *delayLineQ15;
     float32_t   gain;
     int32_t     N;
     int32_t     currentPtr;
+    int32_t     mask;
 }MW_DSP_APCF;
 
 
@@ -45,9 +58,11 @@ typedef struct
 typedef struct
 {
     float32_t       *delayLine;
+    q15_t           *delayLineQ15;
     float32_t       gain;
     int32_t         N;
     int32_t         currentPtr;
+    int32_t         mask;
 
     MW_DSP_APCF     *innerAPCFs;
     int32_t         numInnerAPCFs;
@@ -57,11 +72,64 @@ typedef struct
 
 
 int32_t     MW_DSP_APCF_init(MW_DSP_APCF *filter, float32_t *delayLineBuffer, int32_t N, float32_t gain);
+int32_t     MW_DSP_APCF_init_pow2(MW_DSP_APCF *filter, float32_t *delayLineBuffer, int32_t bufferSize, int32_t N, float32_t gain);
+int32_t     MW_DSP_APCF_init_q15(MW_DSP_APCF *filter, q15_t *delayLineBuffer, int32_t N, float32_t gain);
 float32_t   MW_DSP_APCF_tick(MW_DSP_APCF *filter, float32_t x);
+void        MW_DSP_APCF_process(MW_DSP_APCF *filter, float32_t *in, float32_t *out, size_t numSamples);
 
 
 int32_t     MW_DSP_NestedAPCF_init(MW_DSP_NestedAPCF *filter, float32_t *delayLineBuffer, int32_t N, float32_t gain, MW_DSP_APCF *innerAPCFs, int32_t numInnerAPCFs);
+int32_t     MW_DSP_NestedAPCF_init_pow2(MW_DSP_NestedAPCF *filter, float32_t *delayLineBuffer, int32_t bufferSize, int32_t N, float32_t gain, MW_DSP_APCF *innerAPCFs, int32_t numInnerAPCFs);
+int32_t     MW_DSP_NestedAPCF_init_q15(MW_DSP_NestedAPCF *filter, q15_t *delayLineBuffer, int32_t N, float32_t gain, MW_DSP_APCF *innerAPCFs, int32_t numInnerAPCFs);
 float32_t   MW_DSP_NestedAPCF_tick(MW_DSP_NestedAPCF *filter, float32_t x);
+void        MW_DSP_NestedAPCF_process(MW_DSP_NestedAPCF *filter, float32_t *in, float32_t *out, size_t numSamples);
+
+
+
+/*
+ *  LFO shared by a group of MW_DSP_ModAPCF filters
+ *  phase is in [0, 1) and is only evaluated at control rate (once per processed block by each filter).  Run every filter of
+ *  the group over a block, then call MW_DSP_ModAPCF_LFO_advance() with the block size
+ */
+typedef struct
+{
+    float32_t   phase;
+    float32_t   phaseIncrement;     //  Per sample
+}MW_DSP_ModAPCF_LFO;
+
+
+/*
+ *  APCF with a modulated, fractional delay length (linear interpolation) for reverb diffusers
+ *  The delay is M + depth * sin(2 * PI * (lfo phase + phaseOffset)).  It is computed at the start and end of each block and
+ *  ramped linearly in between, so a block costs one sine per filter.  Giving each filter of a group a different phaseOffset
+ *  decorrelates them while they share one LFO.
+ *
+ *  minDelay is the shortest integer delay the modulation can reach.  Blocks are processed minDelay samples (or
+ *  MW_DSP_APCF_BLOCK_SIZE) at a time so that every delayed sample is read before the block is written.  The delay line has
+ *  a guard zone of MW_DSP_MODAPCF_GUARD_SIZE samples (see MW_DSP_RingBuffer) so both interpolation taps are read without a
+ *  wrap check
+ */
+#define MW_DSP_MODAPCF_GUARD_SIZE 1
+
+typedef struct
+{
+    MW_DSP_RingBuffer   ringBuffer;
+    int32_t     currentPtr;
+    int32_t     minDelay;
+    float32_t   M;
+    float32_t   depth;
+    float32_t   phaseOffset;
+    float32_t   gain;
+    float32_t   currentDelay;       //  Delay length at the end of the last block
+}MW_DSP_ModAPCF;
+
+
+int32_t     MW_DSP_ModAPCF_LFO_init(MW_DSP_ModAPCF_LFO *lfo, float32_t frequency, float32_t fs);
+void        MW_DSP_ModAPCF_LFO_advance(MW_DSP_ModAPCF_LFO *lfo, size_t numSamples);
+
+int32_t     MW_DSP_ModAPCF_init(MW_DSP_ModAPCF *filter, float32_t *delayLineBuffer, int32_t bufferSize, float32_t M, float32_t depth, float32_t phaseOffset, float32_t gain);
+void        MW_DSP_ModAPCF_process(MW_DSP_ModAPCF *filter, const MW_DSP_ModAPCF_LFO *lfo, float32_t *in, float32_t *out, size_t numSamples);
+void        MW_DSP_ModAPCF_reset(MW_DSP_ModAPCF *filter);
 
 
 #endif /* MW_DSP_APCF_H_ */
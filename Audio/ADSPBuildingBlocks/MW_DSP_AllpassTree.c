@@ -0,0 +1,239 @@
+//  Copyright 2021 Allen Lee
+//
+//  Author:  Allen Lee (alee@meoworkshop.org)
+//  
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//  For more information, please refer to https://opensource.org/licenses/mit-license.php
+//
+//  ------------------------------------------------------------------------------------------------  //
+
+
+
+#include "MW_DSP_AllpassTree.h"
+
+
+/*
+ *  Returns the number of samples of memory needed by the delay lines of a tree, or 0 if a delay length is invalid
+ */
+int32_t MW_DSP_AllpassTree_calculateMemorySize(const MW_DSP_AllpassTreeNode *nodes, int32_t numNodes)
+{
+    if (nodes == NULL)
+        return 0;
+
+    int32_t memorySize = 0;
+    for (int32_t i = 0; i < numNodes; ++i)
+    {
+        if (nodes[i].N <= 0)
+            return 0;
+
+        memorySize += nodes[i].N;
+    }
+
+    return memorySize;
+}
+
+
+/*
+ *  Compiles a tree descriptor (see MW_DSP_AllpassTreeNode) into a flat schedule.  The delay lines are placed one after another
+ *  in memory in the same order as the descriptor, and are cleared
+ *
+ *  Inputs:
+ *    tree:         Pointer to the allpass tree
+ *    nodes:        Tree descriptor in pre-order.  Not needed after initialization
+ *    numNodes:     Number of nodes (up to MW_DSP_ALLPASSTREE_MAX_NODES)
+ *    memory:       Memory for the delay lines
+ *    memorySize:   Number of samples in memory.  Must be at least MW_DSP_AllpassTree_calculateMemorySize()
+ *
+ *  Returns:
+ *    0 if a node has an invalid delay length or gain, the descriptor is malformed (a node claims more children than follow it)
+ *    or nested deeper than MW_DSP_ALLPASSTREE_MAX_DEPTH, or memory is too small.  1 otherwise
+ */
+int32_t MW_DSP_AllpassTree_init(MW_DSP_AllpassTree *tree, const MW_DSP_AllpassTreeNode *nodes, int32_t numNodes, float32_t *memory, int32_t memorySize)
+{
+    if (tree == NULL || nodes == NULL || memory == NULL)
+        return 0;
+
+    if (numNodes <= 0 || numNodes > MW_DSP_ALLPASSTREE_MAX_NODES)
+        return 0;
+
+    int32_t requiredMemorySize = MW_DSP_AllpassTree_calculateMemorySize(nodes, numNodes);
+    if (requiredMemorySize == 0 || requiredMemorySize > memorySize)
+        return 0;
+
+    //  Walk the descriptor keeping the chain of open nodes and how many children each one still has to take
+    int32_t openNodes[MW_DSP_ALLPASSTREE_MAX_DEPTH];
+    int32_t childrenLeft[MW_DSP_ALLPASSTREE_MAX_DEPTH];
+    int32_t depth = 0;
+    int32_t scheduleLength = 0;
+    int32_t offset = 0;
+    int32_t minN = nodes[0].N;
+
+    for (int32_t i = 0; i < numNodes; ++i)
+    {
+        if (fabsf(nodes[i].gain) >= 1.f || nodes[i].numChildren < 0 || depth == MW_DSP_ALLPASSTREE_MAX_DEPTH)
+            return 0;
+
+        if (depth > 0)
+            childrenLeft[depth - 1]--;
+
+        tree->N[i] = nodes[i].N;
+        tree->gain[i] = nodes[i].gain;
+        tree->offset[i] = offset;
+        tree->currentPtr[i] = 0;
+        offset += nodes[i].N;
+
+        if (nodes[i].N < minN)
+            minN = nodes[i].N;
+
+        tree->schedule[scheduleLength++] = i;
+        openNodes[depth] = i;
+        childrenLeft[depth] = nodes[i].numChildren;
+        depth++;
+
+        while (depth > 0 && childrenLeft[depth - 1] == 0)
+        {
+            depth--;
+            tree->schedule[scheduleLength++] = ~openNodes[depth];
+        }
+    }
+
+    if (depth != 0)
+        return 0;
+
+    tree->memory = memory;
+    tree->numNodes = numNodes;
+    tree->minN = minN;
+    tree->scheduleLength = scheduleLength;
+
+    MW_DSP_AllpassTree_reset(tree);
+
+    return 1;
+}
+
+
+float32_t MW_DSP_AllpassTree_tick(MW_DSP_AllpassTree *tree, float32_t x)
+{
+    float32_t y;
+    MW_DSP_AllpassTree_process(tree, &x, &y, 1);
+    return y;
+}
+
+
+/*
+ *  Runs the tree over a block.  Up to MW_DSP_ALLPASSTREE_BLOCK_SIZE samples (but no more than the shortest delay) go
+ *  through the schedule at a time.  Entering a node reads its delayed samples and forms v = x - gain * delayed, which
+ *  becomes the input of its children.  Leaving a node writes the output of its children into its delay line and forms
+ *  y = delayed + gain * v.  Since no block is longer than any delay, every delayed sample a block needs was written before
+ *  the block started.  Each nesting level keeps its delayed and v samples in its own scratch buffers
+ *
+ *  Inputs:
+ *    tree:         Pointer to the allpass tree
+ *    in:           Input samples
+ *    out:          Output samples (can be the same as in)
+ *    numSamples:   Number of samples to process
+ */
+void MW_DSP_AllpassTree_process(MW_DSP_AllpassTree *tree, float32_t *in, float32_t *out, size_t numSamples)
+{
+    #ifdef NO_OPTIMIZE
+    if (tree == NULL || in == NULL || out == NULL) while(1);
+    #endif
+
+    float32_t delayed[MW_DSP_ALLPASSTREE_MAX_DEPTH][MW_DSP_ALLPASSTREE_BLOCK_SIZE];
+    float32_t v[MW_DSP_ALLPASSTREE_MAX_DEPTH][MW_DSP_ALLPASSTREE_BLOCK_SIZE];
+
+    size_t maxBlockSize = MW_DSP_ALLPASSTREE_BLOCK_SIZE;
+    if (maxBlockSize > (size_t)tree->minN)
+        maxBlockSize = tree->minN;
+
+    while (numSamples > 0)
+    {
+        int32_t blockSize = numSamples < maxBlockSize ? numSamples : maxBlockSize;
+        float32_t *x = in;
+        int32_t depth = 0;
+
+        for (int32_t s = 0; s < tree->scheduleLength; ++s)
+        {
+            int32_t node = tree->schedule[s];
+
+            if (node >= 0)
+            {
+                float32_t *delayLine = tree->memory + tree->offset[node];
+                float32_t *d = delayed[depth];
+                float32_t *vd = v[depth];
+                float32_t gain = tree->gain[node];
+                int32_t ptr = tree->currentPtr[node];
+                int32_t N = tree->N[node];
+
+                for (int32_t i = 0; i < blockSize; ++i)
+                {
+                    d[i] = delayLine[ptr];
+                    vd[i] = x[i] - (gain * d[i]);
+                    if (++ptr == N)
+                        ptr = 0;
+                }
+
+                x = vd;
+                depth++;
+            }
+            else
+            {
+                node = ~node;
+                depth--;
+
+                float32_t *delayLine = tree->memory + tree->offset[node];
+                float32_t *d = delayed[depth];
+                float32_t *vd = v[depth];
+                float32_t gain = tree->gain[node];
+                int32_t ptr = tree->currentPtr[node];
+                int32_t N = tree->N[node];
+
+                //  x is the output of the children (or vd itself for a node without children)
+                for (int32_t i = 0; i < blockSize; ++i)
+                {
+                    delayLine[ptr] = x[i];
+                    vd[i] = d[i] + (gain * vd[i]);
+                    if (++ptr == N)
+                        ptr = 0;
+                }
+
+                tree->currentPtr[node] = ptr;
+                x = vd;
+            }
+        }
+
+        arm_copy_f32(x, out, blockSize);
+
+        in += blockSize;
+        out += blockSize;
+        numSamples -= blockSize;
+    }
+}
+
+
+//  Clears the delay lines
+void MW_DSP_AllpassTree_reset(MW_DSP_AllpassTree *tree)
+{
+    int32_t memorySize = tree->offset[tree->numNodes - 1] + tree->N[tree->numNodes - 1];
+
+    arm_fill_f32(0.f, tree->memory, memorySize);
+
+    for (int32_t i = 0; i < tree->numNodes; ++i)
+        tree->currentPtr[i] = 0;
+}
@@ -0,0 +1,90 @@
+//  Copyright 2021 Allen Lee
+//
+//  Author:  Allen Lee (alee@meoworkshop.org)
+//  
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//  For more information, please refer to https://opensource.org/licenses/mit-license.php
+//
+//  ------------------------------------------------------------------------------------------------  //
+
+
+#ifndef MW_DSP_ALLPASSTREE_H_
+#define MW_DSP_ALLPASSTREE_H_
+
+#include "arm_math.h"
+
+#define MW_DSP_ALLPASSTREE_MAX_NODES 16
+
+//  Maximum nesting depth (a tree of APCFs in series with no nesting has a depth of 1)
+#define MW_DSP_ALLPASSTREE_MAX_DEPTH 4
+
+//  The tree is run this many samples at a time (or less if a delay is shorter than this)
+#define MW_DSP_ALLPASSTREE_BLOCK_SIZE 32
+
+
+/*
+ *  Descriptor for one APCF in an allpass tree
+ *
+ *  A tree is described by an array of nodes in pre-order: every node is followed by its numChildren children (each with its
+ *  own children following it).  The children of a node run in series inside its feedback loop, between the feedforward
+ *  sum and the delay line, in the same way as the inner APCFs of MW_DSP_NestedAPCF.  Nodes at the top level run in series.
+ *
+ *  For example, the first nested APCF of the Gardner small room reverb followed by its standalone APCF is described by
+ *    {N = 35 msec, gain = 0.3, numChildren = 2}
+ *    {N = 22 msec, gain = 0.4, numChildren = 0}
+ *    {N = 8.3 msec, gain = 0.6, numChildren = 0}
+ *    {N = 30 msec, gain = 0.4, numChildren = 0}
+ */
+typedef struct
+{
+    int32_t     N;
+    float32_t   gain;
+    int32_t     numChildren;
+}MW_DSP_AllpassTreeNode;
+
+
+/*
+ *  Compiled allpass tree
+ *  Every delay line lives in one block of memory (delay line k starts at offset[k]).  The schedule holds the order in which
+ *  the nodes are entered and left (an entry of k enters node k and ~k leaves it), so the tree can be run without recursion
+ *  or per-node function calls.  minN is the shortest delay, which limits how many samples can be run as one block
+ */
+typedef struct
+{
+    float32_t   *memory;
+    int32_t     numNodes;
+    int32_t     minN;
+    int32_t     scheduleLength;
+    int32_t     schedule[2 * MW_DSP_ALLPASSTREE_MAX_NODES];
+    int32_t     N[MW_DSP_ALLPASSTREE_MAX_NODES];
+    int32_t     offset[MW_DSP_ALLPASSTREE_MAX_NODES];
+    int32_t     currentPtr[MW_DSP_ALLPASSTREE_MAX_NODES];
+    float32_t   gain[MW_DSP_ALLPASSTREE_MAX_NODES];
+}MW_DSP_AllpassTree;
+
+
+int32_t     MW_DSP_AllpassTree_calculateMemorySize(const MW_DSP_AllpassTreeNode *nodes, int32_t numNodes);
+int32_t     MW_DSP_AllpassTree_init(MW_DSP_AllpassTree *tree, const MW_DSP_AllpassTreeNode *nodes, int32_t numNodes, float32_t *memory, int32_t memorySize);
+float32_t   MW_DSP_AllpassTree_tick(MW_DSP_AllpassTree *tree, float32_t x);
+void        MW_DSP_AllpassTree_process(MW_DSP_AllpassTree *tree, float32_t *in, float32_t *out, size_t numSamples);
+void        MW_DSP_AllpassTree_reset(MW_DSP_AllpassTree *tree);
+
+
+#endif /* MW_DSP_ALLPASSTREE_H_ */
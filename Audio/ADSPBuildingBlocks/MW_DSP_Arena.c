@@ -0,0 +1,155 @@
+//  Copyright 2021 Allen Lee
+//
+//  Author:  Allen Lee (alee@meoworkshop.org)
+//  
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//  For more information, please refer to https://opensource.org/licenses/mit-license.php
+//
+//  ------------------------------------------------------------------------------------------------  //
+
+
+
+#include "MW_DSP_Arena.h"
+
+
+/*
+ *  Initialize an instance of MW_DSP_Arena
+ *  NOTE:  The arena will NOT allocate memory for you.  Pass in a pre-allocated block (a static array for instance) that is
+ *  large enough for every buffer the arena will hand out.  Use MW_DSP_ARENA_MEMORY_SIZE() to size it
+ *
+ *  Inputs:
+ *    arena:        Pointer to MW_DSP_Arena instance
+ *    memory:       Pointer to the block of memory to allocate from.  It does not need to be aligned
+ *    memorySize:   Size of memory in bytes
+ *
+ *  Returns:
+ *    1 if successful, 0 otherwise
+ */
+int32_t MW_DSP_Arena_init(MW_DSP_Arena *arena, void *memory, size_t memorySize)
+{
+  if (arena == NULL || memory == NULL)
+    return 0;
+
+  uintptr_t start = (uintptr_t)memory;
+  uintptr_t alignedStart = (start + MW_DSP_ARENA_ALIGNMENT - 1) & ~((uintptr_t)MW_DSP_ARENA_ALIGNMENT - 1);
+  size_t padding = (size_t)(alignedStart - start);
+
+  if (memorySize <= padding)
+    return 0;
+
+  arena->base = (uint8_t*)memory + padding;
+  arena->size = memorySize - padding;
+  arena->used = 0;
+
+  return 1;
+}
+
+
+/*
+ *  Allocate numBytes from the arena.  The returned buffer is aligned to MW_DSP_ARENA_ALIGNMENT bytes and is NOT cleared
+ *
+ *  Inputs:
+ *    arena:      Pointer to MW_DSP_Arena instance (must be previously initialized)
+ *    numBytes:   Number of bytes to allocate
+ *
+ *  Returns:
+ *    Pointer to the buffer
+ *    NULL if the arena does not have enough memory left (nothing is allocated in that case)
+ */
+void* MW_DSP_Arena_alloc(MW_DSP_Arena *arena, size_t numBytes)
+{
+#ifdef NO_OPTIMIZE
+  assert(arena != NULL);
+#endif
+
+  if (arena == NULL || numBytes == 0)
+    return NULL;
+
+  size_t alignedSize = MW_DSP_ARENA_ALIGNED_SIZE(numBytes);
+  if (alignedSize < numBytes || alignedSize > arena->size - arena->used)
+    return NULL;
+
+  void *buffer = arena->base + arena->used;
+  arena->used += alignedSize;
+
+  return buffer;
+}
+
+
+/*
+ *  Same as MW_DSP_Arena_alloc() for an array of numSamples float32_t samples
+ */
+float32_t* MW_DSP_Arena_allocFloat(MW_DSP_Arena *arena, size_t numSamples)
+{
+  if (numSamples > SIZE_MAX / sizeof(float32_t))
+    return NULL;
+
+  return (float32_t*)MW_DSP_Arena_alloc(arena, numSamples * sizeof(float32_t));
+}
+
+
+/*
+ *  Save the current allocation offset.  Passing the marker to MW_DSP_Arena_release() frees everything allocated after it
+ *  (init_arena functions use this to give memory back when initialization fails)
+ */
+size_t MW_DSP_Arena_mark(MW_DSP_Arena *arena)
+{
+#ifdef NO_OPTIMIZE
+  assert(arena != NULL);
+#endif
+
+  return arena->used;
+}
+
+
+void MW_DSP_Arena_release(MW_DSP_Arena *arena, size_t marker)
+{
+#ifdef NO_OPTIMIZE
+  assert(arena != NULL);
+  assert(marker <= arena->used);
+#endif
+
+  if (marker <= arena->used)
+    arena->used = marker;
+}
+
+
+/*
+ *  Free every buffer allocated from the arena.  Any unit that was initialized with memory from the arena must be
+ *  re-initialized before it is used again
+ */
+void MW_DSP_Arena_reset(MW_DSP_Arena *arena)
+{
+#ifdef NO_OPTIMIZE
+  assert(arena != NULL);
+#endif
+
+  arena->used = 0;
+}
+
+
+size_t MW_DSP_Arena_bytesRemaining(MW_DSP_Arena *arena)
+{
+#ifdef NO_OPTIMIZE
+  assert(arena != NULL);
+#endif
+
+  return arena->size - arena->used;
+}
@@ -0,0 +1,71 @@
+//  Copyright 2021 Allen Lee
+//
+//  Author:  Allen Lee (alee@meoworkshop.org)
+//  
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//  For more information, please refer to https://opensource.org/licenses/mit-license.php
+//
+//  ------------------------------------------------------------------------------------------------  //
+
+
+#ifndef MW_DSP_ARENA_H_
+#define MW_DSP_ARENA_H_
+
+#include "arm_math.h"
+#include "assert.h"
+
+//  Every allocation starts on a MW_DSP_ARENA_ALIGNMENT byte boundary (a cache line on Cortex-M7 and an AVX vector on hosts)
+#define MW_DSP_ARENA_ALIGNMENT 32
+
+//  Number of arena bytes taken by an allocation of numBytes (including the padding up to the next aligned address)
+#define MW_DSP_ARENA_ALIGNED_SIZE(numBytes) (((numBytes) + MW_DSP_ARENA_ALIGNMENT - 1) & ~((size_t)MW_DSP_ARENA_ALIGNMENT - 1))
+
+//  Number of bytes to pass into MW_DSP_Arena_init() to hold allocations totalling numBytes (the extra alignment covers an
+//  unaligned memory block)
+#define MW_DSP_ARENA_MEMORY_SIZE(numBytes) ((numBytes) + MW_DSP_ARENA_ALIGNMENT)
+
+
+/*
+ *  Bump allocator for building block memory
+ *  The arena hands out aligned buffers from one pre-allocated block of memory.  Allocating only moves an offset (O(1)), and
+ *  memory is given back all at once with MW_DSP_Arena_reset() or back to a saved marker with MW_DSP_Arena_release().
+ *  Buffers allocated one after another sit next to each other in memory, so a chain of effects that is initialized in
+ *  processing order walks through memory linearly.
+ *
+ *  base is the first aligned address in the memory block and size is the number of bytes from base to the end of the block
+ */
+typedef struct
+{
+  uint8_t   *base;
+  size_t    size;
+  size_t    used;
+}MW_DSP_Arena;
+
+
+int32_t     MW_DSP_Arena_init(MW_DSP_Arena *arena, void *memory, size_t memorySize);
+void*       MW_DSP_Arena_alloc(MW_DSP_Arena *arena, size_t numBytes);
+float32_t*  MW_DSP_Arena_allocFloat(MW_DSP_Arena *arena, size_t numSamples);
+size_t      MW_DSP_Arena_mark(MW_DSP_Arena *arena);
+void        MW_DSP_Arena_release(MW_DSP_Arena *arena, size_t marker);
+void        MW_DSP_Arena_reset(MW_DSP_Arena *arena);
+size_t      MW_DSP_Arena_bytesRemaining(MW_DSP_Arena *arena);
+
+
+#endif /* MW_DSP_ARENA_H_ */
@@ -26,6 +26,7 @@
 
 
 #include "MW_DSP_CombFilter.h"
+#include "MW_DSP_DelayLine.h"
 
 int32_t MW_DSP_FBCF_init(MW_DSP_FBCF *filter, float32_t *delayLine, int32_t N, float32_t b0, float32_t am)
 {
@@ -33,19 +34,68 @@ int32_t MW_DSP_FBCF_init(MW_DSP_FBCF *filter, float32_t *delayLine, int32_t N, f
         return 0;
 
     filter->delayLine = delayLine;
+    filter->delayLineQ15 = NULL;
     filter->b0 = b0;
     filter->am = am;
     filter->currentPtr = 0;
     filter->N = N;
+    filter->mask = 0;
 
     return 1;
 }
 
 
+/*
+ *  Same as MW_DSP_FBCF_init() except that the delay line buffer size is a power of two (and at least N samples long)
+ *  so that wrapping the delay line pointer is a bitwise AND instead of an integer divide.
+ *  Use MW_DSP_DelayLine_nextPowerOfTwo() to find bufferSize for a given N
+ */
+int32_t MW_DSP_FBCF_init_pow2(MW_DSP_FBCF *filter, float32_t *delayLine, int32_t bufferSize, int32_t N, float32_t b0, float32_t am)
+{
+    if (bufferSize < N || (bufferSize & (bufferSize - 1)) != 0)
+        return 0;
+
+    if (!MW_DSP_FBCF_init(filter, delayLine, N, b0, am))
+        return 0;
+
+    filter->mask = bufferSize - 1;
+
+    return 1;
+}
+
+
+/*
+ *  Same as MW_DSP_FBCF_init() except that the delay line is stored as Q15 (see MW_DSP_DelayLine_init_q15()) which halves
+ *  its memory.  The delay line holds the comb output, which is b0 / (1 - |am|) times louder than the input in the worst case,
+ *  so scale b0 to leave enough headroom.  The delay line buffer is cleared
+ */
+int32_t MW_DSP_FBCF_init_q15(MW_DSP_FBCF *filter, q15_t *delayLine, int32_t N, float32_t b0, float32_t am)
+{
+    if (filter == NULL || delayLine == NULL || N <= 0)
+        return 0;
+
+    filter->delayLine = NULL;
+    filter->delayLineQ15 = delayLine;
+    filter->b0 = b0;
+    filter->am = am;
+    filter->currentPtr = 0;
+    filter->N = N;
+    filter->mask = 0;
+
+    arm_fill_q15(0, delayLine, N);
+
+    return 1;
+}
+
+
+/*
+ *  tick() is for delay lines initialized with MW_DSP_FBCF_init().  Power-of-two and Q15 delay lines have their own entry
+ *  points (MW_DSP_FBCF_tick_pow2() and MW_DSP_FBCF_tick_q15()) so that the plain delay line doesn't pay for their checks
+ */
 float32_t MW_DSP_FBCF_tick(MW_DSP_FBCF *filter, float32_t x)
 {
     #ifdef NO_OPTIMIZE
-    if (filter == NULL)
+    if (filter == NULL || filter->mask || filter->delayLineQ15)
         while(1);
     #endif
 
@@ -55,4 +105,307 @@ float32_t MW_DSP_FBCF_tick(MW_DSP_FBCF *filter, float32_t x)
     filter->currentPtr = (filter->currentPtr + 1) % filter->N;
 
     return v;
-}
\ No newline at end of file
+}
+
+
+/*
+ *  Same as MW_DSP_FBCF_tick() for delay lines initialized with MW_DSP_FBCF_init_pow2()
+ */
+float32_t MW_DSP_FBCF_tick_pow2(MW_DSP_FBCF *filter, float32_t x)
+{
+    #ifdef NO_OPTIMIZE
+    if (filter == NULL || filter->mask == 0)
+        while(1);
+    #endif
+
+    int32_t readPtr = (filter->currentPtr - filter->N) & filter->mask;
+
+    float32_t v = (x * filter->b0) + (filter->delayLine[readPtr] * filter->am);
+    filter->delayLine[filter->currentPtr] = v;
+
+    filter->currentPtr = (filter->currentPtr + 1) & filter->mask;
+
+    return v;
+}
+
+
+/*
+ *  Same as MW_DSP_FBCF_tick() for delay lines initialized with MW_DSP_FBCF_init_q15()
+ */
+float32_t MW_DSP_FBCF_tick_q15(MW_DSP_FBCF *filter, float32_t x)
+{
+    #ifdef NO_OPTIMIZE
+    if (filter == NULL || filter->delayLineQ15 == NULL)
+        while(1);
+    #endif
+
+    float32_t v = (x * filter->b0) + (MW_DSP_DelayLine_q15ToFloat(filter->delayLineQ15[filter->currentPtr]) * filter->am);
+    filter->delayLineQ15[filter->currentPtr] = MW_DSP_DelayLine_floatToQ15(v);
+
+    filter->currentPtr = (filter->currentPtr + 1) % filter->N;
+
+    return v;
+}
+
+
+
+// ============================================================================================================== //
+
+
+/*
+ *  Returns the number of samples of memory needed by the delay lines of a comb bank, or 0 if a delay length is invalid
+ */
+int32_t MW_DSP_FBCFBank_calculateMemorySize(const int32_t *N, int32_t numCombs)
+{
+    if (N == NULL)
+        return 0;
+
+    int32_t memorySize = 0;
+    for (int32_t i = 0; i < numCombs; ++i)
+    {
+        if (N[i] <= 0)
+            return 0;
+
+        memorySize += N[i];
+    }
+
+    return memorySize;
+}
+
+
+/*
+ *  Inputs:
+ *    bank:         Pointer to the comb bank
+ *    memory:       Memory for the delay lines.  It is cleared
+ *    memorySize:   Number of samples in memory.  Must be at least MW_DSP_FBCFBank_calculateMemorySize()
+ *    N:            Delay length of each comb
+ *    b0:           Feedforward gain of each comb
+ *    am:           Feedback gain of each comb
+ *    numCombs:     Number of combs (up to MW_DSP_FBCFBANK_MAX_COMBS)
+ *
+ *  The feedback lowpass filters are off (see MW_DSP_FBCFBank_setDamping())
+ *
+ *  Returns:
+ *    0 if there are too many combs, a delay length is invalid or memory is too small.  1 otherwise
+ */
+int32_t MW_DSP_FBCFBank_init(MW_DSP_FBCFBank *bank, float32_t *memory, int32_t memorySize, const int32_t *N, const float32_t *b0, const float32_t *am, int32_t numCombs)
+{
+    if (bank == NULL || memory == NULL || N == NULL || b0 == NULL || am == NULL)
+        return 0;
+
+    if (numCombs <= 0 || numCombs > MW_DSP_FBCFBANK_MAX_COMBS)
+        return 0;
+
+    int32_t requiredMemorySize = MW_DSP_FBCFBank_calculateMemorySize(N, numCombs);
+    if (requiredMemorySize == 0 || requiredMemorySize > memorySize)
+        return 0;
+
+    float32_t *delayLine = memory;
+    int32_t minN = N[0];
+
+    for (int32_t i = 0; i < numCombs; ++i)
+    {
+        bank->delayLines[i] = delayLine;
+        bank->N[i] = N[i];
+        bank->b0[i] = b0[i];
+        bank->am[i] = am[i];
+        bank->damping[i] = 0.f;
+        delayLine += N[i];
+
+        if (N[i] < minN)
+            minN = N[i];
+    }
+
+    bank->memory = memory;
+    bank->numCombs = numCombs;
+    bank->minN = minN;
+
+    MW_DSP_FBCFBank_reset(bank);
+
+    return 1;
+}
+
+
+/*
+ *  Sets the one-pole lowpass in the feedback path of a comb.  0 turns the lowpass off and values closer to 1 damp the high
+ *  frequencies more (the same as the Freeverb damping parameter).  Pass a comb of -1 to set every comb
+ *
+ *  Returns:
+ *    0 if the comb or damping (which must be in [0, 1)) is invalid.  1 otherwise
+ */
+int32_t MW_DSP_FBCFBank_setDamping(MW_DSP_FBCFBank *bank, int32_t comb, float32_t damping)
+{
+    if (bank == NULL)
+        return 0;
+
+    if (comb < -1 || comb >= bank->numCombs || damping < 0.f || damping >= 1.f)
+        return 0;
+
+    for (int32_t i = 0; i < bank->numCombs; ++i)
+        if (comb == -1 || comb == i)
+            bank->damping[i] = damping;
+
+    return 1;
+}
+
+
+/*
+ *  Runs the delayed samples v of comb k through its lowpass and feedback, in place in its delay line.  damped is a
+ *  constant at each call site: without damping the lowpass output is the delayed sample itself, so there is no recurrence
+ *  from one sample to the next and the loop can be pipelined (or vectorized).  With damping, only one multiply-add
+ *  depends on the previous sample's lowpass state
+ */
+static inline void MW_DSP_FBCFBank_updateComb(MW_DSP_FBCFBank *bank, int32_t k, float32_t *in, float32_t *v, int32_t numSamples, const int32_t damped)
+{
+    float32_t b0 = bank->b0[k];
+    float32_t am = bank->am[k];
+
+    if (damped)
+    {
+        float32_t damping = bank->damping[k];
+        float32_t oneMinusDamping = 1.f - damping;
+        float32_t s = bank->lowpassState[k];
+
+        for (int32_t n = 0; n < numSamples; ++n)
+        {
+            s = (damping * s) + (oneMinusDamping * v[n]);
+            v[n] = (in[n] * b0) + (s * am);
+        }
+
+        bank->lowpassState[k] = s;
+    }
+    else
+    {
+        bank->lowpassState[k] = v[numSamples - 1];
+
+        for (int32_t n = 0; n < numSamples; ++n)
+            v[n] = (in[n] * b0) + (v[n] * am);
+    }
+}
+
+
+/*
+ *  Runs up to MW_DSP_FBCFBANK_BLOCK_SIZE samples (but no more than the shortest delay) through every comb.  Since the
+ *  block is no longer than any delay, every delayed sample it needs was written before the block started.  Each comb's
+ *  block is split into the contiguous segments before and after the wrap.  Each segment is updated in place in the delay
+ *  line and then copied into the comb's row of combOut
+ */
+static void MW_DSP_FBCFBank_processBlock(MW_DSP_FBCFBank *bank, float32_t *in, float32_t combOut[][MW_DSP_FBCFBANK_BLOCK_SIZE], int32_t blockSize)
+{
+    for (int32_t k = 0; k < bank->numCombs; ++k)
+    {
+        float32_t *delayLine = bank->delayLines[k];
+        int32_t ptr = bank->currentPtr[k];
+        int32_t N = bank->N[k];
+
+        int32_t segmentStart = 0;
+        while (segmentStart < blockSize)
+        {
+            int32_t segmentLength = N - ptr;
+            if (segmentLength > blockSize - segmentStart)
+                segmentLength = blockSize - segmentStart;
+
+            if (bank->damping[k] > 0.f)
+                MW_DSP_FBCFBank_updateComb(bank, k, &in[segmentStart], &delayLine[ptr], segmentLength, 1);
+            else
+                MW_DSP_FBCFBank_updateComb(bank, k, &in[segmentStart], &delayLine[ptr], segmentLength, 0);
+
+            arm_copy_f32(&delayLine[ptr], &combOut[k][segmentStart], segmentLength);
+
+            segmentStart += segmentLength;
+            ptr += segmentLength;
+            ptr -= (ptr == N) * N;
+        }
+
+        bank->currentPtr[k] = ptr;
+    }
+}
+
+
+static int32_t MW_DSP_FBCFBank_blockSize(MW_DSP_FBCFBank *bank, size_t numSamples)
+{
+    size_t blockSize = MW_DSP_FBCFBANK_BLOCK_SIZE;
+    if (blockSize > (size_t)bank->minN)
+        blockSize = bank->minN;
+
+    if (blockSize > numSamples)
+        blockSize = numSamples;
+
+    return blockSize;
+}
+
+
+/*
+ *  Runs the input through every comb and sums the comb outputs
+ *
+ *  Inputs:
+ *    bank:         Pointer to the comb bank
+ *    in:           Input samples
+ *    out:          Sum of the comb outputs (can be the same as in)
+ *    numSamples:   Number of samples to process
+ */
+void MW_DSP_FBCFBank_process(MW_DSP_FBCFBank *bank, float32_t *in, float32_t *out, size_t numSamples)
+{
+    #ifdef NO_OPTIMIZE
+    if (bank == NULL || in == NULL || out == NULL) while(1);
+    #endif
+
+    float32_t combOut[MW_DSP_FBCFBANK_MAX_COMBS][MW_DSP_FBCFBANK_BLOCK_SIZE];
+
+    while (numSamples > 0)
+    {
+        int32_t blockSize = MW_DSP_FBCFBank_blockSize(bank, numSamples);
+        MW_DSP_FBCFBank_processBlock(bank, in, combOut, blockSize);
+
+        arm_copy_f32(combOut[0], out, blockSize);
+        for (int32_t k = 1; k < bank->numCombs; ++k)
+            arm_add_f32(out, combOut[k], out, blockSize);
+
+        in += blockSize;
+        out += blockSize;
+        numSamples -= blockSize;
+    }
+}
+
+
+/*
+ *  Same as MW_DSP_FBCFBank_process() except that each comb output is written to its own buffer
+ *
+ *  Inputs:
+ *    outputs:      Array of numCombs output buffers, each holding numSamples samples.  None of them can be the same as in
+ */
+void MW_DSP_FBCFBank_processOutputs(MW_DSP_FBCFBank *bank, float32_t *in, float32_t **outputs, size_t numSamples)
+{
+    #ifdef NO_OPTIMIZE
+    if (bank == NULL || in == NULL || outputs == NULL) while(1);
+    #endif
+
+    float32_t combOut[MW_DSP_FBCFBANK_MAX_COMBS][MW_DSP_FBCFBANK_BLOCK_SIZE];
+    size_t offset = 0;
+
+    while (offset < numSamples)
+    {
+        int32_t blockSize = MW_DSP_FBCFBank_blockSize(bank, numSamples - offset);
+        MW_DSP_FBCFBank_processBlock(bank, in + offset, combOut, blockSize);
+
+        for (int32_t k = 0; k < bank->numCombs; ++k)
+            arm_copy_f32(combOut[k], &outputs[k][offset], blockSize);
+
+        offset += blockSize;
+    }
+}
+
+
+//  Clears the delay lines and lowpass states
+void MW_DSP_FBCFBank_reset(MW_DSP_FBCFBank *bank)
+{
+    int32_t memorySize = (bank->delayLines[bank->numCombs - 1] - bank->memory) + bank->N[bank->numCombs - 1];
+
+    arm_fill_f32(0.f, bank->memory, memorySize);
+
+    for (int32_t i = 0; i < bank->numCombs; ++i)
+    {
+        bank->currentPtr[i] = 0;
+        bank->lowpassState[i] = 0.f;
+    }
+}
@@ -29,17 +29,70 @@
 
 #include "arm_math.h"
 
+/*
+ *  mask is 0 unless the FBCF was initialized with MW_DSP_FBCF_init_pow2()
+ *  In that case the delay line buffer holds (mask + 1) samples (a power of two) while N is the delay length, and the filter
+ *  is run with MW_DSP_FBCF_tick_pow2()
+ *
+ *  delayLineQ15 is NULL unless the FBCF was initialized with MW_DSP_FBCF_init_q15() (delayLine is NULL in that case and the
+ *  filter is run with MW_DSP_FBCF_tick_q15())
+ */
 typedef struct
 {
     float32_t   *delayLine;
+    q15_t       *delayLineQ15;
     int32_t     N;
     float32_t   b0;
     float32_t   am;
     int32_t     currentPtr;
+    int32_t     mask;
 }MW_DSP_FBCF;
 
 
 int32_t     MW_DSP_FBCF_init(MW_DSP_FBCF *filter, float32_t *delayLine, int32_t N, float32_t b0, float32_t am);
+int32_t     MW_DSP_FBCF_init_pow2(MW_DSP_FBCF *filter, float32_t *delayLine, int32_t bufferSize, int32_t N, float32_t b0, float32_t am);
+int32_t     MW_DSP_FBCF_init_q15(MW_DSP_FBCF *filter, q15_t *delayLine, int32_t N, float32_t b0, float32_t am);
 float32_t   MW_DSP_FBCF_tick(MW_DSP_FBCF *filter, float32_t x);
+float32_t   MW_DSP_FBCF_tick_pow2(MW_DSP_FBCF *filter, float32_t x);
+float32_t   MW_DSP_FBCF_tick_q15(MW_DSP_FBCF *filter, float32_t x);
+
+
+// ============================================================================================================== //
+
+#define MW_DSP_FBCFBANK_MAX_COMBS 16
+
+//  The bank is run this many samples at a time (or less if a delay is shorter than this)
+#define MW_DSP_FBCFBANK_BLOCK_SIZE 16
+
+
+/*
+ *  Bank of feedback comb filters that all take the same input (Schroeder/Freeverb style reverbs, resonator banks)
+ *  Each comb computes v = (x * b0) + (lowpass(delayed) * am) where lowpass is an optional one-pole lowpass
+ *  s = delayed + damping * (s - delayed) in the feedback path.  With a damping of 0 each comb is the same as MW_DSP_FBCF.
+ *
+ *  The delay lines sit back to back in one block of memory.  The bank is run a block at a time and each comb updates its
+ *  block in place in its delay line, one contiguous segment on each side of the wrap, so there is no per-sample wrap check
+ */
+typedef struct
+{
+    float32_t   *memory;
+    int32_t     numCombs;
+    int32_t     minN;
+    float32_t   *delayLines[MW_DSP_FBCFBANK_MAX_COMBS];
+    int32_t     N[MW_DSP_FBCFBANK_MAX_COMBS];
+    int32_t     currentPtr[MW_DSP_FBCFBANK_MAX_COMBS];
+    float32_t   b0[MW_DSP_FBCFBANK_MAX_COMBS];
+    float32_t   am[MW_DSP_FBCFBANK_MAX_COMBS];
+    float32_t   damping[MW_DSP_FBCFBANK_MAX_COMBS];
+    float32_t   lowpassState[MW_DSP_FBCFBANK_MAX_COMBS];
+}MW_DSP_FBCFBank;
+
+
+int32_t     MW_DSP_FBCFBank_calculateMemorySize(const int32_t *N, int32_t numCombs);
+int32_t     MW_DSP_FBCFBank_init(MW_DSP_FBCFBank *bank, float32_t *memory, int32_t memorySize, const int32_t *N, const float32_t *b0, const float32_t *am, int32_t numCombs);
+int32_t     MW_DSP_FBCFBank_setDamping(MW_DSP_FBCFBank *bank, int32_t comb, float32_t damping);
+void        MW_DSP_FBCFBank_process(MW_DSP_FBCFBank *bank, float32_t *in, float32_t *out, size_t numSamples);
+void        MW_DSP_FBCFBank_processOutputs(MW_DSP_FBCFBank *bank, float32_t *in, float32_t **outputs, size_t numSamples);
+void        MW_DSP_FBCFBank_reset(MW_DSP_FBCFBank *bank);
 
 #endif /* MW_DSP_COMBFILTER_H_ */
@@ -29,6 +29,76 @@
 
 
 
+/*
+ *  Exchange the contents of a delay line segment and an audio buffer segment
+ *  Used by MW_DSP_DelayLine_process() when the input and output buffers are the same
+ */
+static void MW_DSP_DelayLine_swapSegment(float32_t *segment, float32_t *buffer, size_t numSamples)
+{
+  for (size_t i = 0; i < numSamples; ++i)
+  {
+    float32_t y = segment[i];
+    segment[i] = buffer[i];
+    buffer[i] = y;
+  }
+}
+
+
+/*
+ *  Same as MW_DSP_DelayLine_swapSegment() for a Q15 delay line segment.  The segment is converted in blocks of
+ *  MW_DSP_DELAYLINE_BLOCK_SIZE samples so that the delayed samples can be read out before the input overwrites them
+ */
+static void MW_DSP_DelayLine_exchangeSegmentQ15(q15_t *segment, float32_t *in, float32_t *out, size_t numSamples)
+{
+  float32_t delayed[MW_DSP_DELAYLINE_BLOCK_SIZE];
+
+  while (numSamples > 0)
+  {
+    size_t blockSize = numSamples;
+    if (blockSize > MW_DSP_DELAYLINE_BLOCK_SIZE)
+      blockSize = MW_DSP_DELAYLINE_BLOCK_SIZE;
+
+    arm_q15_to_float(segment, delayed, blockSize);
+    arm_float_to_q15(in, segment, blockSize);
+    arm_copy_f32(delayed, out, blockSize);
+
+    segment += blockSize;
+    in += blockSize;
+    out += blockSize;
+    numSamples -= blockSize;
+  }
+}
+
+
+static void MW_DSP_DelayLine_initCrossfade(MW_DSP_DelayLine *delayLine)
+{
+  delayLine->crossfadeLength = MW_DSP_DELAYLINE_DEFAULT_CROSSFADE_LENGTH;
+  delayLine->crossfadeRemaining = 0;
+  delayLine->fadingReadPtr = 0;
+  delayLine->fadingN = 0;
+  delayLine->pendingN = 0;
+}
+
+
+//  Move the read head to a delay of N samples and start fading out the old one.  Only called between crossfades
+static void MW_DSP_DelayLine_moveReadHead(MW_DSP_DelayLine *delayLine, size_t N)
+{
+  size_t readPtr = delayLine->currentPtr + delayLine->bufferSize - N;
+  if (readPtr >= delayLine->bufferSize)
+    readPtr -= delayLine->bufferSize;
+
+  if (delayLine->crossfadeLength > 0)
+  {
+    delayLine->fadingReadPtr = delayLine->readPtr;
+    delayLine->fadingN = delayLine->N;
+    delayLine->crossfadeRemaining = delayLine->crossfadeLength;
+  }
+
+  delayLine->N = N;
+  delayLine->readPtr = readPtr;
+}
+
+
 /*
  *  MW_DSP_DelayLine_init will not allocate memory for you!
  *  You must have a place in memory set aside to contain the delay line samples
@@ -50,8 +120,13 @@ int32_t MW_DSP_DelayLine_init(MW_DSP_DelayLine *delayLine, float32_t *bufferMemo
     return 0;
 
   delayLine->buffer = bufferMemory;
+  delayLine->bufferQ15 = NULL;
   delayLine->N = N;
+  delayLine->bufferSize = N;
+  delayLine->mask = 0;
   delayLine->currentPtr = 0;
+  MW_DSP_DelayLine_initCrossfade(delayLine);
+  delayLine->readPtr = 0;
 
   arm_fill_f32(0.0, delayLine->buffer, delayLine->N);
 
@@ -61,6 +136,113 @@ int32_t MW_DSP_DelayLine_init(MW_DSP_DelayLine *delayLine, float32_t *bufferMemo
 }
 
 
+/*
+ *  MW_DSP_DelayLine_init_pow2 is the same as MW_DSP_DelayLine_init() except that the buffer size is a power of two
+ *  The delay length (N) is kept separately from the buffer size so that wrapping the read/write pointers only takes a
+ *  bitwise AND instead of an integer divide.  The trade off is memory: up to (almost) twice the delay length may be needed.
+ *  Use MW_DSP_DelayLine_nextPowerOfTwo() to find the buffer size for a given delay length.
+ *
+ *  Inputs:
+ *    delayLine:    Pointer to a MS_DSP_DelayLine structure
+ *    bufferMemory: Pointer to array that will hold the audio samples.  Must be already allocated to hold bufferSize samples
+ *    bufferSize:   Size of bufferMemory.  Must be a power of two
+ *    N:            Delay line length (must not be greater than bufferSize)
+ *
+ *  Returns:
+ *    0 if initialization unsuccessful
+ *    1 if initialization successful
+ */
+int32_t MW_DSP_DelayLine_init_pow2(MW_DSP_DelayLine *delayLine, float32_t *bufferMemory, size_t bufferSize, size_t N)
+{
+  if (delayLine == NULL || bufferMemory == NULL || N == 0)
+    return 0;
+
+  if (bufferSize < N || (bufferSize & (bufferSize - 1)) != 0)
+    return 0;
+
+  delayLine->buffer = bufferMemory;
+  delayLine->bufferQ15 = NULL;
+  delayLine->N = N;
+  delayLine->bufferSize = bufferSize;
+  delayLine->mask = bufferSize - 1;
+  delayLine->currentPtr = 0;
+  MW_DSP_DelayLine_initCrossfade(delayLine);
+  delayLine->readPtr = (bufferSize - N) & delayLine->mask;
+
+  arm_fill_f32(0.0, delayLine->buffer, bufferSize);
+
+  delayLine->memoryDynamicallyAllocated = 0;
+
+  return 1;
+}
+
+
+/*
+ *  MW_DSP_DelayLine_init_q15 is the same as MW_DSP_DelayLine_init() except that the samples are stored as Q15 (int16)
+ *  This halves the delay line memory at the cost of ~16 bits of resolution (roughly 90 dB SNR for a full scale sine).
+ *  Samples outside [-1, 1) are saturated so leave some headroom when the delay line is inside a feedback loop.
+ *  MW_DSP_DelayLine_process() converts whole segments with arm_float_to_q15()/arm_q15_to_float()
+ *
+ *  Inputs:
+ *    delayLine:    Pointer to a MS_DSP_DelayLine structure
+ *    bufferMemory: Pointer to array that will hold the audio samples.  Must be already allocated to hold N samples
+ *    N:            Delay line length
+ *
+ *  Returns:
+ *    0 if initialization unsuccessful
+ *    1 if initialization successful
+ */
+int32_t MW_DSP_DelayLine_init_q15(MW_DSP_DelayLine *delayLine, q15_t *bufferMemory, size_t N)
+{
+  if (delayLine == NULL || bufferMemory == NULL || N == 0)
+    return 0;
+
+  delayLine->buffer = NULL;
+  delayLine->bufferQ15 = bufferMemory;
+  delayLine->N = N;
+  delayLine->bufferSize = N;
+  delayLine->mask = 0;
+  delayLine->currentPtr = 0;
+  MW_DSP_DelayLine_initCrossfade(delayLine);
+  delayLine->readPtr = 0;
+
+  arm_fill_q15(0, delayLine->bufferQ15, delayLine->N);
+
+  delayLine->memoryDynamicallyAllocated = 0;
+
+  return 1;
+}
+
+
+/*
+ *  MW_DSP_DelayLine_init_arena is the same as MW_DSP_DelayLine_init() except that the delay line buffer is allocated from arena
+ *  (see MW_DSP_Arena) instead of being passed in.  Nothing is allocated if initialization fails
+ *
+ *  Inputs:
+ *    delayLine:    Pointer to a MS_DSP_DelayLine structure
+ *    arena:        Arena to allocate N samples from
+ *    N:            Delay line length
+ *
+ *  Returns:
+ *    0 if initialization unsuccessful
+ *    1 if initialization successful
+ */
+int32_t MW_DSP_DelayLine_init_arena(MW_DSP_DelayLine *delayLine, MW_DSP_Arena *arena, size_t N)
+{
+  if (delayLine == NULL || arena == NULL || N == 0)
+    return 0;
+
+  size_t marker = MW_DSP_Arena_mark(arena);
+  if (!MW_DSP_DelayLine_init(delayLine, MW_DSP_Arena_allocFloat(arena, N), N))
+  {
+    MW_DSP_Arena_release(arena, marker);
+    return 0;
+  }
+
+  return 1;
+}
+
+
 /*
  *  MW_DSP_DelayLine_init_memalloc is the same as MW_DSP_DelayLine_init() except that it will
  *  dynamically allocate memory for the delay line buffer for you
@@ -94,9 +276,14 @@ int32_t MW_DSP_DelayLine_init_memalloc(MW_DSP_DelayLine **delayLine, size_t N)
 
   arm_fill_f32(0.f, (*delayLine)->buffer, N);
 
+  (*delayLine)->bufferQ15 = NULL;
   (*delayLine)->N = N;
+  (*delayLine)->bufferSize = N;
+  (*delayLine)->mask = 0;
   (*delayLine)->currentPtr = 0;
+  (*delayLine)->readPtr = 0;
   (*delayLine)->memoryDynamicallyAllocated = 1;
+  MW_DSP_DelayLine_initCrossfade(*delayLine);
 
   return 1;
 }
@@ -129,223 +316,1334 @@ int32_t MW_DSP_DelayLine_delete(MW_DSP_DelayLine **delayLine)
 
 
 /*
- *  tick() receives an input and returns the next output sample
- *  A nullptr check is omitted to avoid slowdowns due to branches so beware!
+ *  Set the delay length (rounded to the nearest sample) without clearing the delay line.  Only the read pointer moves so
+ *  this takes O(1) time.  The delay length can be anything from 1 sample up to the buffer size (N for a delay line
+ *  initialized with MW_DSP_DelayLine_init(), bufferSize for MW_DSP_DelayLine_init_pow2())
+ *
+ *  Jumping the read pointer would click, so the output crossfades from the old read head to the new one over the crossfade
+ *  length (see MW_DSP_DelayLine_setCrossfadeLength()).  If the delay length changes again in the middle of a crossfade, the
+ *  new length is queued and the next crossfade starts when the current one completes.  Only the latest queued length is
+ *  kept
  *
  *  Inputs:
  *    delayLine:  Pointer to MW_DSP_DelayLine structure (must be previously initialized)
- *    x:          Sample to feed into the delay line
+ *    M:          New delay length in samples
  *
  *  Returns:
- *    Sample delayed by N cycles
- *    (NO_OPTIMIZE) NAN if delayLine is NULL
- *
+ *    None
  */
-float32_t MW_DSP_DelayLine_tick(MW_DSP_DelayLine *delayLine, float32_t x)
+void MW_DSP_DelayLine_setDelayLength(MW_DSP_DelayLine *delayLine, float32_t M)
 {
 #ifdef NO_OPTIMIZE
-  if (delayLine == NULL)
-    return NAN;
-
-  if (delayLine->N == 0 || delayLine->buffer == NULL)
-    return NAN;
+  assert(delayLine != NULL);
+  assert(M >= 0.5f);
+  assert(M < (float32_t)delayLine->bufferSize + 0.5f);
 #endif
 
-  float32_t y = delayLine->buffer[delayLine->currentPtr];
-  delayLine->buffer[delayLine->currentPtr] = x;
+  size_t N = (size_t)(M + 0.5f);
+  if (N < 1)
+    N = 1;
 
-  delayLine->currentPtr = (delayLine->currentPtr + 1) % delayLine->N;
+  if (N > delayLine->bufferSize)
+    N = delayLine->bufferSize;
 
-  return y;
+  //  Restarting a crossfade would drop one of the heads that are being mixed and click
+  if (delayLine->crossfadeRemaining)
+  {
+    delayLine->pendingN = (N == delayLine->N) ? 0 : N;
+    return;
+  }
+
+  if (N == delayLine->N)
+    return;
+
+  MW_DSP_DelayLine_moveReadHead(delayLine, N);
 }
 
 
 /*
- *  peek() will return the next output sample in the delay line but will NOT pop it off the delay line!
+ *  Set the number of samples it takes to crossfade between the old and new read heads when the delay length changes
+ *  (see MW_DSP_DelayLine_setDelayLength()).  0 switches read heads immediately.  The default is
+ *  MW_DSP_DELAYLINE_DEFAULT_CROSSFADE_LENGTH.  A crossfade that is already running keeps its original length
  *
  *  Inputs:
- *    delayLine:  Pointer to MW_DSP_DelayLine structure (must be previously initialized)
+ *    delayLine:        Pointer to MW_DSP_DelayLine structure (must be previously initialized)
+ *    crossfadeLength:  Crossfade length in samples
  *
  *  Returns:
- *    Sample delayed by N cycles
- *    (NO_OPTIMIZE) NAN if delayLine is NULL
+ *    None
  */
-float32_t MW_DSP_DelayLine_peek(MW_DSP_DelayLine *delayLine)
+void MW_DSP_DelayLine_setCrossfadeLength(MW_DSP_DelayLine *delayLine, size_t crossfadeLength)
 {
 #ifdef NO_OPTIMIZE
-  if (delayLine == NULL)
-    return NAN;
-
-  if (delayLine->N == 0 || delayLine->buffer == NULL)
-    return NAN;
+  assert(delayLine != NULL);
 #endif
-  return delayLine->buffer[delayLine->currentPtr];
-}
-
 
+  delayLine->crossfadeLength = crossfadeLength;
+  if (delayLine->crossfadeRemaining > crossfadeLength)
+    delayLine->crossfadeRemaining = crossfadeLength;
+}
 
-//  Fractional Delay line Functions
-// ------------------------------------------------------------------------------------------------------------------ //
-// ------------------------------------------------------------------------------------------------------------------ //
 
-/*
- *  Initialize an instance of MW_DSP_FractionalDelayLine
- *  NOTE:  The initialization function will NOT allocate memory for its internal delay line buffer
- *  You must pass in a pre-allocated array.
- * 
- *  Total delay size (N) is limited to int16_t to accomodate SIMD processing calls.  That means the total delay length
- *  is 32768.  For a resource limited system, this should be okay.  Hopefully.
- * 
- *  Inputs:
- *    delayLine:    Pointer to MW_DSP_FractionalDelayLine instance
- *    buffer:       Pointer to array that will hold delayed samples (must be already allocated in memory)
- *    N:            Total delay line length (ie. the size of buffer)
- *    M:            Desired delay line length (may be fractional)
-*/
-int32_t MW_DSP_FractionalDelayLine_init(MW_DSP_FractionalDelayLine *delayLine, float32_t *buffer, int16_t N, float32_t M)
+static inline float32_t MW_DSP_DelayLine_readSample(const MW_DSP_DelayLine *delayLine, size_t ptr)
 {
-  if (delayLine == NULL || buffer == NULL || M < 0 || N <= 0 || M >= MW_DSP_FRAC_DELAY_MAX_DELAY_LENGTH)
-    return 0;
+  if (delayLine->bufferQ15)
+    return MW_DSP_DelayLine_q15ToFloat(delayLine->bufferQ15[ptr]);
 
-  if ((int16_t)M > N)
-    return 0;
+  return delayLine->buffer[ptr];
+}
 
-  arm_fill_f32(0.f, buffer, N);
 
-  delayLine->buffer = buffer;
-  delayLine->N = N;
-  delayLine->writePtr = N - 1;
+static inline size_t MW_DSP_DelayLine_advance(const MW_DSP_DelayLine *delayLine, size_t ptr, size_t numSamples)
+{
+  if (delayLine->mask)
+    return (ptr + numSamples) & delayLine->mask;
 
-  delayLine->MInt = (int16_t)M;
-  delayLine->MFrac = M - delayLine->MInt;
-  delayLine->readPtr = delayLine->MInt + delayLine->writePtr - N;
+  ptr += numSamples;
+  if (ptr >= delayLine->bufferSize)
+    ptr -= delayLine->bufferSize;
 
-  return 1;
+  return ptr;
 }
 
 
-/*
- *  Set the delay length.  Fractional lengths are allowed
- *
- *  Inputs:
- *    delayLine:    Pointer to MW_DSP_FractionalDelayLine instance
- *    M:            Delay length
- *
- *  Returns:
- *    None
- */
-void MW_DSP_FractionalDelayLine_setDelayLength(MW_DSP_FractionalDelayLine *delayLine, float32_t M)
+//  Weight of the new read head for the next output sample of a crossfade.  Shared by tick() and process() so that they
+//  give identical output
+static inline float32_t MW_DSP_DelayLine_crossfadeGain(const MW_DSP_DelayLine *delayLine, size_t sampleOffset)
 {
-#ifdef NO_OPTIMIZE
-  assert(delayLine != NULL);
-  assert(M > 0);
-  assert(delayLine->delay.N != 0);
-#endif
-
-  delayLine->MInt = (int16_t)M;
-  delayLine->MFrac = M - floorf(M);
-
-  delayLine->readPtr = (delayLine->writePtr - delayLine->MInt + delayLine->N) % delayLine->N;
+  return (float32_t)(delayLine->crossfadeLength - delayLine->crossfadeRemaining + sampleOffset + 1) / (float32_t)delayLine->crossfadeLength;
 }
 
 
 /*
- *  Execute one cycle of delay line operation
- *  Note when writing to the delay line, instead of starting from 0 and moving up, this implementation starts from the end
- *  of the delay line and moves down.  This is done to check when the write pointer needs to wrap around while using SIMD functions
- * 
+ *  tick() receives an input and returns the next output sample
+ *  A nullptr check is omitted to avoid slowdowns due to branches so beware!
+ *
  *  Inputs:
- *    delayLine:    Pointer to MW_DSP_FractionalDelayLine instance
- *    x:            Value to shift into the delay line
- * 
+ *    delayLine:  Pointer to MW_DSP_DelayLine structure (must be previously initialized)
+ *    x:          Sample to feed into the delay line
+ *
  *  Returns:
- *    Linearly interpolated sample
+ *    Sample delayed by N cycles
+ *    (NO_OPTIMIZE) NAN if delayLine is NULL
+ *
  */
-float32_t MW_DSP_FractionalDelayLine_tick(MW_DSP_FractionalDelayLine *delayLine, float32_t x)
+float32_t MW_DSP_DelayLine_tick(MW_DSP_DelayLine *delayLine, float32_t x)
 {
 #ifdef NO_OPTIMIZE
-  assert(delayLine != NULL);
-  assert(&delayLine->delay != NULL);
-#endif
-
-  delayLine->buffer[delayLine->writePtr--] = x;
-  if (delayLine->writePtr < 0)
-    delayLine->writePtr = delayLine->N - 1;
-  
-  int32_t firstInterpolatingIndex = delayLine->readPtr--;
-  int32_t secondInterpolatingIndex = firstInterpolatingIndex - 1;
-  if (secondInterpolatingIndex < 0)
-    secondInterpolatingIndex = delayLine->N - 1;
-
-  float32_t y = ((1.f - delayLine->MFrac) * delayLine->buffer[firstInterpolatingIndex]) + (delayLine->MFrac * delayLine->buffer[secondInterpolatingIndex]);
-
-  if (delayLine->readPtr < 0)
-    delayLine->readPtr = delayLine->N - 1;
-
-  return y;
-}
+  if (delayLine == NULL)
+    return NAN;
 
+  if (delayLine->N == 0 || (delayLine->buffer == NULL && delayLine->bufferQ15 == NULL))
+    return NAN;
+#endif
 
-void MW_DSP_FractionalDelayLine_process(MW_DSP_FractionalDelayLine *delayLine, float32_t *buffer, size_t numSamples)
-{
-  #ifdef NO_OPTIMIZE
-    assert(delayLine != NULL);
-  #endif
+  float32_t y = MW_DSP_DelayLine_readSample(delayLine, delayLine->readPtr);
 
-  for (int32_t i = 0; i < numSamples; ++i)
+  if (delayLine->crossfadeRemaining)
   {
-    delayLine->buffer[delayLine->writePtr--] = buffer[i];
+    float32_t faded = MW_DSP_DelayLine_readSample(delayLine, delayLine->fadingReadPtr);
+    y = faded + MW_DSP_DelayLine_crossfadeGain(delayLine, 0) * (y - faded);
 
-    if (delayLine->writePtr < 0)
-      delayLine->writePtr = delayLine->N - 1;
+    delayLine->fadingReadPtr = MW_DSP_DelayLine_advance(delayLine, delayLine->fadingReadPtr, 1);
+    delayLine->crossfadeRemaining--;
+  }
 
-    //  We are going to linearly interpolate between two values in the delay line
-    int32_t firstInterpolatingIndex = delayLine->readPtr--;
-    int32_t secondInterpolatingIndex = firstInterpolatingIndex + 1;
-    if (secondInterpolatingIndex >= delayLine->N)
-      secondInterpolatingIndex = 0;
+  if (delayLine->bufferQ15)
+    delayLine->bufferQ15[delayLine->currentPtr] = MW_DSP_DelayLine_floatToQ15(x);
+  else
+    delayLine->buffer[delayLine->currentPtr] = x;
 
-    buffer[i] = ((1.f - delayLine->MFrac) * delayLine->buffer[firstInterpolatingIndex]) + (delayLine->MFrac * delayLine->buffer[secondInterpolatingIndex]);
+  delayLine->currentPtr = MW_DSP_DelayLine_advance(delayLine, delayLine->currentPtr, 1);
+  delayLine->readPtr = MW_DSP_DelayLine_advance(delayLine, delayLine->readPtr, 1);
 
-    if (delayLine->readPtr < 0)
-      delayLine->readPtr = delayLine->N - 1;
+  if (delayLine->pendingN && !delayLine->crossfadeRemaining)
+  {
+    MW_DSP_DelayLine_moveReadHead(delayLine, delayLine->pendingN);
+    delayLine->pendingN = 0;
   }
 
+  return y;
 }
 
 
-void MW_DSP_FractionalDelayLine_reset(MW_DSP_FractionalDelayLine *delayLine)
+/*
+ *  Move a contiguous segment between an audio buffer and the delay line, converting to/from Q15 if needed
+ */
+static inline void MW_DSP_DelayLine_readSegment(const MW_DSP_DelayLine *delayLine, size_t ptr, float32_t *out, size_t numSamples)
 {
-  #ifdef NO_OPTIMIZE
-  if (delayLine == NULL) while(1);
-  if (delayLine->buffer == NULL) while(1);
-  #endif
-
-  if (delayLine == NULL) return;
-  if (delayLine->buffer == NULL) return;
-
-  arm_fill_f32(0, delayLine->buffer, delayLine->N);
+  if (delayLine->bufferQ15)
+    arm_q15_to_float(&delayLine->bufferQ15[ptr], out, numSamples);
+  else
+    arm_copy_f32(&delayLine->buffer[ptr], out, numSamples);
+}
 
-  delayLine->readPtr = 0;
-  delayLine->writePtr = 0;
+static inline void MW_DSP_DelayLine_writeSegment(MW_DSP_DelayLine *delayLine, size_t ptr, float32_t *in, size_t numSamples)
+{
+  if (delayLine->bufferQ15)
+    arm_float_to_q15(in, &delayLine->bufferQ15[ptr], numSamples);
+  else
+    arm_copy_f32(in, &delayLine->buffer[ptr], numSamples);
 }
 
 
+/*
+ *  Process one segment of a crossfade between two read heads.  Both heads are read into scratch buffers before the input
+ *  is written, so the segment only has to be short enough that neither head reads a sample written in the same segment
+ *
+ *  Returns:
+ *    Number of samples processed (no more than numSamples)
+ */
+static size_t MW_DSP_DelayLine_crossfadeSegment(MW_DSP_DelayLine *delayLine, float32_t *in, float32_t *out, size_t numSamples)
+{
+  float32_t delayed[MW_DSP_DELAYLINE_BLOCK_SIZE];
+  float32_t faded[MW_DSP_DELAYLINE_BLOCK_SIZE];
 
+  size_t segmentLength = numSamples;
+  if (segmentLength > MW_DSP_DELAYLINE_BLOCK_SIZE)
+    segmentLength = MW_DSP_DELAYLINE_BLOCK_SIZE;
 
+  if (segmentLength > delayLine->crossfadeRemaining)
+    segmentLength = delayLine->crossfadeRemaining;
 
+  if (segmentLength > delayLine->bufferSize - delayLine->readPtr)
+    segmentLength = delayLine->bufferSize - delayLine->readPtr;
 
+  if (segmentLength > delayLine->bufferSize - delayLine->fadingReadPtr)
+    segmentLength = delayLine->bufferSize - delayLine->fadingReadPtr;
 
+  if (segmentLength > delayLine->N)
+    segmentLength = delayLine->N;
 
+  if (segmentLength > delayLine->fadingN)
+    segmentLength = delayLine->fadingN;
 
+  MW_DSP_DelayLine_readSegment(delayLine, delayLine->readPtr, delayed, segmentLength);
+  MW_DSP_DelayLine_readSegment(delayLine, delayLine->fadingReadPtr, faded, segmentLength);
+  MW_DSP_DelayLine_writeSegment(delayLine, delayLine->currentPtr, in, segmentLength);
 
+  for (size_t i = 0; i < segmentLength; ++i)
+    out[i] = faded[i] + MW_DSP_DelayLine_crossfadeGain(delayLine, i) * (delayed[i] - faded[i]);
 
+  delayLine->fadingReadPtr = MW_DSP_DelayLine_advance(delayLine, delayLine->fadingReadPtr, segmentLength);
+  delayLine->crossfadeRemaining -= segmentLength;
 
+  return segmentLength;
+}
 
 
+/*
+ *  Process a block of samples
+ *  The output is identical to calling tick() on every sample, but instead of wrapping the delay line pointer on every sample,
+ *  the block is split into contiguous segments at the wrap point and each segment is moved with arm_copy_f32().
+ *  A block that is no longer than N will be split into at most two segments (delay lines that are shorter than their
+ *  buffer may need more segments since the read and write segments wrap around at different times).
+ *  Q15 delay lines (see MW_DSP_DelayLine_init_q15()) convert each segment with arm_q15_to_float()/arm_float_to_q15()
+ *
+ *  While crossfading after a delay length change, the old read head is read as a second stream and mixed into the output
+ *  in segments of up to MW_DSP_DELAYLINE_BLOCK_SIZE samples
+ *
+ *  in and out may point to the same buffer (in-place processing) but must not partially overlap.  In-place calls on a delay
+ *  line that is shorter than its buffer are staged through a scratch block of MW_DSP_DELAYLINE_BLOCK_SIZE samples
+ *
+ *  Inputs:
+ *    delayLine:  Pointer to MW_DSP_DelayLine structure (must be previously initialized)
+ *    in:         Buffer of samples to feed into the delay line
+ *    out:        Buffer that will hold the delayed samples
+ *    numSamples: Number of samples to process
+ *
+ *  Returns:
+ *    None
+ */
+void MW_DSP_DelayLine_process(MW_DSP_DelayLine *delayLine, float32_t *in, float32_t *out, size_t numSamples)
+{
+#ifdef NO_OPTIMIZE
+  if (delayLine == NULL || in == NULL || out == NULL)
+    return;
 
+  if (delayLine->N == 0 || (delayLine->buffer == NULL && delayLine->bufferQ15 == NULL))
+    return;
+#endif
 
+  while (numSamples > 0)
+  {
+    size_t segmentLength = numSamples;
+    if (segmentLength > delayLine->bufferSize - delayLine->currentPtr)
+      segmentLength = delayLine->bufferSize - delayLine->currentPtr;
+
+    if (delayLine->crossfadeRemaining)
+      segmentLength = MW_DSP_DelayLine_crossfadeSegment(delayLine, in, out, segmentLength);
+    else if (delayLine->readPtr == delayLine->currentPtr)
+    {
+      if (delayLine->bufferQ15)
+        MW_DSP_DelayLine_exchangeSegmentQ15(&delayLine->bufferQ15[delayLine->currentPtr], in, out, segmentLength);
+      else
+      {
+        float32_t *segment = &delayLine->buffer[delayLine->currentPtr];
+
+        if (in == out)
+          MW_DSP_DelayLine_swapSegment(segment, out, segmentLength);
+        else
+        {
+          arm_copy_f32(segment, out, segmentLength);
+          arm_copy_f32(in, segment, segmentLength);
+        }
+      }
+    }
+    else
+    {
+      //  The output is read before the input is written, so a segment only has to be short enough (<= N) that it never
+      //  reads a sample written in the same segment.  In-place calls stage the input through a scratch block since
+      //  reading the output would otherwise overwrite it
+      if (segmentLength > delayLine->bufferSize - delayLine->readPtr)
+        segmentLength = delayLine->bufferSize - delayLine->readPtr;
+
+      if (segmentLength > delayLine->N)
+        segmentLength = delayLine->N;
+
+      if (in == out)
+      {
+        float32_t scratch[MW_DSP_DELAYLINE_BLOCK_SIZE];
+
+        if (segmentLength > MW_DSP_DELAYLINE_BLOCK_SIZE)
+          segmentLength = MW_DSP_DELAYLINE_BLOCK_SIZE;
+
+        arm_copy_f32(in, scratch, segmentLength);
+        MW_DSP_DelayLine_readSegment(delayLine, delayLine->readPtr, out, segmentLength);
+        MW_DSP_DelayLine_writeSegment(delayLine, delayLine->currentPtr, scratch, segmentLength);
+      }
+      else
+      {
+        MW_DSP_DelayLine_readSegment(delayLine, delayLine->readPtr, out, segmentLength);
+        MW_DSP_DelayLine_writeSegment(delayLine, delayLine->currentPtr, in, segmentLength);
+      }
+    }
+
+    delayLine->currentPtr += segmentLength;
+    if (delayLine->currentPtr >= delayLine->bufferSize)
+      delayLine->currentPtr = 0;
+
+    delayLine->readPtr += segmentLength;
+    if (delayLine->readPtr >= delayLine->bufferSize)
+      delayLine->readPtr = 0;
+
+    if (delayLine->pendingN && !delayLine->crossfadeRemaining)
+    {
+      MW_DSP_DelayLine_moveReadHead(delayLine, delayLine->pendingN);
+      delayLine->pendingN = 0;
+    }
+
+    in += segmentLength;
+    out += segmentLength;
+    numSamples -= segmentLength;
+  }
+}
 
 
+/*
+ *  peek() will return the next output sample in the delay line but will NOT pop it off the delay line!
+ *
+ *  Inputs:
+ *    delayLine:  Pointer to MW_DSP_DelayLine structure (must be previously initialized)
+ *
+ *  Returns:
+ *    Sample delayed by N cycles
+ *    (NO_OPTIMIZE) NAN if delayLine is NULL
+ */
+float32_t MW_DSP_DelayLine_peek(MW_DSP_DelayLine *delayLine)
+{
+#ifdef NO_OPTIMIZE
+  if (delayLine == NULL)
+    return NAN;
+
+  if (delayLine->N == 0 || (delayLine->buffer == NULL && delayLine->bufferQ15 == NULL))
+    return NAN;
+#endif
+  float32_t y = MW_DSP_DelayLine_readSample(delayLine, delayLine->readPtr);
+
+  if (delayLine->crossfadeRemaining)
+  {
+    float32_t faded = MW_DSP_DelayLine_readSample(delayLine, delayLine->fadingReadPtr);
+    y = faded + MW_DSP_DelayLine_crossfadeGain(delayLine, 0) * (y - faded);
+  }
+
+  return y;
+}
+
+
+/*
+ *  peekAt() returns the sample that was fed into the delay line delay samples ago without popping anything off the delay line.
+ *  peekAt(delayLine, 1) is the most recent input and peekAt(delayLine, N) is the same as peek() (outside of a crossfade).
+ *  Use it to read extra taps from a delay line
+ *
+ *  Inputs:
+ *    delayLine:  Pointer to MW_DSP_DelayLine structure (must be previously initialized)
+ *    delay:      Tap delay in samples (1 to bufferSize)
+ *
+ *  Returns:
+ *    Sample delayed by delay cycles
+ *    (NO_OPTIMIZE) NAN if delayLine is NULL
+ */
+float32_t MW_DSP_DelayLine_peekAt(MW_DSP_DelayLine *delayLine, size_t delay)
+{
+#ifdef NO_OPTIMIZE
+  if (delayLine == NULL)
+    return NAN;
+
+  assert(delay >= 1 && delay <= delayLine->bufferSize);
+#endif
+
+  size_t ptr = delayLine->currentPtr + delayLine->bufferSize - delay;
+  if (ptr >= delayLine->bufferSize)
+    ptr -= delayLine->bufferSize;
+
+  return MW_DSP_DelayLine_readSample(delayLine, ptr);
+}
+
+
+/*
+ *  Find the smallest power of two that is greater than or equal to N
+ *  Use this to size the buffer passed into MW_DSP_DelayLine_init_pow2() (and the APCF/FBCF _init_pow2() functions)
+ *
+ *  Inputs:
+ *    N:  Delay length
+ *
+ *  Returns:
+ *    Power of two buffer size
+ */
+size_t MW_DSP_DelayLine_nextPowerOfTwo(size_t N)
+{
+  size_t size = 1;
+  while (size < N)
+    size <<= 1;
+
+  return size;
+}
+
+
+
+//  Fractional Delay line Functions
+// ------------------------------------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------------------------------------ //
+
+//  Interpolation weights for a fractional delay f.  They are shared by the fixed delay kernel (computed once per delay change)
+//  and processModulated() (computed once per sample)
+static inline void MW_DSP_FractionalDelayLine_lagrangeWeights(float32_t f, float32_t *w)
+{
+  //  Taps at delays MInt - 1, MInt, MInt + 1, MInt + 2 evaluated at MInt + f
+  w[0] = -f * (f - 1.f) * (f - 2.f) * (1.f / 6.f);
+  w[1] = (f + 1.f) * (f - 1.f) * (f - 2.f) * 0.5f;
+  w[2] = -(f + 1.f) * f * (f - 2.f) * 0.5f;
+  w[3] = (f + 1.f) * f * (f - 1.f) * (1.f / 6.f);
+}
+
+static inline void MW_DSP_FractionalDelayLine_hermiteWeights(float32_t f, float32_t *w)
+{
+  w[0] = f * (-0.5f + f * (1.f - 0.5f * f));
+  w[1] = 1.f + f * f * (-2.5f + 1.5f * f);
+  w[2] = f * (0.5f + f * (2.f - 1.5f * f));
+  w[3] = f * f * (-0.5f + 0.5f * f);
+}
+
+//  The allpass pole approaches z = -1 as its delay approaches 0, so keep the allpass delay in [0.5, 1.5)
+//  by borrowing one sample from the integer delay when possible.  offset is set to -1 when a sample is borrowed
+static inline float32_t MW_DSP_FractionalDelayLine_thiranCoefficient(int32_t MInt, float32_t f, int32_t *offset)
+{
+  float32_t d = f;
+  *offset = 0;
+  if (f < 0.5f && MInt >= 1)
+  {
+    d = f + 1.f;
+    *offset = -1;
+  }
+
+  return (1.f - d) / (1.f + d);
+}
+
+
+/*
+ *  Compute the interpolation weights for the current fractional delay.  The weights only depend on MFrac so they are
+ *  computed once per delay change instead of once per sample
+ */
+static void MW_DSP_FractionalDelayLine_calculateKernel(MW_DSP_FractionalDelayLine *delayLine)
+{
+  float32_t f = delayLine->MFrac;
+
+  switch (delayLine->interpolation)
+  {
+    case MW_DSP_FRAC_DELAY_LAGRANGE3:
+      MW_DSP_FractionalDelayLine_lagrangeWeights(f, delayLine->kernel);
+      delayLine->kernelOffset = -1;
+      delayLine->kernelLength = 4;
+      break;
+
+    case MW_DSP_FRAC_DELAY_HERMITE:
+      MW_DSP_FractionalDelayLine_hermiteWeights(f, delayLine->kernel);
+      delayLine->kernelOffset = -1;
+      delayLine->kernelLength = 4;
+      break;
+
+    case MW_DSP_FRAC_DELAY_THIRAN:
+      delayLine->kernel[0] = MW_DSP_FractionalDelayLine_thiranCoefficient(delayLine->MInt, f, &delayLine->kernelOffset);
+      delayLine->kernelLength = 2;
+      break;
+
+    case MW_DSP_FRAC_DELAY_LINEAR:
+    default:
+      delayLine->kernel[0] = 1.f - f;
+      delayLine->kernel[1] = f;
+      delayLine->kernelOffset = 0;
+      delayLine->kernelLength = 2;
+      break;
+  }
+}
+
+
+/*
+ *  Common initialization for all MW_DSP_FractionalDelayLine variants.  buffer must hold N + guardSize samples
+*/
+static int32_t MW_DSP_FractionalDelayLine_initRingBuffer(MW_DSP_FractionalDelayLine *delayLine, float32_t *buffer, int32_t N, float32_t M,
+                                                         MW_DSP_FractionalDelayInterpolation interpolation, int32_t guardSize)
+{
+  if (delayLine == NULL || buffer == NULL || M < 0 || N <= 0)
+    return 0;
+
+  if ((int32_t)M > N)
+    return 0;
+
+  if (interpolation >= MW_DSP_FRAC_DELAY_NUM_INTERPOLATION_TYPES)
+    return 0;
+
+  if (interpolation == MW_DSP_FRAC_DELAY_LAGRANGE3 || interpolation == MW_DSP_FRAC_DELAY_HERMITE)
+  {
+    if (M < 1.f || (int32_t)M + 2 >= N)
+      return 0;
+  }
+
+  if (!MW_DSP_RingBuffer_init(&delayLine->ringBuffer, buffer, N, guardSize))
+    return 0;
+
+  delayLine->buffer = buffer;
+  delayLine->N = N;
+  delayLine->writePtr = N - 1;
+  delayLine->interpolation = interpolation;
+  delayLine->thiranState = 0.f;
+
+  MW_DSP_FractionalDelayLine_setDelayLength(delayLine, M);
+
+  return 1;
+}
+
+
+/*
+ *  Initialize an instance of MW_DSP_FractionalDelayLine using linear interpolation
+ *  NOTE:  The initialization function will NOT allocate memory for its internal delay line buffer
+ *  You must pass in a pre-allocated array.
+ * 
+ *  The delay line is indexed with 32-bit integers so the total delay size (N) is only limited by memory.
+ *  Block processing does not rely on packing indices into SIMD registers.  Instead, process() splits each block into
+ *  segments where neither the read nor the write pointer wraps, so the inner loop only walks two pointers linearly.
+ * 
+ *  Inputs:
+ *    delayLine:    Pointer to MW_DSP_FractionalDelayLine instance
+ *    buffer:       Pointer to array that will hold delayed samples (must be already allocated in memory)
+ *    N:            Total delay line length (ie. the size of buffer)
+ *    M:            Desired delay line length (may be fractional)
+*/
+int32_t MW_DSP_FractionalDelayLine_init(MW_DSP_FractionalDelayLine *delayLine, float32_t *buffer, int32_t N, float32_t M)
+{
+  return MW_DSP_FractionalDelayLine_init_interpolation(delayLine, buffer, N, M, MW_DSP_FRAC_DELAY_LINEAR);
+}
+
+
+/*
+ *  Initialize an instance of MW_DSP_FractionalDelayLine with a specific interpolation kernel
+ *  The 4-point kernels (LAGRANGE3, HERMITE) need M >= 1 and M + 2 < N since they read one sample on either side of
+ *  the two samples used by linear interpolation
+ * 
+ *  Inputs:
+ *    delayLine:      Pointer to MW_DSP_FractionalDelayLine instance
+ *    buffer:         Pointer to array that will hold delayed samples (must be already allocated in memory)
+ *    N:              Total delay line length (ie. the size of buffer)
+ *    M:              Desired delay line length (may be fractional)
+ *    interpolation:  Interpolation kernel
+ * 
+ *  Returns:
+ *    1 if successful, 0 otherwise
+*/
+int32_t MW_DSP_FractionalDelayLine_init_interpolation(MW_DSP_FractionalDelayLine *delayLine, float32_t *buffer, int32_t N, float32_t M,
+                                                      MW_DSP_FractionalDelayInterpolation interpolation)
+{
+  return MW_DSP_FractionalDelayLine_initRingBuffer(delayLine, buffer, N, M, interpolation, 0);
+}
+
+
+/*
+ *  Initialize an instance of MW_DSP_FractionalDelayLine with a guard zone (see MW_DSP_RingBuffer)
+ *  buffer must hold MW_DSP_RINGBUFFER_MEMORY_SIZE(N, MW_DSP_FRAC_DELAY_GUARD_SIZE) samples.  In exchange for the extra
+ *  samples, every kernel reads all of its taps with one contiguous load instead of wrapping each tap individually.
+ *  The output is identical to a delay line initialized with MW_DSP_FractionalDelayLine_init_interpolation()
+ * 
+ *  Inputs:
+ *    delayLine:      Pointer to MW_DSP_FractionalDelayLine instance
+ *    buffer:         Pointer to N + MW_DSP_FRAC_DELAY_GUARD_SIZE samples of memory
+ *    N:              Total delay line length (not including the guard zone)
+ *    M:              Desired delay line length (may be fractional)
+ *    interpolation:  Interpolation kernel
+ * 
+ *  Returns:
+ *    1 if successful, 0 otherwise
+*/
+int32_t MW_DSP_FractionalDelayLine_init_guarded(MW_DSP_FractionalDelayLine *delayLine, float32_t *buffer, int32_t N, float32_t M,
+                                                MW_DSP_FractionalDelayInterpolation interpolation)
+{
+  return MW_DSP_FractionalDelayLine_initRingBuffer(delayLine, buffer, N, M, interpolation, MW_DSP_FRAC_DELAY_GUARD_SIZE);
+}
+
+
+/*
+ *  Same as MW_DSP_FractionalDelayLine_init_guarded() except that the delay line buffer (including the guard zone) is allocated
+ *  from arena (see MW_DSP_Arena).  Nothing is allocated if initialization fails
+ * 
+ *  Inputs:
+ *    delayLine:      Pointer to MW_DSP_FractionalDelayLine instance
+ *    arena:          Arena to allocate N + MW_DSP_FRAC_DELAY_GUARD_SIZE samples from
+ *    N:              Total delay line length (not including the guard zone)
+ *    M:              Desired delay line length (may be fractional)
+ *    interpolation:  Interpolation kernel
+ * 
+ *  Returns:
+ *    1 if successful, 0 otherwise
+*/
+int32_t MW_DSP_FractionalDelayLine_init_arena(MW_DSP_FractionalDelayLine *delayLine, MW_DSP_Arena *arena, int32_t N, float32_t M,
+                                              MW_DSP_FractionalDelayInterpolation interpolation)
+{
+  if (arena == NULL || N <= 0)
+    return 0;
+
+  size_t marker = MW_DSP_Arena_mark(arena);
+  float32_t *buffer = MW_DSP_Arena_allocFloat(arena, MW_DSP_RINGBUFFER_MEMORY_SIZE(N, MW_DSP_FRAC_DELAY_GUARD_SIZE));
+
+  if (!MW_DSP_FractionalDelayLine_init_guarded(delayLine, buffer, N, M, interpolation))
+  {
+    MW_DSP_Arena_release(arena, marker);
+    return 0;
+  }
+
+  return 1;
+}
+
+
+/*
+ *  Set the delay length.  Fractional lengths are allowed
+ *
+ *  Inputs:
+ *    delayLine:    Pointer to MW_DSP_FractionalDelayLine instance
+ *    M:            Delay length
+ *
+ *  Returns:
+ *    None
+ */
+void MW_DSP_FractionalDelayLine_setDelayLength(MW_DSP_FractionalDelayLine *delayLine, float32_t M)
+{
+#ifdef NO_OPTIMIZE
+  assert(delayLine != NULL);
+  assert(M >= 0);
+  assert(delayLine->N != 0);
+  if (delayLine->interpolation == MW_DSP_FRAC_DELAY_LAGRANGE3 || delayLine->interpolation == MW_DSP_FRAC_DELAY_HERMITE)
+    assert(M >= 1.f);
+#endif
+
+  delayLine->MInt = (int32_t)M;
+  delayLine->MFrac = M - floorf(M);
+
+  //  Older samples sit at higher indices since the write pointer moves down through the buffer
+  delayLine->readPtr = delayLine->writePtr + delayLine->MInt;
+  if (delayLine->readPtr >= delayLine->N)
+    delayLine->readPtr -= delayLine->N;
+
+  MW_DSP_FractionalDelayLine_calculateKernel(delayLine);
+}
+
+
+/*
+ *  Interpolate the output sample around readPtr using the current kernel
+ *  A guarded delay line reads every tap straight from memory (into the guard if needed).  Otherwise taps that run past the
+ *  end are wrapped individually.  guarded is a constant at each call site so the compiler can specialize both versions
+ */
+static inline float32_t MW_DSP_FractionalDelayLine_interpolate(MW_DSP_FractionalDelayLine *delayLine, const int32_t guarded)
+{
+  float32_t wrappedTaps[4];
+  const float32_t *taps;
+  int32_t index = delayLine->readPtr + delayLine->kernelOffset;
+
+  //  The 4-point kernels start one sample before readPtr, which wraps to N - 1
+  index += (index < 0) * delayLine->N;
+
+  if (guarded || index + delayLine->kernelLength <= delayLine->N)
+    taps = &delayLine->buffer[index];
+  else
+  {
+    for (int32_t k = 0; k < delayLine->kernelLength; ++k)
+    {
+      wrappedTaps[k] = delayLine->buffer[index++];
+      if (index >= delayLine->N)
+        index = 0;
+    }
+    taps = wrappedTaps;
+  }
+
+  switch (delayLine->interpolation)
+  {
+    case MW_DSP_FRAC_DELAY_LAGRANGE3:
+    case MW_DSP_FRAC_DELAY_HERMITE:
+      return (delayLine->kernel[0] * taps[0]) + (delayLine->kernel[1] * taps[1]) +
+             (delayLine->kernel[2] * taps[2]) + (delayLine->kernel[3] * taps[3]);
+
+    case MW_DSP_FRAC_DELAY_THIRAN:
+      delayLine->thiranState = (delayLine->kernel[0] * (taps[0] - delayLine->thiranState)) + taps[1];
+      return delayLine->thiranState;
+
+    case MW_DSP_FRAC_DELAY_LINEAR:
+    default:
+      return (delayLine->kernel[0] * taps[0]) + (delayLine->kernel[1] * taps[1]);
+  }
+}
+
+
+//  One cycle of tick().  guarded is a compile time constant at each call site so that the unguarded layout neither mirrors
+//  writes into the guard zone nor checks whether it has to
+static inline float32_t MW_DSP_FractionalDelayLine_tickSample(MW_DSP_FractionalDelayLine *delayLine, float32_t x, const int32_t guarded)
+{
+  if (guarded)
+    MW_DSP_RingBuffer_write(&delayLine->ringBuffer, delayLine->writePtr, x);
+  else
+    delayLine->buffer[delayLine->writePtr] = x;
+
+  if (--delayLine->writePtr < 0)
+    delayLine->writePtr = delayLine->N - 1;
+
+  float32_t y = MW_DSP_FractionalDelayLine_interpolate(delayLine, guarded);
+
+  if (--delayLine->readPtr < 0)
+    delayLine->readPtr = delayLine->N - 1;
+
+  return y;
+}
+
+
+/*
+ *  Execute one cycle of delay line operation
+ *  Note when writing to the delay line, instead of starting from 0 and moving up, this implementation starts from the end
+ *  of the delay line and moves down.  This is done to check when the write pointer needs to wrap around while using SIMD functions
+ * 
+ *  Inputs:
+ *    delayLine:    Pointer to MW_DSP_FractionalDelayLine instance
+ *    x:            Value to shift into the delay line
+ * 
+ *  Returns:
+ *    Interpolated sample
+ */
+float32_t MW_DSP_FractionalDelayLine_tick(MW_DSP_FractionalDelayLine *delayLine, float32_t x)
+{
+#ifdef NO_OPTIMIZE
+  assert(delayLine != NULL);
+  assert(delayLine->buffer != NULL);
+#endif
+
+  return (delayLine->ringBuffer.guardSize > 0) ? MW_DSP_FractionalDelayLine_tickSample(delayLine, x, 1) :
+                                                 MW_DSP_FractionalDelayLine_tickSample(delayLine, x, 0);
+}
+
+
+//  Per-kernel segment loops for process().  readSegment points at the first (newest) tap of the first output sample and
+//  older taps sit at higher addresses.  Both segments move down through the buffer
+static void MW_DSP_FractionalDelayLine_processLinear(float32_t *writeSegment, const float32_t *readSegment, float32_t *buffer,
+                                                     int32_t n, const float32_t *kernel)
+{
+  float32_t a = kernel[0];
+  float32_t b = kernel[1];
+
+  for (int32_t i = 0; i < n; ++i)
+  {
+    writeSegment[-i] = buffer[i];
+    buffer[i] = (a * readSegment[-i]) + (b * readSegment[1 - i]);
+  }
+}
+
+static void MW_DSP_FractionalDelayLine_process4Point(float32_t *writeSegment, const float32_t *readSegment, float32_t *buffer,
+                                                     int32_t n, const float32_t *kernel)
+{
+  float32_t k0 = kernel[0];
+  float32_t k1 = kernel[1];
+  float32_t k2 = kernel[2];
+  float32_t k3 = kernel[3];
+
+  for (int32_t i = 0; i < n; ++i)
+  {
+    writeSegment[-i] = buffer[i];
+    buffer[i] = (k0 * readSegment[-i]) + (k1 * readSegment[1 - i]) + (k2 * readSegment[2 - i]) + (k3 * readSegment[3 - i]);
+  }
+}
+
+static void MW_DSP_FractionalDelayLine_processThiran(float32_t *writeSegment, const float32_t *readSegment, float32_t *buffer,
+                                                     int32_t n, float32_t eta, float32_t *state)
+{
+  float32_t y = *state;
+
+  for (int32_t i = 0; i < n; ++i)
+  {
+    writeSegment[-i] = buffer[i];
+    y = (eta * (readSegment[-i] - y)) + readSegment[1 - i];
+    buffer[i] = y;
+  }
+
+  *state = y;
+}
 
 
+/*
+ *  Process a block of samples (in-place)
+ *  The output is identical to calling tick() on every sample.
+ *
+ *  The block is split into segments in which neither the write pointer nor any of the interpolation taps wrap around
+ *  so the inner loop is free of bounds checks.  Samples whose taps straddle the end of the buffer are handled one at
+ *  a time with tick(), unless the delay line has a guard zone in which case those taps are read from the guard.
+ *
+ *  Inputs:
+ *    delayLine:    Pointer to MW_DSP_FractionalDelayLine instance
+ *    buffer:       Buffer of samples to process.  Output samples are written back into this buffer
+ *    numSamples:   Number of samples to process
+ *
+ *  Returns:
+ *    None
+ */
+void MW_DSP_FractionalDelayLine_process(MW_DSP_FractionalDelayLine *delayLine, float32_t *buffer, size_t numSamples)
+{
+  #ifdef NO_OPTIMIZE
+    assert(delayLine != NULL);
+  #endif
+
+  int32_t firstTap = delayLine->kernelOffset;
+  int32_t lastTap = delayLine->kernelOffset + delayLine->kernelLength - 1;
+  int32_t readLimit = delayLine->N + delayLine->ringBuffer.guardSize;
+
+  while (numSamples > 0)
+  {
+    if (delayLine->readPtr + firstTap < 0 || delayLine->readPtr + lastTap >= readLimit)
+    {
+      *buffer = MW_DSP_FractionalDelayLine_tick(delayLine, *buffer);
+      buffer++;
+      numSamples--;
+      continue;
+    }
+
+    //  Both pointers move down so a segment ends when either of them would go below 0
+    int32_t segmentLength = (int32_t)numSamples;
+    if (segmentLength > delayLine->writePtr + 1)
+      segmentLength = delayLine->writePtr + 1;
+
+    if (segmentLength > delayLine->readPtr + firstTap + 1)
+      segmentLength = delayLine->readPtr + firstTap + 1;
+
+    float32_t *writeSegment = &delayLine->buffer[delayLine->writePtr];
+    float32_t *readSegment = &delayLine->buffer[delayLine->readPtr + firstTap];
+
+    switch (delayLine->interpolation)
+    {
+      case MW_DSP_FRAC_DELAY_LAGRANGE3:
+      case MW_DSP_FRAC_DELAY_HERMITE:
+        MW_DSP_FractionalDelayLine_process4Point(writeSegment, readSegment, buffer, segmentLength, delayLine->kernel);
+        break;
+
+      case MW_DSP_FRAC_DELAY_THIRAN:
+        MW_DSP_FractionalDelayLine_processThiran(writeSegment, readSegment, buffer, segmentLength, delayLine->kernel[0],
+                                                 &delayLine->thiranState);
+        break;
+
+      case MW_DSP_FRAC_DELAY_LINEAR:
+      default:
+        MW_DSP_FractionalDelayLine_processLinear(writeSegment, readSegment, buffer, segmentLength, delayLine->kernel);
+        break;
+    }
+
+    //  Any tap read from the guard in this segment refers to a slot that is only overwritten after it was read, so the
+    //  guard can be brought up to date afterwards
+    MW_DSP_RingBuffer_updateGuard(&delayLine->ringBuffer, delayLine->writePtr - segmentLength + 1, segmentLength);
+
+    delayLine->writePtr -= segmentLength;
+    if (delayLine->writePtr < 0)
+      delayLine->writePtr = delayLine->N - 1;
+
+    delayLine->readPtr -= segmentLength;
+    if (delayLine->readPtr < 0)
+      delayLine->readPtr = delayLine->N - 1;
+
+    buffer += segmentLength;
+    numSamples -= segmentLength;
+  }
+}
+
+
+//  Per-kernel loops for processModulated().  writePtr is where the first sample of the segment was written, so sample i
+//  is read relative to writePtr - i.  The read position changes every sample so each tap is wrapped individually unless
+//  the delay line has a guard zone (guarded is a constant at each call site so the compiler can specialize each loop)
+static inline float32_t MW_DSP_FractionalDelayLine_interpolate4Point(const float32_t *delayBuffer, int32_t N, int32_t index, const float32_t *w,
+                                                                     const int32_t guarded)
+{
+  if (guarded)
+    return (w[0] * delayBuffer[index]) + (w[1] * delayBuffer[index + 1]) + (w[2] * delayBuffer[index + 2]) + (w[3] * delayBuffer[index + 3]);
+
+  int32_t i1 = index + 1;
+  if (i1 >= N) i1 -= N;
+  int32_t i2 = index + 2;
+  if (i2 >= N) i2 -= N;
+  int32_t i3 = index + 3;
+  if (i3 >= N) i3 -= N;
+
+  return (w[0] * delayBuffer[index]) + (w[1] * delayBuffer[i1]) + (w[2] * delayBuffer[i2]) + (w[3] * delayBuffer[i3]);
+}
+
+static void MW_DSP_FractionalDelayLine_processModulatedLinear(const float32_t *delayBuffer, int32_t N, int32_t writePtr,
+                                                              float32_t *buffer, const float32_t *delayTimes, int32_t n, const int32_t guarded)
+{
+  for (int32_t i = 0; i < n; ++i)
+  {
+    int32_t MInt = (int32_t)delayTimes[i];
+    float32_t f = delayTimes[i] - floorf(delayTimes[i]);
+
+    int32_t first = writePtr - i + MInt;
+    if (first >= N) first -= N;
+    int32_t second = first + 1;
+    if (!guarded && second >= N) second = 0;
+
+    buffer[i] = ((1.f - f) * delayBuffer[first]) + (f * delayBuffer[second]);
+  }
+}
+
+static void MW_DSP_FractionalDelayLine_processModulatedLagrange(const float32_t *delayBuffer, int32_t N, int32_t writePtr,
+                                                                float32_t *buffer, const float32_t *delayTimes, int32_t n, const int32_t guarded)
+{
+  float32_t w[4];
+
+  for (int32_t i = 0; i < n; ++i)
+  {
+    int32_t MInt = (int32_t)delayTimes[i];
+    MW_DSP_FractionalDelayLine_lagrangeWeights(delayTimes[i] - floorf(delayTimes[i]), w);
+
+    int32_t first = writePtr - i + MInt - 1;
+    if (first >= N) first -= N;
+
+    buffer[i] = MW_DSP_FractionalDelayLine_interpolate4Point(delayBuffer, N, first, w, guarded);
+  }
+}
+
+static void MW_DSP_FractionalDelayLine_processModulatedHermite(const float32_t *delayBuffer, int32_t N, int32_t writePtr,
+                                                               float32_t *buffer, const float32_t *delayTimes, int32_t n, const int32_t guarded)
+{
+  float32_t w[4];
+
+  for (int32_t i = 0; i < n; ++i)
+  {
+    int32_t MInt = (int32_t)delayTimes[i];
+    MW_DSP_FractionalDelayLine_hermiteWeights(delayTimes[i] - floorf(delayTimes[i]), w);
+
+    int32_t first = writePtr - i + MInt - 1;
+    if (first >= N) first -= N;
+
+    buffer[i] = MW_DSP_FractionalDelayLine_interpolate4Point(delayBuffer, N, first, w, guarded);
+  }
+}
+
+static void MW_DSP_FractionalDelayLine_processModulatedThiran(const float32_t *delayBuffer, int32_t N, int32_t writePtr,
+                                                              float32_t *buffer, const float32_t *delayTimes, int32_t n, float32_t *state, const int32_t guarded)
+{
+  float32_t y = *state;
+
+  for (int32_t i = 0; i < n; ++i)
+  {
+    int32_t offset;
+    int32_t MInt = (int32_t)delayTimes[i];
+    float32_t eta = MW_DSP_FractionalDelayLine_thiranCoefficient(MInt, delayTimes[i] - floorf(delayTimes[i]), &offset);
+
+    int32_t first = writePtr - i + MInt + offset;
+    if (first >= N) first -= N;
+    int32_t second = first + 1;
+    if (!guarded && second >= N) second = 0;
+
+    y = (eta * (delayBuffer[first] - y)) + delayBuffer[second];
+    buffer[i] = y;
+  }
+
+  *state = y;
+}
+
+
+static inline void MW_DSP_FractionalDelayLine_processModulatedSegment(MW_DSP_FractionalDelayLine *delayLine, float32_t *buffer,
+                                                                      const float32_t *delayTimes, int32_t n, const int32_t guarded)
+{
+  switch (delayLine->interpolation)
+  {
+    case MW_DSP_FRAC_DELAY_LAGRANGE3:
+      MW_DSP_FractionalDelayLine_processModulatedLagrange(delayLine->buffer, delayLine->N, delayLine->writePtr, buffer, delayTimes, n, guarded);
+      break;
+
+    case MW_DSP_FRAC_DELAY_HERMITE:
+      MW_DSP_FractionalDelayLine_processModulatedHermite(delayLine->buffer, delayLine->N, delayLine->writePtr, buffer, delayTimes, n, guarded);
+      break;
+
+    case MW_DSP_FRAC_DELAY_THIRAN:
+      MW_DSP_FractionalDelayLine_processModulatedThiran(delayLine->buffer, delayLine->N, delayLine->writePtr, buffer, delayTimes, n,
+                                                        &delayLine->thiranState, guarded);
+      break;
+
+    case MW_DSP_FRAC_DELAY_LINEAR:
+    default:
+      MW_DSP_FractionalDelayLine_processModulatedLinear(delayLine->buffer, delayLine->N, delayLine->writePtr, buffer, delayTimes, n, guarded);
+      break;
+  }
+}
+
+
+/*
+ *  Process a block of samples (in-place) with a different delay length for every sample
+ *  The output is identical to calling setDelayLength(delayTimes[i]) followed by tick() on every sample, but the LFO (or
+ *  whatever drives the delay) can be computed for the whole block up front.
+ *
+ *  Each segment is written into the delay line in one pass and then read back with a gather-and-interpolate pass.
+ *  With a guard zone, every tap after the first is read without a wrap check.
+ *  A segment is cut short if a sample in it would read a slot that a later sample in the same segment overwrites,
+ *  which can only happen when the delay comes within one segment length of N.
+ *
+ *  After processing, the delay length is left at delayTimes[numSamples - 1].
+ *
+ *  Inputs:
+ *    delayLine:    Pointer to MW_DSP_FractionalDelayLine instance
+ *    buffer:       Buffer of samples to process.  Output samples are written back into this buffer
+ *    delayTimes:   Delay length (in samples, may be fractional) for each sample in buffer.  Must stay within the bounds
+ *                  allowed by the interpolation kernel (see MW_DSP_FractionalDelayLine_init_interpolation())
+ *    numSamples:   Number of samples to process
+ *
+ *  Returns:
+ *    None
+ */
+void MW_DSP_FractionalDelayLine_processModulated(MW_DSP_FractionalDelayLine *delayLine, float32_t *buffer, const float32_t *delayTimes, size_t numSamples)
+{
+  #ifdef NO_OPTIMIZE
+    assert(delayLine != NULL);
+    assert(delayTimes != NULL);
+  #endif
+
+  if (numSamples == 0)
+    return;
+
+  //  Oldest tap read past the integer delay
+  int32_t tapSpan = 1;
+  if (delayLine->interpolation == MW_DSP_FRAC_DELAY_LAGRANGE3 || delayLine->interpolation == MW_DSP_FRAC_DELAY_HERMITE)
+    tapSpan = 2;
+
+  float32_t *in = buffer;
+  const float32_t *times = delayTimes;
+  size_t remaining = numSamples;
+
+  while (remaining > 0)
+  {
+    int32_t segmentLength = (int32_t)remaining;
+    if (segmentLength > delayLine->writePtr + 1)
+      segmentLength = delayLine->writePtr + 1;
+
+    float32_t maxDelay = 0.f;
+    for (int32_t i = 0; i < segmentLength; ++i)
+    {
+      #ifdef NO_OPTIMIZE
+        assert(times[i] >= 0.f && (int32_t)times[i] + tapSpan < delayLine->N);
+      #endif
+
+      if (times[i] > maxDelay)
+        maxDelay = times[i];
+    }
+
+    int32_t safeLength = delayLine->N - (int32_t)maxDelay - tapSpan;
+    if (safeLength < 1)
+      safeLength = 1;
+
+    if (segmentLength > safeLength)
+      segmentLength = safeLength;
+
+    float32_t *writeSegment = &delayLine->buffer[delayLine->writePtr];
+    for (int32_t i = 0; i < segmentLength; ++i)
+      writeSegment[-i] = in[i];
+
+    MW_DSP_RingBuffer_updateGuard(&delayLine->ringBuffer, delayLine->writePtr - segmentLength + 1, segmentLength);
+
+    if (delayLine->ringBuffer.guardSize > 0)
+      MW_DSP_FractionalDelayLine_processModulatedSegment(delayLine, in, times, segmentLength, 1);
+    else
+      MW_DSP_FractionalDelayLine_processModulatedSegment(delayLine, in, times, segmentLength, 0);
+
+    delayLine->writePtr -= segmentLength;
+    if (delayLine->writePtr < 0)
+      delayLine->writePtr = delayLine->N - 1;
+
+    in += segmentLength;
+    times += segmentLength;
+    remaining -= segmentLength;
+  }
+
+  MW_DSP_FractionalDelayLine_setDelayLength(delayLine, delayTimes[numSamples - 1]);
+}
+
+
+/*
+ *  Clear the delay line buffer.  The delay length is kept
+ */
+void MW_DSP_FractionalDelayLine_reset(MW_DSP_FractionalDelayLine *delayLine)
+{
+  #ifdef NO_OPTIMIZE
+  if (delayLine == NULL) while(1);
+  if (delayLine->buffer == NULL) while(1);
+  #endif
+
+  if (delayLine == NULL) return;
+  if (delayLine->buffer == NULL) return;
+
+  MW_DSP_RingBuffer_reset(&delayLine->ringBuffer);
+
+  delayLine->thiranState = 0.f;
+  delayLine->writePtr = delayLine->N - 1;
+  delayLine->readPtr = delayLine->writePtr + delayLine->MInt;
+  if (delayLine->readPtr >= delayLine->N)
+    delayLine->readPtr -= delayLine->N;
+}
+
+
+
+
+//  Multi-tap Delay line Functions
+// ------------------------------------------------------------------------------------------------------------------ //
+// ------------------------------------------------------------------------------------------------------------------ //
+
+/*
+ *  Initialize an instance of MW_DSP_MultiTapDelayLine
+ *  NOTE:  The initialization function will NOT allocate memory for its internal delay line buffer
+ *
+ *  process() handles at most N - (longest tap delay) - 1 samples per pass, so make N at least the longest tap delay plus
+ *  the block size to process whole blocks at once
+ *
+ *  Inputs:
+ *    delayLine:  Pointer to MW_DSP_MultiTapDelayLine instance
+ *    buffer:     Pointer to MW_DSP_RINGBUFFER_MEMORY_SIZE(N, MW_DSP_MULTITAP_GUARD_SIZE) samples of memory
+ *    N:          Delay line length (not including the guard zone)
+ *    tapDelays:  Delay of each tap in samples (may be fractional).  Must be at least 0 and less than N - 1
+ *    numTaps:    Number of taps (1 to MW_DSP_MULTITAP_MAX_TAPS)
+ *
+ *  Returns:
+ *    1 if successful, 0 otherwise
+ */
+int32_t MW_DSP_MultiTapDelayLine_init(MW_DSP_MultiTapDelayLine *delayLine, float32_t *buffer, int32_t N, const float32_t *tapDelays, int32_t numTaps)
+{
+  if (delayLine == NULL || buffer == NULL || tapDelays == NULL || N <= 1)
+    return 0;
+
+  if (numTaps <= 0 || numTaps > MW_DSP_MULTITAP_MAX_TAPS)
+    return 0;
+
+  for (int32_t tap = 0; tap < numTaps; ++tap)
+  {
+    if (tapDelays[tap] < 0.f || tapDelays[tap] >= (float32_t)(N - 1))
+      return 0;
+  }
+
+  if (!MW_DSP_RingBuffer_init(&delayLine->ringBuffer, buffer, N, MW_DSP_MULTITAP_GUARD_SIZE))
+    return 0;
+
+  delayLine->buffer = buffer;
+  delayLine->N = N;
+  delayLine->writePtr = N - 1;
+  delayLine->numTaps = numTaps;
+
+  for (int32_t tap = 0; tap < numTaps; ++tap)
+    MW_DSP_MultiTapDelayLine_setTapDelay(delayLine, tap, tapDelays[tap]);
+
+  return 1;
+}
+
+
+/*
+ *  Set the delay of one tap.  Fractional delays are allowed
+ *
+ *  Inputs:
+ *    delayLine:  Pointer to MW_DSP_MultiTapDelayLine instance
+ *    tap:        Tap index (less than numTaps)
+ *    M:          Tap delay in samples.  Must be at least 0 and less than N - 1
+ *
+ *  Returns:
+ *    None
+ */
+void MW_DSP_MultiTapDelayLine_setTapDelay(MW_DSP_MultiTapDelayLine *delayLine, int32_t tap, float32_t M)
+{
+#ifdef NO_OPTIMIZE
+  assert(delayLine != NULL);
+  assert(tap >= 0 && tap < delayLine->numTaps);
+  assert(M >= 0.f && M < (float32_t)(delayLine->N - 1));
+#endif
+
+  delayLine->tapInt[tap] = (int32_t)M;
+  delayLine->tapFrac[tap] = M - floorf(M);
+}
+
+
+/*
+ *  Feed one sample into the delay line and read every tap
+ *
+ *  Inputs:
+ *    delayLine:  Pointer to MW_DSP_MultiTapDelayLine instance
+ *    x:          Sample to feed into the delay line
+ *    tapOutputs: Array of numTaps samples that will hold the output of each tap
+ *
+ *  Returns:
+ *    None
+ */
+void MW_DSP_MultiTapDelayLine_tick(MW_DSP_MultiTapDelayLine *delayLine, float32_t x, float32_t *tapOutputs)
+{
+#ifdef NO_OPTIMIZE
+  assert(delayLine != NULL);
+  assert(tapOutputs != NULL);
+#endif
+
+  MW_DSP_RingBuffer_write(&delayLine->ringBuffer, delayLine->writePtr, x);
+
+  for (int32_t tap = 0; tap < delayLine->numTaps; ++tap)
+  {
+    int32_t index = delayLine->writePtr + delayLine->tapInt[tap];
+    if (index >= delayLine->N)
+      index -= delayLine->N;
+
+    float32_t f = delayLine->tapFrac[tap];
+    tapOutputs[tap] = ((1.f - f) * delayLine->buffer[index]) + (f * delayLine->buffer[index + 1]);
+  }
+
+  if (--delayLine->writePtr < 0)
+    delayLine->writePtr = delayLine->N - 1;
+}
+
+
+//  Read one tap for a run of samples where the read index doesn't wrap.  index is the newest interpolation tap of the first
+//  sample and both interpolation taps move down through the buffer.  Integer taps are a plain (reversed) copy
+static void MW_DSP_MultiTapDelayLine_readTap(const float32_t *delayBuffer, int32_t index, float32_t f, float32_t *out, int32_t n)
+{
+  const float32_t *taps = &delayBuffer[index];
+
+  if (f == 0.f)
+  {
+    for (int32_t i = 0; i < n; ++i)
+      out[i] = taps[-i];
+  }
+  else
+  {
+    float32_t a = 1.f - f;
+    for (int32_t i = 0; i < n; ++i)
+      out[i] = (a * taps[-i]) + (f * taps[1 - i]);
+  }
+}
+
+
+/*
+ *  Process a block of samples
+ *  The output is identical to calling tick() on every sample.  Each segment of the input is written into the delay line in
+ *  one pass, then every tap is read in one pass over the ring.  A tap's read index wraps at most once per segment so each
+ *  tap is read in at most two contiguous runs.
+ *  A segment is cut short if a tap would read a slot that a later sample in the same segment overwrites, which can only
+ *  happen when a tap delay comes within one segment length of N.
+ *
+ *  Inputs:
+ *    delayLine:  Pointer to MW_DSP_MultiTapDelayLine instance
+ *    in:         Buffer of samples to feed into the delay line
+ *    tapOutputs: Array of numTaps buffers, each numSamples long, that will hold the output of each tap.  They must not
+ *                overlap each other or in
+ *    numSamples: Number of samples to process
+ *
+ *  Returns:
+ *    None
+ */
+void MW_DSP_MultiTapDelayLine_process(MW_DSP_MultiTapDelayLine *delayLine, const float32_t *in, float32_t **tapOutputs, size_t numSamples)
+{
+#ifdef NO_OPTIMIZE
+  assert(delayLine != NULL);
+  assert(in != NULL && tapOutputs != NULL);
+#endif
+
+  int32_t maxTapInt = 0;
+  for (int32_t tap = 0; tap < delayLine->numTaps; ++tap)
+  {
+    if (delayLine->tapInt[tap] > maxTapInt)
+      maxTapInt = delayLine->tapInt[tap];
+  }
+
+  int32_t safeLength = delayLine->N - maxTapInt - 1;
+  if (safeLength < 1)
+    safeLength = 1;
+
+  size_t offset = 0;
+  while (offset < numSamples)
+  {
+    int32_t segmentLength = (int32_t)(numSamples - offset);
+    if (segmentLength > delayLine->writePtr + 1)
+      segmentLength = delayLine->writePtr + 1;
+
+    if (segmentLength > safeLength)
+      segmentLength = safeLength;
+
+    float32_t *writeSegment = &delayLine->buffer[delayLine->writePtr];
+    for (int32_t i = 0; i < segmentLength; ++i)
+      writeSegment[-i] = in[offset + i];
+
+    MW_DSP_RingBuffer_updateGuard(&delayLine->ringBuffer, delayLine->writePtr - segmentLength + 1, segmentLength);
+
+    for (int32_t tap = 0; tap < delayLine->numTaps; ++tap)
+    {
+      float32_t *out = &tapOutputs[tap][offset];
+      int32_t index = delayLine->writePtr + delayLine->tapInt[tap];
+      int32_t n = segmentLength;
+
+      //  Samples whose read index is past the end of the buffer come first
+      if (index >= delayLine->N)
+      {
+        int32_t wrappedLength = index - delayLine->N + 1;
+        if (wrappedLength > n)
+          wrappedLength = n;
+
+        MW_DSP_MultiTapDelayLine_readTap(delayLine->buffer, index - delayLine->N, delayLine->tapFrac[tap], out, wrappedLength);
+
+        index -= wrappedLength;
+        out += wrappedLength;
+        n -= wrappedLength;
+      }
+
+      if (n > 0)
+        MW_DSP_MultiTapDelayLine_readTap(delayLine->buffer, index, delayLine->tapFrac[tap], out, n);
+    }
+
+    delayLine->writePtr -= segmentLength;
+    if (delayLine->writePtr < 0)
+      delayLine->writePtr = delayLine->N - 1;
+
+    offset += segmentLength;
+  }
+}
+
+
+/*
+ *  Clear the delay line buffer.  The tap delays are kept
+ */
+void MW_DSP_MultiTapDelayLine_reset(MW_DSP_MultiTapDelayLine *delayLine)
+{
+  #ifdef NO_OPTIMIZE
+  if (delayLine == NULL) while(1);
+  #endif
+
+  if (delayLine == NULL) return;
+
+  MW_DSP_RingBuffer_reset(&delayLine->ringBuffer);
+  delayLine->writePtr = delayLine->N - 1;
+}
@@ -29,18 +29,104 @@
 
 #include "arm_math.h"
 #include "assert.h"
+#include "MW_DSP_RingBuffer.h"
+#include "MW_DSP_Arena.h"
 
-#define MW_DSP_FRAC_DELAY_MAX_DELAY_LENGTH 32768.f
-
+/*
+ *  N is the delay length and bufferSize is the number of samples the buffer can hold.
+ *  They are the same unless the delay line was initialized with MW_DSP_DelayLine_init_pow2() in which case
+ *  bufferSize is a power of two and mask (bufferSize - 1) is used to wrap the read/write pointers.
+ *  mask is 0 for a regular delay line
+ *
+ *  MW_DSP_DelayLine_setDelayLength() can change N to anything up to bufferSize.  The old read head (fadingReadPtr, with delay
+ *  fadingN) is then faded out over crossfadeLength samples and crossfadeRemaining counts the samples left in the crossfade.
+ *  pendingN is a delay length requested during a crossfade, which is applied when the crossfade completes (0 if none)
+ *
+ *  bufferQ15 is NULL unless the delay line was initialized with MW_DSP_DelayLine_init_q15().  In that case the samples
+ *  are stored as Q15 in bufferQ15 (half the memory of float storage) and buffer is NULL
+ */
 typedef struct
 {
   float32_t *buffer;
+  q15_t     *bufferQ15;
   size_t    N;
   size_t    currentPtr;
   int32_t   memoryDynamicallyAllocated;
+  size_t    bufferSize;
+  size_t    mask;
+  size_t    readPtr;
+  size_t    crossfadeLength;
+  size_t    crossfadeRemaining;
+  size_t    fadingReadPtr;
+  size_t    fadingN;
+  size_t    pendingN;
 }MW_DSP_DelayLine;
 
+//  Default MW_DSP_DelayLine_setDelayLength() crossfade (~5 msec at 48 kHz)
+#define MW_DSP_DELAYLINE_DEFAULT_CROSSFADE_LENGTH 256
+
+
+/*
+ *  Q15 delay line storage
+ *  Samples are saturated to [-1, 1) on the way in (NaN goes to -1), so signals stored in a Q15 delay line need headroom.
+ *  The clamp is done in float before the conversion so out of range feedback never overflows the integer conversion.
+ *  Samples are rounded to nearest like arm_float_to_q15() with CMSIS rounding enabled (within one LSB otherwise) so that
+ *  per-sample tick() functions and block process() functions give the same output
+ *
+ *  MW_DSP_DELAYLINE_BLOCK_SIZE is the number of samples MW_DSP_DelayLine_process() converts (or crossfades) at a time
+ */
+#define MW_DSP_DELAYLINE_BLOCK_SIZE 32
+
+static inline q15_t MW_DSP_DelayLine_floatToQ15(float32_t x)
+{
+  x *= 32768.f;
+
+  if (!(x >= -32768.f))
+    x = -32768.f;
+
+  if (x > 32767.f)
+    x = 32767.f;
 
+  return (q15_t)(x + ((x >= 0.f) ? 0.5f : -0.5f));
+}
+
+static inline float32_t MW_DSP_DelayLine_q15ToFloat(q15_t x)
+{
+  return (float32_t)x * (1.f / 32768.f);
+}
+
+
+/*
+ *  Interpolation kernels for MW_DSP_FractionalDelayLine
+ *    LINEAR:     2-point linear interpolation.  Cheapest, but attenuates high frequencies for fractional delays near 0.5
+ *    LAGRANGE3:  4-point, 3rd order Lagrange interpolation
+ *    HERMITE:    4-point, 3rd order Hermite (Catmull-Rom) interpolation
+ *    THIRAN:     1st order Thiran allpass.  Flat magnitude response, but is recursive so delay changes cause transients
+ *
+ *  The 4-point kernels read one sample newer than the integer delay, so they need a delay of at least 1 sample.
+ *
+ *  MW_DSP_FRAC_DELAY_GUARD_SIZE is the guard zone needed by the widest kernel (see MW_DSP_FractionalDelayLine_init_guarded())
+ */
+#define MW_DSP_FRAC_DELAY_GUARD_SIZE 3
+
+typedef enum
+{
+  MW_DSP_FRAC_DELAY_LINEAR = 0,
+  MW_DSP_FRAC_DELAY_LAGRANGE3,
+  MW_DSP_FRAC_DELAY_HERMITE,
+  MW_DSP_FRAC_DELAY_THIRAN,
+  MW_DSP_FRAC_DELAY_NUM_INTERPOLATION_TYPES
+}MW_DSP_FractionalDelayInterpolation;
+
+
+/*
+ *  kernel holds the interpolation weights for the current delay length.  The first weight is applied to the sample
+ *  at readPtr + kernelOffset and the rest to progressively older samples.  For the Thiran interpolator kernel[0] holds
+ *  the allpass coefficient and thiranState holds the previous output
+ *
+ *  ringBuffer describes the same memory as buffer and N.  Its guard zone is empty unless the delay line was initialized with
+ *  MW_DSP_FractionalDelayLine_init_guarded()
+ */
 typedef struct
 {
   float32_t   *buffer;
@@ -49,24 +135,77 @@ typedef struct
   float32_t   MFrac;
   int32_t     writePtr;
   int32_t     readPtr;
+  MW_DSP_FractionalDelayInterpolation interpolation;
+  float32_t   kernel[4];
+  int32_t     kernelOffset;
+  int32_t     kernelLength;
+  float32_t   thiranState;
+  MW_DSP_RingBuffer ringBuffer;
 }MW_DSP_FractionalDelayLine;
 
 
+/*
+ *  Multi-tap delay line
+ *  One delay line buffer is written once per sample and read by up to MW_DSP_MULTITAP_MAX_TAPS taps.  Tap delays may be
+ *  fractional (linear interpolation).  A tap with a delay of 0 outputs the current input sample.
+ *  Like MW_DSP_FractionalDelayLine, the write pointer moves down through the buffer so the sample at writePtr + d is d samples
+ *  older than the sample at writePtr.  The buffer always has a guard zone of MW_DSP_MULTITAP_GUARD_SIZE samples (see
+ *  MW_DSP_RingBuffer) so both interpolation taps are read without a wrap check.
+ *
+ *  tapInt and tapFrac hold the integer and fractional parts of each tap delay
+ */
+#define MW_DSP_MULTITAP_MAX_TAPS 16
+#define MW_DSP_MULTITAP_GUARD_SIZE 1
+
+typedef struct
+{
+  float32_t   *buffer;
+  int32_t     N;
+  int32_t     writePtr;
+  int32_t     numTaps;
+  int32_t     tapInt[MW_DSP_MULTITAP_MAX_TAPS];
+  float32_t   tapFrac[MW_DSP_MULTITAP_MAX_TAPS];
+  MW_DSP_RingBuffer ringBuffer;
+}MW_DSP_MultiTapDelayLine;
+
+
 int32_t   MW_DSP_DelayLine_init(MW_DSP_DelayLine *delayLine, float32_t *bufferMemory, size_t N);
 int32_t   MW_DSP_DelayLine_init_memalloc(MW_DSP_DelayLine **delayLine, size_t N);
+int32_t   MW_DSP_DelayLine_init_pow2(MW_DSP_DelayLine *delayLine, float32_t *bufferMemory, size_t bufferSize, size_t N);
+int32_t   MW_DSP_DelayLine_init_q15(MW_DSP_DelayLine *delayLine, q15_t *bufferMemory, size_t N);
+int32_t   MW_DSP_DelayLine_init_arena(MW_DSP_DelayLine *delayLine, MW_DSP_Arena *arena, size_t N);
 int32_t   MW_DSP_DelayLine_delete(MW_DSP_DelayLine **delayLine);
 
 void      MW_DSP_DelayLine_setDelayLength(MW_DSP_DelayLine *delayLine, float32_t M);
+void      MW_DSP_DelayLine_setCrossfadeLength(MW_DSP_DelayLine *delayLine, size_t crossfadeLength);
 float32_t MW_DSP_DelayLine_tick(MW_DSP_DelayLine *delayLine, float32_t x);
+void      MW_DSP_DelayLine_process(MW_DSP_DelayLine *delayLine, float32_t *in, float32_t *out, size_t numSamples);
 float32_t MW_DSP_DelayLine_peek(MW_DSP_DelayLine *delayLine);
+float32_t MW_DSP_DelayLine_peekAt(MW_DSP_DelayLine *delayLine, size_t delay);
 
+size_t    MW_DSP_DelayLine_nextPowerOfTwo(size_t N);
 
-int32_t   MW_DSP_FractionalDelayLine_init(MW_DSP_FractionalDelayLine *delayLine, float32_t *buffer, int16_t N, float32_t M);
+
+int32_t   MW_DSP_FractionalDelayLine_init(MW_DSP_FractionalDelayLine *delayLine, float32_t *buffer, int32_t N, float32_t M);
+int32_t   MW_DSP_FractionalDelayLine_init_interpolation(MW_DSP_FractionalDelayLine *delayLine, float32_t *buffer, int32_t N, float32_t M,
+                                                        MW_DSP_FractionalDelayInterpolation interpolation);
+int32_t   MW_DSP_FractionalDelayLine_init_guarded(MW_DSP_FractionalDelayLine *delayLine, float32_t *buffer, int32_t N, float32_t M,
+                                                  MW_DSP_FractionalDelayInterpolation interpolation);
+int32_t   MW_DSP_FractionalDelayLine_init_arena(MW_DSP_FractionalDelayLine *delayLine, MW_DSP_Arena *arena, int32_t N, float32_t M,
+                                                MW_DSP_FractionalDelayInterpolation interpolation);
 
 void      MW_DSP_FractionalDelayLine_setDelayLength(MW_DSP_FractionalDelayLine *delayLine, float32_t M);
 float32_t MW_DSP_FractionalDelayLine_tick(MW_DSP_FractionalDelayLine *delayLine, float32_t x);
 void      MW_DSP_FractionalDelayLine_process(MW_DSP_FractionalDelayLine *delayLine, float32_t *buffer, size_t numSamples);
+void      MW_DSP_FractionalDelayLine_processModulated(MW_DSP_FractionalDelayLine *delayLine, float32_t *buffer, const float32_t *delayTimes, size_t numSamples);
 void      MW_DSP_FractionalDelayLine_reset(MW_DSP_FractionalDelayLine *delayLine);
 
 
+int32_t   MW_DSP_MultiTapDelayLine_init(MW_DSP_MultiTapDelayLine *delayLine, float32_t *buffer, int32_t N, const float32_t *tapDelays, int32_t numTaps);
+void      MW_DSP_MultiTapDelayLine_setTapDelay(MW_DSP_MultiTapDelayLine *delayLine, int32_t tap, float32_t M);
+void      MW_DSP_MultiTapDelayLine_tick(MW_DSP_MultiTapDelayLine *delayLine, float32_t x, float32_t *tapOutputs);
+void      MW_DSP_MultiTapDelayLine_process(MW_DSP_MultiTapDelayLine *delayLine, const float32_t *in, float32_t **tapOutputs, size_t numSamples);
+void      MW_DSP_MultiTapDelayLine_reset(MW_DSP_MultiTapDelayLine *delayLine);
+
+
 #endif /* ADSPBUILDINGBLOCKS_MW_DSP_DELAYLINE_H_ */
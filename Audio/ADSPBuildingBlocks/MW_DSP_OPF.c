@@ -37,6 +37,58 @@ static void MW_DSP_OPF_invalidateOPF(MW_DSP_OPF *filter)
 
 
 
+static void MW_DSP_OPF_updatePowers(MW_DSP_OPF *filter)
+{
+  float32_t power = 1.f;
+  for (int32_t i = 0; i < MW_DSP_OPF_CHUNK_SIZE; ++i)
+  {
+    power *= filter->a1;
+    filter->a1Powers[i] = power;
+  }
+
+  filter->a1PowersSource = filter->a1;
+}
+
+
+
+/*
+ *  Filter one block of MW_DSP_OPF_SCAN_BLOCK_SIZE samples in place
+ *  The block is split into chunks.  First the zero-state response of every chunk (the output if the chunk started from a
+ *  state of 0) is computed with all chunks running side by side, so the inner loop has no dependency between iterations.
+ *  Then the state entering each chunk is carried through: a chunk that starts from a state s adds a1^(n+1) * s to its
+ *  zero-state response at sample n, and its last sample is the state entering the next chunk.  Only that last step is serial
+ */
+static void MW_DSP_OPF_processScanBlock(MW_DSP_OPF *filter, float32_t *buffer)
+{
+  float32_t state[MW_DSP_OPF_NUM_CHUNKS] = {0.f};
+  float32_t a1 = filter->a1;
+  float32_t b0 = filter->b0;
+
+  for (int32_t n = 0; n < MW_DSP_OPF_CHUNK_SIZE; ++n)
+  {
+    for (int32_t c = 0; c < MW_DSP_OPF_NUM_CHUNKS; ++c)
+    {
+      state[c] = (state[c] * a1) + (buffer[c * MW_DSP_OPF_CHUNK_SIZE + n] * b0);
+      buffer[c * MW_DSP_OPF_CHUNK_SIZE + n] = state[c];
+    }
+  }
+
+  float32_t carry = filter->stateVariable;
+  for (int32_t c = 0; c < MW_DSP_OPF_NUM_CHUNKS; ++c)
+  {
+    float32_t *chunk = buffer + c * MW_DSP_OPF_CHUNK_SIZE;
+
+    for (int32_t n = 0; n < MW_DSP_OPF_CHUNK_SIZE; ++n)
+      chunk[n] += filter->a1Powers[n] * carry;
+
+    carry = chunk[MW_DSP_OPF_CHUNK_SIZE - 1];
+  }
+
+  filter->stateVariable = carry;
+}
+
+
+
 /*
  *  Initialize MW_DSP_OPF filter instance
  *  NOTE:   a1 (filter feedback gain) is not subtracted from the filter input by default.  Be careful that you don't pass in
@@ -58,6 +110,9 @@ int32_t MW_DSP_OPF_init(MW_DSP_OPF *filter, float32_t b0, float32_t a1)
 
   filter->b0 = b0;
   filter->a1 = a1;
+  filter->stateVariable = 0.f;
+
+  MW_DSP_OPF_updatePowers(filter);
 
   return 1;
 }
@@ -88,6 +143,8 @@ float32_t MW_DSP_OPF_tick(MW_DSP_OPF *filter, float32_t x)
 
 /*
  *  Process a buffer of samples
+ *  Buffers of at least MW_DSP_OPF_SCAN_BLOCK_SIZE samples are filtered in blocks with MW_DSP_OPF_processScanBlock(), which
+ *  matches MW_DSP_OPF_tick() to within float rounding (the carried state is scaled by a1^n instead of n multiplies by a1)
  *
  *  Inputs:
  *    filter:     MW_DSP_OPF filter instance
@@ -114,6 +171,18 @@ void MW_DSP_OPF_process(MW_DSP_OPF *filter, float32_t *buffer, size_t bufferSize
 
 #endif
 
+  if (bufferSize >= MW_DSP_OPF_SCAN_BLOCK_SIZE)
+  {
+    if (filter->a1PowersSource != filter->a1)
+      MW_DSP_OPF_updatePowers(filter);
+
+    while (bufferSize >= MW_DSP_OPF_SCAN_BLOCK_SIZE)
+    {
+      MW_DSP_OPF_processScanBlock(filter, buffer);
+      buffer += MW_DSP_OPF_SCAN_BLOCK_SIZE;
+      bufferSize -= MW_DSP_OPF_SCAN_BLOCK_SIZE;
+    }
+  }
 
   for (uint32_t i = 0; i < bufferSize; ++i)
   {
@@ -124,3 +193,180 @@ void MW_DSP_OPF_process(MW_DSP_OPF *filter, float32_t *buffer, size_t bufferSize
 
 
 
+/*
+ *  Initialize MW_DSP_OPFBank instance
+ *  Every channel starts with the same coefficients (see MW_DSP_OPF_init()) and a state of 0
+ *
+ *  Inputs:
+ *    bank:         MW_DSP_OPFBank instance
+ *    numChannels:  Number of channels (up to MW_DSP_OPFBANK_MAX_CHANNELS)
+ *    b0:           OPF filter input gain
+ *    a1:           OPF filter feedback gain
+ *
+ *  Returns:
+ *    0 if initialization unsuccessful
+ *    1 if initialization successful
+ */
+int32_t MW_DSP_OPFBank_init(MW_DSP_OPFBank *bank, int32_t numChannels, float32_t b0, float32_t a1)
+{
+  if (bank == NULL)
+    return 0;
+
+  if (numChannels <= 0 || numChannels > MW_DSP_OPFBANK_MAX_CHANNELS)
+    return 0;
+
+  bank->numChannels = numChannels;
+
+  for (int32_t i = 0; i < numChannels; ++i)
+  {
+    bank->b0[i] = b0;
+    bank->a1[i] = a1;
+  }
+
+  MW_DSP_OPFBank_reset(bank);
+
+  return 1;
+}
+
+
+/*
+ *  Set the coefficients of one channel, or of every channel if channel is -1
+ *
+ *  Returns:
+ *    0 if the channel is invalid
+ *    1 otherwise
+ */
+int32_t MW_DSP_OPFBank_setCoefficients(MW_DSP_OPFBank *bank, int32_t channel, float32_t b0, float32_t a1)
+{
+  if (bank == NULL)
+    return 0;
+
+  if (channel < -1 || channel >= bank->numChannels)
+    return 0;
+
+  for (int32_t i = 0; i < bank->numChannels; ++i)
+  {
+    if (channel == -1 || channel == i)
+    {
+      bank->b0[i] = b0;
+      bank->a1[i] = a1;
+    }
+  }
+
+  return 1;
+}
+
+
+/*
+ *  Process interleaved samples (frame n holds buffer[n * numChannels] to buffer[n * numChannels + numChannels - 1])
+ *
+ *  Inputs:
+ *    bank:       MW_DSP_OPFBank instance
+ *    buffer:     Pointer to numFrames * numChannels interleaved samples
+ *    numFrames:  Number of frames to process
+ *
+ *  Returns:
+ *    Buffer of processed data (written to the input buffer)
+ */
+void MW_DSP_OPFBank_processInterleaved(MW_DSP_OPFBank *bank, float32_t *buffer, size_t numFrames)
+{
+#ifdef NO_OPTIMIZE
+  if (bank == NULL || buffer == NULL)
+    return;
+#endif
+
+  int32_t numChannels = bank->numChannels;
+  float32_t *state = bank->stateVariables;
+  float32_t *b0 = bank->b0;
+  float32_t *a1 = bank->a1;
+
+  for (size_t n = 0; n < numFrames; ++n)
+  {
+    for (int32_t i = 0; i < numChannels; ++i)
+    {
+      state[i] = (state[i] * a1[i]) + (buffer[i] * b0[i]);
+      buffer[i] = state[i];
+    }
+
+    buffer += numChannels;
+  }
+}
+
+
+/*
+ *  Process planar samples (one buffer per channel)
+ *  Reading buffers[i][n] across channels is a strided, pointer-chased access, so the channels are not run in lockstep
+ *  here.  Instead MW_DSP_OPFBANK_PLANAR_GROUP_SIZE channels are filtered side by side over the whole buffer, each walking
+ *  its own buffer linearly with its state in a register.  Their recurrences are independent so they overlap
+ *
+ *  Inputs:
+ *    bank:       MW_DSP_OPFBank instance
+ *    buffers:    Array of numChannels buffers
+ *    bufferSize: Number of samples in each buffer
+ *
+ *  Returns:
+ *    Buffers of processed data (written to the input buffers)
+ */
+void MW_DSP_OPFBank_processPlanar(MW_DSP_OPFBank *bank, float32_t **buffers, size_t bufferSize)
+{
+#ifdef NO_OPTIMIZE
+  if (bank == NULL || buffers == NULL)
+    return;
+#endif
+
+  int32_t numChannels = bank->numChannels;
+  float32_t *state = bank->stateVariables;
+  float32_t *b0 = bank->b0;
+  float32_t *a1 = bank->a1;
+  int32_t i = 0;
+
+  for (; i + MW_DSP_OPFBANK_PLANAR_GROUP_SIZE <= numChannels; i += MW_DSP_OPFBANK_PLANAR_GROUP_SIZE)
+  {
+    float32_t *x0 = buffers[i];
+    float32_t *x1 = buffers[i + 1];
+    float32_t *x2 = buffers[i + 2];
+    float32_t *x3 = buffers[i + 3];
+    float32_t s0 = state[i];
+    float32_t s1 = state[i + 1];
+    float32_t s2 = state[i + 2];
+    float32_t s3 = state[i + 3];
+
+    for (size_t n = 0; n < bufferSize; ++n)
+    {
+      s0 = (s0 * a1[i]) + (x0[n] * b0[i]);
+      s1 = (s1 * a1[i + 1]) + (x1[n] * b0[i + 1]);
+      s2 = (s2 * a1[i + 2]) + (x2[n] * b0[i + 2]);
+      s3 = (s3 * a1[i + 3]) + (x3[n] * b0[i + 3]);
+      x0[n] = s0;
+      x1[n] = s1;
+      x2[n] = s2;
+      x3[n] = s3;
+    }
+
+    state[i] = s0;
+    state[i + 1] = s1;
+    state[i + 2] = s2;
+    state[i + 3] = s3;
+  }
+
+  for (; i < numChannels; ++i)
+  {
+    float32_t *x = buffers[i];
+    float32_t s = state[i];
+
+    for (size_t n = 0; n < bufferSize; ++n)
+    {
+      s = (s * a1[i]) + (x[n] * b0[i]);
+      x[n] = s;
+    }
+
+    state[i] = s;
+  }
+}
+
+
+void MW_DSP_OPFBank_reset(MW_DSP_OPFBank *bank)
+{
+  for (int32_t i = 0; i < bank->numChannels; ++i)
+    bank->stateVariables[i] = 0.f;
+}
@@ -29,11 +29,24 @@
 
 #include "arm_math.h"
 
+//  MW_DSP_OPF_process() splits blocks of MW_DSP_OPF_SCAN_BLOCK_SIZE samples into MW_DSP_OPF_NUM_CHUNKS chunks of
+//  MW_DSP_OPF_CHUNK_SIZE samples which are filtered side by side.  Shorter buffers (and leftover samples) are filtered serially
+#define MW_DSP_OPF_CHUNK_SIZE 8
+#define MW_DSP_OPF_NUM_CHUNKS 4
+#define MW_DSP_OPF_SCAN_BLOCK_SIZE (MW_DSP_OPF_CHUNK_SIZE * MW_DSP_OPF_NUM_CHUNKS)
+
+
+/*
+ *  a1Powers holds a1^1 to a1^MW_DSP_OPF_CHUNK_SIZE for MW_DSP_OPF_process().  It is recomputed whenever a1 differs from
+ *  a1PowersSource, so a1 can still be changed directly
+ */
 typedef struct
 {
   float32_t   stateVariable;
   float32_t   b0;
   float32_t   a1;
+  float32_t   a1PowersSource;
+  float32_t   a1Powers[MW_DSP_OPF_CHUNK_SIZE];
 }MW_DSP_OPF;
 
 
@@ -41,4 +54,31 @@ int32_t     MW_DSP_OPF_init(MW_DSP_OPF *filter, float32_t b0, float32_t a1);
 float32_t   MW_DSP_OPF_tick(MW_DSP_OPF *filter, float32_t x);
 void        MW_DSP_OPF_process(MW_DSP_OPF *filter, float32_t *buffer, size_t bufferSize);
 
+
+#define MW_DSP_OPFBANK_MAX_CHANNELS 64
+
+//  MW_DSP_OPFBank_processPlanar() filters this many channels side by side (the code is written out for 4)
+#define MW_DSP_OPFBANK_PLANAR_GROUP_SIZE 4
+
+/*
+ *  Bank of OPFs (one per channel).  Interleaved input is run in lockstep, one sample of every channel at a time.  The
+ *  states and coefficients are kept in contiguous arrays so that the loop across channels has no dependency between
+ *  iterations (the recurrence of one channel runs while the others are computed) and can be vectorized.  Planar input
+ *  is run a few channels at a time over the whole buffer instead (see MW_DSP_OPFBank_processPlanar())
+ */
+typedef struct
+{
+  int32_t     numChannels;
+  float32_t   stateVariables[MW_DSP_OPFBANK_MAX_CHANNELS];
+  float32_t   b0[MW_DSP_OPFBANK_MAX_CHANNELS];
+  float32_t   a1[MW_DSP_OPFBANK_MAX_CHANNELS];
+}MW_DSP_OPFBank;
+
+
+int32_t     MW_DSP_OPFBank_init(MW_DSP_OPFBank *bank, int32_t numChannels, float32_t b0, float32_t a1);
+int32_t     MW_DSP_OPFBank_setCoefficients(MW_DSP_OPFBank *bank, int32_t channel, float32_t b0, float32_t a1);
+void        MW_DSP_OPFBank_processInterleaved(MW_DSP_OPFBank *bank, float32_t *buffer, size_t numFrames);
+void        MW_DSP_OPFBank_processPlanar(MW_DSP_OPFBank *bank, float32_t **buffers, size_t bufferSize);
+void        MW_DSP_OPFBank_reset(MW_DSP_OPFBank *bank);
+
 #endif /* MW_DSP_OPF_H_ */
@@ -0,0 +1,140 @@
+//  Copyright 2021 Allen Lee
+//
+//  Author:  Allen Lee (alee@meoworkshop.org)
+//  
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//  For more information, please refer to https://opensource.org/licenses/mit-license.php
+//
+//  ------------------------------------------------------------------------------------------------  //
+
+
+
+#include "MW_DSP_RingBuffer.h"
+
+
+/*
+ *  Initialize an instance of MW_DSP_RingBuffer
+ *  NOTE:  The initialization function will NOT allocate memory for the buffer.  You must pass in a pre-allocated array
+ *  that holds at least MW_DSP_RINGBUFFER_MEMORY_SIZE(N, guardSize) samples.  The memory is cleared.
+ *
+ *  Inputs:
+ *    ringBuffer:     Pointer to MW_DSP_RingBuffer instance
+ *    bufferMemory:   Pointer to N + guardSize samples of memory
+ *    N:              Ring buffer length
+ *    guardSize:      Number of samples mirrored past the end of the buffer (0 to N)
+ *
+ *  Returns:
+ *    1 if successful, 0 otherwise
+ */
+int32_t MW_DSP_RingBuffer_init(MW_DSP_RingBuffer *ringBuffer, float32_t *bufferMemory, int32_t N, int32_t guardSize)
+{
+  if (ringBuffer == NULL || bufferMemory == NULL)
+    return 0;
+
+  if (N <= 0 || guardSize < 0 || guardSize > N)
+    return 0;
+
+  ringBuffer->buffer = bufferMemory;
+  ringBuffer->N = N;
+  ringBuffer->guardSize = guardSize;
+
+  arm_fill_f32(0.f, bufferMemory, MW_DSP_RINGBUFFER_MEMORY_SIZE(N, guardSize));
+
+  return 1;
+}
+
+
+/*
+ *  Write a block of samples starting at index and moving up through the buffer.  The block wraps around to the start
+ *  of the buffer if needed and the guard zone is updated
+ *
+ *  Inputs:
+ *    ringBuffer:     Pointer to MW_DSP_RingBuffer instance
+ *    index:          Index of the first sample (0 <= index < N)
+ *    x:              Samples to write
+ *    numSamples:     Number of samples to write (no more than N)
+ *
+ *  Returns:
+ *    None
+ */
+void MW_DSP_RingBuffer_writeBlock(MW_DSP_RingBuffer *ringBuffer, int32_t index, const float32_t *x, int32_t numSamples)
+{
+#ifdef NO_OPTIMIZE
+  assert(ringBuffer != NULL);
+  assert(index >= 0 && index < ringBuffer->N);
+  assert(numSamples <= ringBuffer->N);
+#endif
+
+  int32_t firstSegmentLength = ringBuffer->N - index;
+  if (firstSegmentLength > numSamples)
+    firstSegmentLength = numSamples;
+
+  arm_copy_f32((float32_t *)x, &ringBuffer->buffer[index], firstSegmentLength);
+  MW_DSP_RingBuffer_updateGuard(ringBuffer, index, firstSegmentLength);
+
+  if (numSamples > firstSegmentLength)
+  {
+    arm_copy_f32((float32_t *)&x[firstSegmentLength], ringBuffer->buffer, numSamples - firstSegmentLength);
+    MW_DSP_RingBuffer_updateGuard(ringBuffer, 0, numSamples - firstSegmentLength);
+  }
+}
+
+
+/*
+ *  Mirror any of the samples in [index, index + numSamples) that fall in the guard zone.  Call this after writing directly
+ *  into the buffer.  The range must not wrap.
+ *
+ *  Inputs:
+ *    ringBuffer:     Pointer to MW_DSP_RingBuffer instance
+ *    index:          Index of the first sample that was written
+ *    numSamples:     Number of samples written
+ *
+ *  Returns:
+ *    None
+ */
+void MW_DSP_RingBuffer_updateGuard(MW_DSP_RingBuffer *ringBuffer, int32_t index, int32_t numSamples)
+{
+  if (index >= ringBuffer->guardSize)
+    return;
+
+  int32_t end = index + numSamples;
+  if (end > ringBuffer->guardSize)
+    end = ringBuffer->guardSize;
+
+  if (end > index)
+    arm_copy_f32(&ringBuffer->buffer[index], &ringBuffer->buffer[index + ringBuffer->N], end - index);
+}
+
+
+/*
+ *  Clear the ring buffer and its guard zone
+ */
+void MW_DSP_RingBuffer_reset(MW_DSP_RingBuffer *ringBuffer)
+{
+  #ifdef NO_OPTIMIZE
+  if (ringBuffer == NULL) while(1);
+  if (ringBuffer->buffer == NULL) while(1);
+  #endif
+
+  if (ringBuffer == NULL) return;
+  if (ringBuffer->buffer == NULL) return;
+
+  arm_fill_f32(0.f, ringBuffer->buffer, MW_DSP_RINGBUFFER_MEMORY_SIZE(ringBuffer->N, ringBuffer->guardSize));
+}
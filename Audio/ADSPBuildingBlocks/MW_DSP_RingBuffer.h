@@ -0,0 +1,72 @@
+//  Copyright 2021 Allen Lee
+//
+//  Author:  Allen Lee (alee@meoworkshop.org)
+//  
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//  For more information, please refer to https://opensource.org/licenses/mit-license.php
+//
+//  ------------------------------------------------------------------------------------------------  //
+
+
+#ifndef MW_DSP_RINGBUFFER_H_
+#define MW_DSP_RINGBUFFER_H_
+
+#include "arm_math.h"
+#include "assert.h"
+
+//  Number of samples of memory needed for a ring buffer of N samples with a guard zone of guardSize samples
+#define MW_DSP_RINGBUFFER_MEMORY_SIZE(N, guardSize) ((N) + (guardSize))
+
+
+/*
+ *  Ring buffer with an optional guard zone
+ *  The first guardSize samples of the buffer are mirrored past its end (buffer[N + i] == buffer[i] for i < guardSize),
+ *  so up to guardSize + 1 consecutive samples can be read starting from any index in [0, N) without wrapping.
+ *  Readers that interpolate between neighbouring samples can then load all of their taps without bounds checks.
+ *
+ *  The guard is kept up to date by writing through MW_DSP_RingBuffer_write() or by calling MW_DSP_RingBuffer_updateGuard()
+ *  after writing directly into buffer.  A guardSize of 0 gives a plain ring buffer.
+ */
+typedef struct
+{
+  float32_t *buffer;
+  int32_t   N;
+  int32_t   guardSize;
+}MW_DSP_RingBuffer;
+
+
+int32_t   MW_DSP_RingBuffer_init(MW_DSP_RingBuffer *ringBuffer, float32_t *bufferMemory, int32_t N, int32_t guardSize);
+void      MW_DSP_RingBuffer_writeBlock(MW_DSP_RingBuffer *ringBuffer, int32_t index, const float32_t *x, int32_t numSamples);
+void      MW_DSP_RingBuffer_updateGuard(MW_DSP_RingBuffer *ringBuffer, int32_t index, int32_t numSamples);
+void      MW_DSP_RingBuffer_reset(MW_DSP_RingBuffer *ringBuffer);
+
+
+/*
+ *  Write a single sample at index (0 <= index < N), mirroring it into the guard zone if needed
+ *  Defined here so that per-sample writers can inline it
+ */
+static inline void MW_DSP_RingBuffer_write(MW_DSP_RingBuffer *ringBuffer, int32_t index, float32_t x)
+{
+  ringBuffer->buffer[index] = x;
+  if (index < ringBuffer->guardSize)
+    ringBuffer->buffer[index + ringBuffer->N] = x;
+}
+
+#endif /* MW_DSP_RINGBUFFER_H_ */
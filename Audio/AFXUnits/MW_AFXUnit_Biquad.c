@@ -26,6 +26,23 @@
 
 
 #include "MW_AFXUnit_Biquad.h"
+#include "MW_AFXUnit_MiscUtils.h"
+
+
+/*
+ *  Fold the dry path of a tone control filter into its biquad coefficients
+ *  Shelving and non-constant-Q parametric EQ filters are designed as y = x + (mu - 1) * H(x).  With H = B / A this is
+ *  y = (A + (mu - 1) * B) / A, which is again a single biquad.  coefficientsOut[5] must hold mu - 1 and is left as is
+ *  (note that CMSIS expects the feedback coefficients with their signs flipped, so A = 1 - a1 * z^-1 - a2 * z^-2)
+ */
+static void MW_AFXUnit_Biquad_foldDryPath(float32_t *coefficientsOut)
+{
+    float32_t wetGain = coefficientsOut[5];
+
+    coefficientsOut[0] = 1.f + wetGain * coefficientsOut[0];
+    coefficientsOut[1] = -coefficientsOut[3] + wetGain * coefficientsOut[1];
+    coefficientsOut[2] = -coefficientsOut[4] + wetGain * coefficientsOut[2];
+}
 
 
 /*
@@ -44,9 +61,46 @@ void MW_AFXUnit_Biquad_calculateCoefficients(MW_AFXUnit_BiquadType filterType, f
 
     switch(filterType)
     {
+        //  First order shelves (Q is ignored)
+        case MW_BIQUAD_LOW_SHELF:
+        {
+            float32_t mu = powf(10.f, gain / 20.f);
+            float32_t theta = PI * fc / fs;
+            float32_t delta = (4.f / (1.f + mu)) * arm_sin_f32(theta) / arm_cos_f32(theta);
+            float32_t gamma = (1.f - delta) / (1.f + delta);
+
+            coefficientsOut[0] = 0.5f * (1.f - gamma);
+            coefficientsOut[1] = 0.5f * (1.f - gamma);
+            coefficientsOut[2] = 0.f;
+            coefficientsOut[3] = gamma;
+            coefficientsOut[4] = 0.f;
+            coefficientsOut[5] = mu - 1.f;
+
+            MW_AFXUnit_Biquad_foldDryPath(coefficientsOut);
+            break;
+        }
+
+        case MW_BIQUAD_HIGH_SHELF:
+        {
+            float32_t mu = powf(10.f, gain / 20.f);
+            float32_t theta = PI * fc / fs;
+            float32_t delta = (0.25f * (1.f + mu)) * arm_sin_f32(theta) / arm_cos_f32(theta);
+            float32_t gamma = (1.f - delta) / (1.f + delta);
+
+            coefficientsOut[0] = 0.5f * (1.f + gamma);
+            coefficientsOut[1] = -0.5f * (1.f + gamma);
+            coefficientsOut[2] = 0.f;
+            coefficientsOut[3] = gamma;
+            coefficientsOut[4] = 0.f;
+            coefficientsOut[5] = mu - 1.f;
+
+            MW_AFXUnit_Biquad_foldDryPath(coefficientsOut);
+            break;
+        }
+
         case MW_BIQUAD_PARAM_EQ_NCQ:
         {
-            float32_t mu = pow(10, gain / 20.f);
+            float32_t mu = powf(10.f, gain / 20.f);
             float32_t theta = 2.f * PI * fc / fs;
 
             float32_t zeta = 4.f / (1.f + mu);
@@ -61,6 +115,7 @@ void MW_AFXUnit_Biquad_calculateCoefficients(MW_AFXUnit_BiquadType filterType, f
             coefficientsOut[4] = -2.f * beta;
             coefficientsOut[5] = mu - 1.f;
 
+            MW_AFXUnit_Biquad_foldDryPath(coefficientsOut);
             break;
         }
 
@@ -68,7 +123,7 @@ void MW_AFXUnit_Biquad_calculateCoefficients(MW_AFXUnit_BiquadType filterType, f
         {
             float32_t phase = PI * fc / fs;
             float32_t K = arm_sin_f32(phase) / arm_cos_f32(phase);
-            float32_t V0 = pow(10, gain / 20.f);
+            float32_t V0 = powf(10.f, gain / 20.f);
             float32_t QInv = 1.f / Q;
             float32_t KSq = K * K;
             
@@ -149,8 +204,8 @@ void MW_AFXUnit_Biquad_calculateCoefficients(MW_AFXUnit_BiquadType filterType, f
             coefficientsOut[0] = a0;
             coefficientsOut[1] = 0.f;
             coefficientsOut[2] = -a0;
-            coefficientsOut[3] = 2.f * Q * ((k * k) - 1.f) / delta;
-            coefficientsOut[4] = ((k * k * Q) - k + Q) / delta;
+            coefficientsOut[3] = -2.f * Q * ((k * k) - 1.f) / delta;
+            coefficientsOut[4] = -((k * k * Q) - k + Q) / delta;
 
             break;
         }
@@ -161,25 +216,150 @@ void MW_AFXUnit_Biquad_calculateCoefficients(MW_AFXUnit_BiquadType filterType, f
 }
 
 
+/*
+ *  Frequency response of a cascade of biquad stages
+ *  Frequencies are handled in blocks of MW_AFXUNIT_BIQUAD_RESPONSE_BLOCK_SIZE.  The trig terms are computed once per block and
+ *  shared by every stage, and each stage multiplies its response into the block with plain loops over the frequencies (which
+ *  the compiler vectorizes).  The magnitude and phase are only taken once, from the product of all stages
+ *
+ *  Evaluating B and A with cos(w) and cos(2w) loses most of the float precision at low frequencies (cos(w) is within a few ULPs
+ *  of 1 and the terms cancel).  They are evaluated with 1 - cos(w) = 2 * sin^2(w / 2) instead, around the sums of the
+ *  coefficients (the response at DC), which are computed in double once per stage
+ *
+ *  Inputs:
+ *      coefficients:   numStages * 5 coefficients in the CMSIS df2T layout (MW_AFXUnit_Biquad.coefficients for a single stage,
+ *                      MW_AFXUnit_BiquadCascade.coefficients for a cascade)
+ *      numStages:      Number of stages
+ *      fs:             Sampling frequency
+ *      frequencies:    Frequencies to evaluate (in Hz)
+ *      magnitude:      Linear magnitude at each frequency (or NULL)
+ *      phase:          Phase in radians, wrapped to [-pi, pi], at each frequency (or NULL)
+ *      numFrequencies: Number of frequencies
+ */
+void MW_AFXUnit_Biquad_response(const float32_t *coefficients, int32_t numStages, float32_t fs, const float32_t *frequencies,
+                                float32_t *magnitude, float32_t *phase, size_t numFrequencies)
+{
+#ifdef NO_OPTIMIZE
+    if (coefficients == NULL) while(1);
+    if (frequencies == NULL) while(1);
+    if (fs <= 0.f) while(1);
+#endif
+
+    float32_t u1[MW_AFXUNIT_BIQUAD_RESPONSE_BLOCK_SIZE];     //  1 - cos(w)
+    float32_t u2[MW_AFXUNIT_BIQUAD_RESPONSE_BLOCK_SIZE];     //  1 - cos(2w)
+    float32_t s1[MW_AFXUNIT_BIQUAD_RESPONSE_BLOCK_SIZE];     //  sin(w)
+    float32_t re[MW_AFXUNIT_BIQUAD_RESPONSE_BLOCK_SIZE];
+    float32_t im[MW_AFXUNIT_BIQUAD_RESPONSE_BLOCK_SIZE];
+    float32_t omegaScale = 2.f * PI / fs;
+
+    for (size_t start = 0; start < numFrequencies; start += MW_AFXUNIT_BIQUAD_RESPONSE_BLOCK_SIZE)
+    {
+        size_t blockSize = numFrequencies - start;
+        if (blockSize > MW_AFXUNIT_BIQUAD_RESPONSE_BLOCK_SIZE)
+            blockSize = MW_AFXUNIT_BIQUAD_RESPONSE_BLOCK_SIZE;
+
+        for (size_t i = 0; i < blockSize; ++i)
+        {
+            float32_t omega = omegaScale * frequencies[start + i];
+            float32_t halfSin = arm_sin_f32(0.5f * omega);
+
+            s1[i] = arm_sin_f32(omega);
+            u1[i] = 2.f * halfSin * halfSin;
+            u2[i] = 2.f * s1[i] * s1[i];
+            re[i] = 1.f;
+            im[i] = 0.f;
+        }
+
+        //  H = B / A with B = b0 + b1 * z^-1 + b2 * z^-2 and A = 1 - a1 * z^-1 - a2 * z^-2, at z^-k = cos(kw) - j * sin(kw):
+        //      Re(B) = (b0 + b1 + b2) - b1 * u1 - b2 * u2          Im(B) = -s1 * ((b1 + 2 * b2) - 2 * b2 * u1)
+        //      Re(A) = (1 - a1 - a2) + a1 * u1 + a2 * u2           Im(A) =  s1 * ((a1 + 2 * a2) - 2 * a2 * u1)
+        for (int32_t stage = 0; stage < numStages; ++stage)
+        {
+            const float32_t *c = &coefficients[5 * stage];
+            float32_t b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+            float32_t sumB = (float32_t)((double)c[0] + (double)c[1] + (double)c[2]);
+            float32_t sumA = (float32_t)(1.0 - (double)c[3] - (double)c[4]);
+            float32_t slopeB = (float32_t)((double)c[1] + 2.0 * (double)c[2]);
+            float32_t slopeA = (float32_t)((double)c[3] + 2.0 * (double)c[4]);
+
+            for (size_t i = 0; i < blockSize; ++i)
+            {
+                float32_t numRe = sumB - b1 * u1[i] - b2 * u2[i];
+                float32_t numIm = -s1[i] * (slopeB - 2.f * b2 * u1[i]);
+                float32_t denRe = sumA + a1 * u1[i] + a2 * u2[i];
+                float32_t denIm = s1[i] * (slopeA - 2.f * a2 * u1[i]);
+
+                //  B / A = B * conj(A) / |A|^2
+                float32_t denInv = 1.f / (denRe * denRe + denIm * denIm);
+                float32_t hRe = (numRe * denRe + numIm * denIm) * denInv;
+                float32_t hIm = (numIm * denRe - numRe * denIm) * denInv;
+
+                float32_t productRe = re[i] * hRe - im[i] * hIm;
+                im[i] = re[i] * hIm + im[i] * hRe;
+                re[i] = productRe;
+            }
+        }
+
+        for (size_t i = 0; i < blockSize; ++i)
+        {
+            if (magnitude != NULL)
+                magnitude[start + i] = sqrtf(re[i] * re[i] + im[i] * im[i]);
+
+            if (phase != NULL)
+                phase[start + i] = atan2f(im[i], re[i]);
+        }
+    }
+}
+
+
+/*
+ *  Quantize the float coefficients of a biquad for its fixed point format
+ *  The smallest postShift that brings every coefficient into [-1, 1) is used, so the coefficients keep as many bits as possible
+ */
+static void MW_AFXUnit_Biquad_quantizeCoefficients(MW_AFXUnit_Biquad *biquad)
+{
+    float32_t maxCoefficient = 0.f;
+    for (int32_t i = 0; i < 5; ++i)
+        if (fabsf(biquad->coefficients[i]) > maxCoefficient)
+            maxCoefficient = fabsf(biquad->coefficients[i]);
+
+    int32_t postShift = 0;
+    while (maxCoefficient >= 1.f && postShift < 15)
+    {
+        maxCoefficient *= 0.5f;
+        postShift++;
+    }
+
+    float32_t scale = 1.f / (float32_t)(1 << postShift);
+    for (int32_t i = 0; i < 5; ++i)
+    {
+        float32_t x = biquad->coefficients[i] * scale;
+        q63_t q31 = (q63_t)(x * 2147483648.f + ((x >= 0.f) ? 0.5f : -0.5f));
+        q31_t q15 = (q31_t)(x * 32768.f + ((x >= 0.f) ? 0.5f : -0.5f));
+
+        biquad->coefficientsQ31[i] = (q31 > 0x7FFFFFFF) ? 0x7FFFFFFF : (q31_t)q31;
+        biquad->coefficientsQ15[(i == 0) ? 0 : i + 1] = clip_q31_to_q15(q15);
+    }
+    biquad->coefficientsQ15[1] = 0;
+
+    biquad->instanceQ31.postShift = (uint8_t)postShift;
+    biquad->instance32x64.postShift = (uint8_t)postShift;
+    biquad->instanceQ15.postShift = (int8_t)postShift;
+}
+
+
 /*
  *  Initialize an instance of MW_AFXUnit_Biquad
  *  This implementation will leverage the biquad functions already available in the ARM CMSIS DSP library.
  * 
- *  Depending on the type of filter, valid inputs for copyBuffer and copyBufferSize may need to be passed
- *  This typically applies to tone control filters (shelving and parametric EQ filters) as they have a feed-forward component
- *  that is summed with the biquad output.
- *  
- *  The following filter types must have valid copyBuffer and copyBufferSize inputs (copyBuffer must hold the same number of samples in your audio buffer)
- *      - MW_BIQUAD_LOW_SHELF
- *      - MW_BIQUAD_HIGH_SHELF
- *      - MW_BIQUAD_PARAM_EQ_NCQ
- * 
- *  All other filter types can pass in NULL.
+ *  Tone control filters (shelving and non-constant-Q parametric EQ filters) have a feed-forward component that is summed
+ *  with the biquad output.  This dry path is folded into the biquad coefficients, so every filter type runs as a single
+ *  in-place biquad pass on buffers of any size.
  * 
  *  Some filter types do not need Q defined, in which case, it is simply ignored
  * 
- *  NOTE:   This implementation does not have input parameter smoothing so any rapid changes in parameters will likely result in
- *          clicking noises.  For a variable parameter filter, the MW_AFXUnit_SVFilter is preferable
+ *  NOTE:   MW_AFXUnit_Biquad_changeParameters() does not smooth parameter changes, so any rapid changes in parameters will likely
+ *          result in clicking noises.  For automated parameters, enable the modulation mode (MW_AFXUnit_Biquad_enableModulation())
  * 
  *  Inputs:
  *      biquad:         Pointer to MW_AFXUnit_Biquad instance
@@ -188,14 +368,12 @@ void MW_AFXUnit_Biquad_calculateCoefficients(MW_AFXUnit_BiquadType filterType, f
  *      fc:             Filter cutoff/centre frequency
  *      Q:              Filter Q
  *      gain:           Filter gain (in dB)
- *      copyBuffer:     Pointer to pre-allocated array that holds the same number of samples as your audio buffer (If using Low, High Shelf or Param EQ filters)
- *      copyBufferSize: Size of copyBuffer (must be the same size as your audio buffer)
  * 
  *  Returns:
  *      0: if initialization unsuccessful
  *      1: otherwise
  */ 
-int32_t MW_AFXUnit_Biquad_init(MW_AFXUnit_Biquad *biquad, MW_AFXUnit_BiquadType filterType, float32_t fs, float32_t fc, float32_t Q, float32_t gain, float32_t *copyBuffer, size_t copyBufferSize)
+int32_t MW_AFXUnit_Biquad_init(MW_AFXUnit_Biquad *biquad, MW_AFXUnit_BiquadType filterType, float32_t fs, float32_t fc, float32_t Q, float32_t gain)
 {
     if (biquad == NULL)
         return 0;
@@ -212,24 +390,50 @@ int32_t MW_AFXUnit_Biquad_init(MW_AFXUnit_Biquad *biquad, MW_AFXUnit_BiquadType
     if (filterType < 0 || filterType >= MW_BIQUAD_NUM_TYPES)
         return 0;
 
-    //  These filter types need to have a valid copyBuffer and copyBufferSize input
-    if ((filterType == MW_BIQUAD_LOW_SHELF && copyBuffer == NULL) || (filterType == MW_BIQUAD_LOW_SHELF && copyBufferSize == 0))
-        return 0;
+    biquad->fs = fs;
+    biquad->filterType = filterType;
+    biquad->modulation.interval = 0;
+    biquad->format = MW_BIQUAD_FORMAT_F32;
+
+    MW_AFXUnit_Biquad_calculateCoefficients(filterType, biquad->coefficients, fs, fc, Q, gain);
+
+    arm_biquad_cascade_df2T_init_f32(&biquad->biquadInstance, 1, biquad->coefficients, biquad->stateVariables);
+
+    return 1;
+}
+
 
-    if ((filterType == MW_BIQUAD_HIGH_SHELF && copyBuffer == NULL) || (filterType == MW_BIQUAD_HIGH_SHELF && copyBufferSize == 0))
+/*
+ *  Initialize an instance of MW_AFXUnit_Biquad that processes in a given numeric format
+ *  Fixed point biquads are processed with MW_AFXUnit_Biquad_process_q31() (MW_BIQUAD_FORMAT_Q31 and MW_BIQUAD_FORMAT_Q31_32X64)
+ *  or MW_AFXUnit_Biquad_process_q15() (MW_BIQUAD_FORMAT_Q15).  Fixed point samples saturate (or wrap) above full scale, so the
+ *  input needs as much headroom as the filter has gain
+ *
+ *  Inputs:
+ *      format:         Numeric format of the buffers to process
+ *      (all other inputs are the same as MW_AFXUnit_Biquad_init())
+ *
+ *  Returns:
+ *      0: if initialization unsuccessful
+ *      1: otherwise
+ */
+int32_t MW_AFXUnit_Biquad_init_format(MW_AFXUnit_Biquad *biquad, MW_AFXUnit_BiquadFormat format, MW_AFXUnit_BiquadType filterType, float32_t fs, float32_t fc, float32_t Q, float32_t gain)
+{
+    if (format < 0 || format >= MW_BIQUAD_NUM_FORMATS)
         return 0;
 
-    if ((filterType == MW_BIQUAD_PARAM_EQ_NCQ && copyBuffer == NULL) || (filterType == MW_BIQUAD_PARAM_EQ_NCQ && copyBufferSize == 0))
+    if (!MW_AFXUnit_Biquad_init(biquad, filterType, fs, fc, Q, gain))
         return 0;
 
-    biquad->copyBuffer = copyBuffer;
-    biquad->bufferSize = copyBufferSize;
-    biquad->fs = fs;
-    biquad->filterType = filterType;
+    biquad->format = format;
+    if (format == MW_BIQUAD_FORMAT_F32)
+        return 1;
 
-    MW_AFXUnit_Biquad_calculateCoefficients(filterType, biquad->coefficients, fs, fc, Q, gain);
+    arm_biquad_cascade_df1_init_q31(&biquad->instanceQ31, 1, biquad->coefficientsQ31, biquad->stateVariablesQ31, 0);
+    arm_biquad_cas_df1_32x64_init_q31(&biquad->instance32x64, 1, biquad->coefficientsQ31, biquad->stateVariablesQ63, 0);
+    arm_biquad_cascade_df1_init_q15(&biquad->instanceQ15, 1, biquad->coefficientsQ15, biquad->stateVariablesQ15, 0);
 
-    arm_biquad_cascade_df2T_init_f32(&biquad->biquadInstance, 1, biquad->coefficients, biquad->stateVariables);
+    MW_AFXUnit_Biquad_quantizeCoefficients(biquad);
 
     return 1;
 }
@@ -246,38 +450,78 @@ void MW_AFXUnit_Biquad_changeParameters(MW_AFXUnit_Biquad *biquad, MW_AFXUnit_Bi
 
     MW_AFXUnit_Biquad_calculateCoefficients(filterType, biquad->coefficients, biquad->fs, fc, Q, gain);
 
+    if (biquad->format != MW_BIQUAD_FORMAT_F32)
+        MW_AFXUnit_Biquad_quantizeCoefficients(biquad);
+
     return;
 }
 
 
+/*
+ *  Same as MW_AFXUnit_Biquad_changeParameters(), but the coefficients are looked up in (or added to) a coefficient cache
+ *  Parameters are quantized to the cache steps (see MW_AFXUnit_BiquadCache).  The cache must run at the same fs as the biquad
+ */
+void MW_AFXUnit_Biquad_changeParametersCached(MW_AFXUnit_Biquad *biquad, MW_AFXUnit_BiquadCache *cache, MW_AFXUnit_BiquadType filterType, float32_t fc, float32_t Q, float32_t gain)
+{
+#ifdef NO_OPTIMIZE
+    if (biquad == NULL) while(1);
+    if (cache == NULL) while(1);
+    if (cache->fs != biquad->fs) while(1);
+    if (filterType >= MW_BIQUAD_NUM_TYPES || filterType < 0) while(1);
+    if (fc >= biquad->fs * 0.5f) while(1);
+#endif
+
+    MW_AFXUnit_BiquadCache_calculateCoefficients(cache, filterType, biquad->coefficients, fc, Q, gain);
+
+    if (biquad->format != MW_BIQUAD_FORMAT_F32)
+        MW_AFXUnit_Biquad_quantizeCoefficients(biquad);
+}
+
+
+static void MW_AFXUnit_Biquad_processModulated(MW_AFXUnit_Biquad *biquad, float32_t *buffer, size_t numSamples);
+
 void MW_AFXUnit_Biquad_process(MW_AFXUnit_Biquad *biquad, float32_t *buffer, size_t numSamples)
 {
 #ifdef NO_OPTIMIZE
     if (biquad == NULL) while(1);
     if (buffer == NULL) while(1);
+    if (biquad->format != MW_BIQUAD_FORMAT_F32) while(1);
 #endif
 
-    switch (biquad->filterType)
+    if (biquad->modulation.interval > 0)
     {
-        case MW_BIQUAD_LOW_SHELF:
-        case MW_BIQUAD_HIGH_SHELF:
-        case MW_BIQUAD_PARAM_EQ_NCQ:
-        {
-            #ifdef NO_OPTIMIZE
-            if (biquad->bufferSize != numSamples) while(1);
-            #endif
-            arm_copy_f32(buffer, biquad->copyBuffer, numSamples);
-            arm_biquad_cascade_df2T_f32(&biquad->biquadInstance, buffer, buffer, numSamples);
-            arm_scale_f32(buffer, biquad->coefficients[5], buffer, numSamples);
-            arm_add_f32(buffer, biquad->copyBuffer, buffer, numSamples);
+        MW_AFXUnit_Biquad_processModulated(biquad, buffer, numSamples);
+        return;
+    }
 
-            break;
-        }
+    arm_biquad_cascade_df2T_f32(&biquad->biquadInstance, buffer, buffer, numSamples);
+}
 
-        default:
-            arm_biquad_cascade_df2T_f32(&biquad->biquadInstance, buffer, buffer, numSamples);
-            break;
-    }
+
+void MW_AFXUnit_Biquad_process_q31(MW_AFXUnit_Biquad *biquad, q31_t *buffer, size_t numSamples)
+{
+#ifdef NO_OPTIMIZE
+    if (biquad == NULL) while(1);
+    if (buffer == NULL) while(1);
+    if (biquad->format != MW_BIQUAD_FORMAT_Q31 && biquad->format != MW_BIQUAD_FORMAT_Q31_32X64) while(1);
+#endif
+
+    if (biquad->format == MW_BIQUAD_FORMAT_Q31_32X64)
+        arm_biquad_cas_df1_32x64_q31(&biquad->instance32x64, buffer, buffer, numSamples);
+    else
+        arm_biquad_cascade_df1_fast_q31(&biquad->instanceQ31, buffer, buffer, numSamples);
+}
+
+
+void MW_AFXUnit_Biquad_process_q15(MW_AFXUnit_Biquad *biquad, q15_t *buffer, size_t numSamples)
+{
+#ifdef NO_OPTIMIZE
+    if (biquad == NULL) while(1);
+    if (buffer == NULL) while(1);
+    if (biquad->format != MW_BIQUAD_FORMAT_Q15) while(1);
+#endif
+
+    arm_biquad_cascade_df1_fast_q15(&biquad->instanceQ15, buffer, buffer, numSamples);
 }
 
 
@@ -291,4 +535,878 @@ void MW_AFXUnit_Biquad_reset(MW_AFXUnit_Biquad *biquad)
 
     biquad->stateVariables[0] = 0;
     biquad->stateVariables[1] = 0;
+
+    for (int32_t i = 0; i < 4; ++i)
+    {
+        biquad->stateVariablesQ31[i] = 0;
+        biquad->stateVariablesQ63[i] = 0;
+        biquad->stateVariablesQ15[i] = 0;
+    }
+}
+
+
+
+//  CMSIS df2T coefficients (b0, b1, b2, a1, a2) to (b0, b1, b2, k1, k2).  The feedback part is 1 - a1 * z^-1 - a2 * z^-2
+static void MW_AFXUnit_Biquad_toLattice(float32_t *coefficients, float32_t *lattice)
+{
+    lattice[0] = coefficients[0];
+    lattice[1] = coefficients[1];
+    lattice[2] = coefficients[2];
+    lattice[3] = -coefficients[3] / (1.f - coefficients[4]);
+    lattice[4] = -coefficients[4];
+}
+
+
+static void MW_AFXUnit_Biquad_fromLattice(float32_t *lattice, float32_t *coefficients)
+{
+    coefficients[0] = lattice[0];
+    coefficients[1] = lattice[1];
+    coefficients[2] = lattice[2];
+    coefficients[3] = -lattice[3] * (1.f + lattice[4]);
+    coefficients[4] = -lattice[4];
+}
+
+
+/*
+ *  Enable (or disable) the modulation mode of a biquad
+ *  In modulation mode, parameters are set with MW_AFXUnit_Biquad_modulateParameters(), which only stores them.  Every controlInterval
+ *  samples, the latest parameters are designed and the filter ramps to them over the next controlInterval samples, stepping its
+ *  coefficients every MW_AFXUNIT_BIQUAD_MODULATION_STEP samples.  The cost is at most one design per control interval however often
+ *  the parameters are changed, and each step is still a single block call to the CMSIS biquad kernel
+ *
+ *  Inputs:
+ *      biquad:             Pointer to an initialized MW_AFXUnit_Biquad instance
+ *      controlInterval:    Control interval K in samples, a multiple of MW_AFXUNIT_BIQUAD_MODULATION_STEP (0 disables the modulation mode)
+ *
+ *  Returns:
+ *      0: if controlInterval is invalid or the biquad uses a fixed point format
+ *      1: otherwise
+ */
+int32_t MW_AFXUnit_Biquad_enableModulation(MW_AFXUnit_Biquad *biquad, int32_t controlInterval)
+{
+    if (biquad == NULL)
+        return 0;
+
+    if (controlInterval < 0 || controlInterval % MW_AFXUNIT_BIQUAD_MODULATION_STEP != 0)
+        return 0;
+
+    //  Modulation ramps the float coefficients only
+    if (biquad->format != MW_BIQUAD_FORMAT_F32)
+        return 0;
+
+    MW_AFXUnit_BiquadModulation *modulation = &biquad->modulation;
+
+    modulation->interval = controlInterval;
+    modulation->samplesToControl = 0;
+    modulation->stepsLeft = 0;
+    modulation->parametersChanged = 0;
+
+    MW_AFXUnit_Biquad_toLattice(biquad->coefficients, modulation->current);
+
+    return 1;
+}
+
+
+/*
+ *  Set the parameters a modulated biquad ramps to.  This only stores them, so it can be called as often as needed (e.g. every sample)
+ */
+void MW_AFXUnit_Biquad_modulateParameters(MW_AFXUnit_Biquad *biquad, MW_AFXUnit_BiquadType filterType, float32_t fc, float32_t Q, float32_t gain)
+{
+#ifdef NO_OPTIMIZE
+    if (biquad == NULL) while(1);
+    if (biquad->modulation.interval == 0) while(1);
+    if (filterType >= MW_BIQUAD_NUM_TYPES || filterType < 0) while(1);
+    if (fc >= biquad->fs * 0.5f) while(1);
+#endif
+
+    MW_AFXUnit_BiquadModulation *modulation = &biquad->modulation;
+
+    modulation->targetType = filterType;
+    modulation->targetFc = fc;
+    modulation->targetQ = Q;
+    modulation->targetGain = gain;
+    modulation->parametersChanged = 1;
+}
+
+
+static void MW_AFXUnit_Biquad_processModulated(MW_AFXUnit_Biquad *biquad, float32_t *buffer, size_t numSamples)
+{
+    MW_AFXUnit_BiquadModulation *modulation = &biquad->modulation;
+
+    while (numSamples > 0)
+    {
+        //  Control update: start a ramp to the latest parameters
+        if (modulation->samplesToControl == 0)
+        {
+            modulation->samplesToControl = modulation->interval;
+
+            if (modulation->parametersChanged)
+            {
+                float32_t coefficients[6];
+                int32_t numSteps = modulation->interval / MW_AFXUNIT_BIQUAD_MODULATION_STEP;
+
+                MW_AFXUnit_Biquad_calculateCoefficients(modulation->targetType, coefficients, biquad->fs, modulation->targetFc, modulation->targetQ, modulation->targetGain);
+                MW_AFXUnit_Biquad_toLattice(coefficients, modulation->target);
+
+                arm_sub_f32(modulation->target, modulation->current, modulation->increment, 5);
+                arm_scale_f32(modulation->increment, 1.f / numSteps, modulation->increment, 5);
+
+                biquad->filterType = modulation->targetType;
+                modulation->stepsLeft = numSteps;
+                modulation->parametersChanged = 0;
+            }
+        }
+
+        //  While ramping, the coefficients step at every multiple of MW_AFXUNIT_BIQUAD_MODULATION_STEP samples into the control interval
+        size_t blockSize = modulation->samplesToControl;
+        if (modulation->stepsLeft > 0)
+        {
+            int32_t samplesToStep = modulation->samplesToControl % MW_AFXUNIT_BIQUAD_MODULATION_STEP;
+            if (samplesToStep == 0)
+            {
+                modulation->stepsLeft--;
+                if (modulation->stepsLeft == 0)
+                    arm_copy_f32(modulation->target, modulation->current, 5);
+                else
+                    arm_add_f32(modulation->current, modulation->increment, modulation->current, 5);
+
+                MW_AFXUnit_Biquad_fromLattice(modulation->current, biquad->coefficients);
+                samplesToStep = MW_AFXUNIT_BIQUAD_MODULATION_STEP;
+            }
+
+            blockSize = samplesToStep;
+        }
+
+        if (blockSize > numSamples)
+            blockSize = numSamples;
+
+        arm_biquad_cascade_df2T_f32(&biquad->biquadInstance, buffer, buffer, blockSize);
+
+        buffer += blockSize;
+        numSamples -= blockSize;
+        modulation->samplesToControl -= blockSize;
+    }
+}
+
+
+// ============================================================================================================== //
+
+
+/*
+ *  Initialize an empty MW_AFXUnit_BiquadCache
+ *
+ *  Inputs:
+ *      cache:          Pointer to MW_AFXUnit_BiquadCache instance
+ *      fs:             Sampling frequency of the biquads using the cache
+ *
+ *  Returns:
+ *      0: if initialization unsuccessful
+ *      1: otherwise
+ */
+int32_t MW_AFXUnit_BiquadCache_init(MW_AFXUnit_BiquadCache *cache, float32_t fs)
+{
+    if (cache == NULL)
+        return 0;
+
+    if (fs <= 0)
+        return 0;
+
+    cache->numEntries = 0;
+    cache->useCounter = 0;
+    for (int32_t i = 0; i < 2 * MW_AFXUNIT_BIQUADCACHE_SIZE; ++i)
+        cache->hints[i] = 0;
+    cache->fs = fs;
+
+    return 1;
+}
+
+
+//  Round to the nearest integer without going through lrintf()
+static inline int32_t MW_AFXUnit_BiquadCache_quantize(float32_t x)
+{
+    return (x >= 0.f) ? (int32_t)(x + 0.5f) : (int32_t)(x - 0.5f);
+}
+
+
+/*
+ *  Look up the coefficients for the quantized parameters, designing them on a miss
+ *  On a miss the least recently used entry is replaced.  For performance reasons, no parameter checks are performed
+ *
+ *  Inputs:
+ *      cache:              Pointer to MW_AFXUnit_BiquadCache instance
+ *      filterType:         Filter type
+ *      coefficientsOut:    Array of 6 coefficients (same layout as MW_AFXUnit_Biquad_calculateCoefficients())
+ *      fc, Q, gain:        Filter parameters, quantized to MW_AFXUNIT_BIQUADCACHE_FC_STEP, _Q_STEP and _GAIN_STEP
+ *
+ *  Returns:
+ *      0: if the coefficients had to be designed
+ *      1: if they were found in the cache
+ */
+int32_t MW_AFXUnit_BiquadCache_calculateCoefficients(MW_AFXUnit_BiquadCache *cache, MW_AFXUnit_BiquadType filterType, float32_t *coefficientsOut, float32_t fc, float32_t Q, float32_t gain)
+{
+#ifdef NO_OPTIMIZE
+    if (cache == NULL) while(1);
+    if (coefficientsOut == NULL) while(1);
+#endif
+
+    //  Pack the quantized parameters into a single key: 4 bits of type, 20 bits of fc (up to 65 kHz), 18 bits of Q (up to 262)
+    //  and 22 bits of gain (+/-209 dB, offset to be positive)
+    int32_t fcSteps = MW_AFXUnit_BiquadCache_quantize(fc * (1.f / MW_AFXUNIT_BIQUADCACHE_FC_STEP));
+    int32_t QSteps = MW_AFXUnit_BiquadCache_quantize(Q * (1.f / MW_AFXUNIT_BIQUADCACHE_Q_STEP));
+    int32_t gainSteps = MW_AFXUnit_BiquadCache_quantize(gain * (1.f / MW_AFXUNIT_BIQUADCACHE_GAIN_STEP));
+    uint64_t key = ((uint64_t)filterType << 60) | ((uint64_t)(fcSteps & 0xFFFFF) << 40) | ((uint64_t)(QSteps & 0x3FFFF) << 22) | (uint64_t)((gainSteps + 0x200000) & 0x3FFFFF);
+
+    cache->useCounter++;
+
+    //  Most repeated lookups are found straight away through the hint for their hash, the others fall back to a scan
+    int32_t hash = (int32_t)((key * 0x9E3779B97F4A7C15ull) >> 58) & (2 * MW_AFXUNIT_BIQUADCACHE_SIZE - 1);
+    int32_t hint = cache->hints[hash];
+    if (hint < cache->numEntries && cache->keys[hint] == key)
+    {
+        cache->lastUsed[hint] = cache->useCounter;
+        arm_copy_f32(cache->coefficients[hint], coefficientsOut, 6);
+        return 1;
+    }
+
+    for (int32_t i = 0; i < cache->numEntries; ++i)
+    {
+        if (cache->keys[i] == key)
+        {
+            cache->hints[hash] = (uint8_t)i;
+            cache->lastUsed[i] = cache->useCounter;
+            arm_copy_f32(cache->coefficients[i], coefficientsOut, 6);
+            return 1;
+        }
+    }
+
+    int32_t entry = cache->numEntries;
+    if (entry < MW_AFXUNIT_BIQUADCACHE_SIZE)
+    {
+        cache->numEntries++;
+    }
+    else
+    {
+        //  Unsigned differences keep the age ordering correct when useCounter wraps around
+        entry = 0;
+        for (int32_t i = 1; i < MW_AFXUNIT_BIQUADCACHE_SIZE; ++i)
+            if (cache->useCounter - cache->lastUsed[i] > cache->useCounter - cache->lastUsed[entry])
+                entry = i;
+    }
+
+    cache->keys[entry] = key;
+    cache->hints[hash] = (uint8_t)entry;
+    cache->lastUsed[entry] = cache->useCounter;
+
+    MW_AFXUnit_Biquad_calculateCoefficients(filterType, cache->coefficients[entry], cache->fs, fcSteps * MW_AFXUNIT_BIQUADCACHE_FC_STEP,
+                                            QSteps * MW_AFXUNIT_BIQUADCACHE_Q_STEP, gainSteps * MW_AFXUNIT_BIQUADCACHE_GAIN_STEP);
+    arm_copy_f32(cache->coefficients[entry], coefficientsOut, 6);
+
+    return 0;
+}
+
+
+
+// ============================================================================================================== //
+
+
+/*
+ *  Initialize an instance of MW_AFXUnit_BiquadCascade
+ *  Every stage starts as a pass-through (b0 = 1).  Set up each stage with MW_AFXUnit_BiquadCascade_changeStageParameters()
+ *
+ *  Inputs:
+ *      cascade:        Pointer to MW_AFXUnit_BiquadCascade instance
+ *      numStages:      Number of biquad stages (up to MW_AFXUNIT_BIQUADCASCADE_MAX_STAGES)
+ *      fs:             Sampling frequency
+ *
+ *  Returns:
+ *      0: if initialization unsuccessful
+ *      1: otherwise
+ */
+int32_t MW_AFXUnit_BiquadCascade_init(MW_AFXUnit_BiquadCascade *cascade, int32_t numStages, float32_t fs)
+{
+    if (cascade == NULL)
+        return 0;
+
+    if (numStages <= 0 || numStages > MW_AFXUNIT_BIQUADCASCADE_MAX_STAGES)
+        return 0;
+
+    if (fs <= 0)
+        return 0;
+
+    cascade->numStages = numStages;
+    cascade->convolution = NULL;
+    cascade->fs = fs;
+
+    for (int32_t i = 0; i < numStages; ++i)
+    {
+        float32_t *coefficients = &cascade->coefficients[5 * i];
+
+        cascade->filterTypes[i] = MW_BIQUAD_LPF;
+        coefficients[0] = 1.f;
+        coefficients[1] = 0.f;
+        coefficients[2] = 0.f;
+        coefficients[3] = 0.f;
+        coefficients[4] = 0.f;
+    }
+
+    arm_biquad_cascade_df2T_init_f32(&cascade->biquadInstance, numStages, cascade->coefficients, cascade->stateVariables);
+
+    return 1;
+}
+
+
+static void MW_AFXUnit_BiquadCascade_startRebuild(MW_AFXUnit_BiquadCascade *cascade);
+static void MW_AFXUnit_BiquadCascade_processPartition(MW_AFXUnit_BiquadCascade *cascade, float32_t *buffer);
+
+
+static int32_t MW_AFXUnit_BiquadCascade_isValidStage(MW_AFXUnit_BiquadCascade *cascade, int32_t stage, MW_AFXUnit_BiquadType filterType, float32_t fc, float32_t Q)
+{
+    if (cascade == NULL)
+        return 0;
+
+    if (stage < 0 || stage >= cascade->numStages)
+        return 0;
+
+    if (fc >= 0.5f * cascade->fs || Q <= 0.f)
+        return 0;
+
+    if (filterType < 0 || filterType >= MW_BIQUAD_NUM_TYPES)
+        return 0;
+
+    return 1;
+}
+
+
+/*
+ *  Redesign one stage of the cascade.  The state variables of the stage are kept
+ *  A cascade running as an FIR keeps the previous response until the FIR has been rebuilt in the background
+ *
+ *  Returns:
+ *      0: if the stage or parameters are invalid (the stage is left unchanged)
+ *      1: otherwise
+ */
+int32_t MW_AFXUnit_BiquadCascade_changeStageParameters(MW_AFXUnit_BiquadCascade *cascade, int32_t stage, MW_AFXUnit_BiquadType filterType, float32_t fc, float32_t Q, float32_t gain)
+{
+    if (!MW_AFXUnit_BiquadCascade_isValidStage(cascade, stage, filterType, fc, Q))
+        return 0;
+
+    float32_t coefficients[6];
+    MW_AFXUnit_Biquad_calculateCoefficients(filterType, coefficients, cascade->fs, fc, Q, gain);
+
+    arm_copy_f32(coefficients, &cascade->coefficients[5 * stage], 5);
+    cascade->filterTypes[stage] = filterType;
+    MW_AFXUnit_BiquadCascade_startRebuild(cascade);
+
+    return 1;
+}
+
+
+/*
+ *  Same as MW_AFXUnit_BiquadCascade_changeStageParameters(), but the coefficients are looked up in (or added to) a coefficient cache
+ *
+ *  Returns:
+ *      0: if the stage or parameters are invalid, or the cache runs at a different fs (the stage is left unchanged)
+ *      1: otherwise
+ */
+int32_t MW_AFXUnit_BiquadCascade_changeStageParametersCached(MW_AFXUnit_BiquadCascade *cascade, MW_AFXUnit_BiquadCache *cache, int32_t stage, MW_AFXUnit_BiquadType filterType,
+                                                             float32_t fc, float32_t Q, float32_t gain)
+{
+    if (!MW_AFXUnit_BiquadCascade_isValidStage(cascade, stage, filterType, fc, Q))
+        return 0;
+
+    if (cache == NULL || cache->fs != cascade->fs)
+        return 0;
+
+    float32_t coefficients[6];
+    MW_AFXUnit_BiquadCache_calculateCoefficients(cache, filterType, coefficients, fc, Q, gain);
+
+    arm_copy_f32(coefficients, &cascade->coefficients[5 * stage], 5);
+    cascade->filterTypes[stage] = filterType;
+    MW_AFXUnit_BiquadCascade_startRebuild(cascade);
+
+    return 1;
+}
+
+
+/*
+ *  Filter a buffer in place
+ *  NOTE:   When the convolution picked the FIR path, numSamples must be the block size given to
+ *          MW_AFXUnit_BiquadCascade_enableConvolution() (which only picks the FIR path for multiples of
+ *          MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE)
+ */
+void MW_AFXUnit_BiquadCascade_process(MW_AFXUnit_BiquadCascade *cascade, float32_t *buffer, size_t numSamples)
+{
+#ifdef NO_OPTIMIZE
+    if (cascade == NULL) while(1);
+    if (buffer == NULL) while(1);
+    if (cascade->convolution != NULL && cascade->convolution->useFIR && numSamples % MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE != 0) while(1);
+#endif
+
+    if (cascade->convolution == NULL || !cascade->convolution->useFIR)
+    {
+        arm_biquad_cascade_df2T_f32(&cascade->biquadInstance, buffer, buffer, numSamples);
+        return;
+    }
+
+    for (size_t offset = 0; offset + MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE <= numSamples; offset += MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE)
+        MW_AFXUnit_BiquadCascade_processPartition(cascade, &buffer[offset]);
+}
+
+
+void MW_AFXUnit_BiquadCascade_reset(MW_AFXUnit_BiquadCascade *cascade)
+{
+    #ifdef NO_OPTIMIZE
+    if (cascade == NULL) while(1);
+    #endif
+
+    if (cascade == NULL) return;
+
+    arm_fill_f32(0.f, cascade->stateVariables, 2 * cascade->numStages);
+
+    if (cascade->convolution != NULL)
+    {
+        arm_fill_f32(0.f, &cascade->convolution->inputSpectra[0][0], MW_AFXUNIT_BIQUADCONVOLUTION_NUM_PARTITIONS * MW_AFXUNIT_BIQUADCONVOLUTION_FFT_SIZE);
+        arm_fill_f32(0.f, cascade->convolution->inputBuffer, MW_AFXUNIT_BIQUADCONVOLUTION_FFT_SIZE);
+    }
+}
+
+
+
+// ============================================================================================================== //
+
+
+/*
+ *  Start sampling the impulse response of the cascade into the spectra set that is not in use
+ *  A rebuild that is already running is left to finish (restarting it on every change would never finish under automation)
+ *  and another one is started after it
+ */
+static void MW_AFXUnit_BiquadCascade_startRebuild(MW_AFXUnit_BiquadCascade *cascade)
+{
+    MW_AFXUnit_BiquadConvolution *convolution = cascade->convolution;
+
+    if (convolution == NULL || !convolution->useFIR)
+        return;
+
+    if (convolution->buildPartition >= 0)
+    {
+        convolution->rebuildPending = 1;
+        return;
+    }
+
+    arm_copy_f32(cascade->coefficients, convolution->buildCoefficients, 5 * cascade->numStages);
+    arm_fill_f32(0.f, convolution->buildStateVariables, 2 * cascade->numStages);
+    convolution->responseEnergy = 0.f;
+    convolution->buildPartition = 0;
+}
+
+
+/*
+ *  Sample the next partition of the impulse response and store its spectrum
+ *  After the last partition, one more partition is sampled to measure the energy the FIR leaves out
+ *
+ *  Returns:
+ *      0: if the rebuild is still running
+ *      1: if the FIR is done and the response decays within it
+ *      -1: if the FIR is done but would truncate the response
+ */
+static int32_t MW_AFXUnit_BiquadCascade_rebuildStep(MW_AFXUnit_BiquadConvolution *convolution)
+{
+    float32_t *buffer = convolution->buildBuffer;
+    float32_t energy;
+
+    arm_fill_f32(0.f, buffer, MW_AFXUNIT_BIQUADCONVOLUTION_FFT_SIZE);
+    if (convolution->buildPartition == 0)
+        buffer[0] = 1.f;
+
+    arm_biquad_cascade_df2T_f32(&convolution->buildInstance, buffer, buffer, MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE);
+    arm_power_f32(buffer, MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE, &energy);
+
+    if (convolution->buildPartition == MW_AFXUNIT_BIQUADCONVOLUTION_NUM_PARTITIONS)
+    {
+        convolution->buildPartition = -1;
+        return (energy <= MW_AFXUNIT_BIQUADCONVOLUTION_MAX_TAIL * convolution->responseEnergy) ? 1 : -1;
+    }
+
+    convolution->responseEnergy += energy;
+    arm_rfft_fast_f32(&convolution->fftInstance, buffer, convolution->spectra[1 - convolution->currentSpectra][convolution->buildPartition], 0);
+    convolution->buildPartition++;
+
+    return 0;
+}
+
+
+//  Transform the newest partition of input (overlap-save: the previous partition followed by this one) into the delay line
+static void MW_AFXUnit_BiquadCascade_pushPartition(MW_AFXUnit_BiquadConvolution *convolution, float32_t *buffer)
+{
+    const size_t P = MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE;
+
+    convolution->newestPartition++;
+    if (convolution->newestPartition == MW_AFXUNIT_BIQUADCONVOLUTION_NUM_PARTITIONS)
+        convolution->newestPartition = 0;
+
+    arm_copy_f32(buffer, &convolution->inputBuffer[P], P);
+    arm_copy_f32(convolution->inputBuffer, convolution->scratch, 2 * P);
+    arm_rfft_fast_f32(&convolution->fftInstance, convolution->scratch, convolution->inputSpectra[convolution->newestPartition], 0);
+    arm_copy_f32(buffer, convolution->inputBuffer, P);
+}
+
+
+/*
+ *  Convolve the delay line with one set of spectra and write one partition of output
+ *  Spectra are packed as CMSIS real FFTs: {DC, Nyquist, re[1], im[1], ...}
+ */
+static void MW_AFXUnit_BiquadCascade_convolve(MW_AFXUnit_BiquadConvolution *convolution, int32_t spectraSet, float32_t *output)
+{
+    const size_t P = MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE;
+    float32_t *accumulator = convolution->accumulator;
+    int32_t slot = convolution->newestPartition;
+
+    arm_fill_f32(0.f, accumulator, 2 * P);
+
+    for (int32_t k = 0; k < MW_AFXUNIT_BIQUADCONVOLUTION_NUM_PARTITIONS; ++k)
+    {
+        const float32_t *x = convolution->inputSpectra[slot];
+        const float32_t *h = convolution->spectra[spectraSet][k];
+
+        accumulator[0] += x[0] * h[0];
+        accumulator[1] += x[1] * h[1];
+        for (size_t i = 2; i < 2 * P; i += 2)
+        {
+            accumulator[i] += x[i] * h[i] - x[i + 1] * h[i + 1];
+            accumulator[i + 1] += x[i] * h[i + 1] + x[i + 1] * h[i];
+        }
+
+        slot = (slot == 0) ? MW_AFXUNIT_BIQUADCONVOLUTION_NUM_PARTITIONS - 1 : slot - 1;
+    }
+
+    arm_rfft_fast_f32(&convolution->fftInstance, accumulator, convolution->scratch, 1);
+    arm_copy_f32(&convolution->scratch[P], output, P);
+}
+
+
+//  Linear crossfade over one partition, from a to b
+static void MW_AFXUnit_BiquadCascade_crossfade(const float32_t *a, const float32_t *b, float32_t *output)
+{
+    const float32_t step = 1.f / MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE;
+
+    for (int32_t i = 0; i < MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE; ++i)
+        output[i] = a[i] + (b[i] - a[i]) * (i + 1) * step;
+}
+
+
+/*
+ *  Process one partition on the FIR path
+ *  The delay line is fed whenever the FIR is producing the output or being rebuilt.  A rebuild takes one partition longer than
+ *  the delay line, so the delay line is always up to date by the time a rebuilt FIR is faded in.  Switching back to the biquads
+ *  runs them for the length of the FIR first, so they start from the same input history the FIR was using
+ */
+static void MW_AFXUnit_BiquadCascade_processPartition(MW_AFXUnit_BiquadCascade *cascade, float32_t *buffer)
+{
+    MW_AFXUnit_BiquadConvolution *convolution = cascade->convolution;
+    const size_t P = MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE;
+    int32_t rebuilt = 0;
+
+    if (convolution->activeFIR || convolution->buildPartition >= 0)
+        MW_AFXUnit_BiquadCascade_pushPartition(convolution, buffer);
+
+    if (convolution->buildPartition >= 0)
+        rebuilt = MW_AFXUnit_BiquadCascade_rebuildStep(convolution);
+
+    //  The next rebuild only samples its first partition on the next call, after the spectra sets have been swapped below
+    if (rebuilt != 0 && convolution->rebuildPending)
+    {
+        convolution->rebuildPending = 0;
+        MW_AFXUnit_BiquadCascade_startRebuild(cascade);
+    }
+
+    if (rebuilt == 1)
+        convolution->iirWarmup = 0;
+    else if (rebuilt == -1 && convolution->activeFIR && convolution->iirWarmup == 0)
+    {
+        arm_fill_f32(0.f, cascade->stateVariables, 2 * cascade->numStages);
+        convolution->iirWarmup = MW_AFXUNIT_BIQUADCONVOLUTION_NUM_PARTITIONS;
+    }
+
+    if (!convolution->activeFIR)
+    {
+        arm_biquad_cascade_df2T_f32(&cascade->biquadInstance, buffer, buffer, P);
+
+        if (rebuilt == 1)
+        {
+            MW_AFXUnit_BiquadCascade_convolve(convolution, 1 - convolution->currentSpectra, convolution->output[0]);
+            MW_AFXUnit_BiquadCascade_crossfade(buffer, convolution->output[0], buffer);
+            convolution->currentSpectra = 1 - convolution->currentSpectra;
+            convolution->activeFIR = 1;
+        }
+
+        return;
+    }
+
+    MW_AFXUnit_BiquadCascade_convolve(convolution, convolution->currentSpectra, convolution->output[0]);
+
+    if (rebuilt == 1)
+    {
+        MW_AFXUnit_BiquadCascade_convolve(convolution, 1 - convolution->currentSpectra, convolution->output[1]);
+        MW_AFXUnit_BiquadCascade_crossfade(convolution->output[0], convolution->output[1], buffer);
+        convolution->currentSpectra = 1 - convolution->currentSpectra;
+    }
+    else if (convolution->iirWarmup > 0)
+    {
+        arm_biquad_cascade_df2T_f32(&cascade->biquadInstance, buffer, convolution->output[1], P);
+        convolution->iirWarmup--;
+
+        if (convolution->iirWarmup == 0)
+        {
+            MW_AFXUnit_BiquadCascade_crossfade(convolution->output[0], convolution->output[1], buffer);
+            convolution->activeFIR = 0;
+        }
+        else
+            arm_copy_f32(convolution->output[0], buffer, P);
+    }
+    else
+        arm_copy_f32(convolution->output[0], buffer, P);
+}
+
+
+/*
+ *  Let a cascade run as an FIR (uniformly partitioned FFT convolution) when that is cheaper than running its biquads
+ *  The biquads cost numStages passes per sample while the FIR costs the same whatever the number of stages, so the FIR wins
+ *  for long cascades (e.g. 30+ band mastering EQs).  With MW_BIQUADCASCADE_PATH_AUTO, both paths are timed with
+ *  MW_AFXUnit_Utils_getCycleCount() (call MW_AFXUnit_Utils_enableCycleCounter() first) and the cheaper one is kept.  The FIR is
+ *  only used while the response of the cascade decays within its length, otherwise the biquads keep running.
+ *  Call after setting up the stages and before processing.  The biquad state variables are reset
+ *
+ *  The FIR processes whole partitions without adding latency, so it is only used when the host block size is a multiple of
+ *  MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE.  Any other block size keeps the biquads (or fails with MW_BIQUADCASCADE_PATH_FIR)
+ *
+ *  NOTE:   On the FIR path, parameter changes are heard once the FIR has been rebuilt (MW_AFXUNIT_BIQUADCONVOLUTION_NUM_PARTITIONS + 1
+ *          partitions later) and process() must be called with blockSize samples
+ *
+ *  Inputs:
+ *      cascade:        Pointer to an initialized MW_AFXUnit_BiquadCascade instance
+ *      convolution:    Pointer to the MW_AFXUnit_BiquadConvolution instance the cascade uses from now on
+ *      blockSize:      Number of samples the host passes to MW_AFXUnit_BiquadCascade_process()
+ *      path:           MW_BIQUADCASCADE_PATH_AUTO, or a path to force
+ *
+ *  Returns:
+ *      0: if unsuccessful
+ *      1: otherwise
+ */
+int32_t MW_AFXUnit_BiquadCascade_enableConvolution(MW_AFXUnit_BiquadCascade *cascade, MW_AFXUnit_BiquadConvolution *convolution, size_t blockSize,
+                                                   MW_AFXUnit_BiquadCascadePath path)
+{
+    if (cascade == NULL || convolution == NULL || blockSize == 0)
+        return 0;
+
+    if (path < 0 || path >= MW_BIQUADCASCADE_NUM_PATHS)
+        return 0;
+
+    int32_t wholePartitions = (blockSize % MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE == 0);
+    if (path == MW_BIQUADCASCADE_PATH_FIR && !wholePartitions)
+        return 0;
+
+    if (arm_rfft_fast_init_f32(&convolution->fftInstance, MW_AFXUNIT_BIQUADCONVOLUTION_FFT_SIZE) != ARM_MATH_SUCCESS)
+        return 0;
+
+    arm_biquad_cascade_df2T_init_f32(&convolution->buildInstance, cascade->numStages, convolution->buildCoefficients, convolution->buildStateVariables);
+
+    cascade->convolution = convolution;
+    convolution->useFIR = 1;
+    convolution->activeFIR = 1;
+    convolution->currentSpectra = 1;
+    convolution->buildPartition = -1;
+    convolution->rebuildPending = 0;
+    convolution->iirWarmup = 0;
+    convolution->newestPartition = 0;
+    MW_AFXUnit_BiquadCascade_reset(cascade);
+
+    int32_t rebuilt = 0;
+    MW_AFXUnit_BiquadCascade_startRebuild(cascade);
+    while (rebuilt == 0)
+        rebuilt = MW_AFXUnit_BiquadCascade_rebuildStep(convolution);
+    convolution->currentSpectra = 0;
+
+    //  Time both paths on silence (which leaves every state at zero)
+    float32_t *silence = convolution->output[1];
+    uint32_t iirCycles = 0;
+    uint32_t firCycles = 0;
+
+    for (int32_t i = 0; i < MW_AFXUNIT_BIQUADCONVOLUTION_MEASURE_PARTITIONS; ++i)
+    {
+        arm_fill_f32(0.f, silence, MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE);
+        uint32_t start = MW_AFXUnit_Utils_getCycleCount();
+        arm_biquad_cascade_df2T_f32(&cascade->biquadInstance, silence, silence, MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE);
+        iirCycles += MW_AFXUnit_Utils_getCycleCount() - start;
+
+        start = MW_AFXUnit_Utils_getCycleCount();
+        MW_AFXUnit_BiquadCascade_processPartition(cascade, silence);
+        firCycles += MW_AFXUnit_Utils_getCycleCount() - start;
+    }
+
+    convolution->iirCyclesPerSample = (float32_t)iirCycles / (MW_AFXUNIT_BIQUADCONVOLUTION_MEASURE_PARTITIONS * MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE);
+    convolution->firCyclesPerSample = (float32_t)firCycles / (MW_AFXUNIT_BIQUADCONVOLUTION_MEASURE_PARTITIONS * MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE);
+
+    if (path == MW_BIQUADCASCADE_PATH_AUTO)
+        convolution->useFIR = wholePartitions && (firCycles < iirCycles);
+    else
+        convolution->useFIR = (path == MW_BIQUADCASCADE_PATH_FIR);
+
+    convolution->activeFIR = convolution->useFIR && (rebuilt == 1);
+    MW_AFXUnit_BiquadCascade_reset(cascade);
+
+    return 1;
+}
+
+
+
+// ============================================================================================================== //
+
+
+/*
+ *  Initialize an instance of MW_AFXUnit_InterleavedBiquad
+ *
+ *  Inputs:
+ *      biquad:         Pointer to MW_AFXUnit_InterleavedBiquad instance
+ *      numChannels:    Number of interleaved channels (2, 4 or 8)
+ *      filterType:     Filter type
+ *      fs:             Sampling frequency
+ *      fc:             Filter cutoff/centre frequency
+ *      Q:              Filter Q
+ *      gain:           Filter gain (in dB)
+ *
+ *  Returns:
+ *      0: if initialization unsuccessful
+ *      1: otherwise
+ */
+int32_t MW_AFXUnit_InterleavedBiquad_init(MW_AFXUnit_InterleavedBiquad *biquad, int32_t numChannels, MW_AFXUnit_BiquadType filterType, float32_t fs, float32_t fc, float32_t Q, float32_t gain)
+{
+    if (biquad == NULL)
+        return 0;
+
+    if (numChannels != 2 && numChannels != 4 && numChannels != 8)
+        return 0;
+
+    if (fs <= 0)
+        return 0;
+
+    if (fc >= 0.5f * fs)
+        return 0;
+
+    if (Q <= 0.f)
+        return 0;
+
+    if (filterType < 0 || filterType >= MW_BIQUAD_NUM_TYPES)
+        return 0;
+
+    biquad->numChannels = numChannels;
+    biquad->filterType = filterType;
+    biquad->fs = fs;
+
+    MW_AFXUnit_Biquad_calculateCoefficients(filterType, biquad->coefficients, fs, fc, Q, gain);
+
+    arm_biquad_cascade_stereo_df2T_init_f32(&biquad->stereoInstance, 1, biquad->coefficients, biquad->stateVariables);
+    MW_AFXUnit_InterleavedBiquad_reset(biquad);
+
+    return 1;
+}
+
+
+void MW_AFXUnit_InterleavedBiquad_changeParameters(MW_AFXUnit_InterleavedBiquad *biquad, MW_AFXUnit_BiquadType filterType, float32_t fc, float32_t Q, float32_t gain)
+{
+#ifdef NO_OPTIMIZE
+    if (biquad == NULL) while(1);
+    if (filterType >= MW_BIQUAD_NUM_TYPES || filterType < 0) while(1);
+    if (fc >= biquad->fs * 0.5f) while(1);
+#endif
+
+    MW_AFXUnit_Biquad_calculateCoefficients(filterType, biquad->coefficients, biquad->fs, fc, Q, gain);
+    biquad->filterType = filterType;
+}
+
+
+/*
+ *  df2T over numChannels interleaved channels.  Called with a constant numChannels, so once inlined the channel loop becomes
+ *  vector operations on d1 and d2, which stay in locals (registers) for the whole block
+ */
+static inline void MW_AFXUnit_InterleavedBiquad_processChannels(MW_AFXUnit_InterleavedBiquad *biquad, float32_t *buffer, size_t numFrames, const int32_t numChannels)
+{
+    float32_t b0 = biquad->coefficients[0];
+    float32_t b1 = biquad->coefficients[1];
+    float32_t b2 = biquad->coefficients[2];
+    float32_t a1 = biquad->coefficients[3];
+    float32_t a2 = biquad->coefficients[4];
+    float32_t d1[MW_AFXUNIT_INTERLEAVEDBIQUAD_MAX_CHANNELS];
+    float32_t d2[MW_AFXUNIT_INTERLEAVEDBIQUAD_MAX_CHANNELS];
+
+    for (int32_t c = 0; c < numChannels; ++c)
+    {
+        d1[c] = biquad->stateVariables[c];
+        d2[c] = biquad->stateVariables[numChannels + c];
+    }
+
+    for (size_t n = 0; n < numFrames; ++n)
+    {
+        float32_t *frame = &buffer[n * numChannels];
+        for (int32_t c = 0; c < numChannels; ++c)
+        {
+            float32_t x = frame[c];
+            float32_t y = b0 * x + d1[c];
+            d1[c] = b1 * x + a1 * y + d2[c];
+            d2[c] = b2 * x + a2 * y;
+            frame[c] = y;
+        }
+    }
+
+    for (int32_t c = 0; c < numChannels; ++c)
+    {
+        biquad->stateVariables[c] = d1[c];
+        biquad->stateVariables[numChannels + c] = d2[c];
+    }
+}
+
+
+/*
+ *  Filter a block of interleaved frames in place
+ *
+ *  Inputs:
+ *      biquad:         Pointer to MW_AFXUnit_InterleavedBiquad instance
+ *      buffer:         Interleaved audio (numFrames * numChannels samples)
+ *      numFrames:      Number of frames in buffer
+ */
+void MW_AFXUnit_InterleavedBiquad_process(MW_AFXUnit_InterleavedBiquad *biquad, float32_t *buffer, size_t numFrames)
+{
+#ifdef NO_OPTIMIZE
+    if (biquad == NULL) while(1);
+    if (buffer == NULL) while(1);
+#endif
+
+    switch (biquad->numChannels)
+    {
+        case 2:
+            arm_biquad_cascade_stereo_df2T_f32(&biquad->stereoInstance, buffer, buffer, numFrames);
+            break;
+
+        case 4:
+            MW_AFXUnit_InterleavedBiquad_processChannels(biquad, buffer, numFrames, 4);
+            break;
+
+        case 8:
+            MW_AFXUnit_InterleavedBiquad_processChannels(biquad, buffer, numFrames, 8);
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+void MW_AFXUnit_InterleavedBiquad_reset(MW_AFXUnit_InterleavedBiquad *biquad)
+{
+    #ifdef NO_OPTIMIZE
+    if (biquad == NULL) while(1);
+    #endif
+
+    if (biquad == NULL) return;
+
+    arm_fill_f32(0.f, biquad->stateVariables, 2 * MW_AFXUNIT_INTERLEAVEDBIQUAD_MAX_CHANNELS);
 }
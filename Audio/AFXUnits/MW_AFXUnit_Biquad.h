@@ -43,10 +43,75 @@ typedef enum
     MW_BIQUAD_NUM_TYPES
 }MW_AFXUnit_BiquadType;
 
+/*
+ *  Numeric format a MW_AFXUnit_Biquad processes in
+ *  Fixed point filters are designed in float and their coefficients are quantized with a postShift (coefficients are stored
+ *  divided by 2^postShift so that all of them fit in [-1, 1)).  They use the CMSIS direct form I kernels:
+ *      MW_BIQUAD_FORMAT_Q31:           arm_biquad_cascade_df1_fast_q31() (32 bit accumulator, cheapest)
+ *      MW_BIQUAD_FORMAT_Q31_32X64:     arm_biquad_cas_df1_32x64_q31() (64 bit feedback state, for low cutoffs and high Q)
+ *      MW_BIQUAD_FORMAT_Q15:           arm_biquad_cascade_df1_fast_q15()
+ */
+typedef enum
+{
+    MW_BIQUAD_FORMAT_F32 = 0,
+    MW_BIQUAD_FORMAT_Q31,
+    MW_BIQUAD_FORMAT_Q31_32X64,
+    MW_BIQUAD_FORMAT_Q15,
+    MW_BIQUAD_NUM_FORMATS
+}MW_AFXUnit_BiquadFormat;
+
+#define MW_AFXUNIT_BIQUADCACHE_SIZE             32          //  Must be a power of 2
+
+//  Parameter quantization steps used for the cache keys
+#define MW_AFXUNIT_BIQUADCACHE_FC_STEP          0.0625f     //  Hz
+#define MW_AFXUNIT_BIQUADCACHE_Q_STEP           0.001f
+#define MW_AFXUNIT_BIQUADCACHE_GAIN_STEP        0.01f       //  dB
+
+/*
+ *  Least recently used cache of biquad coefficients, keyed on the quantized (filterType, fc, Q, gain)
+ *  Coefficients are always designed from the quantized parameters, so a lookup returns the same result whether it hits or not.
+ *  A cache holds coefficients for a single sampling frequency and can be shared by any number of biquads running at that rate
+ *  Keys cover fc up to 65 kHz, Q up to 262 and gains within +/-209 dB
+ */
+typedef struct
+{
+    uint64_t                                keys[MW_AFXUNIT_BIQUADCACHE_SIZE];
+    uint8_t                                 hints[2 * MW_AFXUNIT_BIQUADCACHE_SIZE];     //  Entry last seen for each key hash
+    float32_t                               coefficients[MW_AFXUNIT_BIQUADCACHE_SIZE][6];
+    uint32_t                                lastUsed[MW_AFXUNIT_BIQUADCACHE_SIZE];
+    uint32_t                                useCounter;
+    int32_t                                 numEntries;
+    float32_t                               fs;
+}MW_AFXUnit_BiquadCache;
+
+//  Coefficients of a modulated biquad are stepped every MW_AFXUNIT_BIQUAD_MODULATION_STEP samples
+#define MW_AFXUNIT_BIQUAD_MODULATION_STEP       16
+
+/*
+ *  Modulation state of a MW_AFXUnit_Biquad (see MW_AFXUnit_Biquad_enableModulation())
+ *  The filter is interpolated as (b0, b1, b2, k1, k2), where k1 and k2 are the reflection coefficients of the feedback part.
+ *  The filter is stable as long as |k1| < 1 and |k2| < 1, which holds all along a linear ramp between two stable filters
+ */
+typedef struct
+{
+    int32_t                                 interval;               //  Control interval K in samples (0 when not modulated)
+    int32_t                                 samplesToControl;       //  Samples until the next control update
+    int32_t                                 stepsLeft;              //  Coefficient steps left in the current ramp
+    int32_t                                 parametersChanged;
+    MW_AFXUnit_BiquadType                   targetType;
+    float32_t                               targetFc;
+    float32_t                               targetQ;
+    float32_t                               targetGain;
+    float32_t                               current[5];
+    float32_t                               increment[5];
+    float32_t                               target[5];
+}MW_AFXUnit_BiquadModulation;
+
 /*
  *  Single biquad instance
- *  A single biquad stage will contain 5 + 1 coefficients (+1 for filter output gain)
- *  and 2 state variables (single sample delay lines)
+ *  A single biquad stage will contain 5 + 1 coefficients (+1 for the wet path gain of tone control filters, which is already
+ *  folded into the first 5) and 2 state variables (single sample delay lines)
+ *  Biquads initialized with a fixed point format also keep the quantized coefficients and the direct form I state of their format
  */ 
 typedef struct
 {
@@ -55,19 +120,149 @@ typedef struct
     int32_t                                 isInitializated;
     float32_t                               coefficients[6];
     float32_t                               stateVariables[2];
-    float32_t                               *copyBuffer;
-    size_t                                  bufferSize;
+    MW_AFXUnit_BiquadModulation             modulation;
+    MW_AFXUnit_BiquadFormat                 format;
+    arm_biquad_casd_df1_inst_q31            instanceQ31;
+    arm_biquad_cas_df1_32x64_ins_q31        instance32x64;
+    arm_biquad_casd_df1_inst_q15            instanceQ15;
+    q31_t                                   coefficientsQ31[5];
+    q15_t                                   coefficientsQ15[6];     //  {b0, 0, b1, b2, a1, a2} as expected by the CMSIS Q15 kernels
+    q31_t                                   stateVariablesQ31[4];
+    q63_t                                   stateVariablesQ63[4];
+    q15_t                                   stateVariablesQ15[4];
     float32_t                               fs;
 }MW_AFXUnit_Biquad;
 
 
 
-int32_t MW_AFXUnit_Biquad_init(MW_AFXUnit_Biquad *biquad, MW_AFXUnit_BiquadType filterType, float32_t fs, float32_t fc, float32_t Q, float32_t gain, float32_t *copyBuffer, size_t copyBufferSize);
+int32_t MW_AFXUnit_Biquad_init(MW_AFXUnit_Biquad *biquad, MW_AFXUnit_BiquadType filterType, float32_t fs, float32_t fc, float32_t Q, float32_t gain);
+int32_t MW_AFXUnit_Biquad_init_format(MW_AFXUnit_Biquad *biquad, MW_AFXUnit_BiquadFormat format, MW_AFXUnit_BiquadType filterType, float32_t fs, float32_t fc, float32_t Q, float32_t gain);
 void    MW_AFXUnit_Biquad_changeParameters(MW_AFXUnit_Biquad *biquad, MW_AFXUnit_BiquadType filterType, float32_t fc, float32_t Q, float32_t gain);
 void    MW_AFXUnit_Biquad_process(MW_AFXUnit_Biquad *biquad, float32_t *buffer, size_t numSamples);
+void    MW_AFXUnit_Biquad_process_q31(MW_AFXUnit_Biquad *biquad, q31_t *buffer, size_t numSamples);
+void    MW_AFXUnit_Biquad_process_q15(MW_AFXUnit_Biquad *biquad, q15_t *buffer, size_t numSamples);
 void    MW_AFXUnit_Biquad_reset(MW_AFXUnit_Biquad *biquad);
 
+int32_t MW_AFXUnit_Biquad_enableModulation(MW_AFXUnit_Biquad *biquad, int32_t controlInterval);
+void    MW_AFXUnit_Biquad_modulateParameters(MW_AFXUnit_Biquad *biquad, MW_AFXUnit_BiquadType filterType, float32_t fc, float32_t Q, float32_t gain);
+
 //  Non-standard extra functions
+#define MW_AFXUNIT_BIQUAD_RESPONSE_BLOCK_SIZE   32
+
+void    MW_AFXUnit_Biquad_response(const float32_t *coefficients, int32_t numStages, float32_t fs, const float32_t *frequencies,
+                                   float32_t *magnitude, float32_t *phase, size_t numFrequencies);
 void    MW_AFXUnit_Biquad_calculateCoefficients(MW_AFXUnit_BiquadType filterType, float32_t *coefficientsOut, float32_t fs, float32_t fc, float32_t Q, float32_t gain);
+void    MW_AFXUnit_Biquad_changeParametersCached(MW_AFXUnit_Biquad *biquad, MW_AFXUnit_BiquadCache *cache, MW_AFXUnit_BiquadType filterType, float32_t fc, float32_t Q, float32_t gain);
+
+int32_t MW_AFXUnit_BiquadCache_init(MW_AFXUnit_BiquadCache *cache, float32_t fs);
+int32_t MW_AFXUnit_BiquadCache_calculateCoefficients(MW_AFXUnit_BiquadCache *cache, MW_AFXUnit_BiquadType filterType, float32_t *coefficientsOut, float32_t fc, float32_t Q, float32_t gain);
+
+
+#define MW_AFXUNIT_BIQUADCASCADE_MAX_STAGES 32
+
+//  FIR path of a cascade (see MW_AFXUnit_BiquadCascade_enableConvolution()).  The FIR is MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE *
+//  MW_AFXUNIT_BIQUADCONVOLUTION_NUM_PARTITIONS taps long (2048 taps, 43 ms at 48 kHz)
+#define MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE     128
+#define MW_AFXUNIT_BIQUADCONVOLUTION_NUM_PARTITIONS     16
+#define MW_AFXUNIT_BIQUADCONVOLUTION_FFT_SIZE           (2 * MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE)
+#define MW_AFXUNIT_BIQUADCONVOLUTION_MAX_TAIL           1e-8f       //  Largest truncated energy (relative to the whole response)
+#define MW_AFXUNIT_BIQUADCONVOLUTION_MEASURE_PARTITIONS 4           //  Partitions timed on each path when picking one
+
+typedef enum
+{
+    MW_BIQUADCASCADE_PATH_AUTO = 0,             //  Time both paths and keep the cheaper one
+    MW_BIQUADCASCADE_PATH_IIR,
+    MW_BIQUADCASCADE_PATH_FIR,
+    MW_BIQUADCASCADE_NUM_PATHS
+}MW_AFXUnit_BiquadCascadePath;
+
+/*
+ *  FIR (uniformly partitioned FFT convolution) path of a MW_AFXUnit_BiquadCascade
+ *  The impulse response of the cascade is sampled into MW_AFXUNIT_BIQUADCONVOLUTION_NUM_PARTITIONS partitions, each kept as the
+ *  spectrum of its zero padded samples.  Every partition of input is transformed once into a frequency domain delay line, and
+ *  the output is the inverse transform of the sum of the delay line times the partition spectra (overlap-save)
+ *  There are two sets of spectra: the one in use and the one being rebuilt after a parameter change.  A rebuild runs one
+ *  partition per processed partition of input, and the output crossfades to the new set when it is done.  Parameter changes
+ *  made during a rebuild do not restart it: another rebuild starts once it is done, so automation is picked up within two rebuilds.
+ *  A response that does not decay within the FIR length is not truncated: the cascade crossfades back to the biquads instead.
+ *  About 55 KB, so it is kept apart from the cascade
+ */
+typedef struct
+{
+    arm_rfft_fast_instance_f32              fftInstance;
+    arm_biquad_cascade_df2T_instance_f32    buildInstance;      //  Runs the cascade coefficients to sample the impulse response
+    int32_t                                 useFIR;             //  Path picked when the convolution was enabled
+    int32_t                                 activeFIR;          //  Path currently producing the output
+    int32_t                                 currentSpectra;
+    int32_t                                 buildPartition;     //  Next partition of the rebuilt FIR (-1 when not rebuilding)
+    int32_t                                 rebuildPending;     //  Parameters changed since the rebuild in progress started
+    int32_t                                 iirWarmup;          //  Partitions left before switching back to the biquads
+    int32_t                                 newestPartition;    //  Delay line slot of the newest input partition
+    float32_t                               responseEnergy;     //  Energy of the impulse response being rebuilt
+    float32_t                               iirCyclesPerSample;
+    float32_t                               firCyclesPerSample;
+    float32_t                               spectra[2][MW_AFXUNIT_BIQUADCONVOLUTION_NUM_PARTITIONS][MW_AFXUNIT_BIQUADCONVOLUTION_FFT_SIZE];
+    float32_t                               inputSpectra[MW_AFXUNIT_BIQUADCONVOLUTION_NUM_PARTITIONS][MW_AFXUNIT_BIQUADCONVOLUTION_FFT_SIZE];
+    float32_t                               inputBuffer[MW_AFXUNIT_BIQUADCONVOLUTION_FFT_SIZE];     //  Previous and current partition
+    float32_t                               buildBuffer[MW_AFXUNIT_BIQUADCONVOLUTION_FFT_SIZE];
+    float32_t                               buildCoefficients[5 * MW_AFXUNIT_BIQUADCASCADE_MAX_STAGES];     //  Coefficients when the rebuild started
+    float32_t                               buildStateVariables[2 * MW_AFXUNIT_BIQUADCASCADE_MAX_STAGES];
+    float32_t                               accumulator[MW_AFXUNIT_BIQUADCONVOLUTION_FFT_SIZE];
+    float32_t                               scratch[MW_AFXUNIT_BIQUADCONVOLUTION_FFT_SIZE];
+    float32_t                               output[2][MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE];
+}MW_AFXUnit_BiquadConvolution;
+
+/*
+ *  Cascade of biquad stages run with a single arm_biquad_cascade_df2T_f32() call
+ *  Each stage has its own filter type and parameters.  Stage i uses coefficients[5 * i] to coefficients[5 * i + 4] and
+ *  stateVariables[2 * i] to stateVariables[2 * i + 1]
+ *  Long cascades can run as an FIR instead (see MW_AFXUnit_BiquadCascade_enableConvolution())
+ */
+typedef struct
+{
+    arm_biquad_cascade_df2T_instance_f32    biquadInstance;
+    int32_t                                 numStages;
+    MW_AFXUnit_BiquadType                   filterTypes[MW_AFXUNIT_BIQUADCASCADE_MAX_STAGES];
+    float32_t                               coefficients[5 * MW_AFXUNIT_BIQUADCASCADE_MAX_STAGES];
+    float32_t                               stateVariables[2 * MW_AFXUNIT_BIQUADCASCADE_MAX_STAGES];
+    MW_AFXUnit_BiquadConvolution            *convolution;       //  NULL when the convolution is not enabled
+    float32_t                               fs;
+}MW_AFXUnit_BiquadCascade;
+
+
+int32_t MW_AFXUnit_BiquadCascade_init(MW_AFXUnit_BiquadCascade *cascade, int32_t numStages, float32_t fs);
+int32_t MW_AFXUnit_BiquadCascade_changeStageParameters(MW_AFXUnit_BiquadCascade *cascade, int32_t stage, MW_AFXUnit_BiquadType filterType, float32_t fc, float32_t Q, float32_t gain);
+int32_t MW_AFXUnit_BiquadCascade_changeStageParametersCached(MW_AFXUnit_BiquadCascade *cascade, MW_AFXUnit_BiquadCache *cache, int32_t stage, MW_AFXUnit_BiquadType filterType,
+                                                             float32_t fc, float32_t Q, float32_t gain);
+void    MW_AFXUnit_BiquadCascade_process(MW_AFXUnit_BiquadCascade *cascade, float32_t *buffer, size_t numSamples);
+void    MW_AFXUnit_BiquadCascade_reset(MW_AFXUnit_BiquadCascade *cascade);
+
+int32_t MW_AFXUnit_BiquadCascade_enableConvolution(MW_AFXUnit_BiquadCascade *cascade, MW_AFXUnit_BiquadConvolution *convolution, size_t blockSize,
+                                                   MW_AFXUnit_BiquadCascadePath path);
+
+
+#define MW_AFXUNIT_INTERLEAVEDBIQUAD_MAX_CHANNELS   8
+
+/*
+ *  Biquad that filters 2, 4 or 8 interleaved channels (e.g. an I2S block) with one set of coefficients
+ *  Channel c of frame n is buffer[n * numChannels + c].  The state variables are stored per channel, as
+ *  stateVariables[2 * numChannels] = {d1 of every channel, d2 of every channel}, so each frame updates all channels
+ *  together.  2 channels use arm_biquad_cascade_stereo_df2T_f32() (which keeps its own state layout)
+ */
+typedef struct
+{
+    arm_biquad_cascade_stereo_df2T_instance_f32 stereoInstance;
+    MW_AFXUnit_BiquadType                   filterType;
+    int32_t                                 numChannels;
+    float32_t                               coefficients[6];
+    float32_t                               stateVariables[2 * MW_AFXUNIT_INTERLEAVEDBIQUAD_MAX_CHANNELS];
+    float32_t                               fs;
+}MW_AFXUnit_InterleavedBiquad;
+
+
+int32_t MW_AFXUnit_InterleavedBiquad_init(MW_AFXUnit_InterleavedBiquad *biquad, int32_t numChannels, MW_AFXUnit_BiquadType filterType, float32_t fs, float32_t fc, float32_t Q, float32_t gain);
+void    MW_AFXUnit_InterleavedBiquad_changeParameters(MW_AFXUnit_InterleavedBiquad *biquad, MW_AFXUnit_BiquadType filterType, float32_t fc, float32_t Q, float32_t gain);
+void    MW_AFXUnit_InterleavedBiquad_process(MW_AFXUnit_InterleavedBiquad *biquad, float32_t *buffer, size_t numFrames);
+void    MW_AFXUnit_InterleavedBiquad_reset(MW_AFXUnit_InterleavedBiquad *biquad);
 
 #endif /* MW_AFXUNIT_BIQUAD_H_ */
@@ -0,0 +1,264 @@
+//  Copyright 2021 Allen Lee
+//
+//  Author:  Allen Lee (alee@meoworkshop.org)
+//  
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//  For more information, please refer to https://opensource.org/licenses/mit-license.php
+//
+//  ------------------------------------------------------------------------------------------------  //
+
+
+
+#include "MW_AFXUnit_Crossover.h"
+
+
+/*
+ *  Design the lowpass and the allpass of a split at fc
+ *  LR2: lowpass = Butterworth1^2 (biquad with Q = 0.5), allpass = (c + z^-1) / (1 + c z^-1), c = (K - 1) / (K + 1), K = tan(pi fc / fs)
+ *  LR4: lowpass = Butterworth2^2 (two biquads with Q = 1/sqrt(2)), allpass = the Butterworth denominator reversed over itself
+ *  Both filters come from the same bilinear transform (prewarped at fc), so lowpass + highpass = allpass holds exactly
+ */
+static void MW_AFXUnit_Crossover_designSplit(MW_AFXUnit_CrossoverSplit *split, MW_AFXUnit_CrossoverType type, float32_t fs, float32_t fc)
+{
+    float32_t coefficients[6];
+
+    if (type == MW_CROSSOVER_LR2)
+    {
+        MW_AFXUnit_Biquad_calculateCoefficients(MW_BIQUAD_LPF, coefficients, fs, fc, 0.5f, 0.f);
+        arm_copy_f32(coefficients, split->lowpassCoefficients, 5);
+
+        float32_t theta = PI * fc / fs;
+        float32_t K = arm_sin_f32(theta) / arm_cos_f32(theta);
+        float32_t c = (K - 1.f) / (K + 1.f);
+
+        split->allpassCoefficients[0] = c;
+        split->allpassCoefficients[1] = 1.f;
+        split->allpassCoefficients[2] = 0.f;
+        split->allpassCoefficients[3] = -c;
+        split->allpassCoefficients[4] = 0.f;
+    }
+    else
+    {
+        MW_AFXUnit_Biquad_calculateCoefficients(MW_BIQUAD_LPF, coefficients, fs, fc, 0.70710678f, 0.f);
+        arm_copy_f32(coefficients, split->lowpassCoefficients, 5);
+        arm_copy_f32(coefficients, &split->lowpassCoefficients[5], 5);
+
+        split->allpassCoefficients[0] = -coefficients[4];
+        split->allpassCoefficients[1] = -coefficients[3];
+        split->allpassCoefficients[2] = 1.f;
+        split->allpassCoefficients[3] = coefficients[3];
+        split->allpassCoefficients[4] = coefficients[4];
+    }
+}
+
+
+/*
+ *  Split input into low and high (numSamples <= MW_AFXUNIT_CROSSOVER_BLOCK_SIZE)
+ *  The allpass runs first, so input and low may be the same buffer
+ */
+static inline void MW_AFXUnit_Crossover_split(MW_AFXUnit_CrossoverSplit *split, const float32_t *input, float32_t *low, float32_t *high, size_t numSamples)
+{
+    arm_biquad_cascade_df2T_f32(&split->allpassInstance, (float32_t *)input, high, numSamples);
+    arm_biquad_cascade_df2T_f32(&split->lowpassInstance, (float32_t *)input, low, numSamples);
+    arm_sub_f32(high, low, high, numSamples);
+}
+
+
+
+// ============================================================================================================== //
+
+
+/*
+ *  Initialize an instance of MW_AFXUnit_Crossover
+ *
+ *  Inputs:
+ *      crossover:              Pointer to MW_AFXUnit_Crossover instance
+ *      type:                   Linkwitz-Riley order (MW_CROSSOVER_LR2 or MW_CROSSOVER_LR4)
+ *      numBands:               Number of bands (2 to MW_AFXUNIT_CROSSOVER_MAX_BANDS)
+ *      crossoverFrequencies:   numBands - 1 crossover frequencies, in ascending order
+ *      fs:                     Sampling frequency
+ *
+ *  Returns:
+ *      0: if initialization unsuccessful
+ *      1: otherwise
+ */
+int32_t MW_AFXUnit_Crossover_init(MW_AFXUnit_Crossover *crossover, MW_AFXUnit_CrossoverType type, int32_t numBands,
+                                  const float32_t *crossoverFrequencies, float32_t fs)
+{
+    if (crossover == NULL || crossoverFrequencies == NULL)
+        return 0;
+
+    if (type < 0 || type >= MW_CROSSOVER_NUM_TYPES)
+        return 0;
+
+    if (numBands < 2 || numBands > MW_AFXUNIT_CROSSOVER_MAX_BANDS)
+        return 0;
+
+    if (fs <= 0)
+        return 0;
+
+    for (int32_t i = 0; i < numBands - 1; ++i)
+    {
+        if (crossoverFrequencies[i] <= 0.f || crossoverFrequencies[i] >= 0.5f * fs)
+            return 0;
+
+        if (i > 0 && crossoverFrequencies[i] <= crossoverFrequencies[i - 1])
+            return 0;
+    }
+
+    crossover->type = type;
+    crossover->numBands = numBands;
+    crossover->fs = fs;
+
+    for (int32_t i = 0; i < numBands - 1; ++i)
+    {
+        MW_AFXUnit_CrossoverSplit *split = &crossover->splits[i];
+
+        crossover->crossoverFrequencies[i] = crossoverFrequencies[i];
+        MW_AFXUnit_Crossover_designSplit(split, type, fs, crossoverFrequencies[i]);
+
+        arm_biquad_cascade_df2T_init_f32(&split->lowpassInstance, type == MW_CROSSOVER_LR2 ? 1 : 2, split->lowpassCoefficients, split->lowpassStateVariables);
+        arm_biquad_cascade_df2T_init_f32(&split->allpassInstance, 1, split->allpassCoefficients, split->allpassStateVariables);
+    }
+
+    //  The compensating allpasses share the coefficients of the splits they compensate for
+    if (numBands == 4)
+        arm_biquad_cascade_df2T_init_f32(&crossover->lowCompensationInstance, 1, crossover->splits[2].allpassCoefficients, crossover->lowCompensationStateVariables);
+
+    if (numBands >= 3)
+        arm_biquad_cascade_df2T_init_f32(&crossover->highCompensationInstance, 1, crossover->splits[0].allpassCoefficients, crossover->highCompensationStateVariables);
+
+    MW_AFXUnit_Crossover_reset(crossover);
+
+    return 1;
+}
+
+
+/*
+ *  Move one crossover frequency.  The state variables are kept
+ *  NOTE:   Like MW_AFXUnit_Biquad_changeParameters(), changes are not smoothed
+ *
+ *  Inputs:
+ *      index:      Crossover to move (0 to numBands - 2)
+ *      fc:         New crossover frequency.  Must stay between its neighbouring crossover frequencies
+ *
+ *  Returns:
+ *      0: if the index or frequency is invalid (the crossover is left unchanged)
+ *      1: otherwise
+ */
+int32_t MW_AFXUnit_Crossover_changeFrequency(MW_AFXUnit_Crossover *crossover, int32_t index, float32_t fc)
+{
+    if (crossover == NULL)
+        return 0;
+
+    if (index < 0 || index >= crossover->numBands - 1)
+        return 0;
+
+    if (fc <= 0.f || fc >= 0.5f * crossover->fs)
+        return 0;
+
+    if (index > 0 && fc <= crossover->crossoverFrequencies[index - 1])
+        return 0;
+
+    if (index < crossover->numBands - 2 && fc >= crossover->crossoverFrequencies[index + 1])
+        return 0;
+
+    crossover->crossoverFrequencies[index] = fc;
+    MW_AFXUnit_Crossover_designSplit(&crossover->splits[index], crossover->type, crossover->fs, fc);
+
+    return 1;
+}
+
+
+/*
+ *  Split a block of samples into all bands
+ *  Each block of MW_AFXUNIT_CROSSOVER_BLOCK_SIZE samples goes through the whole tree before the next one, so every filter state
+ *  is updated once per sample and the intermediate signals stay in two small scratch buffers
+ *
+ *  Inputs:
+ *      crossover:      Pointer to MW_AFXUnit_Crossover instance
+ *      input:          Input samples.  May be the same buffer as bands[0]
+ *      bands:          numBands output buffers of numSamples samples each, from the lowest to the highest band
+ *      numSamples:     Number of samples to process
+ */
+void MW_AFXUnit_Crossover_process(MW_AFXUnit_Crossover *crossover, const float32_t *input, float32_t **bands, size_t numSamples)
+{
+#ifdef NO_OPTIMIZE
+    if (crossover == NULL) while(1);
+    if (input == NULL) while(1);
+    if (bands == NULL) while(1);
+#endif
+
+    float32_t low[MW_AFXUNIT_CROSSOVER_BLOCK_SIZE];
+    float32_t high[MW_AFXUNIT_CROSSOVER_BLOCK_SIZE];
+    size_t offset = 0;
+
+    while (offset < numSamples)
+    {
+        size_t blockSize = numSamples - offset;
+        if (blockSize > MW_AFXUNIT_CROSSOVER_BLOCK_SIZE)
+            blockSize = MW_AFXUNIT_CROSSOVER_BLOCK_SIZE;
+
+        switch (crossover->numBands)
+        {
+            case 2:
+                MW_AFXUnit_Crossover_split(&crossover->splits[0], &input[offset], &bands[0][offset], &bands[1][offset], blockSize);
+                break;
+
+            case 3:
+                MW_AFXUnit_Crossover_split(&crossover->splits[1], &input[offset], low, high, blockSize);
+                MW_AFXUnit_Crossover_split(&crossover->splits[0], low, &bands[0][offset], &bands[1][offset], blockSize);
+                arm_biquad_cascade_df2T_f32(&crossover->highCompensationInstance, high, &bands[2][offset], blockSize);
+                break;
+
+            case 4:
+                MW_AFXUnit_Crossover_split(&crossover->splits[1], &input[offset], low, high, blockSize);
+                arm_biquad_cascade_df2T_f32(&crossover->lowCompensationInstance, low, low, blockSize);
+                arm_biquad_cascade_df2T_f32(&crossover->highCompensationInstance, high, high, blockSize);
+                MW_AFXUnit_Crossover_split(&crossover->splits[0], low, &bands[0][offset], &bands[1][offset], blockSize);
+                MW_AFXUnit_Crossover_split(&crossover->splits[2], high, &bands[2][offset], &bands[3][offset], blockSize);
+                break;
+
+            default:
+                return;
+        }
+
+        offset += blockSize;
+    }
+}
+
+
+void MW_AFXUnit_Crossover_reset(MW_AFXUnit_Crossover *crossover)
+{
+#ifdef NO_OPTIMIZE
+    if (crossover == NULL) while(1);
+#endif
+
+    if (crossover == NULL) return;
+
+    for (int32_t i = 0; i < MW_AFXUNIT_CROSSOVER_MAX_BANDS - 1; ++i)
+    {
+        arm_fill_f32(0.f, crossover->splits[i].lowpassStateVariables, 4);
+        arm_fill_f32(0.f, crossover->splits[i].allpassStateVariables, 2);
+    }
+
+    arm_fill_f32(0.f, crossover->lowCompensationStateVariables, 2);
+    arm_fill_f32(0.f, crossover->highCompensationStateVariables, 2);
+}
@@ -0,0 +1,97 @@
+//  Copyright 2021 Allen Lee
+//
+//  Author:  Allen Lee (alee@meoworkshop.org)
+//  
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//  For more information, please refer to https://opensource.org/licenses/mit-license.php
+//
+//  ------------------------------------------------------------------------------------------------  //
+
+
+#ifndef MW_AFXUNIT_CROSSOVER_H_
+#define MW_AFXUNIT_CROSSOVER_H_
+
+#include "arm_math.h"
+#include "MW_AFXUnit_Biquad.h"
+
+#define MW_AFXUNIT_CROSSOVER_MAX_BANDS      4
+#define MW_AFXUNIT_CROSSOVER_BLOCK_SIZE     32      //  Samples processed through the whole tree at a time
+
+/*
+ *  Linkwitz-Riley crossover orders
+ *      MW_CROSSOVER_LR2:   12 dB/oct.  The high band of every split is polarity inverted, so that the bands sum to an allpass
+ *      MW_CROSSOVER_LR4:   24 dB/oct
+ */
+typedef enum
+{
+    MW_CROSSOVER_LR2 = 0,
+    MW_CROSSOVER_LR4,
+    MW_CROSSOVER_NUM_TYPES
+}MW_AFXUnit_CrossoverType;
+
+/*
+ *  A single 2 way split at one crossover frequency
+ *  The low band is the Linkwitz-Riley lowpass (LR2: one biquad with Q = 0.5, LR4: two Butterworth biquads).  The low and high
+ *  bands of a Linkwitz-Riley split sum to an allpass that shares the lowpass poles, so the high band is computed as
+ *  allpass - lowpass instead of being filtered separately (LR4: 3 biquads per split instead of 4)
+ */
+typedef struct
+{
+    arm_biquad_cascade_df2T_instance_f32    lowpassInstance;
+    arm_biquad_cascade_df2T_instance_f32    allpassInstance;
+    float32_t                               lowpassCoefficients[10];
+    float32_t                               allpassCoefficients[5];
+    float32_t                               lowpassStateVariables[4];
+    float32_t                               allpassStateVariables[2];
+}MW_AFXUnit_CrossoverSplit;
+
+/*
+ *  Linkwitz-Riley crossover that splits a signal into 2, 3 or 4 bands
+ *  The splits form a tree that shares state between the bands: the input is split at the middle crossover frequency and each
+ *  half is split again.  Every band is delayed by the allpasses of the splits it does not go through, so the bands always sum
+ *  to an allpass.  The compensating allpass is applied once per subtree (before its split) and uses the coefficients of the
+ *  split it compensates for:
+ *      2 bands:    split[0]
+ *      3 bands:    split[1] -> low:  split[0]
+ *                           -> high: allpass(fc[0])
+ *      4 bands:    split[1] -> low:  allpass(fc[2]) -> split[0]
+ *                           -> high: allpass(fc[0]) -> split[2]
+ */
+typedef struct
+{
+    MW_AFXUnit_CrossoverType                type;
+    int32_t                                 numBands;
+    float32_t                               crossoverFrequencies[MW_AFXUNIT_CROSSOVER_MAX_BANDS - 1];
+    MW_AFXUnit_CrossoverSplit               splits[MW_AFXUNIT_CROSSOVER_MAX_BANDS - 1];
+    arm_biquad_cascade_df2T_instance_f32    lowCompensationInstance;
+    arm_biquad_cascade_df2T_instance_f32    highCompensationInstance;
+    float32_t                               lowCompensationStateVariables[2];
+    float32_t                               highCompensationStateVariables[2];
+    float32_t                               fs;
+}MW_AFXUnit_Crossover;
+
+
+int32_t MW_AFXUnit_Crossover_init(MW_AFXUnit_Crossover *crossover, MW_AFXUnit_CrossoverType type, int32_t numBands,
+                                  const float32_t *crossoverFrequencies, float32_t fs);
+int32_t MW_AFXUnit_Crossover_changeFrequency(MW_AFXUnit_Crossover *crossover, int32_t index, float32_t fc);
+void    MW_AFXUnit_Crossover_process(MW_AFXUnit_Crossover *crossover, const float32_t *input, float32_t **bands, size_t numSamples);
+void    MW_AFXUnit_Crossover_reset(MW_AFXUnit_Crossover *crossover);
+
+#endif /* MW_AFXUNIT_CROSSOVER_H_ */
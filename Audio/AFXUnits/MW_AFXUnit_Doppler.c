@@ -32,6 +32,34 @@
 #define TRANSITION_EXIT_DELTA 0.005f
 
 
+/*
+ *  Common initialization for MW_AFXUnit_Doppler_init() and MW_AFXUnit_Doppler_init_guarded()
+ *  delayLineBuffer must hold delayLineBufferSize + guardSize samples
+ */
+static int32_t MW_AFXUnit_Doppler_initRingBuffer(MW_AFXUnit_Doppler *dopplerUnit, float32_t *delayLineBuffer, int32_t delayLineBufferSize, float32_t fs,
+                                                 int32_t guardSize)
+{
+  if (dopplerUnit == NULL || delayLineBuffer == NULL || delayLineBufferSize <= 0)
+    return 0;
+
+  if (!MW_DSP_RingBuffer_init(&dopplerUnit->ringBuffer, delayLineBuffer, delayLineBufferSize, guardSize))
+    return 0;
+
+  dopplerUnit->buffer = delayLineBuffer;
+  dopplerUnit->N = delayLineBufferSize;
+  dopplerUnit->writePtr = 1;
+  dopplerUnit->readPtr = 0;
+  dopplerUnit->g = 0.f;
+  dopplerUnit->inTransition = 0;
+  dopplerUnit->readWritePtrCross = 0;
+  dopplerUnit->prevOutput = 0;
+  dopplerUnit->transitionPhaseIncrement = 6.283185 * TRANSITION_SIGNAL_FREQ / fs;
+  dopplerUnit->transitionSignalPhase = 0;
+
+  return 1;
+}
+
+
 /*
  *  Initialize a MW_AFXUnit_Doppler structure
  *  Doppler initialization routine WILL NOT allocate memory for the internal delay line for you
@@ -49,22 +77,56 @@
  */
 int32_t MW_AFXUnit_Doppler_init(MW_AFXUnit_Doppler *dopplerUnit, float32_t *delayLineBuffer, int32_t delayLineBufferSize, float32_t fs)
 {
+  return MW_AFXUnit_Doppler_initRingBuffer(dopplerUnit, delayLineBuffer, delayLineBufferSize, fs, 0);
+}
 
-  if (dopplerUnit == NULL || delayLineBuffer == NULL || delayLineBufferSize <= 0)
+
+/*
+ *  Initialize a MW_AFXUnit_Doppler structure whose delay line has a guard zone (see MW_DSP_RingBuffer)
+ *  delayLineBuffer must hold MW_DSP_RINGBUFFER_MEMORY_SIZE(delayLineBufferSize, MW_AFXUNIT_DOPPLER_GUARD_SIZE) samples.
+ *  The second interpolation tap is then always the next sample in memory so it never has to be wrapped
+ *
+ *  Inputs:
+ *    dopplerUnit:          Pointer to a MW_AFXUnit_Doppler structure
+ *    delayLineBuffer:      Pointer to delayLineBufferSize + MW_AFXUNIT_DOPPLER_GUARD_SIZE samples of memory
+ *    delayLineBufferSize:  Delay line length (not including the guard zone)
+ *    fs:                   Sampling Frequency
+ * 
+ *  Returns:
+ *    0 if unsuccessful, 1 otherwise    
+ */
+int32_t MW_AFXUnit_Doppler_init_guarded(MW_AFXUnit_Doppler *dopplerUnit, float32_t *delayLineBuffer, int32_t delayLineBufferSize, float32_t fs)
+{
+  return MW_AFXUnit_Doppler_initRingBuffer(dopplerUnit, delayLineBuffer, delayLineBufferSize, fs, MW_AFXUNIT_DOPPLER_GUARD_SIZE);
+}
+
+
+/*
+ *  Same as MW_AFXUnit_Doppler_init_guarded() except that the delay line (including the guard zone) is allocated from arena
+ *  (see MW_DSP_Arena).  Nothing is allocated if initialization fails
+ *
+ *  Inputs:
+ *    dopplerUnit:          Pointer to a MW_AFXUnit_Doppler structure
+ *    arena:                Arena to allocate delayLineBufferSize + MW_AFXUNIT_DOPPLER_GUARD_SIZE samples from
+ *    delayLineBufferSize:  Delay line length (not including the guard zone)
+ *    fs:                   Sampling Frequency
+ * 
+ *  Returns:
+ *    0 if unsuccessful, 1 otherwise    
+ */
+int32_t MW_AFXUnit_Doppler_init_arena(MW_AFXUnit_Doppler *dopplerUnit, MW_DSP_Arena *arena, int32_t delayLineBufferSize, float32_t fs)
+{
+  if (arena == NULL || delayLineBufferSize <= 0)
     return 0;
 
-  arm_fill_f32(0.f, delayLineBuffer, delayLineBufferSize);
+  size_t marker = MW_DSP_Arena_mark(arena);
+  float32_t *delayLineBuffer = MW_DSP_Arena_allocFloat(arena, MW_DSP_RINGBUFFER_MEMORY_SIZE(delayLineBufferSize, MW_AFXUNIT_DOPPLER_GUARD_SIZE));
 
-  dopplerUnit->buffer = delayLineBuffer;
-  dopplerUnit->N = delayLineBufferSize;
-  dopplerUnit->writePtr = 1;
-  dopplerUnit->readPtr = 0;
-  dopplerUnit->g = 0.f;
-  dopplerUnit->inTransition = 0;
-  dopplerUnit->readWritePtrCross = 0;
-  dopplerUnit->prevOutput = 0;
-  dopplerUnit->transitionPhaseIncrement = 6.283185 * TRANSITION_SIGNAL_FREQ / fs;
-  dopplerUnit->transitionSignalPhase = 0;
+  if (!MW_AFXUnit_Doppler_init_guarded(dopplerUnit, delayLineBuffer, delayLineBufferSize, fs))
+  {
+    MW_DSP_Arena_release(arena, marker);
+    return 0;
+  }
 
   return 1;
 }
@@ -89,39 +151,17 @@ void MW_AFXUnit_Doppler_changeParameters(MW_AFXUnit_Doppler *dopplerUnit, float3
 }
 
 
-/*
- *  Apply doppler effect to a buffer of audio samples
- *  Linear interpolation is used to calculate the fractional delay sample
- *
- *  Inputs:
- *    dopplerUnit:  Pointer to MW_AFXUnit_Doppler structure (must be previously initialized)
- *    buffer:       Pointer to buffer holding audio samples.  Processed audio will be stored in the same buffer
- *    bufferSize:   Number of audio samples
- *
- *  Returns:
- *    None
- */
-void MW_AFXUnit_Doppler_process(MW_AFXUnit_Doppler *dopplerUnit, float32_t *buffer, size_t bufferSize)
+//  Sample loop of MW_AFXUnit_Doppler_process().  With a guard zone the second tap is always read from the next sample in
+//  memory (guarded is a constant at each call site so the compiler can specialize the loop and drop the wrap)
+static inline void MW_AFXUnit_Doppler_processSamples(MW_AFXUnit_Doppler *dopplerUnit, float32_t *buffer, size_t bufferSize, const int32_t guarded)
 {
-  #ifdef NO_OPTIMIZE
-  if (dopplerUnit == NULL || dopplerUnit->buffer == NULL) while(1);
-  #endif
-
-  if (dopplerUnit == NULL || dopplerUnit->buffer == NULL) return;
-
-  if (dopplerUnit->g == 1.f)
-  {
-    arm_fill_f32(0.f, buffer, bufferSize);
-    return;
-  }
-
   for (size_t i = 0; i < bufferSize; ++i)
   {
     //  Calculate interpolated sample from fractional delay
     int32_t index1 = (int32_t)dopplerUnit->readPtr;
     int32_t index2 = index1 + 1;
 
-    if (index2 >= dopplerUnit->N)
+    if (!guarded && index2 >= dopplerUnit->N)
       index2 = 0;
 
     //  Determine if the read/write pointer overlap each other
@@ -159,7 +199,7 @@ void MW_AFXUnit_Doppler_process(MW_AFXUnit_Doppler *dopplerUnit, float32_t *buff
 
     dopplerUnit->readPtr += (1.f - dopplerUnit->g);
 
-    dopplerUnit->buffer[dopplerUnit->writePtr++] = buffer[i];
+    MW_DSP_RingBuffer_write(&dopplerUnit->ringBuffer, dopplerUnit->writePtr++, buffer[i]);
 
     //  read/writePtr bounds check
     //  ------------------------------------------------- //
@@ -198,6 +238,39 @@ void MW_AFXUnit_Doppler_process(MW_AFXUnit_Doppler *dopplerUnit, float32_t *buff
 }
 
 
+/*
+ *  Apply doppler effect to a buffer of audio samples
+ *  Linear interpolation is used to calculate the fractional delay sample
+ *
+ *  Inputs:
+ *    dopplerUnit:  Pointer to MW_AFXUnit_Doppler structure (must be previously initialized)
+ *    buffer:       Pointer to buffer holding audio samples.  Processed audio will be stored in the same buffer
+ *    bufferSize:   Number of audio samples
+ *
+ *  Returns:
+ *    None
+ */
+void MW_AFXUnit_Doppler_process(MW_AFXUnit_Doppler *dopplerUnit, float32_t *buffer, size_t bufferSize)
+{
+  #ifdef NO_OPTIMIZE
+  if (dopplerUnit == NULL || dopplerUnit->buffer == NULL) while(1);
+  #endif
+
+  if (dopplerUnit == NULL || dopplerUnit->buffer == NULL) return;
+
+  if (dopplerUnit->g == 1.f)
+  {
+    arm_fill_f32(0.f, buffer, bufferSize);
+    return;
+  }
+
+  if (dopplerUnit->ringBuffer.guardSize > 0)
+    MW_AFXUnit_Doppler_processSamples(dopplerUnit, buffer, bufferSize, 1);
+  else
+    MW_AFXUnit_Doppler_processSamples(dopplerUnit, buffer, bufferSize, 0);
+}
+
+
 void MW_AFXUnit_Doppler_reset(MW_AFXUnit_Doppler *dopplerUnit)
 {
   #ifdef NO_OPTIMIZE
@@ -208,7 +281,7 @@ void MW_AFXUnit_Doppler_reset(MW_AFXUnit_Doppler *dopplerUnit)
   if (dopplerUnit == NULL) return;
   if (dopplerUnit->buffer == NULL) return;
 
-  arm_fill_f32(0, dopplerUnit->buffer, dopplerUnit->N);
+  MW_DSP_RingBuffer_reset(&dopplerUnit->ringBuffer);
 
   dopplerUnit->g = 0;
   dopplerUnit->readPtr = 0;
@@ -29,7 +29,11 @@
 
 #include "arm_math.h"
 #include "MW_AFXUnit_MiscUtils.h"
+#include "MW_DSP_RingBuffer.h"
+#include "MW_DSP_Arena.h"
 
+//  Guard zone used by MW_AFXUnit_Doppler_init_guarded() (linear interpolation reads one sample past the read pointer)
+#define MW_AFXUNIT_DOPPLER_GUARD_SIZE 1
 
 typedef struct
 {
@@ -49,10 +53,14 @@ typedef struct
   float32_t transitionSignalPhase;
   float32_t transitionPhaseIncrement;
 
+  MW_DSP_RingBuffer ringBuffer;       //  Same memory as buffer and N
+
 }MW_AFXUnit_Doppler;
 
 
 int32_t   MW_AFXUnit_Doppler_init(MW_AFXUnit_Doppler *dopplerUnit, float32_t *delayLineBuffer, int32_t delayLineBufferSize, float32_t fs);
+int32_t   MW_AFXUnit_Doppler_init_guarded(MW_AFXUnit_Doppler *dopplerUnit, float32_t *delayLineBuffer, int32_t delayLineBufferSize, float32_t fs);
+int32_t   MW_AFXUnit_Doppler_init_arena(MW_AFXUnit_Doppler *dopplerUnit, MW_DSP_Arena *arena, int32_t delayLineBufferSize, float32_t fs);
 void      MW_AFXUnit_Doppler_changeParameters(MW_AFXUnit_Doppler *dopplerUnit, float32_t g);
 void      MW_AFXUnit_Doppler_process(MW_AFXUnit_Doppler *dopplerUnit, float32_t *buffer, size_t bufferSize);
 void      MW_AFXUnit_Doppler_reset(MW_AFXUnit_Doppler *dopplerUnit);
@@ -48,7 +48,7 @@
  *      0 if initialization unsuccessful
  *      1 otherwise
  */
-int32_t MW_AFXUnit_Flutter_init(MW_AFXUnit_Flutter *flutter, float32_t *buffer, float32_t fs, float32_t M, int16_t N, float32_t lfoDepth, float32_t lfoFrequency, float32_t b0)
+int32_t MW_AFXUnit_Flutter_init(MW_AFXUnit_Flutter *flutter, float32_t *buffer, float32_t fs, float32_t M, int32_t N, float32_t lfoDepth, float32_t lfoFrequency, float32_t b0)
 {
     if (flutter == NULL || buffer == NULL)
         return 0;
@@ -74,6 +74,29 @@ int32_t MW_AFXUnit_Flutter_init(MW_AFXUnit_Flutter *flutter, float32_t *buffer,
     flutter->b0 = b0;
     flutter->lfoPhaseIncrement = 2.f * PI / flutter->lfoSamplesPerCycle;
     flutter->M = M;
+    flutter->delayLength = M;
+
+    return 1;
+}
+
+
+/*
+ *  Same as MW_AFXUnit_Flutter_init() except that the N sample delay line buffer is allocated from arena (see MW_DSP_Arena)
+ *  Nothing is allocated if initialization fails
+ */
+int32_t MW_AFXUnit_Flutter_init_arena(MW_AFXUnit_Flutter *flutter, MW_DSP_Arena *arena, float32_t fs, float32_t M, int32_t N, float32_t lfoDepth, float32_t lfoFrequency, float32_t b0)
+{
+    if (arena == NULL || N <= 0)
+        return 0;
+
+    size_t marker = MW_DSP_Arena_mark(arena);
+    float32_t *buffer = MW_DSP_Arena_allocFloat(arena, N);
+
+    if (!MW_AFXUnit_Flutter_init(flutter, buffer, fs, M, N, lfoDepth, lfoFrequency, b0))
+    {
+        MW_DSP_Arena_release(arena, marker);
+        return 0;
+    }
 
     return 1;
 }
@@ -98,9 +121,9 @@ void MW_AFXUnit_Flutter_changeParameters(MW_AFXUnit_Flutter *flutter, float32_t
 {
 #ifdef NO_OPTIMIZE
     assert(flutter != NULL);
-    assert(lfoDepth + flutter->delay.M < flutter->delay.delay.N);
+    assert(lfoDepth + flutter->M < flutter->delay.N);
     assert(lfoFrequency >= MW_AFXUNIT_FLUTTER_MIN_LFO_FREQ);
-    assert(lfoFrequency <= (flutter->fs / 2.f))
+    assert(lfoFrequency <= (flutter->fs / 2.f));
 #endif
 
     flutter->lfoDepth = lfoDepth;
@@ -108,6 +131,7 @@ void MW_AFXUnit_Flutter_changeParameters(MW_AFXUnit_Flutter *flutter, float32_t
     flutter->b0 = b0;
 
     flutter->lfoSamplesPerCycle = (int32_t)(flutter->fs / lfoFrequency);
+    flutter->lfoPhaseIncrement = 2.f * PI / flutter->lfoSamplesPerCycle;
     flutter->lfoPhaseCounter = 0;
 }
 
@@ -130,13 +154,26 @@ void MW_AFXUnit_Flutter_process(MW_AFXUnit_Flutter *flutter, float32_t *buffer,
     assert(buffer != NULL);
 #endif
 
-    for (int32_t i = 0; i < bufferSize; ++i)
-    {
-        buffer[i] = MW_DSP_FractionalDelayLine_tick(&flutter->delay, buffer[i]) * flutter->b0;
-        //  TODO:  Use more optimized version of sin
-        MW_DSP_FractionalDelayLine_setDelayLength(&flutter->delay, flutter->M + (flutter->lfoDepth * arm_sin_f32(flutter->lfoPhaseCounter)));
+    float32_t delayTimes[MW_AFXUNIT_FLUTTER_BLOCK_SIZE];
 
-        flutter->lfoPhaseCounter += flutter->lfoPhaseIncrement;
+    while (bufferSize > 0)
+    {
+        size_t blockSize = bufferSize < MW_AFXUNIT_FLUTTER_BLOCK_SIZE ? bufferSize : MW_AFXUNIT_FLUTTER_BLOCK_SIZE;
+
+        //  Each sample uses the delay length computed after the previous one
+        for (size_t i = 0; i < blockSize; ++i)
+        {
+            delayTimes[i] = flutter->delayLength;
+            //  TODO:  Use more optimized version of sin
+            flutter->delayLength = flutter->M + (flutter->lfoDepth * arm_sin_f32(flutter->lfoPhaseCounter));
+            flutter->lfoPhaseCounter += flutter->lfoPhaseIncrement;
+        }
+
+        MW_DSP_FractionalDelayLine_processModulated(&flutter->delay, buffer, delayTimes, blockSize);
+        arm_scale_f32(buffer, flutter->b0, buffer, blockSize);
+
+        buffer += blockSize;
+        bufferSize -= blockSize;
     }
 
     if (flutter->lfoPhaseCounter > 2.f * PI)
@@ -153,5 +190,6 @@ void MW_AFXUnit_Flutter_reset(MW_AFXUnit_Flutter *flutter)
     if (flutter == NULL) return;
 
     flutter->lfoPhaseCounter = 0;
+    flutter->delayLength = flutter->M;
     MW_DSP_FractionalDelayLine_reset(&flutter->delay);
 }
@@ -29,27 +29,33 @@
 
 #include "arm_math.h"
 #include "MW_DSP_DelayLine.h"
+#include "MW_DSP_Arena.h"
 
 //  Theoretically, the min LFO frequency is about 4.6E-10 Hz (frequency with the number of samples that is within the int32_t range)
 //  But we will cap the frequency to 0.001.  That should be enough right?
 #define MW_AFXUNIT_FLUTTER_MIN_LFO_FREQ 0.001f
 
+//  The LFO is computed this many samples at a time before being handed to the delay line
+#define MW_AFXUNIT_FLUTTER_BLOCK_SIZE 32
+
 typedef struct
 {
     MW_DSP_FractionalDelayLine  delay;
     float32_t                   lfoDepth;
     float32_t                   lfoFrequency;
     float32_t                   lfoPhase;       //  Maybe remove?
-    int16_t                     lfoSamplesPerCycle;
+    int32_t                     lfoSamplesPerCycle;
     float32_t                   lfoPhaseCounter;
     float32_t                   lfoPhaseIncrement;
     float32_t                   fs;
     float32_t                   b0;
     float32_t                   M;
+    float32_t                   delayLength;    //  Delay length applied to the next sample
 }MW_AFXUnit_Flutter;
 
 
-int32_t     MW_AFXUnit_Flutter_init(MW_AFXUnit_Flutter *flutter, float32_t *buffer, float32_t fs, float32_t M, int16_t N, float32_t lfoDepth, float32_t lfoFrequency, float32_t b0);
+int32_t     MW_AFXUnit_Flutter_init(MW_AFXUnit_Flutter *flutter, float32_t *buffer, float32_t fs, float32_t M, int32_t N, float32_t lfoDepth, float32_t lfoFrequency, float32_t b0);
+int32_t     MW_AFXUnit_Flutter_init_arena(MW_AFXUnit_Flutter *flutter, MW_DSP_Arena *arena, float32_t fs, float32_t M, int32_t N, float32_t lfoDepth, float32_t lfoFrequency, float32_t b0);
 void        MW_AFXUnit_Flutter_changeParameters(MW_AFXUnit_Flutter *flutter, float32_t lfoDepth, float32_t lfoFrequency, float32_t b0);
 void        MW_AFXUnit_Flutter_process(MW_AFXUnit_Flutter *flutter, float32_t *buffer, size_t bufferSize);
 void        MW_AFXUnit_Flutter_reset(MW_AFXUnit_Flutter *flutter);
@@ -63,25 +63,64 @@ void MW_AFXUnit_GardnerReverb_calculateDelayIndices(int32_t *calculatedIndices,
 
 
 /*
- *  Initialize a MW_AFXUnit_GardnerReverb structure
- *  This structure implements a "medium room" reverberator (see William Gardner's MS thesis [page 56])
- *  This function will not allocate memory for you for each delay line/APCF modules.  Therefore, you must 
- *  pre-allocate memory and pass it into this function.
- * 
- *  MW_AFXUnit_GardnerReverb_init() expects a pointer to a block of contiguous memory which will then be 
- *  split up for each APCF/delay line components
- * 
- *  delayLineMemory size accomodate at least 340 msec of sample data, or 0.34 * fs samples
- *
- *  Inputs:
- *    reverb:           Pointer to a MW_AFXUnit_GardnerReverb structure
- *    delayLineMemory:  Pointer to an array that will hold the audio samples.  Memory must be already allocated
- *    gain:             Reverb feedback gain (must be less than 1 and greater than 0)
- *    fs:               Samping frequency (must be greater than 0)
+ *  Number of samples of delay line memory needed by MW_AFXUnit_GardnerReverb_init() (or MW_AFXUnit_GardnerReverb_init_q15())
+ *  at sampling frequency fs.  This is the exact total of all of the APCF and delay line lengths (a little under 0.34 * fs)
  */
-int32_t MW_AFXUnit_GardnerReverb_init(MW_AFXUnit_GardnerReverb *reverb, float32_t *delayLineMemory, float32_t gain, float32_t fs)
+int32_t MW_AFXUnit_GardnerReverb_calculateMemorySize(float32_t fs)
 {
-    if (reverb == NULL || delayLineMemory == NULL)
+#ifdef NO_OPTIMIZE
+    if (fs <= 0.f) while(1);
+#endif
+
+    int32_t delayLineStarts[MW_AFXUNIT_GARDNERREVERB_TOTAL_DELAY_LINES];
+    MW_AFXUnit_GardnerReverb_calculateDelayIndices(delayLineStarts, fs);
+
+    //  Round the last delay length up the same way the other lengths are
+    float32_t lastDelayLength = _DELAY_LINE_LENGTHS[MW_AFXUNIT_GARDNERREVERB_TOTAL_DELAY_LINES - 1] * fs;
+    int32_t lastDelayLengthToUse = (int32_t)lastDelayLength;
+    if (lastDelayLength - (float32_t)lastDelayLengthToUse > 0)
+        lastDelayLengthToUse++;
+
+    return delayLineStarts[MW_AFXUNIT_GARDNERREVERB_TOTAL_DELAY_LINES - 1] + lastDelayLengthToUse;
+}
+
+
+//  Only one of floatMemory and q15Memory is used by the delay line/APCF helpers below (whichever isn't NULL)
+static int32_t MW_AFXUnit_GardnerReverb_initAPCF(MW_DSP_APCF *filter, float32_t *floatMemory, q15_t *q15Memory, int32_t start, int32_t N, float32_t gain)
+{
+    if (q15Memory != NULL)
+        return MW_DSP_APCF_init_q15(filter, q15Memory + start, N, gain);
+
+    return MW_DSP_APCF_init(filter, floatMemory + start, N, gain);
+}
+
+
+static int32_t MW_AFXUnit_GardnerReverb_initNestedAPCF(MW_DSP_NestedAPCF *filter, float32_t *floatMemory, q15_t *q15Memory, int32_t start, int32_t N,
+                                                      float32_t gain, MW_DSP_APCF *innerAPCFs, int32_t numInnerAPCFs)
+{
+    if (q15Memory != NULL)
+        return MW_DSP_NestedAPCF_init_q15(filter, q15Memory + start, N, gain, innerAPCFs, numInnerAPCFs);
+
+    return MW_DSP_NestedAPCF_init(filter, floatMemory + start, N, gain, innerAPCFs, numInnerAPCFs);
+}
+
+
+static int32_t MW_AFXUnit_GardnerReverb_initDelayLine(MW_DSP_DelayLine *delayLine, float32_t *floatMemory, q15_t *q15Memory, int32_t start, int32_t N)
+{
+    if (q15Memory != NULL)
+        return MW_DSP_DelayLine_init_q15(delayLine, q15Memory + start, N);
+
+    return MW_DSP_DelayLine_init(delayLine, floatMemory + start, N);
+}
+
+
+/*
+ *  Common initialization for MW_AFXUnit_GardnerReverb_init() and MW_AFXUnit_GardnerReverb_init_q15()
+ *  Exactly one of floatMemory and q15Memory must be non-NULL
+ */
+static int32_t MW_AFXUnit_GardnerReverb_initReverb(MW_AFXUnit_GardnerReverb *reverb, float32_t *floatMemory, q15_t *q15Memory, float32_t gain, float32_t fs)
+{
+    if (reverb == NULL || (floatMemory == NULL && q15Memory == NULL))
         return 0;
 
     if (gain <= 0 || fs <= 0 || gain >= 1.f)
@@ -107,47 +146,48 @@ int32_t MW_AFXUnit_GardnerReverb_init(MW_AFXUnit_GardnerReverb *reverb, float32_
 
     //  Initialize APCFs and Delay Lines
     //  Initialize first set of inner APCFs
-    int32_t success = MW_DSP_APCF_init(&reverb->innerAPCF1[0], delayLineMemory + delayLineStarts[1], delayLengthsInSamples[1], 0.7);
+    int32_t success = MW_AFXUnit_GardnerReverb_initAPCF(&reverb->innerAPCF1[0], floatMemory, q15Memory, delayLineStarts[1], delayLengthsInSamples[1], 0.7);
     if (!success)
         return 0;
 
-    success = MW_DSP_APCF_init(&reverb->innerAPCF1[1], delayLineMemory + delayLineStarts[2], delayLengthsInSamples[2], 0.5);
+    success = MW_AFXUnit_GardnerReverb_initAPCF(&reverb->innerAPCF1[1], floatMemory, q15Memory, delayLineStarts[2], delayLengthsInSamples[2], 0.5);
     if (!success)
         return 0;
 
-    success = MW_DSP_NestedAPCF_init(&reverb->nestedAPCFs[0], delayLineMemory, delayLengthsInSamples[0], 0.3, reverb->innerAPCF1, 2);
+    success = MW_AFXUnit_GardnerReverb_initNestedAPCF(&reverb->nestedAPCFs[0], floatMemory, q15Memory, delayLineStarts[0], delayLengthsInSamples[0], 0.3, reverb->innerAPCF1, 2);
     if (!success)
         return 0;
 
-    success = MW_DSP_DelayLine_init(&reverb->delayLines[0], delayLineMemory + delayLineStarts[3], delayLengthsInSamples[3]);
+    success = MW_AFXUnit_GardnerReverb_initDelayLine(&reverb->delayLines[0], floatMemory, q15Memory, delayLineStarts[3], delayLengthsInSamples[3]);
     if (!success)
         return 0;
 
-    success = MW_DSP_APCF_init(&reverb->standaloneAPCF, delayLineMemory + delayLineStarts[4], delayLengthsInSamples[4], 0.5);
+    success = MW_AFXUnit_GardnerReverb_initAPCF(&reverb->standaloneAPCF, floatMemory, q15Memory, delayLineStarts[4], delayLengthsInSamples[4], 0.5);
     if (!success)
         return 0;
 
-    success = MW_DSP_DelayLine_init(&reverb->delayLines[1], delayLineMemory + delayLineStarts[5], delayLengthsInSamples[5]);
+    success = MW_AFXUnit_GardnerReverb_initDelayLine(&reverb->delayLines[1], floatMemory, q15Memory, delayLineStarts[5], delayLengthsInSamples[5]);
     if (!success)
         return 0;
 
-    success = MW_DSP_DelayLine_init(&reverb->delayLines[2], delayLineMemory + delayLineStarts[6], delayLengthsInSamples[6]);
+    success = MW_AFXUnit_GardnerReverb_initDelayLine(&reverb->delayLines[2], floatMemory, q15Memory, delayLineStarts[6], delayLengthsInSamples[6]);
     if (!success)
         return 0;
 
-    success = MW_DSP_APCF_init(&reverb->innerAPCF2, delayLineMemory + delayLineStarts[8], delayLengthsInSamples[8], 0.6);
+    success = MW_AFXUnit_GardnerReverb_initAPCF(reverb->innerAPCF2, floatMemory, q15Memory, delayLineStarts[8], delayLengthsInSamples[8], 0.6);
     if (!success)
         return 0;
 
-    success = MW_DSP_NestedAPCF_init(&reverb->nestedAPCFs[1], delayLineMemory + delayLineStarts[7], delayLengthsInSamples[7], 0.3, reverb->innerAPCF2, 1);
+    success = MW_AFXUnit_GardnerReverb_initNestedAPCF(&reverb->nestedAPCFs[1], floatMemory, q15Memory, delayLineStarts[7], delayLengthsInSamples[7], 0.3, reverb->innerAPCF2, 1);
     if (!success)
         return 0;
 
-    success = MW_DSP_DelayLine_init(&reverb->delayLines[3], delayLineMemory + delayLineStarts[9], delayLengthsInSamples[9]);
+    success = MW_AFXUnit_GardnerReverb_initDelayLine(&reverb->delayLines[3], floatMemory, q15Memory, delayLineStarts[9], delayLengthsInSamples[9]);
     if (!success)
         return 0;
 
-    reverb->delayLineMemory = delayLineMemory;
+    reverb->delayLineMemory = floatMemory;
+    reverb->delayLineMemoryQ15 = q15Memory;
     reverb->gain = gain;
 
     success = MW_AFXUnit_SVFilter_init(&reverb->feedbackLPF, MW_AFXUNIT_SVFILTER_LPF, fs, 2500.f, 0.707f);
@@ -158,6 +198,87 @@ int32_t MW_AFXUnit_GardnerReverb_init(MW_AFXUnit_GardnerReverb *reverb, float32_
 }
 
 
+/*
+ *  Initialize a MW_AFXUnit_GardnerReverb structure
+ *  This structure implements a "medium room" reverberator (see William Gardner's MS thesis [page 56])
+ *  This function will not allocate memory for you for each delay line/APCF modules.  Therefore, you must 
+ *  pre-allocate memory and pass it into this function.
+ * 
+ *  MW_AFXUnit_GardnerReverb_init() expects a pointer to a block of contiguous memory which will then be 
+ *  split up for each APCF/delay line components
+ * 
+ *  delayLineMemory size accomodate at least 340 msec of sample data, or 0.34 * fs samples
+ *
+ *  Inputs:
+ *    reverb:           Pointer to a MW_AFXUnit_GardnerReverb structure
+ *    delayLineMemory:  Pointer to an array that will hold the audio samples.  Memory must be already allocated
+ *    gain:             Reverb feedback gain (must be less than 1 and greater than 0)
+ *    fs:               Samping frequency (must be greater than 0)
+ */
+int32_t MW_AFXUnit_GardnerReverb_init(MW_AFXUnit_GardnerReverb *reverb, float32_t *delayLineMemory, float32_t gain, float32_t fs)
+{
+    if (delayLineMemory == NULL)
+        return 0;
+
+    return MW_AFXUnit_GardnerReverb_initReverb(reverb, delayLineMemory, NULL, gain, fs);
+}
+
+
+/*
+ *  Same as MW_AFXUnit_GardnerReverb_init() except that the delay line memory is allocated from arena (see MW_DSP_Arena)
+ *  and sized with MW_AFXUnit_GardnerReverb_calculateMemorySize(), so the caller doesn't need to size it by hand.
+ *  The memory is cleared.  Nothing is allocated if initialization fails
+ *
+ *  Inputs:
+ *    reverb:           Pointer to a MW_AFXUnit_GardnerReverb structure
+ *    arena:            Arena to allocate the delay line memory from
+ *    gain:             Reverb feedback gain (must be less than 1 and greater than 0)
+ *    fs:               Samping frequency (must be greater than 0)
+ */
+int32_t MW_AFXUnit_GardnerReverb_init_arena(MW_AFXUnit_GardnerReverb *reverb, MW_DSP_Arena *arena, float32_t gain, float32_t fs)
+{
+    if (arena == NULL || fs <= 0)
+        return 0;
+
+    int32_t memorySize = MW_AFXUnit_GardnerReverb_calculateMemorySize(fs);
+
+    size_t marker = MW_DSP_Arena_mark(arena);
+    float32_t *delayLineMemory = MW_DSP_Arena_allocFloat(arena, memorySize);
+    if (delayLineMemory == NULL)
+        return 0;
+
+    arm_fill_f32(0.f, delayLineMemory, memorySize);
+
+    if (!MW_AFXUnit_GardnerReverb_init(reverb, delayLineMemory, gain, fs))
+    {
+        MW_DSP_Arena_release(arena, marker);
+        return 0;
+    }
+
+    return 1;
+}
+
+
+/*
+ *  Same as MW_AFXUnit_GardnerReverb_init() except that every APCF and delay line stores its samples as Q15.
+ *  delayLineMemory must still hold 0.34 * fs samples but this takes half the memory (21.8 kB instead of 43.5 kB at 32 kHz).
+ *  The delay lines saturate at +/-1 so keep the input at least 6 dB below full scale
+ *
+ *  Inputs:
+ *    reverb:           Pointer to a MW_AFXUnit_GardnerReverb structure
+ *    delayLineMemory:  Pointer to an array that will hold the audio samples.  Memory must be already allocated
+ *    gain:             Reverb feedback gain (must be less than 1 and greater than 0)
+ *    fs:               Samping frequency (must be greater than 0)
+ */
+int32_t MW_AFXUnit_GardnerReverb_init_q15(MW_AFXUnit_GardnerReverb *reverb, q15_t *delayLineMemory, float32_t gain, float32_t fs)
+{
+    if (delayLineMemory == NULL)
+        return 0;
+
+    return MW_AFXUnit_GardnerReverb_initReverb(reverb, NULL, delayLineMemory, gain, fs);
+}
+
+
 void MW_AFXUnit_GardnerReverb_changeParameters(MW_AFXUnit_GardnerReverb *reverb, float32_t gain)
 {
     #ifdef NO_OPTIMIZE
@@ -31,6 +31,7 @@
 #include "MW_DSP_APCF.h"
 #include "MW_DSP_DelayLine.h"
 #include "MW_AFXUnit_SVFilter.h"
+#include "MW_DSP_Arena.h"
 
 #define MW_AFXUNIT_GARDNERREVERB_NUM_APCFS 4
 #define MW_AFXUNIT_GARDNERREVERB_NUM_NESTEDAPCFS 2
@@ -42,7 +43,11 @@ typedef struct
 {
     //  delayLineMemory must point to a block of memory that accomodates at least 340 msec worth of samples
     //  If fs = 32000, then the array size must be at least 0.34 * 32000 = 10880 samples
+    //  MW_AFXUnit_GardnerReverb_calculateMemorySize() gives the exact number of samples (or use MW_AFXUnit_GardnerReverb_init_arena())
+    //  delayLineMemoryQ15 is used instead (and delayLineMemory is NULL) if the reverb was initialized with
+    //  MW_AFXUnit_GardnerReverb_init_q15().  The same number of samples is needed but each sample takes half the memory
     float32_t           *delayLineMemory;
+    q15_t               *delayLineMemoryQ15;
     MW_DSP_APCF         innerAPCF1[2];
     MW_DSP_APCF         innerAPCF2[1];
     MW_DSP_APCF         standaloneAPCF;
@@ -55,11 +60,14 @@ typedef struct
 
 
 int32_t     MW_AFXUnit_GardnerReverb_init(MW_AFXUnit_GardnerReverb *reverb, float32_t *delayLineMemory, float32_t gain, float32_t fs);
+int32_t     MW_AFXUnit_GardnerReverb_init_q15(MW_AFXUnit_GardnerReverb *reverb, q15_t *delayLineMemory, float32_t gain, float32_t fs);
+int32_t     MW_AFXUnit_GardnerReverb_init_arena(MW_AFXUnit_GardnerReverb *reverb, MW_DSP_Arena *arena, float32_t gain, float32_t fs);
 void        MW_AFXUnit_GardnerReverb_changeParameters(MW_AFXUnit_GardnerReverb *reverb, float32_t gain);
 void        MW_AFXUnit_GardnerReverb_process(MW_AFXUnit_GardnerReverb *reverb, float32_t *buffer, size_t bufferSize);
 
 
 void        MW_AFXUnit_GardnerReverb_calculateDelayIndices(int32_t *calculatedIndices, float32_t fs);
+int32_t     MW_AFXUnit_GardnerReverb_calculateMemorySize(float32_t fs);
 
 
 
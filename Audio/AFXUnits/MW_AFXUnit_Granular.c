@@ -69,7 +69,12 @@ void MW_AFXUnit_Granular_windowGrain(MW_AFXUnit_Granular *granular)
 
 
 
-int32_t MW_AFXUnit_Granular_init(MW_AFXUnit_Granular *granular, float32_t *tapeBuffer, int32_t tapeBufferSize, float32_t grainSizeInSec, float32_t timeToChangeGrainInSec, float32_t fs)
+/*
+ *  Common initialization for MW_AFXUnit_Granular_init() and MW_AFXUnit_Granular_init_guarded()
+ *  tapeBuffer must hold tapeBufferSize + guardSize samples
+ */
+static int32_t MW_AFXUnit_Granular_initTape(MW_AFXUnit_Granular *granular, float32_t *tapeBuffer, int32_t tapeBufferSize, float32_t grainSizeInSec,
+                                            float32_t timeToChangeGrainInSec, float32_t fs, int32_t guardSize)
 {
     if (tapeBuffer == NULL || granular == NULL)
         return 0;
@@ -101,10 +106,52 @@ int32_t MW_AFXUnit_Granular_init(MW_AFXUnit_Granular *granular, float32_t *tapeB
     granular->changeGrainSize = 0;
     granular->newGrainSize = 0;
     granular->changeTimeBetweenGrains = 0;
+    granular->newNumSamplesBetweenGrainChanges = 0;
 
+    if (!MW_DSP_RingBuffer_init(&granular->tapeRingBuffer, tapeBuffer, tapeBufferSize, guardSize))
+        return 0;
 
     arm_fill_f32(0, granular->grainBuffer, MAX_GRAIN_BUFFER_SIZE);
-    arm_fill_f32(0, granular->tapeBuffer, granular->tapeBufferSize);
+
+    return 1;
+}
+
+
+int32_t MW_AFXUnit_Granular_init(MW_AFXUnit_Granular *granular, float32_t *tapeBuffer, int32_t tapeBufferSize, float32_t grainSizeInSec, float32_t timeToChangeGrainInSec, float32_t fs)
+{
+    return MW_AFXUnit_Granular_initTape(granular, tapeBuffer, tapeBufferSize, grainSizeInSec, timeToChangeGrainInSec, fs, 0);
+}
+
+
+/*
+ *  Initialize a granular unit whose tape buffer has a guard zone (see MW_DSP_RingBuffer)
+ *  tapeBuffer must hold MW_DSP_RINGBUFFER_MEMORY_SIZE(tapeBufferSize, MW_AFXUNIT_GRANULAR_GUARD_SIZE(tapeBufferSize)) samples.
+ *  In exchange, grains are copied out of the tape with a single copy instead of being split where the tape wraps around
+ */
+int32_t MW_AFXUnit_Granular_init_guarded(MW_AFXUnit_Granular *granular, float32_t *tapeBuffer, int32_t tapeBufferSize, float32_t grainSizeInSec, float32_t timeToChangeGrainInSec, float32_t fs)
+{
+    return MW_AFXUnit_Granular_initTape(granular, tapeBuffer, tapeBufferSize, grainSizeInSec, timeToChangeGrainInSec, fs,
+                                        MW_AFXUNIT_GRANULAR_GUARD_SIZE(tapeBufferSize));
+}
+
+
+/*
+ *  Same as MW_AFXUnit_Granular_init() except that the tape buffer is allocated from arena (see MW_DSP_Arena).
+ *  The tape has no guard zone since the guard can be as large as a whole grain.  Nothing is allocated if initialization fails
+ */
+int32_t MW_AFXUnit_Granular_init_arena(MW_AFXUnit_Granular *granular, MW_DSP_Arena *arena, int32_t tapeBufferSize, float32_t grainSizeInSec, float32_t timeToChangeGrainInSec, float32_t fs)
+{
+    if (arena == NULL || tapeBufferSize <= 0)
+        return 0;
+
+    size_t marker = MW_DSP_Arena_mark(arena);
+    float32_t *tapeBuffer = MW_DSP_Arena_allocFloat(arena, tapeBufferSize);
+
+    if (!MW_AFXUnit_Granular_init(granular, tapeBuffer, tapeBufferSize, grainSizeInSec, timeToChangeGrainInSec, fs))
+    {
+        MW_DSP_Arena_release(arena, marker);
+        return 0;
+    }
 
     return 1;
 }
@@ -166,7 +213,7 @@ void MW_AFXUnit_Granular_process(MW_AFXUnit_Granular *granular, float32_t *buffe
 
     for (size_t i = 0; i < bufferSize; ++i)
     {
-        granular->tapeBuffer[granular->tapeBufferPtr] = buffer[i];
+        MW_DSP_RingBuffer_write(&granular->tapeRingBuffer, granular->tapeBufferPtr, buffer[i]);
         granular->tapeBufferPtr = (granular->tapeBufferPtr + 1) % granular->tapeBufferSize;
 
         buffer[i] = granular->grainBuffer[granular->grainBufferPtr++];
@@ -195,13 +242,13 @@ void MW_AFXUnit_Granular_process(MW_AFXUnit_Granular *granular, float32_t *buffe
                 int32_t randomIndexMapped = (int32_t)MW_AFXUnit_Utils_mapToRange(randomIndexUnMapped, 0, __RAND_MAX, 0, keepOutIndex);
                 int32_t startIndex = (granular->tapeBufferPtr + randomIndexMapped) % granular->tapeBufferSize;
 
-                int32_t numSamplesRemaining = granular->tapeBufferSize - startIndex;
+                int32_t numSamplesRemaining = granular->tapeBufferSize + granular->tapeRingBuffer.guardSize - startIndex;
                 if (numSamplesRemaining >= granular->currentGrainSize)
                     arm_copy_f32(&granular->tapeBuffer[startIndex], granular->grainBuffer, granular->currentGrainSize);
                 else
                 {
                     arm_copy_f32(&granular->tapeBuffer[startIndex], granular->grainBuffer, numSamplesRemaining);
-                    arm_copy_f32(granular->tapeBuffer, &granular->grainBuffer[numSamplesRemaining], granular->currentGrainSize - numSamplesRemaining);
+                    arm_copy_f32(&granular->tapeBuffer[granular->tapeRingBuffer.guardSize], &granular->grainBuffer[numSamplesRemaining], granular->currentGrainSize - numSamplesRemaining);
                 }
 
                 //  Window grain buffer to avoid audio clicks
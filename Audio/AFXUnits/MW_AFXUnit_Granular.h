@@ -29,9 +29,14 @@
 
 #include "arm_math.h"
 #include "MW_AFXUnit_MiscUtils.h"
+#include "MW_DSP_RingBuffer.h"
+#include "MW_DSP_Arena.h"
 
 #define MAX_GRAIN_BUFFER_SIZE 6400
 
+//  Guard zone used by MW_AFXUnit_Granular_init_guarded().  Grains never wrap so they can be copied out of the tape in one go
+#define MW_AFXUNIT_GRANULAR_GUARD_SIZE(tapeBufferSize) ((tapeBufferSize) < MAX_GRAIN_BUFFER_SIZE ? (tapeBufferSize) : MAX_GRAIN_BUFFER_SIZE)
+
 typedef struct
 {
     float32_t   *tapeBuffer;
@@ -53,10 +58,14 @@ typedef struct
 
     int32_t     grainChangeCounter;
 
+    MW_DSP_RingBuffer tapeRingBuffer;   //  Same memory as tapeBuffer and tapeBufferSize
+
 }MW_AFXUnit_Granular;
 
 
 int32_t MW_AFXUnit_Granular_init(MW_AFXUnit_Granular *granular, float32_t *tapeBuffer, int32_t tapeBufferSize, float32_t grainSizeInSec, float32_t timeToChangeGrainInSec, float32_t fs);
+int32_t MW_AFXUnit_Granular_init_guarded(MW_AFXUnit_Granular *granular, float32_t *tapeBuffer, int32_t tapeBufferSize, float32_t grainSizeInSec, float32_t timeToChangeGrainInSec, float32_t fs);
+int32_t MW_AFXUnit_Granular_init_arena(MW_AFXUnit_Granular *granular, MW_DSP_Arena *arena, int32_t tapeBufferSize, float32_t grainSizeInSec, float32_t timeToChangeGrainInSec, float32_t fs);
 void    MW_AFXUnit_Granular_changeGrainSize(MW_AFXUnit_Granular *granular, float32_t grainSizeInSec);
 void    MW_AFXUnit_Granular_changeTimeToChangeGrain(MW_AFXUnit_Granular *granular, float32_t timeToChangeGrain);
 void    MW_AFXUnit_Granular_process(MW_AFXUnit_Granular *granular, float32_t *buffer, size_t bufferSize);
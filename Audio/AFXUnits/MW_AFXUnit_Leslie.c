@@ -48,7 +48,7 @@
  *      0:  If initialization unsuccessful
  *      1:  Otherwise
  */
-int32_t MW_AFXUnit_Leslie_init(MW_AFXUnit_Leslie *leslie, float32_t *delayLineBuffer, int16_t delayLineLength, float32_t fs, float32_t rpm)
+int32_t MW_AFXUnit_Leslie_init(MW_AFXUnit_Leslie *leslie, float32_t *delayLineBuffer, int32_t delayLineLength, float32_t fs, float32_t rpm)
 {
     if (leslie == NULL || delayLineBuffer == NULL)
         return 0;
@@ -63,19 +63,23 @@ int32_t MW_AFXUnit_Leslie_init(MW_AFXUnit_Leslie *leslie, float32_t *delayLineBu
         return 0;
 
     //  Initialize filters for loudspeaker filter effect
-    success = MW_AFXUnit_Biquad_init(&leslie->biquads[0], MW_BIQUAD_PARAM_EQ_CQ, fs, 525.f, 1.1f, 8.7f, NULL, 0);
+    success = MW_AFXUnit_BiquadCascade_init(&leslie->speakerEQ, 4, fs);
     if (!success)
         return 0;
 
-    success = MW_AFXUnit_Biquad_init(&leslie->biquads[1], MW_BIQUAD_PARAM_EQ_CQ, fs, 975.f, 1.6f, 22.f, NULL, 0);
+    success = MW_AFXUnit_BiquadCascade_changeStageParameters(&leslie->speakerEQ, 0, MW_BIQUAD_PARAM_EQ_CQ, 525.f, 1.1f, 8.7f);
     if (!success)
         return 0;
 
-    success = MW_AFXUnit_Biquad_init(&leslie->biquads[2], MW_BIQUAD_PARAM_EQ_CQ, fs, 1570.f, 8.2f, 6.2f, NULL, 0);
+    success = MW_AFXUnit_BiquadCascade_changeStageParameters(&leslie->speakerEQ, 1, MW_BIQUAD_PARAM_EQ_CQ, 975.f, 1.6f, 22.f);
     if (!success)
         return 0;
 
-    success = MW_AFXUnit_Biquad_init(&leslie->biquads[3], MW_BIQUAD_PARAM_EQ_CQ, fs, 2460.f, 4.f, 10.6f, NULL, 0);
+    success = MW_AFXUnit_BiquadCascade_changeStageParameters(&leslie->speakerEQ, 2, MW_BIQUAD_PARAM_EQ_CQ, 1570.f, 8.2f, 6.2f);
+    if (!success)
+        return 0;
+
+    success = MW_AFXUnit_BiquadCascade_changeStageParameters(&leslie->speakerEQ, 3, MW_BIQUAD_PARAM_EQ_CQ, 2460.f, 4.f, 10.6f);
     if (!success)
         return 0;
 
@@ -86,6 +90,29 @@ int32_t MW_AFXUnit_Leslie_init(MW_AFXUnit_Leslie *leslie, float32_t *delayLineBu
     leslie->a = 2.f * PI * arm_sin_f32(PI * rpm * 0.0167f / fs);
     leslie->s[0] = 0.5f;
     leslie->s[1] = 0.f;
+    leslie->delayLength = leslie->M;
+
+    return 1;
+}
+
+
+/*
+ *  Same as MW_AFXUnit_Leslie_init() except that the delay line buffer is allocated from arena (see MW_DSP_Arena)
+ *  Nothing is allocated if initialization fails
+ */
+int32_t MW_AFXUnit_Leslie_init_arena(MW_AFXUnit_Leslie *leslie, MW_DSP_Arena *arena, int32_t delayLineLength, float32_t fs, float32_t rpm)
+{
+    if (arena == NULL || delayLineLength <= 0)
+        return 0;
+
+    size_t marker = MW_DSP_Arena_mark(arena);
+    float32_t *delayLineBuffer = MW_DSP_Arena_allocFloat(arena, delayLineLength);
+
+    if (!MW_AFXUnit_Leslie_init(leslie, delayLineBuffer, delayLineLength, fs, rpm))
+    {
+        MW_DSP_Arena_release(arena, marker);
+        return 0;
+    }
 
     return 1;
 }
@@ -135,29 +162,39 @@ void MW_AFXUnit_Leslie_process(MW_AFXUnit_Leslie *leslie, float32_t *buffer, siz
 #endif
 
     //  TODO:  Apply signal to BPF bank
-    for (int32_t i = 0; i < 4; ++i)
-        MW_AFXUnit_Biquad_process(&leslie->biquads[i], buffer, bufferSize);
+    MW_AFXUnit_BiquadCascade_process(&leslie->speakerEQ, buffer, bufferSize);
+
+    float32_t delayTimes[MW_AFXUNIT_LESLIE_BLOCK_SIZE];
+    float32_t envelope[MW_AFXUNIT_LESLIE_BLOCK_SIZE];
+    float32_t dry[MW_AFXUNIT_LESLIE_BLOCK_SIZE];
 
-    for (size_t i = 0; i < bufferSize; ++i)
+    while (bufferSize > 0)
     {
-        float32_t y = MW_DSP_FractionalDelayLine_tick(&leslie->delay, buffer[i]);
+        size_t blockSize = bufferSize < MW_AFXUNIT_LESLIE_BLOCK_SIZE ? bufferSize : MW_AFXUNIT_LESLIE_BLOCK_SIZE;
+
+        //  Run the rotor model for the whole block first.  Each sample uses the delay length computed after the previous one
+        //  The rotor is a serial recurrence, so this loop costs about what processModulated() saves over per-sample ticks
+        for (size_t i = 0; i < blockSize; ++i)
+        {
+            delayTimes[i] = leslie->delayLength;
+
+            leslie->s[0] = leslie->s[0] - (leslie->a * leslie->s[1]);
+            leslie->s[1] = leslie->s[1] + (leslie->a * leslie->s[0]);
+            envelope[i] = 1.f + leslie->s[1];
+
+            //  Modify delay line length based on the physical model of a leslie speaker
+            leslie->delayLength = leslie->M + (-1.5f * leslie->angularVelocity * leslie->s[1]);
+        }
+
+        arm_copy_f32(buffer, dry, blockSize);
+        MW_DSP_FractionalDelayLine_processModulated(&leslie->delay, buffer, delayTimes, blockSize);
 
-        leslie->s[0] = leslie->s[0] - (leslie->a * leslie->s[1]);
-        leslie->s[1] = leslie->s[1] + (leslie->a * leslie->s[0]);
-        
         //  Apply modulation envelope to output signal and mix with dry signal
-        //buffer[i] = (0.2f * buffer[i]) + (y * envelope);
-        buffer[i] = (0.1f * buffer[i]) + (y * (1.f + leslie->s[1]));
-        // buffer[i] = (y * (1.f + leslie->s[1]));
-        //buffer[i] = 0.2f * buffer[i] + (y * (1.5f + leslie->s[1]));
-
-        //  Modify delay line length based on the physical model of a leslie speaker
-        float32_t newDelayLineLength = leslie->M + (-1.5f * leslie->angularVelocity * leslie->s[1]);
-        //float32_t newDelayLineLength = leslie->M;
-        //float32_t newDelayLineLength = leslie->M + (-0.07 * leslie->angularVelocity * lfoValue);
-        MW_DSP_FractionalDelayLine_setDelayLength(&leslie->delay, newDelayLineLength);
-
-        // buffer[i] = y;
+        for (size_t i = 0; i < blockSize; ++i)
+            buffer[i] = (0.1f * dry[i]) + (buffer[i] * envelope[i]);
+
+        buffer += blockSize;
+        bufferSize -= blockSize;
     }
 
     return;
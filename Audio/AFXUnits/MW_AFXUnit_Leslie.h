@@ -29,8 +29,12 @@
 
 #include "arm_math.h"
 #include "MW_DSP_DelayLine.h"
+#include "MW_DSP_Arena.h"
 #include "MW_AFXUnit_Biquad.h"
 
+//  The rotor model is computed this many samples at a time before being handed to the delay line
+#define MW_AFXUNIT_LESLIE_BLOCK_SIZE 32
+
 typedef struct
 {
     MW_DSP_FractionalDelayLine delay;
@@ -39,13 +43,15 @@ typedef struct
     float32_t phaseConstant;
     float32_t phase;
     float32_t M;
+    float32_t delayLength;      //  Delay length applied to the next sample
     float32_t a;
     float32_t s[2];
-    MW_AFXUnit_Biquad biquads[4];
+    MW_AFXUnit_BiquadCascade speakerEQ;     //  Four peaking filters for the loudspeaker response
 }MW_AFXUnit_Leslie;
 
 
-int32_t MW_AFXUnit_Leslie_init(MW_AFXUnit_Leslie *leslie, float32_t *delayLineBuffer, int16_t delayLineLength, float32_t fs, float32_t rpm);
+int32_t MW_AFXUnit_Leslie_init(MW_AFXUnit_Leslie *leslie, float32_t *delayLineBuffer, int32_t delayLineLength, float32_t fs, float32_t rpm);
+int32_t MW_AFXUnit_Leslie_init_arena(MW_AFXUnit_Leslie *leslie, MW_DSP_Arena *arena, int32_t delayLineLength, float32_t fs, float32_t rpm);
 void    MW_AFXUnit_Leslie_changeParameters(MW_AFXUnit_Leslie *leslie, float32_t rpm);
 void    MW_AFXUnit_Leslie_process(MW_AFXUnit_Leslie *leslie, float32_t *buffer, size_t bufferSize);
 
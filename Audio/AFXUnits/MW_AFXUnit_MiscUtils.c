@@ -198,9 +198,41 @@ float32_t MW_AFXUnit_Utils_mapToRange(float32_t value, float32_t low1, float32_t
 }
 
 
+/*
+ *  Start the cycle counter used by MW_AFXUnit_Utils_getCycleCount()
+ *  If MW_AFXUNIT_UTILS_CYCLE_COUNTER is defined, it is up to you to start your timer
+ *
+ *  Inputs:
+ *    None
+ *
+ *  Returns:
+ *    None
+ */
+void MW_AFXUnit_Utils_enableCycleCounter()
+{
+#ifndef MW_AFXUNIT_UTILS_CYCLE_COUNTER
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
 
 
-
-
-
-
+/*
+ *  Read the current value of the cycle counter
+ *  Take the difference of two readings to time a section of code.  Unsigned subtraction takes care of counter wrap around
+ *
+ *  Inputs:
+ *    None
+ *
+ *  Returns:
+ *    Current cycle count
+ */
+uint32_t MW_AFXUnit_Utils_getCycleCount()
+{
+#ifdef MW_AFXUNIT_UTILS_CYCLE_COUNTER
+  return MW_AFXUNIT_UTILS_CYCLE_COUNTER;
+#else
+  return DWT->CYCCNT;
+#endif
+}
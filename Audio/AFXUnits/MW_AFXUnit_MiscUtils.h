@@ -57,6 +57,12 @@ void      MW_AFXUnit_Utils_crossFade(float32_t *fadeInEnvelope, float32_t *fadeO
 //  Value mapping functions
 float32_t   MW_AFXUnit_Utils_mapToRange(float32_t value, float32_t low1, float32_t high1, float32_t low2, float32_t high2);
 
+//  Cycle counting (for benchmarking)
+//  The Cortex-M DWT cycle counter is used by default.  To use a different timer, define MW_AFXUNIT_UTILS_CYCLE_COUNTER
+//  as an expression that returns the current count as a uint32_t
+void        MW_AFXUnit_Utils_enableCycleCounter();
+uint32_t    MW_AFXUnit_Utils_getCycleCount();
+
 
 
 #endif /* MW_AFXUNIT_MISCUTILS_H_ */
@@ -26,19 +26,21 @@
 
 
 #include "MW_AFXUnit_BiquadTests.h"
+#include "MW_AFXUnit_MiscUtils.h"
+
+#define BENCHMARK_BLOCK_SIZE 128
+#define BENCHMARK_NUM_BLOCKS 64
 
 static float32_t epsilon = 1.f;
 
+//  Stage types used by the cascade tests and benchmarks
+static const MW_AFXUnit_BiquadType CASCADE_STAGE_TYPES[4] = {MW_BIQUAD_PARAM_EQ_CQ, MW_BIQUAD_LPF, MW_BIQUAD_BPF, MW_BIQUAD_HPF};
+
 
 static int32_t MW_AFXUnit_Biquad_initializationTests()
 {
     MW_AFXUnit_Biquad biquad;
 
-    //  Depending on the biquad type, we may need to add in a "copy buffer" 
-    //  See the documentation in the Biquad initialization functions for more details
-    float32_t copyBuffer[10];
-    size_t copyBufferSize = 10;
-
     float32_t fs = 44100.f;
     float32_t fc = 100.f;
     float32_t Q = 0.707f;
@@ -46,7 +48,7 @@ static int32_t MW_AFXUnit_Biquad_initializationTests()
 
     //  Initialize with valid parameters
     MW_AFXUnit_BiquadType biquadType = MW_BIQUAD_PARAM_EQ_NCQ;
-    int32_t success = MW_AFXUnit_Biquad_init(&biquad, biquadType, fs, fc, Q, gain, copyBuffer, copyBufferSize);
+    int32_t success = MW_AFXUnit_Biquad_init(&biquad, biquadType, fs, fc, Q, gain);
     if (!success)
         return 0;
 
@@ -72,35 +74,35 @@ static int32_t MW_AFXUnit_Biquad_initializationTests()
     
     //  Check invalid parameter protections
     //  Enter invalid MW_AFXUnit_Biquad instance
-    success = MW_AFXUnit_Biquad_init(NULL, biquadType, fs, fc, Q, gain, copyBuffer, copyBufferSize);
+    success = MW_AFXUnit_Biquad_init(NULL, biquadType, fs, fc, Q, gain);
     if (success)
         return 0;
 
     //  Enter invalid filter type
-    success = MW_AFXUnit_Biquad_init(&biquad, -10, fs, fc, Q, gain, copyBuffer, copyBufferSize);
+    success = MW_AFXUnit_Biquad_init(&biquad, -10, fs, fc, Q, gain);
     if (success)
         return 0;
 
     //  Enter invalid fs
-    success = MW_AFXUnit_Biquad_init(&biquad, biquadType, -fs, fc, Q, gain, copyBuffer, copyBufferSize);
+    success = MW_AFXUnit_Biquad_init(&biquad, biquadType, -fs, fc, Q, gain);
     if (success)
         return 0;
 
-    success = MW_AFXUnit_Biquad_init(&biquad, biquadType, 0, fc, Q, gain, copyBuffer, copyBufferSize);
+    success = MW_AFXUnit_Biquad_init(&biquad, biquadType, 0, fc, Q, gain);
     if (success)
         return 0;
     
     //  Enter invalid fc
-    success = MW_AFXUnit_Biquad_init(&biquad, biquadType, fs, fs * 0.5f + 100, Q, gain, copyBuffer, copyBufferSize);
+    success = MW_AFXUnit_Biquad_init(&biquad, biquadType, fs, fs * 0.5f + 100, Q, gain);
     if (success)
         return 0;
 
     //  Enter invalid Q
-    success = MW_AFXUnit_Biquad_init(&biquad, biquadType, fs, fc, -Q, gain, copyBuffer, copyBufferSize);
+    success = MW_AFXUnit_Biquad_init(&biquad, biquadType, fs, fc, -Q, gain);
     if (success)
         return 0;
 
-    success = MW_AFXUnit_Biquad_init(&biquad, biquadType, fs, fc, 0, gain, copyBuffer, copyBufferSize);
+    success = MW_AFXUnit_Biquad_init(&biquad, biquadType, fs, fc, 0, gain);
     if (success)
         return 0;
 
@@ -116,31 +118,65 @@ static int32_t MW_AFXUnit_Biquad_paramEQNCQInitializationTest()
     MW_AFXUnit_Biquad biquad;
     MW_AFXUnit_BiquadType biquadType = MW_BIQUAD_PARAM_EQ_NCQ;
 
-    float32_t copyBuffer[10];
-    size_t copyBufferSize = 10;
-
     float32_t fs = 44100.f;
-    float32_t fc = 100.f;
+    float32_t fc = 1000.f;
     float32_t Q = 0.707f;
     float32_t gain = 10.f;
 
-    int32_t success = MW_AFXUnit_Biquad_init(&biquad, biquadType, fs, fc, Q, gain, copyBuffer, copyBufferSize);
+    int32_t success = MW_AFXUnit_Biquad_init(&biquad, biquadType, fs, fc, Q, gain);
     if (!success)
         return 0;
 
-    if (biquad.copyBuffer != copyBuffer)
-        return 0;
-
-    if (biquad.bufferSize != copyBufferSize)
-        return 0;
-
-    //  Check for protection against NULL copyBuffer and invalid copyBufferSize
-    success = MW_AFXUnit_Biquad_init(&biquad, biquadType, fs, fc, Q, gain, NULL, copyBufferSize);
-    if (success)
-        return 0;
-
-    success = MW_AFXUnit_Biquad_init(&biquad, biquadType, fs, fc, Q, gain, copyBuffer, 0);
-    if (success)
+    //  The folded filter must match the biquad output scaled by (mu - 1) and summed with the dry signal
+    //  Build the unfolded biquad from the folded coefficients and run the reference with it
+    float32_t wetGain = biquad.coefficients[5];
+    float32_t referenceCoefficients[5];
+    float32_t referenceState[2] = {0.f, 0.f};
+    arm_biquad_cascade_df2T_instance_f32 reference;
+
+    referenceCoefficients[0] = (biquad.coefficients[0] - 1.f) / wetGain;
+    referenceCoefficients[1] = (biquad.coefficients[1] + biquad.coefficients[3]) / wetGain;
+    referenceCoefficients[2] = (biquad.coefficients[2] + biquad.coefficients[4]) / wetGain;
+    referenceCoefficients[3] = biquad.coefficients[3];
+    referenceCoefficients[4] = biquad.coefficients[4];
+    arm_biquad_cascade_df2T_init_f32(&reference, 1, referenceCoefficients, referenceState);
+
+    //  With the dry path folded in, blocks of any size can be processed
+    float32_t buffer[37];
+    float32_t referenceBuffer[37];
+    for (int32_t block = 0; block < 4; ++block)
+    {
+        size_t blockSize = 37 - 9 * block;
+        for (size_t i = 0; i < blockSize; ++i)
+            buffer[i] = (block == 0 && i == 0) ? 1.f : 0.25f * arm_sin_f32(0.05f * (float32_t)(i + 37 * block));
+
+        arm_biquad_cascade_df2T_f32(&reference, buffer, referenceBuffer, blockSize);
+        arm_scale_f32(referenceBuffer, wetGain, referenceBuffer, blockSize);
+        arm_add_f32(referenceBuffer, buffer, referenceBuffer, blockSize);
+
+        MW_AFXUnit_Biquad_process(&biquad, buffer, blockSize);
+
+        for (size_t i = 0; i < blockSize; ++i)
+            if (!(fabsf(buffer[i] - referenceBuffer[i]) <= 1e-5f))
+                return 0;
+    }
+
+    //  The boost must show up at the centre frequency
+    float32_t mu = pow(10, gain / 20.f);
+    float32_t w = 2.f * PI * fc / fs;
+    float32_t re = 0.f, im = 0.f, dre = 0.f, dim = 0.f;
+    float32_t b[3] = {biquad.coefficients[0], biquad.coefficients[1], biquad.coefficients[2]};
+    float32_t a[3] = {1.f, -biquad.coefficients[3], -biquad.coefficients[4]};
+    for (int32_t k = 0; k < 3; ++k)
+    {
+        re += b[k] * arm_cos_f32(w * k);
+        im -= b[k] * arm_sin_f32(w * k);
+        dre += a[k] * arm_cos_f32(w * k);
+        dim -= a[k] * arm_sin_f32(w * k);
+    }
+
+    float32_t magnitude = sqrtf((re * re + im * im) / (dre * dre + dim * dim));
+    if (fabsf(magnitude - mu) > 0.01f * mu)
         return 0;
 
     return 1;
@@ -163,7 +199,7 @@ static int32_t MW_AFXUnit_Biquad_lpfInitializationTests()
     for (int32_t i = 0; i < 5; ++i)
         biquad.coefficients[i] = dummyValue;
 
-    int32_t success = MW_AFXUnit_Biquad_init(&biquad, biquadType, fs, fc, Q, gain, NULL, 0);
+    int32_t success = MW_AFXUnit_Biquad_init(&biquad, biquadType, fs, fc, Q, gain);
     if (!success)
         return 0;
     
@@ -204,7 +240,7 @@ static int32_t MW_AFXUnit_Biquad_hpfInitializationTests()
     for (int32_t i = 0; i < 5; ++i)
         biquad.coefficients[i] = dummyValue;
 
-    int32_t success = MW_AFXUnit_Biquad_init(&biquad, biquadType, fs, fc, Q, gain, NULL, 0);
+    int32_t success = MW_AFXUnit_Biquad_init(&biquad, biquadType, fs, fc, Q, gain);
     if (!success)
         return 0;
     
@@ -244,7 +280,7 @@ static int32_t MW_AFXUnit_Biquad_bpfInitializationTests()
     for (int32_t i = 0; i < 5; ++i)
         biquad.coefficients[i] = dummyValue;
 
-    int32_t success = MW_AFXUnit_Biquad_init(&biquad, biquadType, fs, fc, Q, gain, NULL, 0);
+    int32_t success = MW_AFXUnit_Biquad_init(&biquad, biquadType, fs, fc, Q, gain);
     if (!success)
         return 0;
     
@@ -279,8 +315,45 @@ static int32_t MW_AFXUnit_Biquad_lowShelfInitializationTests()
     float32_t Q = 0.707f;
     float32_t gain = 10.f;
 
-    float32_t copyBuffer[10];
-    size_t copyBufferSize = 10;
+    //  Set coeffients to some known, dummy variable
+    float32_t dummyValue = -999999.f;
+
+    for (int32_t i = 0; i < 6; ++i)
+        biquad.coefficients[i] = dummyValue;
+
+    int32_t success = MW_AFXUnit_Biquad_init(&biquad, biquadType, fs, fc, Q, gain);
+    if (!success)
+        return 0;
+    
+    for (int32_t i = 0; i < 6; ++i)
+        if (biquad.coefficients[i] >= dummyValue - epsilon && biquad.coefficients[i] <= dummyValue + epsilon)
+            return 0;
+
+    //  Create new instance of MW_AFXUnit_Biquad and then immediately try to call MW_AFXUnit_Biquad_changeParameters()
+    //  If NO_OPTIMIZE is enabled, then the program should hang in an infinite loop
+    MW_AFXUnit_Biquad newBiquad;
+    for (int32_t i = 0; i < 6; ++i)
+        newBiquad.coefficients[i] = dummyValue;
+    
+    MW_AFXUnit_Biquad_changeParameters(&newBiquad, biquadType, fc, Q, gain);
+
+    for (int32_t i = 0; i < 6; ++i)
+        if (newBiquad.coefficients[i] >= dummyValue - epsilon && newBiquad.coefficients[i] <= dummyValue + epsilon)
+            return 0;
+
+    return 1;
+}
+
+
+static int32_t MW_AFXUnit_Biquad_highShelfInitializationTests()
+{
+    MW_AFXUnit_Biquad biquad;
+    MW_AFXUnit_BiquadType biquadType = MW_BIQUAD_HIGH_SHELF;
+
+    float32_t fs = 44100.f;
+    float32_t fc = 5000.f;
+    float32_t Q = 0.707f;
+    float32_t gain = 10.f;
 
     //  Set coeffients to some known, dummy variable
     float32_t dummyValue = -999999.f;
@@ -288,7 +361,7 @@ static int32_t MW_AFXUnit_Biquad_lowShelfInitializationTests()
     for (int32_t i = 0; i < 6; ++i)
         biquad.coefficients[i] = dummyValue;
 
-    int32_t success = MW_AFXUnit_Biquad_init(&biquad, biquadType, fs, fc, Q, gain, copyBuffer, copyBufferSize);
+    int32_t success = MW_AFXUnit_Biquad_init(&biquad, biquadType, fs, fc, Q, gain);
     if (!success)
         return 0;
     
@@ -312,6 +385,794 @@ static int32_t MW_AFXUnit_Biquad_lowShelfInitializationTests()
 }
 
 
+//  Magnitude response of a single CMSIS df2T stage at normalized frequency w
+static float32_t MW_AFXUnit_Biquad_magnitudeAt(float32_t *coefficients, float32_t w)
+{
+    float32_t b[3] = {coefficients[0], coefficients[1], coefficients[2]};
+    float32_t a[3] = {1.f, -coefficients[3], -coefficients[4]};
+    float32_t re = 0.f, im = 0.f, dre = 0.f, dim = 0.f;
+
+    for (int32_t k = 0; k < 3; ++k)
+    {
+        re += b[k] * cosf(w * k);
+        im -= b[k] * sinf(w * k);
+        dre += a[k] * cosf(w * k);
+        dim -= a[k] * sinf(w * k);
+    }
+
+    return sqrtf((re * re + im * im) / (dre * dre + dim * dim));
+}
+
+
+//  A low shelf applies its gain at DC and leaves Nyquist untouched, a high shelf the other way around
+static int32_t MW_AFXUnit_Biquad_shelfResponseTests()
+{
+    float32_t coefficients[6];
+    float32_t fs = 48000.f;
+    float32_t gains[4] = {12.f, 6.f, -6.f, -12.f};
+
+    for (int32_t i = 0; i < 4; ++i)
+    {
+        float32_t mu = powf(10.f, gains[i] / 20.f);
+
+        MW_AFXUnit_Biquad_calculateCoefficients(MW_BIQUAD_LOW_SHELF, coefficients, fs, 200.f, 0.707f, gains[i]);
+        if (fabsf(MW_AFXUnit_Biquad_magnitudeAt(coefficients, 0.f) - mu) > 1e-3f * mu)
+            return 0;
+
+        if (fabsf(MW_AFXUnit_Biquad_magnitudeAt(coefficients, PI) - 1.f) > 1e-3f)
+            return 0;
+
+        //  Well above the shelf frequency the response is close to flat
+        if (fabsf(MW_AFXUnit_Biquad_magnitudeAt(coefficients, 2.f * PI * 10000.f / fs) - 1.f) > 0.05f)
+            return 0;
+
+        MW_AFXUnit_Biquad_calculateCoefficients(MW_BIQUAD_HIGH_SHELF, coefficients, fs, 4000.f, 0.707f, gains[i]);
+        if (fabsf(MW_AFXUnit_Biquad_magnitudeAt(coefficients, 0.f) - 1.f) > 1e-3f)
+            return 0;
+
+        if (fabsf(MW_AFXUnit_Biquad_magnitudeAt(coefficients, PI) - mu) > 1e-3f * mu)
+            return 0;
+    }
+
+    return 1;
+}
+
+
+//  A BPF peaks at unity gain on its centre frequency and has its poles inside the unit circle
+static int32_t MW_AFXUnit_Biquad_bpfResponseTests()
+{
+    float32_t coefficients[6];
+    float32_t fs = 48000.f;
+    float32_t fcs[3] = {100.f, 1000.f, 10000.f};
+
+    for (int32_t i = 0; i < 3; ++i)
+    {
+        MW_AFXUnit_Biquad_calculateCoefficients(MW_BIQUAD_BPF, coefficients, fs, fcs[i], 2.f, 0.f);
+
+        if (fabsf(coefficients[4]) >= 1.f || fabsf(coefficients[3]) >= 1.f - coefficients[4])
+            return 0;
+
+        if (fabsf(MW_AFXUnit_Biquad_magnitudeAt(coefficients, 2.f * PI * fcs[i] / fs) - 1.f) > 1e-3f)
+            return 0;
+
+        if (MW_AFXUnit_Biquad_magnitudeAt(coefficients, 2.f * PI * 0.25f * fcs[i] / fs) > 0.5f)
+            return 0;
+    }
+
+    return 1;
+}
+
+
+static int32_t MW_AFXUnit_Biquad_cacheTests()
+{
+    MW_AFXUnit_BiquadCache cache;
+    float32_t fs = 48000.f;
+    float32_t cached[6];
+    float32_t designed[6];
+
+    if (MW_AFXUnit_BiquadCache_init(NULL, fs) || MW_AFXUnit_BiquadCache_init(&cache, 0.f))
+        return 0;
+
+    if (!MW_AFXUnit_BiquadCache_init(&cache, fs))
+        return 0;
+
+    //  A miss designs the coefficients from the quantized parameters, a repeated lookup hits
+    if (MW_AFXUnit_BiquadCache_calculateCoefficients(&cache, MW_BIQUAD_PARAM_EQ_CQ, cached, 1000.f, 1.5f, 3.f))
+        return 0;
+
+    MW_AFXUnit_Biquad_calculateCoefficients(MW_BIQUAD_PARAM_EQ_CQ, designed, fs, 1000.f, 1.5f, 3.f);
+    for (int32_t i = 0; i < 5; ++i)
+        if (cached[i] != designed[i])
+            return 0;
+
+    if (!MW_AFXUnit_BiquadCache_calculateCoefficients(&cache, MW_BIQUAD_PARAM_EQ_CQ, cached, 1000.f, 1.5f, 3.f))
+        return 0;
+
+    //  Values inside the same quantization step share an entry, a different type does not
+    if (!MW_AFXUnit_BiquadCache_calculateCoefficients(&cache, MW_BIQUAD_PARAM_EQ_CQ, cached, 1000.01f, 1.5001f, 3.001f))
+        return 0;
+
+    if (MW_AFXUnit_BiquadCache_calculateCoefficients(&cache, MW_BIQUAD_PARAM_EQ_NCQ, cached, 1000.f, 1.5f, 3.f))
+        return 0;
+
+    //  Fill the cache past its size while keeping the first entry in use; the second entry is the least recently used
+    for (int32_t i = 0; i < MW_AFXUNIT_BIQUADCACHE_SIZE; ++i)
+    {
+        MW_AFXUnit_BiquadCache_calculateCoefficients(&cache, MW_BIQUAD_LPF, cached, 100.f + 10.f * i, 0.707f, 0.f);
+        if (!MW_AFXUnit_BiquadCache_calculateCoefficients(&cache, MW_BIQUAD_PARAM_EQ_CQ, cached, 1000.f, 1.5f, 3.f))
+            return 0;
+    }
+
+    if (cache.numEntries != MW_AFXUNIT_BIQUADCACHE_SIZE)
+        return 0;
+
+    if (MW_AFXUnit_BiquadCache_calculateCoefficients(&cache, MW_BIQUAD_PARAM_EQ_NCQ, cached, 1000.f, 1.5f, 3.f))
+        return 0;
+
+    //  Cached parameter changes on biquads and cascades
+    MW_AFXUnit_Biquad biquad;
+    MW_AFXUnit_BiquadCascade cascade;
+    MW_AFXUnit_BiquadCache otherCache;
+
+    MW_AFXUnit_Biquad_init(&biquad, MW_BIQUAD_LPF, fs, 100.f, 0.707f, 0.f);
+    MW_AFXUnit_Biquad_changeParametersCached(&biquad, &cache, MW_BIQUAD_LOW_SHELF, 250.f, 0.707f, 6.f);
+    MW_AFXUnit_Biquad_calculateCoefficients(MW_BIQUAD_LOW_SHELF, designed, fs, 250.f, 0.707f, 6.f);
+    for (int32_t i = 0; i < 6; ++i)
+        if (biquad.coefficients[i] != designed[i])
+            return 0;
+
+    MW_AFXUnit_BiquadCascade_init(&cascade, 2, fs);
+    MW_AFXUnit_BiquadCache_init(&otherCache, 44100.f);
+    if (MW_AFXUnit_BiquadCascade_changeStageParametersCached(&cascade, &otherCache, 1, MW_BIQUAD_LOW_SHELF, 250.f, 0.707f, 6.f))
+        return 0;
+
+    if (MW_AFXUnit_BiquadCascade_changeStageParametersCached(&cascade, &cache, 2, MW_BIQUAD_LOW_SHELF, 250.f, 0.707f, 6.f))
+        return 0;
+
+    if (!MW_AFXUnit_BiquadCascade_changeStageParametersCached(&cascade, &cache, 1, MW_BIQUAD_LOW_SHELF, 250.f, 0.707f, 6.f))
+        return 0;
+
+    for (int32_t i = 0; i < 5; ++i)
+        if (cascade.coefficients[5 + i] != designed[i])
+            return 0;
+
+    return 1;
+}
+
+
+static int32_t MW_AFXUnit_Biquad_cascadeInitializationTests()
+{
+    MW_AFXUnit_BiquadCascade cascade;
+    float32_t fs = 44100.f;
+
+    if (MW_AFXUnit_BiquadCascade_init(NULL, 4, fs))
+        return 0;
+
+    if (MW_AFXUnit_BiquadCascade_init(&cascade, 0, fs) || MW_AFXUnit_BiquadCascade_init(&cascade, MW_AFXUNIT_BIQUADCASCADE_MAX_STAGES + 1, fs))
+        return 0;
+
+    if (MW_AFXUnit_BiquadCascade_init(&cascade, 4, 0.f))
+        return 0;
+
+    if (!MW_AFXUnit_BiquadCascade_init(&cascade, 4, fs))
+        return 0;
+
+    //  Untouched stages pass the signal through
+    float32_t buffer[8] = {1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f};
+    MW_AFXUnit_BiquadCascade_process(&cascade, buffer, 8);
+    for (int32_t i = 0; i < 8; ++i)
+        if (buffer[i] != (float32_t)(i + 1))
+            return 0;
+
+    if (MW_AFXUnit_BiquadCascade_changeStageParameters(&cascade, 4, MW_BIQUAD_LPF, 1000.f, 0.707f, 0.f))
+        return 0;
+
+    if (MW_AFXUnit_BiquadCascade_changeStageParameters(&cascade, 0, MW_BIQUAD_LPF, 30000.f, 0.707f, 0.f))
+        return 0;
+
+    if (MW_AFXUnit_BiquadCascade_changeStageParameters(&cascade, 0, MW_BIQUAD_LPF, 1000.f, 0.f, 0.f))
+        return 0;
+
+    if (MW_AFXUnit_BiquadCascade_changeStageParameters(&cascade, 0, MW_BIQUAD_NUM_TYPES, 1000.f, 0.707f, 0.f))
+        return 0;
+
+    if (!MW_AFXUnit_BiquadCascade_changeStageParameters(&cascade, 3, MW_BIQUAD_LPF, 1000.f, 0.707f, 0.f))
+        return 0;
+
+    if (cascade.filterTypes[3] != MW_BIQUAD_LPF || cascade.coefficients[15] == 1.f)
+        return 0;
+
+    return 1;
+}
+
+
+//  A cascade must match the same stages run as separate MW_AFXUnit_Biquad instances, including after a stage is changed
+static int32_t MW_AFXUnit_Biquad_cascadeProcessTests()
+{
+    MW_AFXUnit_BiquadCascade cascade;
+    MW_AFXUnit_Biquad biquads[6];
+    float32_t fs = 48000.f;
+    float32_t cascadeBuffer[64];
+    float32_t biquadBuffer[64];
+
+    if (!MW_AFXUnit_BiquadCascade_init(&cascade, 6, fs))
+        return 0;
+
+    for (int32_t i = 0; i < 6; ++i)
+    {
+        float32_t fc = 200.f * (i + 1);
+        if (!MW_AFXUnit_BiquadCascade_changeStageParameters(&cascade, i, CASCADE_STAGE_TYPES[i % 4], fc, 1.2f, 6.f))
+            return 0;
+
+        if (!MW_AFXUnit_Biquad_init(&biquads[i], CASCADE_STAGE_TYPES[i % 4], fs, fc, 1.2f, 6.f))
+            return 0;
+    }
+
+    int32_t t = 0;
+    for (int32_t block = 0; block < 8; ++block)
+    {
+        if (block == 4)
+        {
+            MW_AFXUnit_BiquadCascade_changeStageParameters(&cascade, 2, MW_BIQUAD_PARAM_EQ_NCQ, 3000.f, 2.f, -9.f);
+            MW_AFXUnit_Biquad_changeParameters(&biquads[2], MW_BIQUAD_PARAM_EQ_NCQ, 3000.f, 2.f, -9.f);
+        }
+
+        for (int32_t i = 0; i < 64; ++i, ++t)
+            cascadeBuffer[i] = biquadBuffer[i] = (t == 0) ? 1.f : 0.3f * arm_sin_f32(0.0173f * 2.f * PI * t);
+
+        MW_AFXUnit_BiquadCascade_process(&cascade, cascadeBuffer, 64);
+        for (int32_t i = 0; i < 6; ++i)
+            MW_AFXUnit_Biquad_process(&biquads[i], biquadBuffer, 64);
+
+        for (int32_t i = 0; i < 64; ++i)
+            if (!(fabsf(cascadeBuffer[i] - biquadBuffer[i]) <= 1e-5f))
+                return 0;
+    }
+
+    MW_AFXUnit_BiquadCascade_reset(&cascade);
+    for (int32_t i = 0; i < 12; ++i)
+        if (cascade.stateVariables[i] != 0.f)
+            return 0;
+
+    return 1;
+}
+
+
+/*
+ *  A cascade running as an FIR must match the same cascade running its biquads, follow parameter changes once the FIR has been
+ *  rebuilt, go back to the biquads when the response no longer fits in the FIR, and come back to the FIR when it does again
+ */
+static int32_t MW_AFXUnit_Biquad_convolutionTests()
+{
+    static MW_AFXUnit_BiquadConvolution convolution;
+    MW_AFXUnit_BiquadCascade cascade;
+    MW_AFXUnit_BiquadCascade reference;
+    float32_t buffer[MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE];
+    float32_t referenceBuffer[MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE];
+    float32_t fs = 48000.f;
+    int32_t numStages = 24;
+    int32_t rebuildPartitions = MW_AFXUNIT_BIQUADCONVOLUTION_NUM_PARTITIONS + 1;
+
+    if (MW_AFXUnit_BiquadCascade_init(&cascade, numStages, fs) == 0 || MW_AFXUnit_BiquadCascade_init(&reference, numStages, fs) == 0)
+        return 0;
+
+    if (MW_AFXUnit_BiquadCascade_enableConvolution(NULL, &convolution, MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE, MW_BIQUADCASCADE_PATH_AUTO) ||
+        MW_AFXUnit_BiquadCascade_enableConvolution(&cascade, NULL, MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE, MW_BIQUADCASCADE_PATH_AUTO) ||
+        MW_AFXUnit_BiquadCascade_enableConvolution(&cascade, &convolution, 0, MW_BIQUADCASCADE_PATH_AUTO) ||
+        MW_AFXUnit_BiquadCascade_enableConvolution(&cascade, &convolution, MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE, MW_BIQUADCASCADE_NUM_PATHS))
+        return 0;
+
+    float32_t fc = 100.f;
+    for (int32_t i = 0; i < numStages; ++i, fc *= 1.15f)
+    {
+        float32_t gain = (i % 2) ? -3.f : 3.f;
+        MW_AFXUnit_BiquadCascade_changeStageParameters(&cascade, i, MW_BIQUAD_PARAM_EQ_CQ, fc, 1.f, gain);
+        MW_AFXUnit_BiquadCascade_changeStageParameters(&reference, i, MW_BIQUAD_PARAM_EQ_CQ, fc, 1.f, gain);
+    }
+
+    //  The FIR only runs whole partitions, so block sizes that are not a multiple of the partition size keep the biquads
+    if (MW_AFXUnit_BiquadCascade_enableConvolution(&cascade, &convolution, 100, MW_BIQUADCASCADE_PATH_FIR))
+        return 0;
+
+    if (!MW_AFXUnit_BiquadCascade_enableConvolution(&cascade, &convolution, 100, MW_BIQUADCASCADE_PATH_AUTO) || convolution.useFIR)
+        return 0;
+
+    int32_t t = 0;
+    for (int32_t n = 0; n < 10; ++n)
+    {
+        for (int32_t i = 0; i < 100; ++i, ++t)
+            buffer[i] = referenceBuffer[i] = 0.3f * arm_sin_f32(0.0173f * 2.f * PI * t);
+
+        MW_AFXUnit_BiquadCascade_process(&cascade, buffer, 100);
+        MW_AFXUnit_BiquadCascade_process(&reference, referenceBuffer, 100);
+
+        for (int32_t i = 0; i < 100; ++i)
+            if (buffer[i] != referenceBuffer[i])
+                return 0;
+    }
+
+    MW_AFXUnit_BiquadCascade_reset(&reference);
+
+    if (!MW_AFXUnit_BiquadCascade_enableConvolution(&cascade, &convolution, MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE, MW_BIQUADCASCADE_PATH_FIR))
+        return 0;
+
+    if (!convolution.useFIR || !convolution.activeFIR)
+        return 0;
+
+    //  Partitions at which the parameters change, and from which the outputs must match again
+    int32_t shortChange = 8;
+    int32_t longChange = shortChange + rebuildPartitions + 8;
+    int32_t longChangeDone = longChange + rebuildPartitions + MW_AFXUNIT_BIQUADCONVOLUTION_NUM_PARTITIONS;
+    int32_t restore = longChangeDone + 400;
+    int32_t numPartitions = restore + rebuildPartitions + 8;
+
+    t = 0;
+    for (int32_t n = 0; n < numPartitions; ++n)
+    {
+        if (n == shortChange)
+        {
+            MW_AFXUnit_BiquadCascade_changeStageParameters(&cascade, 5, MW_BIQUAD_PARAM_EQ_CQ, 700.f, 2.f, 6.f);
+            MW_AFXUnit_BiquadCascade_changeStageParameters(&reference, 5, MW_BIQUAD_PARAM_EQ_CQ, 700.f, 2.f, 6.f);
+        }
+
+        //  Rings for much longer than the FIR
+        if (n == longChange)
+        {
+            MW_AFXUnit_BiquadCascade_changeStageParameters(&cascade, 0, MW_BIQUAD_LPF, 50.f, 10.f, 0.f);
+            MW_AFXUnit_BiquadCascade_changeStageParameters(&reference, 0, MW_BIQUAD_LPF, 50.f, 10.f, 0.f);
+        }
+
+        if (n == restore)
+        {
+            MW_AFXUnit_BiquadCascade_changeStageParameters(&cascade, 0, MW_BIQUAD_PARAM_EQ_CQ, 100.f, 1.f, 3.f);
+            MW_AFXUnit_BiquadCascade_changeStageParameters(&reference, 0, MW_BIQUAD_PARAM_EQ_CQ, 100.f, 1.f, 3.f);
+        }
+
+        for (int32_t i = 0; i < MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE; ++i, ++t)
+            buffer[i] = referenceBuffer[i] = (t == 0) ? 1.f : 0.3f * arm_sin_f32(0.0173f * 2.f * PI * t) + 0.2f * arm_sin_f32(0.0021f * 2.f * PI * t);
+
+        MW_AFXUnit_BiquadCascade_process(&cascade, buffer, MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE);
+        MW_AFXUnit_BiquadCascade_process(&reference, referenceBuffer, MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE);
+
+        if (n == longChangeDone && convolution.activeFIR)
+            return 0;
+
+        if (n == numPartitions - 1 && !convolution.activeFIR)
+            return 0;
+
+        int32_t settled = n < shortChange || (n >= shortChange + rebuildPartitions && n < longChange) ||
+                          (n >= restore - 8 && n < restore) || n >= restore + rebuildPartitions;
+
+        for (int32_t i = 0; settled && i < MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE; ++i)
+            if (!(fabsf(buffer[i] - referenceBuffer[i]) <= 1e-3f))
+                return 0;
+    }
+
+    //  The automatic choice keeps the cheaper of the two measured paths
+    if (!MW_AFXUnit_BiquadCascade_enableConvolution(&cascade, &convolution, MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE, MW_BIQUADCASCADE_PATH_AUTO))
+        return 0;
+
+    if (convolution.useFIR != (convolution.firCyclesPerSample < convolution.iirCyclesPerSample))
+        return 0;
+
+    return 1;
+}
+
+
+//  Parameters automated on every block must still reach the FIR: rebuilds finish and swap in while the changes keep coming
+static int32_t MW_AFXUnit_Biquad_convolutionAutomationTests()
+{
+    static MW_AFXUnit_BiquadConvolution convolution;
+    MW_AFXUnit_BiquadCascade cascade;
+    MW_AFXUnit_BiquadCascade reference;
+    float32_t buffer[MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE];
+    float32_t referenceBuffer[MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE];
+    float32_t fs = 48000.f;
+    int32_t numStages = 24;
+    int32_t rebuildPartitions = MW_AFXUNIT_BIQUADCONVOLUTION_NUM_PARTITIONS + 1;
+
+    if (MW_AFXUnit_BiquadCascade_init(&cascade, numStages, fs) == 0 || MW_AFXUnit_BiquadCascade_init(&reference, numStages, fs) == 0)
+        return 0;
+
+    float32_t fc = 100.f;
+    for (int32_t i = 0; i < numStages; ++i, fc *= 1.15f)
+    {
+        float32_t gain = (i % 2) ? -3.f : 3.f;
+        MW_AFXUnit_BiquadCascade_changeStageParameters(&cascade, i, MW_BIQUAD_PARAM_EQ_CQ, fc, 1.f, gain);
+        MW_AFXUnit_BiquadCascade_changeStageParameters(&reference, i, MW_BIQUAD_PARAM_EQ_CQ, fc, 1.f, gain);
+    }
+
+    if (!MW_AFXUnit_BiquadCascade_enableConvolution(&cascade, &convolution, MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE, MW_BIQUADCASCADE_PATH_FIR))
+        return 0;
+
+    //  The automation stops at automationEnd, and the outputs must match once the last change has been rebuilt into the FIR
+    int32_t automationEnd = 10 * rebuildPartitions;
+    int32_t settled = automationEnd + 2 * rebuildPartitions;
+    int32_t numPartitions = settled + 8;
+    int32_t numSwaps = 0;
+
+    int32_t t = 0;
+    for (int32_t n = 0; n < numPartitions; ++n)
+    {
+        if (n < automationEnd)
+        {
+            float32_t gain = 6.f * arm_sin_f32(2.f * PI * n / 64.f);
+            MW_AFXUnit_BiquadCascade_changeStageParameters(&cascade, 5, MW_BIQUAD_PARAM_EQ_CQ, 700.f, 2.f, gain);
+            MW_AFXUnit_BiquadCascade_changeStageParameters(&reference, 5, MW_BIQUAD_PARAM_EQ_CQ, 700.f, 2.f, gain);
+        }
+
+        for (int32_t i = 0; i < MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE; ++i, ++t)
+            buffer[i] = referenceBuffer[i] = 0.3f * arm_sin_f32(0.0173f * 2.f * PI * t) + 0.2f * arm_sin_f32(0.0021f * 2.f * PI * t);
+
+        int32_t spectra = convolution.currentSpectra;
+        MW_AFXUnit_BiquadCascade_process(&cascade, buffer, MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE);
+        MW_AFXUnit_BiquadCascade_process(&reference, referenceBuffer, MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE);
+
+        if (n < automationEnd && convolution.currentSpectra != spectra)
+            numSwaps++;
+
+        for (int32_t i = 0; n >= settled && i < MW_AFXUNIT_BIQUADCONVOLUTION_PARTITION_SIZE; ++i)
+            if (!(fabsf(buffer[i] - referenceBuffer[i]) <= 1e-3f))
+                return 0;
+    }
+
+    //  One rebuild completes every rebuildPartitions partitions
+    if (numSwaps < automationEnd / rebuildPartitions - 1)
+        return 0;
+
+    return convolution.activeFIR && convolution.buildPartition < 0 && !convolution.rebuildPending;
+}
+
+static int32_t MW_AFXUnit_Biquad_modulationTests()
+{
+    MW_AFXUnit_Biquad biquad;
+    MW_AFXUnit_Biquad reference;
+    float32_t fs = 48000.f;
+    float32_t buffer[64];
+    float32_t referenceBuffer[64];
+
+    MW_AFXUnit_Biquad_init(&biquad, MW_BIQUAD_PARAM_EQ_CQ, fs, 1000.f, 1.f, 6.f);
+    MW_AFXUnit_Biquad_init(&reference, MW_BIQUAD_PARAM_EQ_CQ, fs, 1000.f, 1.f, 6.f);
+
+    if (MW_AFXUnit_Biquad_enableModulation(NULL, 64))
+        return 0;
+
+    if (MW_AFXUnit_Biquad_enableModulation(&biquad, -MW_AFXUNIT_BIQUAD_MODULATION_STEP) || MW_AFXUnit_Biquad_enableModulation(&biquad, MW_AFXUNIT_BIQUAD_MODULATION_STEP + 1))
+        return 0;
+
+    if (!MW_AFXUnit_Biquad_enableModulation(&biquad, 64))
+        return 0;
+
+    //  Without parameter changes, a modulated biquad is the same filter
+    for (int32_t i = 0; i < 64; ++i)
+        buffer[i] = referenceBuffer[i] = arm_sin_f32(0.1f * i);
+
+    MW_AFXUnit_Biquad_process(&biquad, buffer, 23);
+    MW_AFXUnit_Biquad_process(&biquad, buffer + 23, 41);
+    MW_AFXUnit_Biquad_process(&reference, referenceBuffer, 64);
+    for (int32_t i = 0; i < 64; ++i)
+        if (!(fabsf(buffer[i] - referenceBuffer[i]) <= 1e-6f))
+            return 0;
+
+    //  Parameter changes only take effect at the next control update, and the filter reaches them one control interval later
+    float32_t target[6];
+    MW_AFXUnit_Biquad_calculateCoefficients(MW_BIQUAD_LPF, target, fs, 3000.f, 2.f, 0.f);
+
+    MW_AFXUnit_Biquad_modulateParameters(&biquad, MW_BIQUAD_LPF, 8000.f, 0.7f, 0.f);
+    MW_AFXUnit_Biquad_modulateParameters(&biquad, MW_BIQUAD_LPF, 3000.f, 2.f, 0.f);
+    if (biquad.coefficients[0] != reference.coefficients[0])
+        return 0;
+
+    //  Mid-ramp, the feedback coefficients stay those of a stable filter
+    MW_AFXUnit_Biquad_process(&biquad, buffer, 37);
+    if (biquad.modulation.stepsLeft == 0 || fabsf(biquad.coefficients[4]) >= 1.f || fabsf(biquad.coefficients[3]) >= 1.f - biquad.coefficients[4])
+        return 0;
+
+    MW_AFXUnit_Biquad_process(&biquad, buffer, 27);
+    for (int32_t i = 0; i < 5; ++i)
+        if (fabsf(biquad.coefficients[i] - target[i]) > 1e-5f)
+            return 0;
+
+    //  Disabling the modulation mode keeps the current filter
+    if (!MW_AFXUnit_Biquad_enableModulation(&biquad, 0))
+        return 0;
+
+    MW_AFXUnit_Biquad_changeParameters(&biquad, MW_BIQUAD_HPF, 500.f, 0.707f, 0.f);
+    MW_AFXUnit_Biquad_calculateCoefficients(MW_BIQUAD_HPF, target, fs, 500.f, 0.707f, 0.f);
+    MW_AFXUnit_Biquad_process(&biquad, buffer, 64);
+    if (biquad.coefficients[0] != target[0])
+        return 0;
+
+    return 1;
+}
+
+
+//  Modulating a resonant filter across the whole spectrum on every sample must not blow up
+static int32_t MW_AFXUnit_Biquad_modulationStabilityTests()
+{
+    MW_AFXUnit_Biquad biquad;
+    float32_t fs = 48000.f;
+    float32_t sample;
+    uint32_t seed = 1;
+
+    MW_AFXUnit_Biquad_init(&biquad, MW_BIQUAD_LPF, fs, 1000.f, 10.f, 0.f);
+    MW_AFXUnit_Biquad_enableModulation(&biquad, MW_AFXUNIT_BIQUAD_MODULATION_STEP);
+
+    for (int32_t n = 0; n < 48000; ++n)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        float32_t fc = (n & 1) ? 20.f : 20000.f;
+        float32_t Q = 0.5f + 9.5f * (float32_t)(seed >> 8) / 16777216.f;
+
+        MW_AFXUnit_Biquad_modulateParameters(&biquad, (n & 256) ? MW_BIQUAD_BPF : MW_BIQUAD_LPF, fc, Q, 0.f);
+
+        sample = (float32_t)(seed >> 8) / 8388608.f - 1.f;
+        MW_AFXUnit_Biquad_process(&biquad, &sample, 1);
+
+        if (!(fabsf(sample) < 100.f))
+            return 0;
+    }
+
+    return 1;
+}
+
+
+//  Each channel of an interleaved biquad must match a mono biquad run on that channel alone
+static int32_t MW_AFXUnit_Biquad_interleavedTests()
+{
+    MW_AFXUnit_InterleavedBiquad biquad;
+    MW_AFXUnit_Biquad mono[MW_AFXUNIT_INTERLEAVEDBIQUAD_MAX_CHANNELS];
+    float32_t fs = 48000.f;
+    float32_t interleaved[48 * MW_AFXUNIT_INTERLEAVEDBIQUAD_MAX_CHANNELS];
+    float32_t expected[48 * MW_AFXUNIT_INTERLEAVEDBIQUAD_MAX_CHANNELS];
+    float32_t channel[48];
+
+    if (MW_AFXUnit_InterleavedBiquad_init(NULL, 2, MW_BIQUAD_LPF, fs, 1000.f, 0.707f, 0.f))
+        return 0;
+
+    if (MW_AFXUnit_InterleavedBiquad_init(&biquad, 3, MW_BIQUAD_LPF, fs, 1000.f, 0.707f, 0.f) || MW_AFXUnit_InterleavedBiquad_init(&biquad, 16, MW_BIQUAD_LPF, fs, 1000.f, 0.707f, 0.f))
+        return 0;
+
+    if (MW_AFXUnit_InterleavedBiquad_init(&biquad, 2, MW_BIQUAD_LPF, fs, 30000.f, 0.707f, 0.f) || MW_AFXUnit_InterleavedBiquad_init(&biquad, 2, MW_BIQUAD_LPF, fs, 1000.f, 0.f, 0.f))
+        return 0;
+
+    for (int32_t numChannels = 2; numChannels <= MW_AFXUNIT_INTERLEAVEDBIQUAD_MAX_CHANNELS; numChannels *= 2)
+    {
+        if (!MW_AFXUnit_InterleavedBiquad_init(&biquad, numChannels, MW_BIQUAD_PARAM_EQ_CQ, fs, 2000.f, 1.5f, 9.f))
+            return 0;
+
+        for (int32_t c = 0; c < numChannels; ++c)
+            MW_AFXUnit_Biquad_init(&mono[c], MW_BIQUAD_PARAM_EQ_CQ, fs, 2000.f, 1.5f, 9.f);
+
+        for (int32_t block = 0; block < 4; ++block)
+        {
+            if (block == 2)
+            {
+                MW_AFXUnit_InterleavedBiquad_changeParameters(&biquad, MW_BIQUAD_HIGH_SHELF, 4000.f, 0.707f, -6.f);
+                for (int32_t c = 0; c < numChannels; ++c)
+                    MW_AFXUnit_Biquad_changeParameters(&mono[c], MW_BIQUAD_HIGH_SHELF, 4000.f, 0.707f, -6.f);
+            }
+
+            //  Every channel gets a different signal, starting with an impulse of a different height
+            size_t numFrames = 48 - 11 * block;
+            for (size_t n = 0; n < numFrames; ++n)
+                for (int32_t c = 0; c < numChannels; ++c)
+                    interleaved[n * numChannels + c] = arm_sin_f32((0.05f + 0.1f * c) * (float32_t)(n + 48 * block)) + ((n == 0 && block == 0) ? (float32_t)(c + 1) : 0.f);
+
+            for (int32_t c = 0; c < numChannels; ++c)
+            {
+                for (size_t n = 0; n < numFrames; ++n)
+                    channel[n] = interleaved[n * numChannels + c];
+
+                MW_AFXUnit_Biquad_process(&mono[c], channel, numFrames);
+
+                for (size_t n = 0; n < numFrames; ++n)
+                    expected[n * numChannels + c] = channel[n];
+            }
+
+            MW_AFXUnit_InterleavedBiquad_process(&biquad, interleaved, numFrames);
+
+            for (size_t i = 0; i < numFrames * numChannels; ++i)
+                if (!(fabsf(interleaved[i] - expected[i]) <= 1e-5f))
+                    return 0;
+        }
+
+        MW_AFXUnit_InterleavedBiquad_reset(&biquad);
+        for (int32_t i = 0; i < 2 * MW_AFXUNIT_INTERLEAVEDBIQUAD_MAX_CHANNELS; ++i)
+            if (biquad.stateVariables[i] != 0.f)
+                return 0;
+    }
+
+    return 1;
+}
+#define FIXED_POINT_TEST_LENGTH 2048
+
+//  Test signal with 12 dB of headroom for the boosting filters of the fixed point tests
+static float32_t MW_AFXUnit_Biquad_fixedPointTestSignal(int32_t n)
+{
+    return 0.125f * arm_sin_f32(2.f * PI * 97.f * n / 48000.f) + 0.125f * arm_sin_f32(2.f * PI * 2203.f * n / 48000.f);
+}
+
+
+/*
+ *  Run a fixed point biquad on the test signal and measure its SNR (dB) against the same filter in float
+ *  The first 128 samples (start up transient) are skipped
+ */
+static float32_t MW_AFXUnit_Biquad_fixedPointSNR(MW_AFXUnit_BiquadFormat format, MW_AFXUnit_BiquadType filterType, float32_t fc, float32_t Q, float32_t gain)
+{
+    MW_AFXUnit_Biquad reference;
+    MW_AFXUnit_Biquad biquad;
+    static float32_t referenceBuffer[FIXED_POINT_TEST_LENGTH];
+    static float32_t output[FIXED_POINT_TEST_LENGTH];
+    static q31_t bufferQ31[FIXED_POINT_TEST_LENGTH];
+    static q15_t bufferQ15[FIXED_POINT_TEST_LENGTH];
+
+    MW_AFXUnit_Biquad_init(&reference, filterType, 48000.f, fc, Q, gain);
+    if (!MW_AFXUnit_Biquad_init_format(&biquad, format, filterType, 48000.f, fc, Q, gain))
+        return 0.f;
+
+    for (int32_t n = 0; n < FIXED_POINT_TEST_LENGTH; ++n)
+        referenceBuffer[n] = MW_AFXUnit_Biquad_fixedPointTestSignal(n);
+
+    if (format == MW_BIQUAD_FORMAT_Q15)
+    {
+        arm_float_to_q15(referenceBuffer, bufferQ15, FIXED_POINT_TEST_LENGTH);
+        MW_AFXUnit_Biquad_process_q15(&biquad, bufferQ15, FIXED_POINT_TEST_LENGTH);
+        arm_q15_to_float(bufferQ15, output, FIXED_POINT_TEST_LENGTH);
+    }
+    else
+    {
+        arm_float_to_q31(referenceBuffer, bufferQ31, FIXED_POINT_TEST_LENGTH);
+        MW_AFXUnit_Biquad_process_q31(&biquad, bufferQ31, FIXED_POINT_TEST_LENGTH);
+        arm_q31_to_float(bufferQ31, output, FIXED_POINT_TEST_LENGTH);
+    }
+
+    MW_AFXUnit_Biquad_process(&reference, referenceBuffer, FIXED_POINT_TEST_LENGTH);
+
+    float32_t signalPower = 0.f;
+    float32_t noisePower = 0.f;
+    for (int32_t n = 128; n < FIXED_POINT_TEST_LENGTH; ++n)
+    {
+        float32_t error = output[n] - referenceBuffer[n];
+        signalPower += referenceBuffer[n] * referenceBuffer[n];
+        noisePower += error * error;
+    }
+
+    if (noisePower == 0.f)
+        return 200.f;
+
+    return 10.f * log10f(signalPower / noisePower);
+}
+
+
+static int32_t MW_AFXUnit_Biquad_fixedPointTests()
+{
+    MW_AFXUnit_Biquad biquad;
+
+    if (MW_AFXUnit_Biquad_init_format(&biquad, MW_BIQUAD_NUM_FORMATS, MW_BIQUAD_LPF, 48000.f, 1000.f, 0.707f, 0.f))
+        return 0;
+
+    if (MW_AFXUnit_Biquad_init_format(&biquad, MW_BIQUAD_FORMAT_Q31, MW_BIQUAD_LPF, 48000.f, 30000.f, 0.707f, 0.f))
+        return 0;
+
+    //  Coefficients above 1 (the a1 of a LPF is close to 2) need a postShift
+    if (!MW_AFXUnit_Biquad_init_format(&biquad, MW_BIQUAD_FORMAT_Q31, MW_BIQUAD_LPF, 48000.f, 1000.f, 0.707f, 0.f))
+        return 0;
+
+    if (biquad.instanceQ31.postShift != 1 || biquad.format != MW_BIQUAD_FORMAT_Q31)
+        return 0;
+
+    if (MW_AFXUnit_Biquad_enableModulation(&biquad, 64))
+        return 0;
+
+    //  Changing parameters requantizes
+    q31_t b0 = biquad.coefficientsQ31[0];
+    MW_AFXUnit_Biquad_changeParameters(&biquad, MW_BIQUAD_LPF, 2000.f, 0.707f, 0.f);
+    if (biquad.coefficientsQ31[0] == b0)
+        return 0;
+
+    //  SNR against the float filter (which is itself only accurate to about 120 dB).  The 32x64 kernel keeps its feedback state
+    //  in 64 bits, which matters most for low cutoffs (poles close to z = 1)
+    if (MW_AFXUnit_Biquad_fixedPointSNR(MW_BIQUAD_FORMAT_Q31, MW_BIQUAD_LPF, 1000.f, 0.707f, 0.f) < 100.f)
+        return 0;
+
+    if (MW_AFXUnit_Biquad_fixedPointSNR(MW_BIQUAD_FORMAT_Q31, MW_BIQUAD_PARAM_EQ_CQ, 2000.f, 2.f, 9.f) < 100.f)
+        return 0;
+
+    if (MW_AFXUnit_Biquad_fixedPointSNR(MW_BIQUAD_FORMAT_Q31_32X64, MW_BIQUAD_LPF, 1000.f, 0.707f, 0.f) < 100.f)
+        return 0;
+
+    if (MW_AFXUnit_Biquad_fixedPointSNR(MW_BIQUAD_FORMAT_Q31_32X64, MW_BIQUAD_LPF, 50.f, 0.707f, 0.f) <= MW_AFXUnit_Biquad_fixedPointSNR(MW_BIQUAD_FORMAT_Q31, MW_BIQUAD_LPF, 50.f, 0.707f, 0.f))
+        return 0;
+
+    //  Q15 coefficients limit the accuracy of anything but gentle filters well above the bass range
+    if (MW_AFXUnit_Biquad_fixedPointSNR(MW_BIQUAD_FORMAT_Q15, MW_BIQUAD_LPF, 1000.f, 0.707f, 0.f) < 30.f)
+        return 0;
+
+    if (MW_AFXUnit_Biquad_fixedPointSNR(MW_BIQUAD_FORMAT_Q15, MW_BIQUAD_HIGH_SHELF, 4000.f, 0.707f, 6.f) < 60.f)
+        return 0;
+
+    return 1;
+}
+
+
+//  Frequency response of one stage at w, the scalar way (double precision, per stage trig)
+static void MW_AFXUnit_Biquad_referenceResponse(const float32_t *c, double w, double *re, double *im)
+{
+    double numRe = c[0] + c[1] * cos(w) + c[2] * cos(2.0 * w);
+    double numIm = -(c[1] * sin(w) + c[2] * sin(2.0 * w));
+    double denRe = 1.0 - c[3] * cos(w) - c[4] * cos(2.0 * w);
+    double denIm = c[3] * sin(w) + c[4] * sin(2.0 * w);
+    double denSq = denRe * denRe + denIm * denIm;
+
+    *re = (numRe * denRe + numIm * denIm) / denSq;
+    *im = (numIm * denRe - numRe * denIm) / denSq;
+}
+
+
+static int32_t MW_AFXUnit_Biquad_responseTests()
+{
+    MW_AFXUnit_BiquadCascade cascade;
+    float32_t fs = 48000.f;
+    float32_t frequencies[100];
+    float32_t magnitude[100];
+    float32_t phase[100];
+
+    //  Cascade of different types, evaluated on a log grid from 20 Hz to 20 kHz (not a multiple of the block size)
+    MW_AFXUnit_BiquadCascade_init(&cascade, 5, fs);
+    MW_AFXUnit_BiquadCascade_changeStageParameters(&cascade, 0, MW_BIQUAD_HPF, 40.f, 0.707f, 0.f);
+    MW_AFXUnit_BiquadCascade_changeStageParameters(&cascade, 1, MW_BIQUAD_LOW_SHELF, 200.f, 0.707f, 4.f);
+    MW_AFXUnit_BiquadCascade_changeStageParameters(&cascade, 2, MW_BIQUAD_PARAM_EQ_CQ, 1000.f, 3.f, -8.f);
+    MW_AFXUnit_BiquadCascade_changeStageParameters(&cascade, 3, MW_BIQUAD_PARAM_EQ_NCQ, 4000.f, 1.f, 5.f);
+    MW_AFXUnit_BiquadCascade_changeStageParameters(&cascade, 4, MW_BIQUAD_LPF, 15000.f, 0.9f, 0.f);
+
+    for (int32_t i = 0; i < 100; ++i)
+        frequencies[i] = 20.f * powf(1000.f, i / 99.f);
+
+    MW_AFXUnit_Biquad_response(cascade.coefficients, 5, fs, frequencies, magnitude, phase, 100);
+
+    for (int32_t i = 0; i < 100; ++i)
+    {
+        double w = 2.0 * PI * frequencies[i] / fs;
+        double re = 1.0, im = 0.0;
+        for (int32_t stage = 0; stage < 5; ++stage)
+        {
+            double hRe, hIm;
+            MW_AFXUnit_Biquad_referenceResponse(&cascade.coefficients[5 * stage], w, &hRe, &hIm);
+
+            double productRe = re * hRe - im * hIm;
+            im = re * hIm + im * hRe;
+            re = productRe;
+        }
+
+        double expectedMagnitude = sqrt(re * re + im * im);
+        double expectedPhase = atan2(im, re);
+        double phaseError = fabs(phase[i] - expectedPhase);
+        if (phaseError > PI)
+            phaseError = 2.0 * PI - phaseError;
+
+        if (!(fabs(magnitude[i] - expectedMagnitude) <= 1e-4 * expectedMagnitude) || !(phaseError <= 1e-4))
+            return 0;
+    }
+
+    //  Single MW_AFXUnit_Biquad: a peaking EQ has its gain at fc, and phase is optional
+    MW_AFXUnit_Biquad biquad;
+    float32_t fc = 2500.f;
+    MW_AFXUnit_Biquad_init(&biquad, MW_BIQUAD_PARAM_EQ_CQ, fs, fc, 2.f, 6.f);
+    MW_AFXUnit_Biquad_response(biquad.coefficients, 1, fs, &fc, magnitude, NULL, 1);
+    if (fabsf(magnitude[0] - powf(10.f, 6.f / 20.f)) > 1e-3f)
+        return 0;
+
+    //  Phase only
+    magnitude[0] = -1.f;
+    MW_AFXUnit_Biquad_response(biquad.coefficients, 1, fs, &fc, NULL, phase, 1);
+    if (fabsf(phase[0]) > 1e-3f)
+        return 0;
+
+    return 1;
+}
+
+
 
 int32_t MW_AFXUnit_Biquad_runUnitTests()
 {
@@ -330,8 +1191,432 @@ int32_t MW_AFXUnit_Biquad_runUnitTests()
     if (!MW_AFXUnit_Biquad_bpfInitializationTests())
         return 0;
 
-    // if (!MW_AFXUnit_Biquad_lowShelfInitializationTests())
-    //     return 0;
+    if (!MW_AFXUnit_Biquad_lowShelfInitializationTests())
+        return 0;
+
+    if (!MW_AFXUnit_Biquad_highShelfInitializationTests())
+        return 0;
+
+    if (!MW_AFXUnit_Biquad_shelfResponseTests())
+        return 0;
+
+    if (!MW_AFXUnit_Biquad_bpfResponseTests())
+        return 0;
+
+    if (!MW_AFXUnit_Biquad_cacheTests())
+        return 0;
+
+    if (!MW_AFXUnit_Biquad_modulationTests())
+        return 0;
+
+    if (!MW_AFXUnit_Biquad_modulationStabilityTests())
+        return 0;
+
+    if (!MW_AFXUnit_Biquad_interleavedTests())
+        return 0;
+
+    if (!MW_AFXUnit_Biquad_fixedPointTests())
+        return 0;
+
+    if (!MW_AFXUnit_Biquad_responseTests())
+        return 0;
+
+    if (!MW_AFXUnit_Biquad_cascadeInitializationTests())
+        return 0;
+
+    if (!MW_AFXUnit_Biquad_cascadeProcessTests())
+        return 0;
+
+    if (!MW_AFXUnit_Biquad_convolutionTests())
+        return 0;
+
+    if (!MW_AFXUnit_Biquad_convolutionAutomationTests())
+        return 0;
 
     return 1;
-}
\ No newline at end of file
+}
+
+
+
+/*
+ *  Compare N separate MW_AFXUnit_Biquad instances (N calls and N passes over the buffer) against a MW_AFXUnit_BiquadCascade
+ *  with the same N stages, for N = 1 to MW_AFXUNIT_BIQUADCASCADE_MAX_STAGES
+ *
+ *  Returns:
+ *    Number of results written (N is the number of stages)
+ */
+size_t MW_AFXUnit_BiquadCascade_runBenchmarks(MW_UnitTest_BenchmarkResult *results, size_t maxResults)
+{
+    float32_t block[BENCHMARK_BLOCK_SIZE];
+    MW_AFXUnit_Biquad biquads[MW_AFXUNIT_BIQUADCASCADE_MAX_STAGES];
+    MW_AFXUnit_BiquadCascade cascade;
+    float32_t fs = 48000.f;
+    size_t numResults = 0;
+
+    for (int32_t N = 1; N <= MW_AFXUNIT_BIQUADCASCADE_MAX_STAGES && numResults < maxResults; ++N)
+    {
+        MW_AFXUnit_BiquadCascade_init(&cascade, N, fs);
+        for (int32_t i = 0; i < N; ++i)
+        {
+            float32_t fc = 100.f * (i + 1);
+            MW_AFXUnit_Biquad_init(&biquads[i], CASCADE_STAGE_TYPES[i % 4], fs, fc, 0.9f, 3.f);
+            MW_AFXUnit_BiquadCascade_changeStageParameters(&cascade, i, CASCADE_STAGE_TYPES[i % 4], fc, 0.9f, 3.f);
+        }
+
+        arm_fill_f32(0.5f, block, BENCHMARK_BLOCK_SIZE);
+
+        uint32_t start = MW_AFXUnit_Utils_getCycleCount();
+        for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+            for (int32_t i = 0; i < N; ++i)
+                MW_AFXUnit_Biquad_process(&biquads[i], block, BENCHMARK_BLOCK_SIZE);
+        uint32_t biquadCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        arm_fill_f32(0.5f, block, BENCHMARK_BLOCK_SIZE);
+
+        start = MW_AFXUnit_Utils_getCycleCount();
+        for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+            MW_AFXUnit_BiquadCascade_process(&cascade, block, BENCHMARK_BLOCK_SIZE);
+        uint32_t cascadeCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        results[numResults].N = N;
+        results[numResults].referenceCyclesPerSample = (float32_t)biquadCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+        results[numResults].cyclesPerSample = (float32_t)cascadeCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+        numResults++;
+    }
+
+    return numResults;
+}
+
+
+
+/*
+ *  Compare a MW_AFXUnit_BiquadCascade running its biquads against the same cascade running as an FIR, for 8 to
+ *  MW_AFXUNIT_BIQUADCASCADE_MAX_STAGES stages.  The FIR costs the same for any number of stages
+ *
+ *  Returns:
+ *    Number of results written (N is the number of stages)
+ */
+size_t MW_AFXUnit_BiquadCascade_runConvolutionBenchmarks(MW_UnitTest_BenchmarkResult *results, size_t maxResults)
+{
+    static MW_AFXUnit_BiquadConvolution convolution;
+    float32_t block[BENCHMARK_BLOCK_SIZE];
+    MW_AFXUnit_BiquadCascade cascade;
+    MW_AFXUnit_BiquadCascade firCascade;
+    float32_t fs = 48000.f;
+    size_t numResults = 0;
+
+    for (int32_t N = 8; N <= MW_AFXUNIT_BIQUADCASCADE_MAX_STAGES && numResults < maxResults; N += 8)
+    {
+        MW_AFXUnit_BiquadCascade_init(&cascade, N, fs);
+        MW_AFXUnit_BiquadCascade_init(&firCascade, N, fs);
+        for (int32_t i = 0; i < N; ++i)
+        {
+            float32_t fc = 100.f * (i + 1);
+            MW_AFXUnit_BiquadCascade_changeStageParameters(&cascade, i, MW_BIQUAD_PARAM_EQ_CQ, fc, 0.9f, 3.f);
+            MW_AFXUnit_BiquadCascade_changeStageParameters(&firCascade, i, MW_BIQUAD_PARAM_EQ_CQ, fc, 0.9f, 3.f);
+        }
+
+        MW_AFXUnit_BiquadCascade_enableConvolution(&firCascade, &convolution, BENCHMARK_BLOCK_SIZE, MW_BIQUADCASCADE_PATH_FIR);
+
+        arm_fill_f32(0.5f, block, BENCHMARK_BLOCK_SIZE);
+
+        uint32_t start = MW_AFXUnit_Utils_getCycleCount();
+        for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+            MW_AFXUnit_BiquadCascade_process(&cascade, block, BENCHMARK_BLOCK_SIZE);
+        uint32_t iirCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        arm_fill_f32(0.5f, block, BENCHMARK_BLOCK_SIZE);
+
+        start = MW_AFXUnit_Utils_getCycleCount();
+        for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+            MW_AFXUnit_BiquadCascade_process(&firCascade, block, BENCHMARK_BLOCK_SIZE);
+        uint32_t firCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        results[numResults].N = N;
+        results[numResults].referenceCyclesPerSample = (float32_t)iirCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+        results[numResults].cyclesPerSample = (float32_t)firCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+        numResults++;
+    }
+
+    return numResults;
+}
+
+
+
+/*
+ *  Sweep the gain of MW_UNITTEST_BIQUADCACHE_NUM_BANDS bands of EQ, one parameter change per band per sample, as automation would.
+ *  The same sweep is played twice (as when an automation lane loops), first without and then with a coefficient cache
+ *
+ *  Returns:
+ *      Number of results written (N is the number of bands, cycles are per parameter change)
+ */
+size_t MW_AFXUnit_BiquadCache_runBenchmarks(MW_UnitTest_BenchmarkResult *results, size_t maxResults)
+{
+    static MW_AFXUnit_BiquadCache cache;
+    MW_AFXUnit_BiquadCascade cascade[MW_UNITTEST_BIQUADCACHE_NUM_BANDS / MW_AFXUNIT_BIQUADCASCADE_MAX_STAGES];
+    float32_t fs = 48000.f;
+    int32_t numSweepSteps = 16;
+    int32_t numChanges = 2 * numSweepSteps * MW_UNITTEST_BIQUADCACHE_NUM_BANDS;
+
+    if (maxResults == 0)
+        return 0;
+
+    MW_AFXUnit_BiquadCache_init(&cache, fs);
+    for (int32_t c = 0; c < MW_UNITTEST_BIQUADCACHE_NUM_BANDS / MW_AFXUNIT_BIQUADCASCADE_MAX_STAGES; ++c)
+        MW_AFXUnit_BiquadCascade_init(&cascade[c], MW_AFXUNIT_BIQUADCASCADE_MAX_STAGES, fs);
+
+    //  Only the first band is swept, so the cache has to hold the sweep of a single band
+    uint32_t start = MW_AFXUnit_Utils_getCycleCount();
+    for (int32_t pass = 0; pass < 2; ++pass)
+        for (int32_t step = 0; step < numSweepSteps; ++step)
+            for (int32_t band = 0; band < MW_UNITTEST_BIQUADCACHE_NUM_BANDS; ++band)
+                MW_AFXUnit_BiquadCascade_changeStageParameters(&cascade[band / MW_AFXUNIT_BIQUADCASCADE_MAX_STAGES], band % MW_AFXUNIT_BIQUADCASCADE_MAX_STAGES,
+                                                               MW_BIQUAD_PARAM_EQ_CQ, 60.f * (band + 1), 1.4f, (band == 0) ? 0.5f * step : 3.f);
+    uint32_t designCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+    start = MW_AFXUnit_Utils_getCycleCount();
+    for (int32_t pass = 0; pass < 2; ++pass)
+        for (int32_t step = 0; step < numSweepSteps; ++step)
+            for (int32_t band = 0; band < MW_UNITTEST_BIQUADCACHE_NUM_BANDS; ++band)
+                MW_AFXUnit_BiquadCascade_changeStageParametersCached(&cascade[band / MW_AFXUNIT_BIQUADCASCADE_MAX_STAGES], &cache, band % MW_AFXUNIT_BIQUADCASCADE_MAX_STAGES,
+                                                                     MW_BIQUAD_PARAM_EQ_CQ, 60.f * (band + 1), 1.4f, (band == 0) ? 0.5f * step : 3.f);
+    uint32_t cachedCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+    results[0].N = MW_UNITTEST_BIQUADCACHE_NUM_BANDS;
+    results[0].referenceCyclesPerSample = (float32_t)designCycles / numChanges;
+    results[0].cyclesPerSample = (float32_t)cachedCycles / numChanges;
+
+    return 1;
+}
+
+
+
+/*
+ *  Automate the cutoff of a LPF with a new value every MW_AFXUNIT_BIQUAD_MODULATION_STEP samples.  The reference redesigns the filter
+ *  for every new value (stepped, clicking automation), the modulated biquad is run with control intervals K = 16 to 256
+ *
+ *  Returns:
+ *      Number of results written (N is the control interval K)
+ */
+size_t MW_AFXUnit_Biquad_runModulationBenchmarks(MW_UnitTest_BenchmarkResult *results, size_t maxResults)
+{
+    float32_t block[BENCHMARK_BLOCK_SIZE];
+    MW_AFXUnit_Biquad biquad;
+    float32_t fs = 48000.f;
+    size_t numResults = 0;
+
+    MW_AFXUnit_Biquad_init(&biquad, MW_BIQUAD_LPF, fs, 1000.f, 2.f, 0.f);
+    arm_fill_f32(0.5f, block, BENCHMARK_BLOCK_SIZE);
+
+    uint32_t start = MW_AFXUnit_Utils_getCycleCount();
+    for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+    {
+        for (int32_t i = 0; i < BENCHMARK_BLOCK_SIZE; i += MW_AFXUNIT_BIQUAD_MODULATION_STEP)
+        {
+            MW_AFXUnit_Biquad_changeParameters(&biquad, MW_BIQUAD_LPF, 1000.f + 10.f * ((n + i) & 63), 2.f, 0.f);
+            MW_AFXUnit_Biquad_process(&biquad, block + i, MW_AFXUNIT_BIQUAD_MODULATION_STEP);
+        }
+    }
+    uint32_t steppedCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+    for (int32_t K = MW_AFXUNIT_BIQUAD_MODULATION_STEP; K <= 256 && numResults < maxResults; K *= 2)
+    {
+        MW_AFXUnit_Biquad_init(&biquad, MW_BIQUAD_LPF, fs, 1000.f, 2.f, 0.f);
+        MW_AFXUnit_Biquad_enableModulation(&biquad, K);
+        arm_fill_f32(0.5f, block, BENCHMARK_BLOCK_SIZE);
+
+        start = MW_AFXUnit_Utils_getCycleCount();
+        for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+        {
+            for (int32_t i = 0; i < BENCHMARK_BLOCK_SIZE; i += MW_AFXUNIT_BIQUAD_MODULATION_STEP)
+                MW_AFXUnit_Biquad_modulateParameters(&biquad, MW_BIQUAD_LPF, 1000.f + 10.f * ((n + i) & 63), 2.f, 0.f);
+
+            MW_AFXUnit_Biquad_process(&biquad, block, BENCHMARK_BLOCK_SIZE);
+        }
+        uint32_t modulatedCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        results[numResults].N = K;
+        results[numResults].referenceCyclesPerSample = (float32_t)steppedCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+        results[numResults].cyclesPerSample = (float32_t)modulatedCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+        numResults++;
+    }
+
+    return numResults;
+}
+
+
+
+/*
+ *  Filter interleaved blocks of 2, 4 and 8 channels.  The reference deinterleaves every channel, runs one MW_AFXUnit_Biquad per
+ *  channel and interleaves the result back, as stereo EQ had to be done before MW_AFXUnit_InterleavedBiquad
+ *
+ *  Returns:
+ *      Number of results written (N is the number of channels, cycles are per sample of one channel)
+ */
+size_t MW_AFXUnit_InterleavedBiquad_runBenchmarks(MW_UnitTest_BenchmarkResult *results, size_t maxResults)
+{
+    float32_t block[BENCHMARK_BLOCK_SIZE * MW_AFXUNIT_INTERLEAVEDBIQUAD_MAX_CHANNELS];
+    float32_t channel[BENCHMARK_BLOCK_SIZE];
+    MW_AFXUnit_Biquad mono[MW_AFXUNIT_INTERLEAVEDBIQUAD_MAX_CHANNELS];
+    MW_AFXUnit_InterleavedBiquad biquad;
+    float32_t fs = 48000.f;
+    size_t numResults = 0;
+
+    for (int32_t numChannels = 2; numChannels <= MW_AFXUNIT_INTERLEAVEDBIQUAD_MAX_CHANNELS && numResults < maxResults; numChannels *= 2)
+    {
+        int32_t numSamples = BENCHMARK_BLOCK_SIZE * numChannels;
+
+        MW_AFXUnit_InterleavedBiquad_init(&biquad, numChannels, MW_BIQUAD_PARAM_EQ_CQ, fs, 2000.f, 1.5f, 6.f);
+        for (int32_t c = 0; c < numChannels; ++c)
+            MW_AFXUnit_Biquad_init(&mono[c], MW_BIQUAD_PARAM_EQ_CQ, fs, 2000.f, 1.5f, 6.f);
+
+        arm_fill_f32(0.5f, block, numSamples);
+
+        uint32_t start = MW_AFXUnit_Utils_getCycleCount();
+        for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+        {
+            for (int32_t c = 0; c < numChannels; ++c)
+            {
+                for (int32_t i = 0; i < BENCHMARK_BLOCK_SIZE; ++i)
+                    channel[i] = block[i * numChannels + c];
+
+                MW_AFXUnit_Biquad_process(&mono[c], channel, BENCHMARK_BLOCK_SIZE);
+
+                for (int32_t i = 0; i < BENCHMARK_BLOCK_SIZE; ++i)
+                    block[i * numChannels + c] = channel[i];
+            }
+        }
+        uint32_t monoCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        arm_fill_f32(0.5f, block, numSamples);
+
+        start = MW_AFXUnit_Utils_getCycleCount();
+        for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+            MW_AFXUnit_InterleavedBiquad_process(&biquad, block, BENCHMARK_BLOCK_SIZE);
+        uint32_t interleavedCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        results[numResults].N = numChannels;
+        results[numResults].referenceCyclesPerSample = (float32_t)monoCycles / (numSamples * BENCHMARK_NUM_BLOCKS);
+        results[numResults].cyclesPerSample = (float32_t)interleavedCycles / (numSamples * BENCHMARK_NUM_BLOCKS);
+        numResults++;
+    }
+
+    return numResults;
+}
+
+
+
+/*
+ *  Cycles and SNR (against the float filter) of the fixed point formats, for the same peaking EQ.  The reference is the float
+ *  biquad (arm_biquad_cascade_df2T_f32)
+ *
+ *  Returns:
+ *      Number of results written
+ */
+size_t MW_AFXUnit_Biquad_runFormatBenchmarks(MW_AFXUnit_Biquad_FormatBenchmarkResult *results, size_t maxResults)
+{
+    static float32_t block[BENCHMARK_BLOCK_SIZE];
+    static q31_t blockQ31[BENCHMARK_BLOCK_SIZE];
+    static q15_t blockQ15[BENCHMARK_BLOCK_SIZE];
+    MW_AFXUnit_Biquad biquad;
+    size_t numResults = 0;
+
+    MW_AFXUnit_Biquad_init(&biquad, MW_BIQUAD_PARAM_EQ_CQ, 48000.f, 2000.f, 2.f, 9.f);
+    arm_fill_f32(0.1f, block, BENCHMARK_BLOCK_SIZE);
+
+    uint32_t start = MW_AFXUnit_Utils_getCycleCount();
+    for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+        MW_AFXUnit_Biquad_process(&biquad, block, BENCHMARK_BLOCK_SIZE);
+    uint32_t floatCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+    for (int32_t format = MW_BIQUAD_FORMAT_Q31; format < MW_BIQUAD_NUM_FORMATS && numResults < maxResults; ++format)
+    {
+        MW_AFXUnit_Biquad_init_format(&biquad, format, MW_BIQUAD_PARAM_EQ_CQ, 48000.f, 2000.f, 2.f, 9.f);
+        arm_fill_f32(0.1f, block, BENCHMARK_BLOCK_SIZE);
+        arm_float_to_q31(block, blockQ31, BENCHMARK_BLOCK_SIZE);
+        arm_float_to_q15(block, blockQ15, BENCHMARK_BLOCK_SIZE);
+
+        start = MW_AFXUnit_Utils_getCycleCount();
+        for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+        {
+            if (format == MW_BIQUAD_FORMAT_Q15)
+                MW_AFXUnit_Biquad_process_q15(&biquad, blockQ15, BENCHMARK_BLOCK_SIZE);
+            else
+                MW_AFXUnit_Biquad_process_q31(&biquad, blockQ31, BENCHMARK_BLOCK_SIZE);
+        }
+        uint32_t fixedCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        results[numResults].format = format;
+        results[numResults].referenceCyclesPerSample = (float32_t)floatCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+        results[numResults].cyclesPerSample = (float32_t)fixedCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+        results[numResults].snrDb = MW_AFXUnit_Biquad_fixedPointSNR(format, MW_BIQUAD_PARAM_EQ_CQ, 2000.f, 2.f, 9.f);
+        numResults++;
+    }
+
+    return numResults;
+}
+
+
+
+/*
+ *  Evaluate the response of 1 to 16 stages at MW_UNITTEST_BIQUADRESPONSE_NUM_FREQUENCIES frequencies.  The reference evaluates
+ *  every stage on its own with scalar complex maths (trig, magnitude and phase per stage and frequency, summing dB and phase),
+ *  as UI code did before MW_AFXUnit_Biquad_response()
+ *
+ *  Returns:
+ *      Number of results written (N is the number of stages, cycles are per frequency)
+ */
+size_t MW_AFXUnit_Biquad_runResponseBenchmarks(MW_UnitTest_BenchmarkResult *results, size_t maxResults)
+{
+    static float32_t frequencies[MW_UNITTEST_BIQUADRESPONSE_NUM_FREQUENCIES];
+    static float32_t magnitude[MW_UNITTEST_BIQUADRESPONSE_NUM_FREQUENCIES];
+    static float32_t phase[MW_UNITTEST_BIQUADRESPONSE_NUM_FREQUENCIES];
+    MW_AFXUnit_BiquadCascade cascade;
+    float32_t fs = 48000.f;
+    size_t numResults = 0;
+
+    for (int32_t i = 0; i < MW_UNITTEST_BIQUADRESPONSE_NUM_FREQUENCIES; ++i)
+        frequencies[i] = 20.f * powf(1000.f, (float32_t)i / MW_UNITTEST_BIQUADRESPONSE_NUM_FREQUENCIES);
+
+    for (int32_t N = 1; N <= MW_AFXUNIT_BIQUADCASCADE_MAX_STAGES && numResults < maxResults; N *= 2)
+    {
+        MW_AFXUnit_BiquadCascade_init(&cascade, N, fs);
+        for (int32_t stage = 0; stage < N; ++stage)
+            MW_AFXUnit_BiquadCascade_changeStageParameters(&cascade, stage, MW_BIQUAD_PARAM_EQ_CQ, 50.f * (stage + 1), 2.f, 3.f);
+
+        uint32_t start = MW_AFXUnit_Utils_getCycleCount();
+        for (int32_t i = 0; i < MW_UNITTEST_BIQUADRESPONSE_NUM_FREQUENCIES; ++i)
+        {
+            float32_t w = 2.f * PI * frequencies[i] / fs;
+            float32_t dB = 0.f;
+            float32_t totalPhase = 0.f;
+
+            for (int32_t stage = 0; stage < N; ++stage)
+            {
+                const float32_t *c = &cascade.coefficients[5 * stage];
+                float32_t numRe = c[0] + c[1] * arm_cos_f32(w) + c[2] * arm_cos_f32(2.f * w);
+                float32_t numIm = -(c[1] * arm_sin_f32(w) + c[2] * arm_sin_f32(2.f * w));
+                float32_t denRe = 1.f - c[3] * arm_cos_f32(w) - c[4] * arm_cos_f32(2.f * w);
+                float32_t denIm = c[3] * arm_sin_f32(w) + c[4] * arm_sin_f32(2.f * w);
+
+                dB += 10.f * log10f((numRe * numRe + numIm * numIm) / (denRe * denRe + denIm * denIm));
+                totalPhase += atan2f(numIm, numRe) - atan2f(denIm, denRe);
+            }
+
+            magnitude[i] = dB;
+            phase[i] = totalPhase;
+        }
+        uint32_t scalarCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        start = MW_AFXUnit_Utils_getCycleCount();
+        MW_AFXUnit_Biquad_response(cascade.coefficients, N, fs, frequencies, magnitude, phase, MW_UNITTEST_BIQUADRESPONSE_NUM_FREQUENCIES);
+        uint32_t batchCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        results[numResults].N = N;
+        results[numResults].referenceCyclesPerSample = (float32_t)scalarCycles / MW_UNITTEST_BIQUADRESPONSE_NUM_FREQUENCIES;
+        results[numResults].cyclesPerSample = (float32_t)batchCycles / MW_UNITTEST_BIQUADRESPONSE_NUM_FREQUENCIES;
+        numResults++;
+    }
+
+    return numResults;
+}
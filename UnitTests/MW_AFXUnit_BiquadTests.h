@@ -29,7 +29,27 @@
 
 #include "arm_math.h"
 #include "MW_AFXUnit_Biquad.h"
+#include "MW_UnitTestBenchmark.h"
+
+#define MW_UNITTEST_BIQUADCACHE_NUM_BANDS 32
+#define MW_UNITTEST_BIQUADRESPONSE_NUM_FREQUENCIES 512
+
+//  Cost of a fixed point biquad against the float biquad, and its SNR against the float filter
+typedef struct
+{
+    MW_AFXUnit_BiquadFormat                 format;
+    float32_t                               referenceCyclesPerSample;
+    float32_t                               cyclesPerSample;
+    float32_t                               snrDb;
+}MW_AFXUnit_Biquad_FormatBenchmarkResult;
 
 int32_t MW_AFXUnit_Biquad_runUnitTests();
+size_t  MW_AFXUnit_Biquad_runModulationBenchmarks(MW_UnitTest_BenchmarkResult *results, size_t maxResults);
+size_t  MW_AFXUnit_Biquad_runFormatBenchmarks(MW_AFXUnit_Biquad_FormatBenchmarkResult *results, size_t maxResults);
+size_t  MW_AFXUnit_Biquad_runResponseBenchmarks(MW_UnitTest_BenchmarkResult *results, size_t maxResults);
+size_t  MW_AFXUnit_BiquadCache_runBenchmarks(MW_UnitTest_BenchmarkResult *results, size_t maxResults);
+size_t  MW_AFXUnit_BiquadCascade_runBenchmarks(MW_UnitTest_BenchmarkResult *results, size_t maxResults);
+size_t  MW_AFXUnit_BiquadCascade_runConvolutionBenchmarks(MW_UnitTest_BenchmarkResult *results, size_t maxResults);
+size_t  MW_AFXUnit_InterleavedBiquad_runBenchmarks(MW_UnitTest_BenchmarkResult *results, size_t maxResults);
 
 #endif /* MW_AFXUNIT_BIQUADTESTS_H_ */
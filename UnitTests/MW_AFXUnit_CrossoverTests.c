@@ -0,0 +1,389 @@
+//  Copyright 2021 Allen Lee
+//
+//  Author:  Allen Lee (alee@meoworkshop.org)
+//  
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//  For more information, please refer to https://opensource.org/licenses/mit-license.php
+//
+//  ------------------------------------------------------------------------------------------------  //
+
+
+
+#include "MW_AFXUnit_CrossoverTests.h"
+#include "MW_AFXUnit_MiscUtils.h"
+
+#define BENCHMARK_BLOCK_SIZE 128
+#define BENCHMARK_NUM_BLOCKS 64
+
+#define CROSSOVER_TEST_LENGTH 1024
+#define NAIVE_MAX_STAGES 6
+
+static const float32_t CROSSOVER_FREQUENCIES[MW_AFXUNIT_CROSSOVER_MAX_BANDS - 1] = {120.f, 900.f, 5000.f};
+
+
+//  Impulse followed by a low, a mid and a high tone
+static float32_t MW_AFXUnit_Crossover_testSignal(int32_t n)
+{
+    if (n == 0)
+        return 1.f;
+
+    return 0.3f * arm_sin_f32(2.f * PI * 61.f * n / 48000.f) + 0.3f * arm_sin_f32(2.f * PI * 1500.f * n / 48000.f) +
+           0.3f * arm_sin_f32(2.f * PI * 9000.f * n / 48000.f);
+}
+
+
+/*
+ *  Naive crossover: every band is a separate chain of MW_AFXUnit_Biquad stages (LR4 lowpasses/highpasses and the compensating
+ *  allpasses wired by hand), each run on its own copy of the input
+ */
+typedef struct
+{
+    MW_AFXUnit_Biquad   stages[NAIVE_MAX_STAGES];
+    int32_t             numStages;
+}MW_AFXUnit_Crossover_NaiveBand;
+
+
+static void MW_AFXUnit_Crossover_addNaiveFilter(MW_AFXUnit_Crossover_NaiveBand *band, MW_AFXUnit_BiquadType filterType, float32_t fs, float32_t fc)
+{
+    for (int32_t i = 0; i < 2; ++i)
+        MW_AFXUnit_Biquad_init(&band->stages[band->numStages++], filterType, fs, fc, 0.70710678f, 0.f);
+}
+
+
+static void MW_AFXUnit_Crossover_addNaiveAllpass(MW_AFXUnit_Crossover_NaiveBand *band, MW_AFXUnit_CrossoverSplit *split, float32_t fs)
+{
+    MW_AFXUnit_Biquad *stage = &band->stages[band->numStages++];
+
+    MW_AFXUnit_Biquad_init(stage, MW_BIQUAD_LPF, fs, 1000.f, 1.f, 0.f);
+    arm_copy_f32(split->allpassCoefficients, stage->coefficients, 5);
+}
+
+
+//  Build the naive equivalent of an LR4 crossover
+static void MW_AFXUnit_Crossover_initNaive(MW_AFXUnit_Crossover_NaiveBand *bands, MW_AFXUnit_Crossover *crossover)
+{
+    const float32_t *f = crossover->crossoverFrequencies;
+    float32_t fs = crossover->fs;
+
+    for (int32_t b = 0; b < crossover->numBands; ++b)
+        bands[b].numStages = 0;
+
+    if (crossover->numBands == 2)
+    {
+        MW_AFXUnit_Crossover_addNaiveFilter(&bands[0], MW_BIQUAD_LPF, fs, f[0]);
+        MW_AFXUnit_Crossover_addNaiveFilter(&bands[1], MW_BIQUAD_HPF, fs, f[0]);
+        return;
+    }
+
+    MW_AFXUnit_Crossover_addNaiveFilter(&bands[0], MW_BIQUAD_LPF, fs, f[1]);
+    MW_AFXUnit_Crossover_addNaiveFilter(&bands[0], MW_BIQUAD_LPF, fs, f[0]);
+    MW_AFXUnit_Crossover_addNaiveFilter(&bands[1], MW_BIQUAD_LPF, fs, f[1]);
+    MW_AFXUnit_Crossover_addNaiveFilter(&bands[1], MW_BIQUAD_HPF, fs, f[0]);
+    MW_AFXUnit_Crossover_addNaiveFilter(&bands[2], MW_BIQUAD_HPF, fs, f[1]);
+    MW_AFXUnit_Crossover_addNaiveAllpass(&bands[2], &crossover->splits[0], fs);
+
+    if (crossover->numBands == 3)
+        return;
+
+    MW_AFXUnit_Crossover_addNaiveAllpass(&bands[0], &crossover->splits[2], fs);
+    MW_AFXUnit_Crossover_addNaiveAllpass(&bands[1], &crossover->splits[2], fs);
+    MW_AFXUnit_Crossover_addNaiveFilter(&bands[2], MW_BIQUAD_LPF, fs, f[2]);
+    MW_AFXUnit_Crossover_addNaiveFilter(&bands[3], MW_BIQUAD_HPF, fs, f[1]);
+    MW_AFXUnit_Crossover_addNaiveFilter(&bands[3], MW_BIQUAD_HPF, fs, f[2]);
+    MW_AFXUnit_Crossover_addNaiveAllpass(&bands[3], &crossover->splits[0], fs);
+}
+
+
+static void MW_AFXUnit_Crossover_processNaive(MW_AFXUnit_Crossover_NaiveBand *bands, int32_t numBands, const float32_t *input, float32_t **outputs, size_t numSamples)
+{
+    for (int32_t b = 0; b < numBands; ++b)
+    {
+        arm_copy_f32((float32_t *)input, outputs[b], numSamples);
+        for (int32_t i = 0; i < bands[b].numStages; ++i)
+            MW_AFXUnit_Biquad_process(&bands[b].stages[i], outputs[b], numSamples);
+    }
+}
+
+
+
+// ============================================================================================================== //
+
+
+static int32_t MW_AFXUnit_Crossover_initializationTests()
+{
+    MW_AFXUnit_Crossover crossover;
+    float32_t fs = 48000.f;
+    float32_t unordered[3] = {900.f, 120.f, 5000.f};
+    float32_t aboveNyquist[3] = {120.f, 900.f, 25000.f};
+
+    if (MW_AFXUnit_Crossover_init(NULL, MW_CROSSOVER_LR4, 4, CROSSOVER_FREQUENCIES, fs))
+        return 0;
+
+    if (MW_AFXUnit_Crossover_init(&crossover, MW_CROSSOVER_LR4, 4, NULL, fs))
+        return 0;
+
+    if (MW_AFXUnit_Crossover_init(&crossover, MW_CROSSOVER_NUM_TYPES, 4, CROSSOVER_FREQUENCIES, fs))
+        return 0;
+
+    if (MW_AFXUnit_Crossover_init(&crossover, MW_CROSSOVER_LR4, 1, CROSSOVER_FREQUENCIES, fs))
+        return 0;
+
+    if (MW_AFXUnit_Crossover_init(&crossover, MW_CROSSOVER_LR4, MW_AFXUNIT_CROSSOVER_MAX_BANDS + 1, CROSSOVER_FREQUENCIES, fs))
+        return 0;
+
+    if (MW_AFXUnit_Crossover_init(&crossover, MW_CROSSOVER_LR4, 4, CROSSOVER_FREQUENCIES, -fs))
+        return 0;
+
+    if (MW_AFXUnit_Crossover_init(&crossover, MW_CROSSOVER_LR4, 4, unordered, fs))
+        return 0;
+
+    if (MW_AFXUnit_Crossover_init(&crossover, MW_CROSSOVER_LR4, 4, aboveNyquist, fs))
+        return 0;
+
+    //  Only the first numBands - 1 frequencies are used
+    if (!MW_AFXUnit_Crossover_init(&crossover, MW_CROSSOVER_LR2, 3, aboveNyquist, fs))
+        return 0;
+
+    if (!MW_AFXUnit_Crossover_init(&crossover, MW_CROSSOVER_LR4, 4, CROSSOVER_FREQUENCIES, fs))
+        return 0;
+
+    //  Crossover frequencies must stay ordered
+    if (MW_AFXUnit_Crossover_changeFrequency(&crossover, 1, 100.f))
+        return 0;
+
+    if (MW_AFXUnit_Crossover_changeFrequency(&crossover, 3, 1000.f))
+        return 0;
+
+    if (!MW_AFXUnit_Crossover_changeFrequency(&crossover, 1, 1200.f) || crossover.crossoverFrequencies[1] != 1200.f)
+        return 0;
+
+    return 1;
+}
+
+
+/*
+ *  The lowpass of every split must be 6 dB down at fc and its allpass must have unit magnitude
+ */
+static int32_t MW_AFXUnit_Crossover_splitResponseTests()
+{
+    MW_AFXUnit_Crossover crossover;
+    float32_t fs = 48000.f;
+    float32_t frequencies[4] = {20.f, 0.f, 2500.f, 20000.f};
+    float32_t magnitude[4];
+
+    for (int32_t type = 0; type < MW_CROSSOVER_NUM_TYPES; ++type)
+    {
+        if (!MW_AFXUnit_Crossover_init(&crossover, (MW_AFXUnit_CrossoverType)type, 4, CROSSOVER_FREQUENCIES, fs))
+            return 0;
+
+        for (int32_t i = 0; i < 3; ++i)
+        {
+            MW_AFXUnit_CrossoverSplit *split = &crossover.splits[i];
+            frequencies[1] = CROSSOVER_FREQUENCIES[i];
+
+            MW_AFXUnit_Biquad_response(split->lowpassCoefficients, type == MW_CROSSOVER_LR2 ? 1 : 2, fs, &frequencies[1], magnitude, NULL, 1);
+            if (fabsf(magnitude[0] - 0.5f) > 1e-3f)
+                return 0;
+
+            MW_AFXUnit_Biquad_response(split->allpassCoefficients, 1, fs, frequencies, magnitude, NULL, 4);
+            for (int32_t k = 0; k < 4; ++k)
+                if (fabsf(magnitude[k] - 1.f) > 1e-4f)
+                    return 0;
+        }
+    }
+
+    return 1;
+}
+
+
+/*
+ *  The bands must sum to the cascade of the allpasses of all splits, for every order and number of bands.  The test signal is
+ *  processed in blocks that are not a multiple of MW_AFXUNIT_CROSSOVER_BLOCK_SIZE, with bands[0] as the input buffer
+ */
+static int32_t MW_AFXUnit_Crossover_allpassSumTests()
+{
+    static float32_t bandBuffers[MW_AFXUNIT_CROSSOVER_MAX_BANDS][CROSSOVER_TEST_LENGTH];
+    static float32_t reference[CROSSOVER_TEST_LENGTH];
+    MW_AFXUnit_Crossover crossover;
+    arm_biquad_cascade_df2T_instance_f32 allpasses[MW_AFXUNIT_CROSSOVER_MAX_BANDS - 1];
+    float32_t allpassStates[MW_AFXUNIT_CROSSOVER_MAX_BANDS - 1][2];
+    float32_t *bands[MW_AFXUNIT_CROSSOVER_MAX_BANDS];
+    float32_t fs = 48000.f;
+    size_t blockSize = 100;
+
+    for (int32_t type = 0; type < MW_CROSSOVER_NUM_TYPES; ++type)
+    {
+        for (int32_t numBands = 2; numBands <= MW_AFXUNIT_CROSSOVER_MAX_BANDS; ++numBands)
+        {
+            if (!MW_AFXUnit_Crossover_init(&crossover, (MW_AFXUnit_CrossoverType)type, numBands, CROSSOVER_FREQUENCIES, fs))
+                return 0;
+
+            for (int32_t i = 0; i < CROSSOVER_TEST_LENGTH; ++i)
+                reference[i] = bandBuffers[0][i] = MW_AFXUnit_Crossover_testSignal(i);
+
+            for (int32_t i = 0; i < numBands - 1; ++i)
+            {
+                arm_fill_f32(0.f, allpassStates[i], 2);
+                arm_biquad_cascade_df2T_init_f32(&allpasses[i], 1, crossover.splits[i].allpassCoefficients, allpassStates[i]);
+                arm_biquad_cascade_df2T_f32(&allpasses[i], reference, reference, CROSSOVER_TEST_LENGTH);
+            }
+
+            for (size_t offset = 0; offset < CROSSOVER_TEST_LENGTH; offset += blockSize)
+            {
+                size_t numSamples = (CROSSOVER_TEST_LENGTH - offset < blockSize) ? CROSSOVER_TEST_LENGTH - offset : blockSize;
+
+                for (int32_t b = 0; b < numBands; ++b)
+                    bands[b] = &bandBuffers[b][offset];
+
+                MW_AFXUnit_Crossover_process(&crossover, bands[0], bands, numSamples);
+            }
+
+            for (int32_t i = 0; i < CROSSOVER_TEST_LENGTH; ++i)
+            {
+                float32_t sum = 0.f;
+                for (int32_t b = 0; b < numBands; ++b)
+                    sum += bandBuffers[b][i];
+
+                if (!(fabsf(sum - reference[i]) <= 1e-4f))
+                    return 0;
+            }
+        }
+    }
+
+    MW_AFXUnit_Crossover_reset(&crossover);
+    for (int32_t i = 0; i < MW_AFXUNIT_CROSSOVER_MAX_BANDS - 1; ++i)
+        if (crossover.splits[i].lowpassStateVariables[0] != 0.f || crossover.splits[i].allpassStateVariables[0] != 0.f)
+            return 0;
+
+    return 1;
+}
+
+
+/*
+ *  Every band of the tree must match the same band built as a separate chain of biquads
+ */
+static int32_t MW_AFXUnit_Crossover_naiveComparisonTests()
+{
+    static float32_t input[CROSSOVER_TEST_LENGTH];
+    static float32_t bandBuffers[MW_AFXUNIT_CROSSOVER_MAX_BANDS][CROSSOVER_TEST_LENGTH];
+    static float32_t naiveBuffers[MW_AFXUNIT_CROSSOVER_MAX_BANDS][CROSSOVER_TEST_LENGTH];
+    MW_AFXUnit_Crossover crossover;
+    MW_AFXUnit_Crossover_NaiveBand naive[MW_AFXUNIT_CROSSOVER_MAX_BANDS];
+    float32_t *bands[MW_AFXUNIT_CROSSOVER_MAX_BANDS];
+    float32_t *naiveBands[MW_AFXUNIT_CROSSOVER_MAX_BANDS];
+    float32_t fs = 48000.f;
+
+    for (int32_t i = 0; i < CROSSOVER_TEST_LENGTH; ++i)
+        input[i] = MW_AFXUnit_Crossover_testSignal(i);
+
+    for (int32_t b = 0; b < MW_AFXUNIT_CROSSOVER_MAX_BANDS; ++b)
+    {
+        bands[b] = bandBuffers[b];
+        naiveBands[b] = naiveBuffers[b];
+    }
+
+    for (int32_t numBands = 2; numBands <= MW_AFXUNIT_CROSSOVER_MAX_BANDS; ++numBands)
+    {
+        if (!MW_AFXUnit_Crossover_init(&crossover, MW_CROSSOVER_LR4, numBands, CROSSOVER_FREQUENCIES, fs))
+            return 0;
+
+        MW_AFXUnit_Crossover_initNaive(naive, &crossover);
+
+        MW_AFXUnit_Crossover_process(&crossover, input, bands, CROSSOVER_TEST_LENGTH);
+        MW_AFXUnit_Crossover_processNaive(naive, numBands, input, naiveBands, CROSSOVER_TEST_LENGTH);
+
+        for (int32_t b = 0; b < numBands; ++b)
+            for (int32_t i = 0; i < CROSSOVER_TEST_LENGTH; ++i)
+                if (!(fabsf(bandBuffers[b][i] - naiveBuffers[b][i]) <= 1e-4f))
+                    return 0;
+    }
+
+    return 1;
+}
+
+
+int32_t MW_AFXUnit_Crossover_runUnitTests()
+{
+    if (!MW_AFXUnit_Crossover_initializationTests())
+        return 0;
+
+    if (!MW_AFXUnit_Crossover_splitResponseTests())
+        return 0;
+
+    if (!MW_AFXUnit_Crossover_allpassSumTests())
+        return 0;
+
+    if (!MW_AFXUnit_Crossover_naiveComparisonTests())
+        return 0;
+
+    return 1;
+}
+
+
+
+// ============================================================================================================== //
+
+
+/*
+ *  Cycles per input sample of an LR4 crossover for 2, 3 and 4 bands.  The reference is the naive crossover (a separate chain
+ *  of MW_AFXUnit_Biquad stages per band)
+ *
+ *  Returns:
+ *      Number of results written
+ */
+size_t MW_AFXUnit_Crossover_runBenchmarks(MW_UnitTest_BenchmarkResult *results, size_t maxResults)
+{
+    static float32_t input[BENCHMARK_BLOCK_SIZE];
+    static float32_t bandBuffers[MW_AFXUNIT_CROSSOVER_MAX_BANDS][BENCHMARK_BLOCK_SIZE];
+    MW_AFXUnit_Crossover crossover;
+    MW_AFXUnit_Crossover_NaiveBand naive[MW_AFXUNIT_CROSSOVER_MAX_BANDS];
+    float32_t *bands[MW_AFXUNIT_CROSSOVER_MAX_BANDS];
+    float32_t fs = 48000.f;
+    size_t numResults = 0;
+
+    for (int32_t b = 0; b < MW_AFXUNIT_CROSSOVER_MAX_BANDS; ++b)
+        bands[b] = bandBuffers[b];
+
+    for (int32_t i = 0; i < BENCHMARK_BLOCK_SIZE; ++i)
+        input[i] = MW_AFXUnit_Crossover_testSignal(i + 1);
+
+    for (int32_t numBands = 2; numBands <= MW_AFXUNIT_CROSSOVER_MAX_BANDS && numResults < maxResults; ++numBands)
+    {
+        MW_AFXUnit_Crossover_init(&crossover, MW_CROSSOVER_LR4, numBands, CROSSOVER_FREQUENCIES, fs);
+        MW_AFXUnit_Crossover_initNaive(naive, &crossover);
+
+        uint32_t start = MW_AFXUnit_Utils_getCycleCount();
+        for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+            MW_AFXUnit_Crossover_processNaive(naive, numBands, input, bands, BENCHMARK_BLOCK_SIZE);
+        uint32_t naiveCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        start = MW_AFXUnit_Utils_getCycleCount();
+        for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+            MW_AFXUnit_Crossover_process(&crossover, input, bands, BENCHMARK_BLOCK_SIZE);
+        uint32_t treeCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        results[numResults].N = numBands;
+        results[numResults].referenceCyclesPerSample = (float32_t)naiveCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+        results[numResults].cyclesPerSample = (float32_t)treeCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+        numResults++;
+    }
+
+    return numResults;
+}
@@ -139,6 +139,106 @@ static int32_t MW_AFXUnit_Flutter_standardOperationTests()
 
 
 
+//  Flutter_process() used to tick the delay line and set its delay length one sample at a time
+//  It is kept here as a reference for the block processing test and the benchmarks
+static void MW_AFXUnit_Flutter_referenceProcess(MW_AFXUnit_Flutter *flutter, float32_t *buffer, size_t bufferSize)
+{
+    for (size_t i = 0; i < bufferSize; ++i)
+    {
+        buffer[i] = MW_DSP_FractionalDelayLine_tick(&flutter->delay, buffer[i]) * flutter->b0;
+        MW_DSP_FractionalDelayLine_setDelayLength(&flutter->delay, flutter->M + (flutter->lfoDepth * arm_sin_f32(flutter->lfoPhaseCounter)));
+
+        flutter->lfoPhaseCounter += flutter->lfoPhaseIncrement;
+    }
+
+    if (flutter->lfoPhaseCounter > 2.f * PI)
+        flutter->lfoPhaseCounter -= (2.f * PI);
+}
+
+
+//  Block processing with a precomputed LFO block must give the same output as the per-sample reference
+static int32_t MW_AFXUnit_Flutter_blockProcessingTests()
+{
+    MW_AFXUnit_Flutter flutter;
+    MW_AFXUnit_Flutter reference;
+    float32_t delayLine[100];
+    float32_t referenceDelayLine[100];
+    float32_t block[100];
+    float32_t expected[100];
+
+    if (!MW_AFXUnit_Flutter_init(&flutter, delayLine, 1000.f, 50.f, 100, 40.f, 7.f, 0.8f))
+        return 0;
+
+    if (!MW_AFXUnit_Flutter_init(&reference, referenceDelayLine, 1000.f, 50.f, 100, 40.f, 7.f, 0.8f))
+        return 0;
+
+    for (int32_t n = 0; n < 10; ++n)
+    {
+        for (int32_t i = 0; i < 100; ++i)
+        {
+            block[i] = arm_sin_f32(0.1f * (i + (100 * n)));
+            expected[i] = block[i];
+        }
+
+        MW_AFXUnit_Flutter_process(&flutter, block, 100);
+        MW_AFXUnit_Flutter_referenceProcess(&reference, expected, 100);
+
+        for (int32_t i = 0; i < 100; ++i)
+            if (block[i] != expected[i])
+                return 0;
+    }
+
+    return 1;
+}
+
+
+/*
+ *  Compare the per-sample flutter loop against Flutter_process() for block sizes of 16 up to 512 samples
+ *  The delay line uses up to 2048 samples of delayLineMemory
+ *
+ *  Returns:
+ *    Number of results written
+ */
+size_t MW_AFXUnit_Flutter_runBenchmarks(float32_t *delayLineMemory, size_t memorySize, MW_UnitTest_BenchmarkResult *results, size_t maxResults)
+{
+    MW_AFXUnit_Flutter flutter;
+    float32_t block[512];
+    size_t numResults = 0;
+    int32_t N = memorySize < 2048 ? (int32_t)memorySize : 2048;
+    float32_t M = (float32_t)(N / 2);
+
+    if (N < 16)
+        return 0;
+
+    arm_fill_f32(0.5f, block, 512);
+
+    for (size_t blockSize = 16; blockSize <= 512 && numResults < maxResults; blockSize *= 2)
+    {
+        size_t numBlocks = 8192 / blockSize;
+
+        MW_AFXUnit_Flutter_init(&flutter, delayLineMemory, 48000.f, M, N, M / 2.f, 5.f, 1.f);
+
+        uint32_t start = MW_AFXUnit_Utils_getCycleCount();
+        for (size_t n = 0; n < numBlocks; ++n)
+            MW_AFXUnit_Flutter_referenceProcess(&flutter, block, blockSize);
+        uint32_t referenceCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        MW_AFXUnit_Flutter_init(&flutter, delayLineMemory, 48000.f, M, N, M / 2.f, 5.f, 1.f);
+
+        start = MW_AFXUnit_Utils_getCycleCount();
+        for (size_t n = 0; n < numBlocks; ++n)
+            MW_AFXUnit_Flutter_process(&flutter, block, blockSize);
+        uint32_t processCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        results[numResults].N = blockSize;
+        results[numResults].referenceCyclesPerSample = (float32_t)referenceCycles / 8192.f;
+        results[numResults].cyclesPerSample = (float32_t)processCycles / 8192.f;
+        numResults++;
+    }
+
+    return numResults;
+}
+
 int32_t MW_AFXUnit_Flutter_runUnitTests()
 {
     if (!MW_AFXUnit_Flutter_initializationTests())
@@ -147,5 +247,8 @@ int32_t MW_AFXUnit_Flutter_runUnitTests()
     if (!MW_AFXUnit_Flutter_standardOperationTests())
         return 0;
 
+    if (!MW_AFXUnit_Flutter_blockProcessingTests())
+        return 0;
+
     return 1;
 }
@@ -30,9 +30,11 @@
 #include "arm_math.h"
 #include "MW_AFXUnit_Flutter.h"
 #include "CommonDefs.h"
+#include "MW_UnitTestBenchmark.h"
 
 
 int32_t MW_AFXUnit_Flutter_runUnitTests();
+size_t  MW_AFXUnit_Flutter_runBenchmarks(float32_t *delayLineMemory, size_t memorySize, MW_UnitTest_BenchmarkResult *results, size_t maxResults);
 
 
 
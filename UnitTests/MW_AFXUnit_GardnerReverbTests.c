@@ -113,10 +113,90 @@ static int32_t MW_AFXUnit_GardnerReverb_initializationTests()
 }
 
 
+//  The Q15 reverb uses the same memory layout as the float reverb (in half the bytes) and must track its output to within
+//  the Q15 quantization error for an input 12 dB below full scale
+static int32_t MW_AFXUnit_GardnerReverb_q15Tests()
+{
+    MW_AFXUnit_GardnerReverb reverb;
+    MW_AFXUnit_GardnerReverb q15Reverb;
+    static float32_t reverbDelayBuffer[10880];
+    static q15_t q15ReverbDelayBuffer[10880];
+    float32_t reverbGain = 0.5f;
+    float32_t fs = 32000.f;
+
+    int32_t expectedStartIndices[MW_AFXUNIT_GARDNERREVERB_TOTAL_DELAY_LINES];
+
+    int32_t success = MW_AFXUnit_GardnerReverb_init_q15(NULL, q15ReverbDelayBuffer, reverbGain, fs);
+    if (success)
+        return 0;
+
+    success = MW_AFXUnit_GardnerReverb_init_q15(&q15Reverb, NULL, reverbGain, fs);
+    if (success)
+        return 0;
+
+    success = MW_AFXUnit_GardnerReverb_init_q15(&q15Reverb, q15ReverbDelayBuffer, 1.2f, fs);
+    if (success)
+        return 0;
+
+    arm_fill_f32(0.f, reverbDelayBuffer, 10880);
+    if (!MW_AFXUnit_GardnerReverb_init(&reverb, reverbDelayBuffer, reverbGain, fs))
+        return 0;
+
+    if (!MW_AFXUnit_GardnerReverb_init_q15(&q15Reverb, q15ReverbDelayBuffer, reverbGain, fs))
+        return 0;
+
+    if (q15Reverb.delayLineMemory != NULL || q15Reverb.delayLineMemoryQ15 != q15ReverbDelayBuffer)
+        return 0;
+
+    MW_AFXUnit_GardnerReverb_calculateDelayIndices(expectedStartIndices, fs);
+
+    if (q15Reverb.nestedAPCFs[0].delayLineQ15 != q15ReverbDelayBuffer + expectedStartIndices[0])
+        return 0;
+
+    if (q15Reverb.standaloneAPCF.delayLineQ15 != q15ReverbDelayBuffer + expectedStartIndices[4])
+        return 0;
+
+    if (q15Reverb.delayLines[3].bufferQ15 != q15ReverbDelayBuffer + expectedStartIndices[9])
+        return 0;
+
+    float32_t buffer[64];
+    float32_t q15Buffer[64];
+    float32_t signalPower = 0.f;
+    float32_t noisePower = 0.f;
+
+    srand(7);
+    for (int32_t block = 0; block < 500; ++block)
+    {
+        for (int32_t i = 0; i < 64; ++i)
+        {
+            buffer[i] = 0.25f * (2.f * (float32_t)rand() / (float32_t)RAND_MAX - 1.f);
+            q15Buffer[i] = buffer[i];
+        }
+
+        MW_AFXUnit_GardnerReverb_process(&reverb, buffer, 64);
+        MW_AFXUnit_GardnerReverb_process(&q15Reverb, q15Buffer, 64);
+
+        for (int32_t i = 0; i < 64; ++i)
+        {
+            signalPower += buffer[i] * buffer[i];
+            noisePower += (q15Buffer[i] - buffer[i]) * (q15Buffer[i] - buffer[i]);
+        }
+    }
+
+    if (10.f * log10f(signalPower / noisePower) < 65.f)
+        return 0;
+
+    return 1;
+}
+
+
 int32_t MW_AFXUnit_GardnerReverb_runUnitTests()
 {
     if (!MW_AFXUnit_GardnerReverb_initializationTests())
         return 0;
 
+    if (!MW_AFXUnit_GardnerReverb_q15Tests())
+        return 0;
+
     return 1;
 }
@@ -44,8 +44,8 @@ static int32_t MW_AFXUnit_GranularTests_initializationTests()
     success = MW_AFXUnit_Granular_init(&granular, NULL, tapeBufferSize, grainSize, timeToChangeGrain, fs);
     if (success) return 0;
 
-    //  Pass in an invalid grain size (max grain size is 0.1 sec)
-    success = MW_AFXUnit_Granular_init(&granular, tapeBuffer, tapeBufferSize, 0.15, timeToChangeGrain, fs);
+    //  Pass in an invalid grain size (max grain size is MAX_GRAIN_BUFFER_SIZE samples, 0.2 sec at 32 kHz)
+    success = MW_AFXUnit_Granular_init(&granular, tapeBuffer, tapeBufferSize, 0.25, timeToChangeGrain, fs);
     if (success) return 0;
 
     //  No negative values allowed!
@@ -118,6 +118,45 @@ static int32_t MW_AFXUnit_GranularTests_windowingTest()
 
 
 
+//  Grains copied out of a guarded tape must match grains copied out of a regular tape (the random grain positions are
+//  reproduced by reseeding rand())
+static int32_t MW_AFXUnit_GranularTests_guardedTest()
+{
+    static MW_AFXUnit_Granular granular;
+    static MW_AFXUnit_Granular guardedGranular;
+    float32_t           tapeBuffer[50];
+    float32_t           guardedTapeBuffer[MW_DSP_RINGBUFFER_MEMORY_SIZE(50, MW_AFXUNIT_GRANULAR_GUARD_SIZE(50))];
+    float32_t           block[64];
+    float32_t           expected[64];
+    float32_t           fs = 100.f;
+
+    if (!MW_AFXUnit_Granular_init(&granular, tapeBuffer, 50, 0.2f, 0.2f, fs))
+        return 0;
+
+    if (!MW_AFXUnit_Granular_init_guarded(&guardedGranular, guardedTapeBuffer, 50, 0.2f, 0.2f, fs))
+        return 0;
+
+    for (int32_t n = 0; n < 8; ++n)
+    {
+        for (int32_t i = 0; i < 64; ++i)
+        {
+            block[i] = (float32_t)(i + 64 * n);
+            expected[i] = block[i];
+        }
+
+        srand(n);
+        MW_AFXUnit_Granular_process(&granular, expected, 64);
+        srand(n);
+        MW_AFXUnit_Granular_process(&guardedGranular, block, 64);
+
+        for (int32_t i = 0; i < 64; ++i)
+            if (block[i] != expected[i])
+                return 0;
+    }
+
+    return 1;
+}
+
 
 int32_t MW_AFXUnit_GranularTests_runUnitTests()
 {
@@ -126,6 +165,9 @@ int32_t MW_AFXUnit_GranularTests_runUnitTests()
 
     if (!MW_AFXUnit_GranularTests_windowingTest())
         return 0;
+
+    if (!MW_AFXUnit_GranularTests_guardedTest())
+        return 0;
         
     return 1;
 }
\ No newline at end of file
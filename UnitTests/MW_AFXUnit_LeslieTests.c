@@ -119,6 +119,109 @@ int32_t MW_AFXUnit_Leslie_standardOperationTests()
 }
 
 
+//  Leslie_process() used to tick the delay line and set its delay length one sample at a time
+//  It is kept here as a reference for the block processing test and the benchmarks
+static void MW_AFXUnit_Leslie_referenceProcess(MW_AFXUnit_Leslie *leslie, float32_t *buffer, size_t bufferSize)
+{
+    MW_AFXUnit_BiquadCascade_process(&leslie->speakerEQ, buffer, bufferSize);
+
+    for (size_t i = 0; i < bufferSize; ++i)
+    {
+        float32_t y = MW_DSP_FractionalDelayLine_tick(&leslie->delay, buffer[i]);
+
+        leslie->s[0] = leslie->s[0] - (leslie->a * leslie->s[1]);
+        leslie->s[1] = leslie->s[1] + (leslie->a * leslie->s[0]);
+
+        buffer[i] = (0.1f * buffer[i]) + (y * (1.f + leslie->s[1]));
+
+        float32_t newDelayLineLength = leslie->M + (-1.5f * leslie->angularVelocity * leslie->s[1]);
+        MW_DSP_FractionalDelayLine_setDelayLength(&leslie->delay, newDelayLineLength);
+    }
+}
+
+
+//  Block processing with a precomputed rotor block must give the same output as the per-sample reference
+static int32_t MW_AFXUnit_Leslie_blockProcessingTests()
+{
+    MW_AFXUnit_Leslie leslie;
+    MW_AFXUnit_Leslie reference;
+    float32_t delayLineBuffer[256];
+    float32_t referenceDelayLineBuffer[256];
+    float32_t block[100];
+    float32_t expected[100];
+
+    if (!MW_AFXUnit_Leslie_init(&leslie, delayLineBuffer, 256, 44100.f, 400.f))
+        return 0;
+
+    if (!MW_AFXUnit_Leslie_init(&reference, referenceDelayLineBuffer, 256, 44100.f, 400.f))
+        return 0;
+
+    for (int32_t n = 0; n < 10; ++n)
+    {
+        for (int32_t i = 0; i < 100; ++i)
+        {
+            block[i] = arm_sin_f32(0.1f * (i + (100 * n)));
+            expected[i] = block[i];
+        }
+
+        MW_AFXUnit_Leslie_process(&leslie, block, 100);
+        MW_AFXUnit_Leslie_referenceProcess(&reference, expected, 100);
+
+        for (int32_t i = 0; i < 100; ++i)
+            if (block[i] != expected[i])
+                return 0;
+    }
+
+    return 1;
+}
+
+
+/*
+ *  Compare the per-sample Leslie loop against Leslie_process() for block sizes of 16 up to 512 samples
+ *  The delay line uses up to 256 samples of delayLineMemory
+ *
+ *  Returns:
+ *    Number of results written
+ */
+size_t MW_AFXUnit_Leslie_runBenchmarks(float32_t *delayLineMemory, size_t memorySize, MW_UnitTest_BenchmarkResult *results, size_t maxResults)
+{
+    MW_AFXUnit_Leslie leslie;
+    float32_t block[512];
+    size_t numResults = 0;
+    int32_t N = memorySize < 256 ? (int32_t)memorySize : 256;
+
+    if (N < 16)
+        return 0;
+
+    arm_fill_f32(0.5f, block, 512);
+
+    for (size_t blockSize = 16; blockSize <= 512 && numResults < maxResults; blockSize *= 2)
+    {
+        size_t numBlocks = 8192 / blockSize;
+
+        MW_AFXUnit_Leslie_init(&leslie, delayLineMemory, N, 48000.f, 400.f);
+
+        uint32_t start = MW_AFXUnit_Utils_getCycleCount();
+        for (size_t n = 0; n < numBlocks; ++n)
+            MW_AFXUnit_Leslie_referenceProcess(&leslie, block, blockSize);
+        uint32_t referenceCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        MW_AFXUnit_Leslie_init(&leslie, delayLineMemory, N, 48000.f, 400.f);
+
+        start = MW_AFXUnit_Utils_getCycleCount();
+        for (size_t n = 0; n < numBlocks; ++n)
+            MW_AFXUnit_Leslie_process(&leslie, block, blockSize);
+        uint32_t processCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        results[numResults].N = blockSize;
+        results[numResults].referenceCyclesPerSample = (float32_t)referenceCycles / 8192.f;
+        results[numResults].cyclesPerSample = (float32_t)processCycles / 8192.f;
+        numResults++;
+    }
+
+    return numResults;
+}
+
 int32_t MW_AFXUnit_Leslie_runUnitTests()
 {
     if (!MW_AFXUnit_Leslie_initializationTests())
@@ -127,5 +230,8 @@ int32_t MW_AFXUnit_Leslie_runUnitTests()
     if (!MW_AFXUnit_Leslie_standardOperationTests())
         return 0;
 
+    if (!MW_AFXUnit_Leslie_blockProcessingTests())
+        return 0;
+
     return 1;
 }
\ No newline at end of file
@@ -29,8 +29,10 @@
 
 #include "arm_math.h"
 #include "MW_AFXUnit_Leslie.h"
+#include "MW_UnitTestBenchmark.h"
 
 int32_t MW_AFXUnit_Leslie_runUnitTests();
+size_t  MW_AFXUnit_Leslie_runBenchmarks(float32_t *delayLineMemory, size_t memorySize, MW_UnitTest_BenchmarkResult *results, size_t maxResults);
 
 
 #endif /* MW_AFXUNIT_LESLIETESTS_H_ */
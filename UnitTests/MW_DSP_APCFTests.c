@@ -26,6 +26,10 @@
 
 
 #include "MW_DSP_APCFTests.h"
+#include "MW_DSP_DelayLine.h"
+
+#define BENCHMARK_BLOCK_SIZE 128
+#define BENCHMARK_NUM_BLOCKS 64
 
 
 static float32_t EPSILON = 0.1f;
@@ -142,6 +146,368 @@ static int32_t MW_DSP_APCF_NestedAPCFInitializationTests()
 
 
 
+//  Power-of-two APCFs must give the same output as regular APCFs with the same delay length
+static int32_t MW_DSP_APCF_PowerOfTwoTests()
+{
+    MW_DSP_APCF         apcf;
+    MW_DSP_APCF         pow2APCF;
+    float32_t           delayLineBuffer[10];
+    float32_t           pow2DelayLineBuffer[16];
+    int32_t             delayLineLength = 10;
+    float32_t           apcfGain = 0.7f;
+
+    arm_fill_f32(0.f, delayLineBuffer, 10);
+    arm_fill_f32(0.f, pow2DelayLineBuffer, 16);
+
+    //  Buffer size must be a power of two and at least N
+    int32_t success = MW_DSP_APCF_init_pow2(&pow2APCF, pow2DelayLineBuffer, 12, delayLineLength, apcfGain);
+    if (success)
+        return 0;
+
+    success = MW_DSP_APCF_init_pow2(&pow2APCF, pow2DelayLineBuffer, 8, delayLineLength, apcfGain);
+    if (success)
+        return 0;
+
+    success = MW_DSP_APCF_init_pow2(&pow2APCF, pow2DelayLineBuffer, 16, delayLineLength, apcfGain);
+    if (!success)
+        return 0;
+
+    if (pow2APCF.mask != 15 || pow2APCF.N != delayLineLength)
+        return 0;
+
+    success = MW_DSP_APCF_init(&apcf, delayLineBuffer, delayLineLength, apcfGain);
+    if (!success)
+        return 0;
+
+    for (int32_t i = 0; i < 50; ++i)
+    {
+        float32_t x = (i == 0) ? 1.f : 0.f;
+        if (MW_DSP_APCF_tick(&apcf, x) != MW_DSP_APCF_tick(&pow2APCF, x))
+            return 0;
+    }
+
+    return 1;
+}
+
+
+
+//  Q15 APCFs must track float APCFs to within the Q15 quantization error.  The input is kept 6 dB below full scale since
+//  the APCF delay lines hold the internal state which is louder than the input
+static int32_t MW_DSP_APCF_Q15Tests()
+{
+    MW_DSP_APCF         apcf;
+    MW_DSP_APCF         q15APCF;
+    MW_DSP_NestedAPCF   nestedAPCF;
+    MW_DSP_NestedAPCF   q15NestedAPCF;
+    float32_t           delayLineBuffer[37];
+    float32_t           nestedDelayLineBuffer[53];
+    q15_t               q15DelayLineBuffer[37];
+    q15_t               q15NestedDelayLineBuffer[53];
+    float32_t           apcfGain = 0.6f;
+
+    int32_t success = MW_DSP_APCF_init_q15(NULL, q15DelayLineBuffer, 37, apcfGain);
+    if (success)
+        return 0;
+
+    success = MW_DSP_APCF_init_q15(&q15APCF, NULL, 37, apcfGain);
+    if (success)
+        return 0;
+
+    success = MW_DSP_APCF_init_q15(&q15APCF, q15DelayLineBuffer, 37, 2.7f);
+    if (success)
+        return 0;
+
+    //  Single APCFs are run inside the nested APCFs (the float APCF is the inner filter of the float nested APCF)
+    arm_fill_f32(0.f, delayLineBuffer, 37);
+    arm_fill_f32(0.f, nestedDelayLineBuffer, 53);
+
+    if (!MW_DSP_APCF_init(&apcf, delayLineBuffer, 37, apcfGain))
+        return 0;
+
+    if (!MW_DSP_APCF_init_q15(&q15APCF, q15DelayLineBuffer, 37, apcfGain))
+        return 0;
+
+    if (q15APCF.delayLine != NULL || q15APCF.delayLineQ15 != q15DelayLineBuffer)
+        return 0;
+
+    if (!MW_DSP_NestedAPCF_init(&nestedAPCF, nestedDelayLineBuffer, 53, 0.3f, &apcf, 1))
+        return 0;
+
+    if (!MW_DSP_NestedAPCF_init_q15(&q15NestedAPCF, q15NestedDelayLineBuffer, 53, 0.3f, &q15APCF, 1))
+        return 0;
+
+    float32_t signalPower = 0.f;
+    float32_t noisePower = 0.f;
+    for (int32_t i = 0; i < 2000; ++i)
+    {
+        float32_t x = 0.5f * arm_sin_f32(0.0123f * 2.f * PI * i);
+        float32_t y = MW_DSP_NestedAPCF_tick(&nestedAPCF, x);
+        float32_t yQ15 = MW_DSP_NestedAPCF_tick(&q15NestedAPCF, x);
+
+        signalPower += y * y;
+        noisePower += (yQ15 - y) * (yQ15 - y);
+    }
+
+    if (10.f * log10f(signalPower / noisePower) < 75.f)
+        return 0;
+
+    return 1;
+}
+
+
+//  Run the same input through a ticked filter and a block processed filter with blocks of different sizes
+static float32_t MW_DSP_APCF_maxProcessError(MW_DSP_APCF *tickedAPCF, MW_DSP_APCF *processedAPCF)
+{
+    float32_t x[97];
+    float32_t y[97];
+    size_t blockSizes[] = {1, 7, 32, 97, 50};
+    float32_t maxError = 0.f;
+    int32_t n = 0;
+
+    for (int32_t block = 0; block < 5; ++block)
+    {
+        for (size_t i = 0; i < blockSizes[block]; ++i, ++n)
+            x[i] = 0.5f * arm_sin_f32(0.0123f * 2.f * PI * n) + 0.1f * arm_sin_f32(0.31f * 2.f * PI * n);
+
+        MW_DSP_APCF_process(processedAPCF, x, y, blockSizes[block]);
+
+        for (size_t i = 0; i < blockSizes[block]; ++i)
+        {
+            float32_t error = fabsf(MW_DSP_APCF_tick(tickedAPCF, x[i]) - y[i]);
+            if (error > maxError)
+                maxError = error;
+        }
+    }
+
+    return maxError;
+}
+
+
+static float32_t MW_DSP_APCF_maxNestedProcessError(MW_DSP_NestedAPCF *tickedAPCF, MW_DSP_NestedAPCF *processedAPCF)
+{
+    float32_t x[97];
+    size_t blockSizes[] = {1, 7, 32, 97, 50};
+    float32_t maxError = 0.f;
+    int32_t n = 0;
+
+    for (int32_t block = 0; block < 5; ++block)
+    {
+        float32_t y[97];
+        for (size_t i = 0; i < blockSizes[block]; ++i, ++n)
+            x[i] = y[i] = 0.5f * arm_sin_f32(0.0123f * 2.f * PI * n) + 0.1f * arm_sin_f32(0.31f * 2.f * PI * n);
+
+        //  In-place processing
+        MW_DSP_NestedAPCF_process(processedAPCF, y, y, blockSizes[block]);
+
+        for (size_t i = 0; i < blockSizes[block]; ++i)
+        {
+            float32_t error = fabsf(MW_DSP_NestedAPCF_tick(tickedAPCF, x[i]) - y[i]);
+            if (error > maxError)
+                maxError = error;
+        }
+    }
+
+    return maxError;
+}
+
+
+//  MW_DSP_APCF_process() and MW_DSP_NestedAPCF_process() must match the tick functions for every type of delay line, and for
+//  delays shorter than MW_DSP_APCF_BLOCK_SIZE (which take the tick fallback)
+static int32_t MW_DSP_APCF_ProcessTests()
+{
+    MW_DSP_APCF         tickedAPCF;
+    MW_DSP_APCF         processedAPCF;
+    MW_DSP_APCF         tickedInnerAPCFs[2];
+    MW_DSP_APCF         processedInnerAPCFs[2];
+    MW_DSP_NestedAPCF   tickedNestedAPCF;
+    MW_DSP_NestedAPCF   processedNestedAPCF;
+    float32_t           tickedBuffers[4][128];
+    float32_t           processedBuffers[4][128];
+    q15_t               tickedQ15Buffer[45];
+    q15_t               processedQ15Buffer[45];
+    int32_t             delayLengths[] = {45, 11};
+
+    //  Float delay lines, with a long and a short delay
+    for (int32_t i = 0; i < 2; ++i)
+    {
+        arm_fill_f32(0.f, tickedBuffers[0], 128);
+        arm_fill_f32(0.f, processedBuffers[0], 128);
+        MW_DSP_APCF_init(&tickedAPCF, tickedBuffers[0], delayLengths[i], 0.7f);
+        MW_DSP_APCF_init(&processedAPCF, processedBuffers[0], delayLengths[i], 0.7f);
+
+        if (MW_DSP_APCF_maxProcessError(&tickedAPCF, &processedAPCF) > 1e-6f)
+            return 0;
+    }
+
+    //  Power of two delay lines
+    arm_fill_f32(0.f, tickedBuffers[0], 128);
+    arm_fill_f32(0.f, processedBuffers[0], 128);
+    MW_DSP_APCF_init_pow2(&tickedAPCF, tickedBuffers[0], 64, 45, -0.7f);
+    MW_DSP_APCF_init_pow2(&processedAPCF, processedBuffers[0], 64, 45, -0.7f);
+
+    if (MW_DSP_APCF_maxProcessError(&tickedAPCF, &processedAPCF) > 1e-6f)
+        return 0;
+
+    //  Q15 delay lines round instead of truncating when block processed
+    MW_DSP_APCF_init_q15(&tickedAPCF, tickedQ15Buffer, 45, 0.7f);
+    MW_DSP_APCF_init_q15(&processedAPCF, processedQ15Buffer, 45, 0.7f);
+
+    if (MW_DSP_APCF_maxProcessError(&tickedAPCF, &processedAPCF) > 1e-3f)
+        return 0;
+
+    //  Nested APCFs with a long and a short inner APCF, using a power of two outer delay line
+    for (int32_t i = 0; i < 4; ++i)
+    {
+        arm_fill_f32(0.f, tickedBuffers[i], 128);
+        arm_fill_f32(0.f, processedBuffers[i], 128);
+    }
+
+    for (int32_t i = 0; i < 2; ++i)
+    {
+        MW_DSP_APCF_init(&tickedInnerAPCFs[i], tickedBuffers[i], delayLengths[i], 0.4f);
+        MW_DSP_APCF_init(&processedInnerAPCFs[i], processedBuffers[i], delayLengths[i], 0.4f);
+    }
+
+    MW_DSP_NestedAPCF_init_pow2(&tickedNestedAPCF, tickedBuffers[2], 128, 70, 0.3f, tickedInnerAPCFs, 2);
+    MW_DSP_NestedAPCF_init_pow2(&processedNestedAPCF, processedBuffers[2], 128, 70, 0.3f, processedInnerAPCFs, 2);
+
+    if (MW_DSP_APCF_maxNestedProcessError(&tickedNestedAPCF, &processedNestedAPCF) > 1e-6f)
+        return 0;
+
+    //  Outer delay shorter than a block
+    MW_DSP_NestedAPCF_init(&tickedNestedAPCF, tickedBuffers[3], 20, 0.3f, tickedInnerAPCFs, 2);
+    MW_DSP_NestedAPCF_init(&processedNestedAPCF, processedBuffers[3], 20, 0.3f, processedInnerAPCFs, 2);
+
+    if (MW_DSP_APCF_maxNestedProcessError(&tickedNestedAPCF, &processedNestedAPCF) > 1e-6f)
+        return 0;
+
+    return 1;
+}
+
+
+static int32_t MW_DSP_APCF_ModAPCFInitializationTests()
+{
+    MW_DSP_ModAPCF      filter;
+    MW_DSP_ModAPCF_LFO  lfo;
+    float32_t           delayLineBuffer[MW_DSP_RINGBUFFER_MEMORY_SIZE(64, MW_DSP_MODAPCF_GUARD_SIZE)];
+
+    if (MW_DSP_ModAPCF_LFO_init(NULL, 0.5f, 48000.f) || MW_DSP_ModAPCF_LFO_init(&lfo, -0.5f, 48000.f) || MW_DSP_ModAPCF_LFO_init(&lfo, 0.5f, 0.f))
+        return 0;
+
+    if (!MW_DSP_ModAPCF_LFO_init(&lfo, 0.5f, 48000.f))
+        return 0;
+
+    if (MW_DSP_ModAPCF_init(NULL, delayLineBuffer, 64, 30.f, 5.f, 0.f, 0.5f))
+        return 0;
+
+    if (MW_DSP_ModAPCF_init(&filter, NULL, 64, 30.f, 5.f, 0.f, 0.5f))
+        return 0;
+
+    //  Delay range must fit between 1 sample and the end of the buffer
+    if (MW_DSP_ModAPCF_init(&filter, delayLineBuffer, 64, 5.f, 4.5f, 0.f, 0.5f))
+        return 0;
+
+    if (MW_DSP_ModAPCF_init(&filter, delayLineBuffer, 64, 60.f, 3.f, 0.f, 0.5f))
+        return 0;
+
+    if (MW_DSP_ModAPCF_init(&filter, delayLineBuffer, 64, 30.f, -1.f, 0.f, 0.5f))
+        return 0;
+
+    if (MW_DSP_ModAPCF_init(&filter, delayLineBuffer, 64, 30.f, 5.f, 0.f, 1.5f))
+        return 0;
+
+    if (!MW_DSP_ModAPCF_init(&filter, delayLineBuffer, 64, 30.f, 5.f, 0.f, 0.5f))
+        return 0;
+
+    if (filter.minDelay != 25 || filter.currentDelay != 30.f)
+        return 0;
+
+    return 1;
+}
+
+
+//  Without modulation a ModAPCF must match an APCF.  With modulation it must match a per-sample reference that ramps the
+//  delay between the LFO values at the block boundaries
+static int32_t MW_DSP_APCF_ModAPCFProcessTests()
+{
+    MW_DSP_ModAPCF      filter;
+    MW_DSP_ModAPCF_LFO  lfo;
+    MW_DSP_APCF         apcf;
+    float32_t           delayLineBuffer[MW_DSP_RINGBUFFER_MEMORY_SIZE(128, MW_DSP_MODAPCF_GUARD_SIZE)];
+    float32_t           apcfDelayLineBuffer[45];
+    float32_t           history[128];
+    float32_t           x[100];
+    float32_t           y[100];
+    size_t              blockSizes[] = {1, 13, 100, 32, 64, 7};
+
+    MW_DSP_ModAPCF_LFO_init(&lfo, 3.f, 1000.f);
+    MW_DSP_ModAPCF_init(&filter, delayLineBuffer, 128, 45.f, 0.f, 0.f, 0.6f);
+    arm_fill_f32(0.f, apcfDelayLineBuffer, 45);
+    MW_DSP_APCF_init(&apcf, apcfDelayLineBuffer, 45, 0.6f);
+
+    int32_t t = 0;
+    for (int32_t b = 0; b < 6; ++b)
+    {
+        for (size_t i = 0; i < blockSizes[b]; ++i, ++t)
+            x[i] = (t == 0) ? 1.f : 0.3f * arm_sin_f32(0.017f * 2.f * PI * t);
+
+        MW_DSP_ModAPCF_process(&filter, &lfo, x, y, blockSizes[b]);
+        MW_DSP_ModAPCF_LFO_advance(&lfo, blockSizes[b]);
+
+        for (size_t i = 0; i < blockSizes[b]; ++i)
+            if (fabsf(MW_DSP_APCF_tick(&apcf, x[i]) - y[i]) > 1e-6f)
+                return 0;
+    }
+
+    //  Modulated, with a minimum delay shorter than a block
+    float32_t M = 40.3f;
+    float32_t depth = 30.5f;
+    float32_t phaseOffset = 0.25f;
+
+    MW_DSP_ModAPCF_LFO_init(&lfo, 7.f, 1000.f);
+    MW_DSP_ModAPCF_init(&filter, delayLineBuffer, 128, M, depth, phaseOffset, 0.6f);
+    arm_fill_f32(0.f, history, 128);
+
+    float32_t delay = M + depth * arm_sin_f32(2.f * PI * phaseOffset);
+    int32_t ptr = 0;
+    t = 0;
+
+    for (int32_t block = 0; block < 30; ++block)
+    {
+        size_t blockSize = blockSizes[block % 6];
+        for (size_t i = 0; i < blockSize; ++i, ++t)
+            x[i] = (t == 0) ? 1.f : 0.3f * arm_sin_f32(0.017f * 2.f * PI * t);
+
+        MW_DSP_ModAPCF_process(&filter, &lfo, x, y, blockSize);
+
+        float32_t endDelay = M + depth * arm_sin_f32(2.f * PI * (lfo.phase + lfo.phaseIncrement * blockSize + phaseOffset));
+        float32_t increment = (endDelay - delay) / blockSize;
+
+        for (size_t i = 0; i < blockSize; ++i)
+        {
+            delay += increment;
+            int32_t delayInt = (int32_t)delay;
+            float32_t delayFrac = delay - delayInt;
+            float32_t newer = history[(ptr - delayInt + 128) % 128];
+            float32_t older = history[(ptr - delayInt - 1 + 128) % 128];
+            float32_t delayed = newer + delayFrac * (older - newer);
+
+            float32_t v = x[i] - 0.6f * delayed;
+            history[ptr] = v;
+            ptr = (ptr + 1) % 128;
+
+            if (fabsf(delayed + 0.6f * v - y[i]) > 1e-5f)
+                return 0;
+        }
+
+        delay = endDelay;
+        MW_DSP_ModAPCF_LFO_advance(&lfo, blockSize);
+    }
+
+    return 1;
+}
+
+
 int32_t MW_DSP_APCF_runUnitTests()
 {
     if (!MW_DSP_APCF_APCFInitializationTests())
@@ -150,5 +516,179 @@ int32_t MW_DSP_APCF_runUnitTests()
     if (!MW_DSP_APCF_NestedAPCFInitializationTests())
         return 0;
 
+    if (!MW_DSP_APCF_PowerOfTwoTests())
+        return 0;
+
+    if (!MW_DSP_APCF_Q15Tests())
+        return 0;
+
+    if (!MW_DSP_APCF_ProcessTests())
+        return 0;
+
+    if (!MW_DSP_APCF_ModAPCFInitializationTests())
+        return 0;
+
+    if (!MW_DSP_APCF_ModAPCFProcessTests())
+        return 0;
+
     return 1;
-}
\ No newline at end of file
+}
+
+
+
+/*
+ *  Compare MW_DSP_APCF_tick() against MW_DSP_APCF_process() for delay lengths from 16 samples, doubling on every run.
+ *  The 16 sample run takes the tick fallback.  delayLineMemory must hold at least N samples
+ *
+ *  Returns:
+ *    Number of results written
+ */
+size_t MW_DSP_APCF_runBenchmarks(float32_t *delayLineMemory, size_t memorySize, MW_UnitTest_BenchmarkResult *results, size_t maxResults)
+{
+    float32_t block[BENCHMARK_BLOCK_SIZE];
+    MW_DSP_APCF apcf;
+    size_t numResults = 0;
+
+    arm_fill_f32(0.5f, block, BENCHMARK_BLOCK_SIZE);
+
+    for (size_t N = 16; N <= 65536 && N <= memorySize && numResults < maxResults; N *= 2)
+    {
+        arm_fill_f32(0.f, delayLineMemory, N);
+        MW_DSP_APCF_init(&apcf, delayLineMemory, N, 0.7f);
+
+        uint32_t start = MW_AFXUnit_Utils_getCycleCount();
+        for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+            for (int32_t i = 0; i < BENCHMARK_BLOCK_SIZE; ++i)
+                block[i] = MW_DSP_APCF_tick(&apcf, block[i]);
+        uint32_t tickCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        arm_fill_f32(0.f, delayLineMemory, N);
+        MW_DSP_APCF_init(&apcf, delayLineMemory, N, 0.7f);
+
+        start = MW_AFXUnit_Utils_getCycleCount();
+        for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+            MW_DSP_APCF_process(&apcf, block, block, BENCHMARK_BLOCK_SIZE);
+        uint32_t processCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        results[numResults].N = N;
+        results[numResults].referenceCyclesPerSample = (float32_t)tickCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+        results[numResults].cyclesPerSample = (float32_t)processCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+        numResults++;
+    }
+
+    return numResults;
+}
+
+
+
+/*
+ *  Same as MW_DSP_APCF_runBenchmarks() for a nested APCF with two inner APCFs, laid out like the first nested APCF of
+ *  MW_AFXUnit_GardnerReverb.  N is the outer delay length and the inner delays are N/2 and N/4.  delayLineMemory must hold
+ *  at least 2 * N samples
+ *
+ *  Returns:
+ *    Number of results written
+ */
+size_t MW_DSP_NestedAPCF_runBenchmarks(float32_t *delayLineMemory, size_t memorySize, MW_UnitTest_BenchmarkResult *results, size_t maxResults)
+{
+    float32_t block[BENCHMARK_BLOCK_SIZE];
+    MW_DSP_APCF innerAPCFs[2];
+    MW_DSP_NestedAPCF nestedAPCF;
+    size_t numResults = 0;
+
+    arm_fill_f32(0.5f, block, BENCHMARK_BLOCK_SIZE);
+
+    for (size_t N = 64; N <= 65536 && 2 * N <= memorySize && numResults < maxResults; N *= 2)
+    {
+        arm_fill_f32(0.f, delayLineMemory, 2 * N);
+        MW_DSP_APCF_init(&innerAPCFs[0], delayLineMemory + N, N / 2, 0.25f);
+        MW_DSP_APCF_init(&innerAPCFs[1], delayLineMemory + N + N / 2, N / 4, 0.3f);
+        MW_DSP_NestedAPCF_init(&nestedAPCF, delayLineMemory, N, 0.5f, innerAPCFs, 2);
+
+        uint32_t start = MW_AFXUnit_Utils_getCycleCount();
+        for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+            for (int32_t i = 0; i < BENCHMARK_BLOCK_SIZE; ++i)
+                block[i] = MW_DSP_NestedAPCF_tick(&nestedAPCF, block[i]);
+        uint32_t tickCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        arm_fill_f32(0.f, delayLineMemory, 2 * N);
+        MW_DSP_APCF_init(&innerAPCFs[0], delayLineMemory + N, N / 2, 0.25f);
+        MW_DSP_APCF_init(&innerAPCFs[1], delayLineMemory + N + N / 2, N / 4, 0.3f);
+        MW_DSP_NestedAPCF_init(&nestedAPCF, delayLineMemory, N, 0.5f, innerAPCFs, 2);
+
+        start = MW_AFXUnit_Utils_getCycleCount();
+        for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+            MW_DSP_NestedAPCF_process(&nestedAPCF, block, block, BENCHMARK_BLOCK_SIZE);
+        uint32_t processCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        results[numResults].N = N;
+        results[numResults].referenceCyclesPerSample = (float32_t)tickCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+        results[numResults].cyclesPerSample = (float32_t)processCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+        numResults++;
+    }
+
+    return numResults;
+}
+
+
+
+/*
+ *  Compare a diffuser of MW_UNITTEST_MODAPCF_NUM_FILTERS plain APCFs run with MW_DSP_APCF_tick() against the same diffuser
+ *  built from MW_DSP_ModAPCF filters that share one LFO.  N is the shortest delay (doubled on every run, starting at 64) and
+ *  the modulation depth is N / 8.  delayLineMemory must hold at least 4 * MW_UNITTEST_MODAPCF_NUM_FILTERS * N samples
+ *
+ *  Returns:
+ *    Number of results written (cycles are per sample of the whole diffuser)
+ */
+size_t MW_DSP_ModAPCF_runBenchmarks(float32_t *delayLineMemory, size_t memorySize, MW_UnitTest_BenchmarkResult *results, size_t maxResults)
+{
+    float32_t block[BENCHMARK_BLOCK_SIZE];
+    MW_DSP_APCF apcfs[MW_UNITTEST_MODAPCF_NUM_FILTERS];
+    MW_DSP_ModAPCF modAPCFs[MW_UNITTEST_MODAPCF_NUM_FILTERS];
+    MW_DSP_ModAPCF_LFO lfo;
+    size_t numResults = 0;
+
+    for (size_t N = 64; 4 * MW_UNITTEST_MODAPCF_NUM_FILTERS * N <= memorySize && numResults < maxResults; N *= 2)
+    {
+        //  Delays from N to about 2N
+        size_t bufferSize = 2 * N + N / 8 + 2;
+        size_t memoryStride = MW_DSP_RINGBUFFER_MEMORY_SIZE(bufferSize, MW_DSP_MODAPCF_GUARD_SIZE);
+
+        arm_fill_f32(0.f, delayLineMemory, MW_UNITTEST_MODAPCF_NUM_FILTERS * memoryStride);
+        for (int32_t k = 0; k < MW_UNITTEST_MODAPCF_NUM_FILTERS; ++k)
+            MW_DSP_APCF_init(&apcfs[k], delayLineMemory + k * memoryStride, N + k * N / MW_UNITTEST_MODAPCF_NUM_FILTERS, 0.6f);
+
+        arm_fill_f32(0.5f, block, BENCHMARK_BLOCK_SIZE);
+
+        uint32_t start = MW_AFXUnit_Utils_getCycleCount();
+        for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+            for (int32_t i = 0; i < BENCHMARK_BLOCK_SIZE; ++i)
+                for (int32_t k = 0; k < MW_UNITTEST_MODAPCF_NUM_FILTERS; ++k)
+                    block[i] = MW_DSP_APCF_tick(&apcfs[k], block[i]);
+        uint32_t tickCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        MW_DSP_ModAPCF_LFO_init(&lfo, 0.7f, 48000.f);
+        for (int32_t k = 0; k < MW_UNITTEST_MODAPCF_NUM_FILTERS; ++k)
+            MW_DSP_ModAPCF_init(&modAPCFs[k], delayLineMemory + k * memoryStride, bufferSize, N + k * N / MW_UNITTEST_MODAPCF_NUM_FILTERS + N / 8,
+                                N / 8, (float32_t)k / MW_UNITTEST_MODAPCF_NUM_FILTERS, 0.6f);
+
+        arm_fill_f32(0.5f, block, BENCHMARK_BLOCK_SIZE);
+
+        start = MW_AFXUnit_Utils_getCycleCount();
+        for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+        {
+            for (int32_t k = 0; k < MW_UNITTEST_MODAPCF_NUM_FILTERS; ++k)
+                MW_DSP_ModAPCF_process(&modAPCFs[k], &lfo, block, block, BENCHMARK_BLOCK_SIZE);
+
+            MW_DSP_ModAPCF_LFO_advance(&lfo, BENCHMARK_BLOCK_SIZE);
+        }
+        uint32_t modCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        results[numResults].N = N;
+        results[numResults].referenceCyclesPerSample = (float32_t)tickCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+        results[numResults].cyclesPerSample = (float32_t)modCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+        numResults++;
+    }
+
+    return numResults;
+}
@@ -29,7 +29,14 @@
 
 #include "arm_math.h"
 #include "MW_DSP_APCF.h"
+#include "MW_UnitTestBenchmark.h"
+
+//  Number of filters in the diffuser used by MW_DSP_ModAPCF_runBenchmarks()
+#define MW_UNITTEST_MODAPCF_NUM_FILTERS 8
 
 int32_t MW_DSP_APCF_runUnitTests();
+size_t  MW_DSP_APCF_runBenchmarks(float32_t *delayLineMemory, size_t memorySize, MW_UnitTest_BenchmarkResult *results, size_t maxResults);
+size_t  MW_DSP_NestedAPCF_runBenchmarks(float32_t *delayLineMemory, size_t memorySize, MW_UnitTest_BenchmarkResult *results, size_t maxResults);
+size_t  MW_DSP_ModAPCF_runBenchmarks(float32_t *delayLineMemory, size_t memorySize, MW_UnitTest_BenchmarkResult *results, size_t maxResults);
 
 #endif /* MW_DSP_APCFTESTS_H_ */
@@ -0,0 +1,314 @@
+//  Copyright 2021 Allen Lee
+//
+//  Author:  Allen Lee (alee@meoworkshop.org)
+//  
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//  For more information, please refer to https://opensource.org/licenses/mit-license.php
+//
+//  ------------------------------------------------------------------------------------------------  //
+
+
+
+#include "MW_DSP_AllpassTreeTests.h"
+#include "MW_DSP_APCF.h"
+
+#define BENCHMARK_BLOCK_SIZE 128
+#define BENCHMARK_NUM_BLOCKS 64
+
+
+static int32_t MW_DSP_AllpassTree_initializationTests()
+{
+    MW_DSP_AllpassTree tree;
+    float32_t memory[100];
+    MW_DSP_AllpassTreeNode nodes[] = {{40, 0.5f, 2}, {20, 0.4f, 1}, {10, 0.3f, 0}, {15, 0.6f, 0}, {5, -0.2f, 0}};
+
+    if (MW_DSP_AllpassTree_calculateMemorySize(nodes, 5) != 90)
+        return 0;
+
+    if (MW_DSP_AllpassTree_init(NULL, nodes, 5, memory, 100))
+        return 0;
+
+    if (MW_DSP_AllpassTree_init(&tree, NULL, 5, memory, 100))
+        return 0;
+
+    if (MW_DSP_AllpassTree_init(&tree, nodes, 5, NULL, 100))
+        return 0;
+
+    if (MW_DSP_AllpassTree_init(&tree, nodes, 0, memory, 100))
+        return 0;
+
+    if (MW_DSP_AllpassTree_init(&tree, nodes, MW_DSP_ALLPASSTREE_MAX_NODES + 1, memory, 100))
+        return 0;
+
+    //  Not enough memory
+    if (MW_DSP_AllpassTree_init(&tree, nodes, 5, memory, 89))
+        return 0;
+
+    //  The first node claims more children than follow it
+    if (MW_DSP_AllpassTree_init(&tree, nodes, 3, memory, 100))
+        return 0;
+
+    //  Gain magnitude must be less than 1
+    nodes[2].gain = 1.2f;
+    if (MW_DSP_AllpassTree_init(&tree, nodes, 5, memory, 100))
+        return 0;
+
+    nodes[2].gain = -1.f;
+    if (MW_DSP_AllpassTree_init(&tree, nodes, 5, memory, 100))
+        return 0;
+    nodes[2].gain = 0.3f;
+
+    nodes[4].N = 0;
+    if (MW_DSP_AllpassTree_init(&tree, nodes, 5, memory, 100))
+        return 0;
+    nodes[4].N = 5;
+
+    //  Too deep
+    MW_DSP_AllpassTreeNode deepNodes[MW_DSP_ALLPASSTREE_MAX_DEPTH + 1];
+    for (int32_t i = 0; i <= MW_DSP_ALLPASSTREE_MAX_DEPTH; ++i)
+    {
+        deepNodes[i].N = 10;
+        deepNodes[i].gain = 0.5f;
+        deepNodes[i].numChildren = i < MW_DSP_ALLPASSTREE_MAX_DEPTH ? 1 : 0;
+    }
+
+    if (MW_DSP_AllpassTree_init(&tree, deepNodes, MW_DSP_ALLPASSTREE_MAX_DEPTH + 1, memory, 100))
+        return 0;
+
+    deepNodes[MW_DSP_ALLPASSTREE_MAX_DEPTH - 1].numChildren = 0;
+    if (!MW_DSP_AllpassTree_init(&tree, deepNodes, MW_DSP_ALLPASSTREE_MAX_DEPTH, memory, 100))
+        return 0;
+
+    //  Check the compiled schedule and memory layout
+    arm_fill_f32(1.f, memory, 100);
+    if (!MW_DSP_AllpassTree_init(&tree, nodes, 5, memory, 100))
+        return 0;
+
+    int32_t expectedSchedule[] = {0, 1, 2, ~2, ~1, 3, ~3, ~0, 4, ~4};
+    if (tree.scheduleLength != 10 || tree.minN != 5)
+        return 0;
+
+    for (int32_t i = 0; i < 10; ++i)
+        if (tree.schedule[i] != expectedSchedule[i])
+            return 0;
+
+    if (tree.offset[0] != 0 || tree.offset[3] != 70 || tree.offset[4] != 85)
+        return 0;
+
+    for (int32_t i = 0; i < 90; ++i)
+        if (memory[i] != 0.f)
+            return 0;
+
+    return 1;
+}
+
+
+//  A tree with one level of nesting must match MW_DSP_NestedAPCF (inner APCFs in series) followed by a standalone MW_DSP_APCF
+static int32_t MW_DSP_AllpassTree_nestedAPCFTests()
+{
+    MW_DSP_AllpassTree tree;
+    MW_DSP_NestedAPCF nestedAPCF;
+    MW_DSP_APCF innerAPCFs[2];
+    MW_DSP_APCF standaloneAPCF;
+    float32_t treeMemory[250];
+    float32_t apcfMemory[250];
+    MW_DSP_AllpassTreeNode nodes[] = {{110, 0.3f, 2}, {70, 0.4f, 0}, {27, 0.6f, 0}, {43, 0.4f, 0}};
+
+    arm_fill_f32(0.f, apcfMemory, 250);
+    MW_DSP_APCF_init(&innerAPCFs[0], apcfMemory + 110, 70, 0.4f);
+    MW_DSP_APCF_init(&innerAPCFs[1], apcfMemory + 180, 27, 0.6f);
+    MW_DSP_NestedAPCF_init(&nestedAPCF, apcfMemory, 110, 0.3f, innerAPCFs, 2);
+    MW_DSP_APCF_init(&standaloneAPCF, apcfMemory + 207, 43, 0.4f);
+
+    if (!MW_DSP_AllpassTree_init(&tree, nodes, 4, treeMemory, 250))
+        return 0;
+
+    size_t blockSizes[] = {1, 13, 100, 32, 64, 200};
+    float32_t block[200];
+    int32_t n = 0;
+
+    for (int32_t b = 0; b < 6; ++b)
+    {
+        float32_t x[200];
+        for (size_t i = 0; i < blockSizes[b]; ++i, ++n)
+            x[i] = (n == 0) ? 1.f : 0.3f * arm_sin_f32(0.017f * 2.f * PI * n);
+
+        MW_DSP_AllpassTree_process(&tree, x, block, blockSizes[b]);
+
+        for (size_t i = 0; i < blockSizes[b]; ++i)
+        {
+            float32_t y = MW_DSP_APCF_tick(&standaloneAPCF, MW_DSP_NestedAPCF_tick(&nestedAPCF, x[i]));
+            if (fabsf(y - block[i]) > 1e-6f)
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+
+//  Reference for deeper trees: recursive, one sample at a time.  Returns the index of the node after the subtree
+static int32_t MW_DSP_AllpassTree_referenceTick(const MW_DSP_AllpassTreeNode *nodes, int32_t node, float32_t **delayLines, int32_t *ptrs, float32_t *x)
+{
+    int32_t numChildren = nodes[node].numChildren;
+    int32_t next = node + 1;
+    float32_t delayed = delayLines[node][ptrs[node]];
+    float32_t v = *x - (nodes[node].gain * delayed);
+    float32_t temp = v;
+
+    for (int32_t i = 0; i < numChildren; ++i)
+        next = MW_DSP_AllpassTree_referenceTick(nodes, next, delayLines, ptrs, &temp);
+
+    delayLines[node][ptrs[node]] = temp;
+    ptrs[node] = (ptrs[node] + 1) % nodes[node].N;
+    *x = delayed + (nodes[node].gain * v);
+
+    return next;
+}
+
+
+//  Three levels of nesting with series nodes at every level, including delays shorter than a block
+static int32_t MW_DSP_AllpassTree_deepTreeTests()
+{
+    MW_DSP_AllpassTreeNode nodes[] = {{150, 0.5f, 3},
+                                          {60, 0.4f, 2},
+                                              {19, 0.3f, 0},
+                                              {23, -0.5f, 0},
+                                          {7, 0.25f, 0},
+                                          {41, 0.35f, 1},
+                                              {29, 0.45f, 0},
+                                      {37, 0.6f, 0}};
+    MW_DSP_AllpassTree tree;
+    float32_t treeMemory[366];
+    float32_t referenceMemory[366];
+    float32_t *delayLines[8];
+    int32_t ptrs[8] = {0};
+
+    arm_fill_f32(0.f, referenceMemory, 366);
+    delayLines[0] = referenceMemory;
+    for (int32_t i = 1; i < 8; ++i)
+        delayLines[i] = delayLines[i - 1] + nodes[i - 1].N;
+
+    if (!MW_DSP_AllpassTree_init(&tree, nodes, 8, treeMemory, 366))
+        return 0;
+
+    float32_t x[50];
+    float32_t y[50];
+    for (int32_t n = 0; n < 1000; n += 50)
+    {
+        for (int32_t i = 0; i < 50; ++i)
+            x[i] = y[i] = (n + i == 0) ? 1.f : 0.3f * arm_sin_f32(0.0071f * 2.f * PI * (n + i));
+
+        MW_DSP_AllpassTree_process(&tree, y, y, 50);
+
+        for (int32_t i = 0; i < 50; ++i)
+        {
+            float32_t reference = x[i];
+            MW_DSP_AllpassTree_referenceTick(nodes, 0, delayLines, ptrs, &reference);
+            MW_DSP_AllpassTree_referenceTick(nodes, 7, delayLines, ptrs, &reference);
+
+            if (fabsf(reference - y[i]) > 1e-5f)
+                return 0;
+        }
+    }
+
+    //  An allpass tree keeps the energy of an impulse
+    MW_DSP_AllpassTree_reset(&tree);
+
+    float32_t energy = 0.f;
+    for (int32_t n = 0; n < 40000; ++n)
+    {
+        float32_t out = MW_DSP_AllpassTree_tick(&tree, n == 0 ? 1.f : 0.f);
+        energy += out * out;
+    }
+
+    if (fabsf(energy - 1.f) > 1e-3f)
+        return 0;
+
+    return 1;
+}
+
+
+int32_t MW_DSP_AllpassTree_runUnitTests()
+{
+    if (!MW_DSP_AllpassTree_initializationTests())
+        return 0;
+
+    if (!MW_DSP_AllpassTree_nestedAPCFTests())
+        return 0;
+
+    if (!MW_DSP_AllpassTree_deepTreeTests())
+        return 0;
+
+    return 1;
+}
+
+
+
+/*
+ *  Compare the first nested APCF and standalone APCF of the Gardner reverb run with MW_DSP_NestedAPCF_tick() and
+ *  MW_DSP_APCF_tick() against the same structure compiled into an allpass tree.  N is the outer delay length (doubled on
+ *  every run) and the other delays are scaled to match.  delayLineMemory must hold at least 4 * N samples
+ *
+ *  Returns:
+ *    Number of results written
+ */
+size_t MW_DSP_AllpassTree_runBenchmarks(float32_t *delayLineMemory, size_t memorySize, MW_UnitTest_BenchmarkResult *results, size_t maxResults)
+{
+    float32_t block[BENCHMARK_BLOCK_SIZE];
+    MW_DSP_APCF innerAPCFs[2];
+    MW_DSP_APCF standaloneAPCF;
+    MW_DSP_NestedAPCF nestedAPCF;
+    MW_DSP_AllpassTree tree;
+    size_t numResults = 0;
+
+    arm_fill_f32(0.5f, block, BENCHMARK_BLOCK_SIZE);
+
+    for (size_t N = 128; N <= 65536 && 4 * N <= memorySize && numResults < maxResults; N *= 2)
+    {
+        MW_DSP_AllpassTreeNode nodes[] = {{N, 0.3f, 2}, {N * 22 / 35, 0.4f, 0}, {N * 83 / 350, 0.6f, 0}, {N * 30 / 35, 0.4f, 0}};
+
+        arm_fill_f32(0.f, delayLineMemory, 4 * N);
+        MW_DSP_APCF_init(&innerAPCFs[0], delayLineMemory + N, nodes[1].N, 0.4f);
+        MW_DSP_APCF_init(&innerAPCFs[1], delayLineMemory + 2 * N, nodes[2].N, 0.6f);
+        MW_DSP_NestedAPCF_init(&nestedAPCF, delayLineMemory, N, 0.3f, innerAPCFs, 2);
+        MW_DSP_APCF_init(&standaloneAPCF, delayLineMemory + 3 * N, nodes[3].N, 0.4f);
+
+        uint32_t start = MW_AFXUnit_Utils_getCycleCount();
+        for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+            for (int32_t i = 0; i < BENCHMARK_BLOCK_SIZE; ++i)
+                block[i] = MW_DSP_APCF_tick(&standaloneAPCF, MW_DSP_NestedAPCF_tick(&nestedAPCF, block[i]));
+        uint32_t tickCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        MW_DSP_AllpassTree_init(&tree, nodes, 4, delayLineMemory, 4 * N);
+
+        start = MW_AFXUnit_Utils_getCycleCount();
+        for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+            MW_DSP_AllpassTree_process(&tree, block, block, BENCHMARK_BLOCK_SIZE);
+        uint32_t treeCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        results[numResults].N = N;
+        results[numResults].referenceCyclesPerSample = (float32_t)tickCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+        results[numResults].cyclesPerSample = (float32_t)treeCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+        numResults++;
+    }
+
+    return numResults;
+}
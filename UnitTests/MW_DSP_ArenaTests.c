@@ -0,0 +1,251 @@
+//  Copyright 2021 Allen Lee
+//
+//  Author:  Allen Lee (alee@meoworkshop.org)
+//  
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//  For more information, please refer to https://opensource.org/licenses/mit-license.php
+//
+//  ------------------------------------------------------------------------------------------------  //
+
+
+
+#include "MW_DSP_ArenaTests.h"
+#include "MW_DSP_DelayLine.h"
+#include "MW_AFXUnit_Doppler.h"
+#include "MW_AFXUnit_Flutter.h"
+#include "MW_AFXUnit_Leslie.h"
+#include "MW_AFXUnit_Granular.h"
+#include "MW_AFXUnit_GardnerReverb.h"
+
+#define ARENA_TEST_NUM_UNITS 30
+
+static uint8_t _arenaMemory[MW_DSP_ARENA_MEMORY_SIZE(512 * 1024)];
+
+
+static int32_t MW_DSP_Arena_isAligned(const void *buffer)
+{
+  return ((uintptr_t)buffer & (MW_DSP_ARENA_ALIGNMENT - 1)) == 0;
+}
+
+
+static int32_t MW_DSP_Arena_initializationTests()
+{
+  MW_DSP_Arena arena;
+
+  if (MW_DSP_Arena_init(NULL, _arenaMemory, 1024))
+    return 0;
+
+  if (MW_DSP_Arena_init(&arena, NULL, 1024))
+    return 0;
+
+  //  The memory block doesn't need to be aligned
+  if (!MW_DSP_Arena_init(&arena, _arenaMemory + 3, 1024))
+    return 0;
+
+  if (!MW_DSP_Arena_isAligned(arena.base) || arena.base < _arenaMemory + 3 || arena.used != 0)
+    return 0;
+
+  if (arena.base + arena.size != _arenaMemory + 3 + 1024)
+    return 0;
+
+  return 1;
+}
+
+
+static int32_t MW_DSP_Arena_allocationTests()
+{
+  MW_DSP_Arena arena;
+
+  if (!MW_DSP_Arena_init(&arena, _arenaMemory, 256))
+    return 0;
+
+  //  Buffers are aligned and packed one after another
+  float32_t *a = MW_DSP_Arena_allocFloat(&arena, 5);
+  float32_t *b = MW_DSP_Arena_allocFloat(&arena, 8);
+  uint8_t *c = (uint8_t*)MW_DSP_Arena_alloc(&arena, 1);
+
+  if (a == NULL || b == NULL || c == NULL)
+    return 0;
+
+  if (!MW_DSP_Arena_isAligned(a) || !MW_DSP_Arena_isAligned(b) || !MW_DSP_Arena_isAligned(c))
+    return 0;
+
+  if ((uint8_t*)b != (uint8_t*)a + MW_DSP_ARENA_ALIGNED_SIZE(5 * sizeof(float32_t)) || c != (uint8_t*)b + 32)
+    return 0;
+
+  //  Running out of memory returns NULL without using up the rest of the arena
+  size_t remaining = MW_DSP_Arena_bytesRemaining(&arena);
+  if (MW_DSP_Arena_alloc(&arena, remaining + 1) != NULL || MW_DSP_Arena_bytesRemaining(&arena) != remaining)
+    return 0;
+
+  if (MW_DSP_Arena_alloc(&arena, 0) != NULL)
+    return 0;
+
+  //  Releasing to a marker frees everything allocated after it
+  size_t marker = MW_DSP_Arena_mark(&arena);
+  if (MW_DSP_Arena_alloc(&arena, remaining) == NULL || MW_DSP_Arena_bytesRemaining(&arena) != 0)
+    return 0;
+
+  MW_DSP_Arena_release(&arena, marker);
+  if (MW_DSP_Arena_bytesRemaining(&arena) != remaining)
+    return 0;
+
+  MW_DSP_Arena_reset(&arena);
+  if (MW_DSP_Arena_allocFloat(&arena, 5) != a)
+    return 0;
+
+  return 1;
+}
+
+
+//  Build a 30 unit chain out of one arena.  Every buffer must be aligned and sit right after the previous one, and a failed
+//  initialization must not use up any arena memory
+static int32_t MW_DSP_Arena_unitChainTests()
+{
+  static MW_DSP_DelayLine           delayLines[ARENA_TEST_NUM_UNITS / 6];
+  static MW_DSP_FractionalDelayLine fractionalDelayLines[ARENA_TEST_NUM_UNITS / 6];
+  static MW_AFXUnit_Doppler         dopplers[ARENA_TEST_NUM_UNITS / 6];
+  static MW_AFXUnit_Flutter         flutters[ARENA_TEST_NUM_UNITS / 6];
+  static MW_AFXUnit_Leslie          leslies[ARENA_TEST_NUM_UNITS / 6];
+  static MW_AFXUnit_Granular        granular;
+  static MW_AFXUnit_GardnerReverb   reverbs[ARENA_TEST_NUM_UNITS / 6 - 1];
+  MW_DSP_Arena arena;
+
+  if (!MW_DSP_Arena_init(&arena, _arenaMemory, sizeof(_arenaMemory)))
+    return 0;
+
+  const uint8_t *expectedNext = arena.base;
+
+  for (int32_t i = 0; i < ARENA_TEST_NUM_UNITS / 6; ++i)
+  {
+    if (!MW_DSP_DelayLine_init_arena(&delayLines[i], &arena, 100 + i))
+      return 0;
+
+    if ((uint8_t*)delayLines[i].buffer != expectedNext)
+      return 0;
+    expectedNext += MW_DSP_ARENA_ALIGNED_SIZE((100 + i) * sizeof(float32_t));
+
+    if (!MW_DSP_FractionalDelayLine_init_arena(&fractionalDelayLines[i], &arena, 200, 20.5f, MW_DSP_FRAC_DELAY_HERMITE))
+      return 0;
+
+    if ((uint8_t*)fractionalDelayLines[i].buffer != expectedNext || fractionalDelayLines[i].ringBuffer.guardSize != MW_DSP_FRAC_DELAY_GUARD_SIZE)
+      return 0;
+    expectedNext += MW_DSP_ARENA_ALIGNED_SIZE(MW_DSP_RINGBUFFER_MEMORY_SIZE(200, MW_DSP_FRAC_DELAY_GUARD_SIZE) * sizeof(float32_t));
+
+    if (!MW_AFXUnit_Doppler_init_arena(&dopplers[i], &arena, 300, 32000.f))
+      return 0;
+
+    if ((uint8_t*)dopplers[i].buffer != expectedNext)
+      return 0;
+    expectedNext += MW_DSP_ARENA_ALIGNED_SIZE(MW_DSP_RINGBUFFER_MEMORY_SIZE(300, MW_AFXUNIT_DOPPLER_GUARD_SIZE) * sizeof(float32_t));
+
+    if (!MW_AFXUnit_Flutter_init_arena(&flutters[i], &arena, 1000.f, 50.f, 100, 40.f, 7.f, 0.8f))
+      return 0;
+
+    if ((uint8_t*)flutters[i].delay.buffer != expectedNext)
+      return 0;
+    expectedNext += MW_DSP_ARENA_ALIGNED_SIZE(100 * sizeof(float32_t));
+
+    if (!MW_AFXUnit_Leslie_init_arena(&leslies[i], &arena, 256, 44100.f, 100.f))
+      return 0;
+
+    if ((uint8_t*)leslies[i].delay.buffer != expectedNext)
+      return 0;
+    expectedNext += MW_DSP_ARENA_ALIGNED_SIZE(256 * sizeof(float32_t));
+
+    if (i == ARENA_TEST_NUM_UNITS / 6 - 1)
+    {
+      if (!MW_AFXUnit_Granular_init_arena(&granular, &arena, 3200, 0.05f, 0.1f, 32000.f))
+        return 0;
+
+      if ((uint8_t*)granular.tapeBuffer != expectedNext)
+        return 0;
+      expectedNext += MW_DSP_ARENA_ALIGNED_SIZE(3200 * sizeof(float32_t));
+    }
+    else
+    {
+      if (!MW_AFXUnit_GardnerReverb_init_arena(&reverbs[i], &arena, 0.5f, 32000.f))
+        return 0;
+
+      if ((uint8_t*)reverbs[i].delayLineMemory != expectedNext)
+        return 0;
+      expectedNext += MW_DSP_ARENA_ALIGNED_SIZE(MW_AFXUnit_GardnerReverb_calculateMemorySize(32000.f) * sizeof(float32_t));
+    }
+  }
+
+  if (arena.base + arena.used != expectedNext)
+    return 0;
+
+  //  Invalid parameters must not use up arena memory
+  size_t remaining = MW_DSP_Arena_bytesRemaining(&arena);
+  MW_DSP_FractionalDelayLine badDelayLine;
+  MW_AFXUnit_GardnerReverb badReverb;
+
+  if (MW_DSP_FractionalDelayLine_init_arena(&badDelayLine, &arena, 200, 300.f, MW_DSP_FRAC_DELAY_LINEAR))
+    return 0;
+
+  if (MW_AFXUnit_GardnerReverb_init_arena(&badReverb, &arena, 1.5f, 32000.f))
+    return 0;
+
+  if (MW_DSP_DelayLine_init_arena(&delayLines[0], &arena, remaining))
+    return 0;
+
+  if (MW_DSP_Arena_bytesRemaining(&arena) != remaining)
+    return 0;
+
+  return 1;
+}
+
+
+//  The exact Gardner reverb memory size must fit within the 340 msec rule of thumb and cover every APCF and delay line
+static int32_t MW_DSP_Arena_gardnerMemorySizeTests()
+{
+  float32_t fs[] = {32000.f, 44100.f, 48000.f};
+  int32_t delayLineStarts[MW_AFXUNIT_GARDNERREVERB_TOTAL_DELAY_LINES];
+
+  for (int32_t i = 0; i < 3; ++i)
+  {
+    int32_t memorySize = MW_AFXUnit_GardnerReverb_calculateMemorySize(fs[i]);
+    MW_AFXUnit_GardnerReverb_calculateDelayIndices(delayLineStarts, fs[i]);
+
+    if (memorySize > (int32_t)(0.34f * fs[i]) || memorySize <= delayLineStarts[MW_AFXUNIT_GARDNERREVERB_TOTAL_DELAY_LINES - 1])
+      return 0;
+  }
+
+  return 1;
+}
+
+
+int32_t MW_DSP_Arena_runUnitTests()
+{
+  if (!MW_DSP_Arena_initializationTests())
+    return 0;
+
+  if (!MW_DSP_Arena_allocationTests())
+    return 0;
+
+  if (!MW_DSP_Arena_unitChainTests())
+    return 0;
+
+  if (!MW_DSP_Arena_gardnerMemorySizeTests())
+    return 0;
+
+  return 1;
+}
@@ -27,6 +27,12 @@
 
 #include "MW_DSP_CombFilterTests.h"
 
+#define BENCHMARK_BLOCK_SIZE 128
+#define BENCHMARK_NUM_BLOCKS 64
+
+//  Freeverb comb lengths at 44.1 kHz
+static const int32_t FREEVERB_COMB_LENGTHS[8] = {1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617};
+
 
 static int32_t MW_DSP_CombFilter_runInitializationTests()
 {
@@ -72,8 +78,326 @@ static int32_t MW_DSP_CombFilter_runInitializationTests()
 }
 
 
+//  A power-of-two FBCF must behave exactly like a regular FBCF of the same length
+static int32_t MW_DSP_CombFilter_runPowerOfTwoTests()
+{
+    MW_DSP_FBCF filter;
+    MW_DSP_FBCF pow2Filter;
+    float32_t filterDelayLine[23];
+    float32_t pow2FilterDelayLine[32];
+    int32_t N = 23;
+
+    if (MW_DSP_FBCF_init_pow2(&pow2Filter, pow2FilterDelayLine, 16, N, 1.f, 0.7f))
+        return 0;
+
+    if (MW_DSP_FBCF_init_pow2(&pow2Filter, pow2FilterDelayLine, 24, N, 1.f, 0.7f))
+        return 0;
+
+    arm_fill_f32(0.f, filterDelayLine, N);
+    arm_fill_f32(0.f, pow2FilterDelayLine, 32);
+    if (!MW_DSP_FBCF_init(&filter, filterDelayLine, N, 1.f, 0.7f) || !MW_DSP_FBCF_init_pow2(&pow2Filter, pow2FilterDelayLine, 32, N, 1.f, 0.7f))
+        return 0;
+
+    for (int32_t i = 0; i < 200; ++i)
+    {
+        float32_t x = (i == 0) ? 1.f : arm_sin_f32(0.0123f * 2.f * PI * i);
+        if (MW_DSP_FBCF_tick(&filter, x) != MW_DSP_FBCF_tick_pow2(&pow2Filter, x))
+            return 0;
+    }
+
+    return 1;
+}
+
+
+//  Q15 FBCFs must track float FBCFs to within the Q15 quantization error.  b0 is scaled by (1 - am) so that the
+//  resonant peaks of the comb stay below full scale
+static int32_t MW_DSP_CombFilter_runQ15Tests()
+{
+    MW_DSP_FBCF filter;
+    MW_DSP_FBCF q15Filter;
+    float32_t filterDelayLine[23];
+    q15_t q15FilterDelayLine[23];
+    int32_t N = 23;
+    float32_t am = 0.7f;
+    float32_t b0 = 1.f - am;
+
+    int32_t success = MW_DSP_FBCF_init_q15(NULL, q15FilterDelayLine, N, b0, am);
+    if (success)
+        return 0;
+
+    success = MW_DSP_FBCF_init_q15(&q15Filter, NULL, N, b0, am);
+    if (success)
+        return 0;
+
+    success = MW_DSP_FBCF_init_q15(&q15Filter, q15FilterDelayLine, 0, b0, am);
+    if (success)
+        return 0;
+
+    arm_fill_f32(0.f, filterDelayLine, N);
+    if (!MW_DSP_FBCF_init(&filter, filterDelayLine, N, b0, am))
+        return 0;
+
+    if (!MW_DSP_FBCF_init_q15(&q15Filter, q15FilterDelayLine, N, b0, am))
+        return 0;
+
+    if (q15Filter.delayLine != NULL || q15Filter.delayLineQ15 != q15FilterDelayLine)
+        return 0;
+
+    float32_t signalPower = 0.f;
+    float32_t noisePower = 0.f;
+    for (int32_t i = 0; i < 2000; ++i)
+    {
+        float32_t x = 0.9f * arm_sin_f32(0.0123f * 2.f * PI * i);
+        float32_t y = MW_DSP_FBCF_tick(&filter, x);
+        float32_t yQ15 = MW_DSP_FBCF_tick_q15(&q15Filter, x);
+
+        signalPower += y * y;
+        noisePower += (yQ15 - y) * (yQ15 - y);
+    }
+
+    if (10.f * log10f(signalPower / noisePower) < 75.f)
+        return 0;
+
+    return 1;
+}
+
+
+static int32_t MW_DSP_CombFilter_runBankInitializationTests()
+{
+    MW_DSP_FBCFBank bank;
+    float32_t memory[64];
+    int32_t N[3] = {10, 20, 30};
+    float32_t b0[3] = {1.f, 1.f, 1.f};
+    float32_t am[3] = {0.5f, 0.5f, 0.5f};
+
+    if (MW_DSP_FBCFBank_calculateMemorySize(N, 3) != 60)
+        return 0;
+
+    if (MW_DSP_FBCFBank_init(NULL, memory, 64, N, b0, am, 3))
+        return 0;
+
+    if (MW_DSP_FBCFBank_init(&bank, NULL, 64, N, b0, am, 3))
+        return 0;
+
+    if (MW_DSP_FBCFBank_init(&bank, memory, 64, N, NULL, am, 3))
+        return 0;
+
+    if (MW_DSP_FBCFBank_init(&bank, memory, 64, N, b0, am, 0))
+        return 0;
+
+    if (MW_DSP_FBCFBank_init(&bank, memory, 64, N, b0, am, MW_DSP_FBCFBANK_MAX_COMBS + 1))
+        return 0;
+
+    if (MW_DSP_FBCFBank_init(&bank, memory, 59, N, b0, am, 3))
+        return 0;
+
+    N[1] = 0;
+    if (MW_DSP_FBCFBank_init(&bank, memory, 64, N, b0, am, 3))
+        return 0;
+    N[1] = 20;
+
+    arm_fill_f32(1.f, memory, 64);
+    if (!MW_DSP_FBCFBank_init(&bank, memory, 64, N, b0, am, 3))
+        return 0;
+
+    if (bank.delayLines[2] != memory + 30 || bank.minN != 10 || memory[59] != 0.f || memory[60] != 1.f)
+        return 0;
+
+    if (MW_DSP_FBCFBank_setDamping(&bank, 3, 0.5f) || MW_DSP_FBCFBank_setDamping(&bank, 0, 1.f) || MW_DSP_FBCFBank_setDamping(&bank, -2, 0.5f))
+        return 0;
+
+    if (!MW_DSP_FBCFBank_setDamping(&bank, -1, 0.2f) || bank.damping[0] != 0.2f || bank.damping[2] != 0.2f)
+        return 0;
+
+    return 1;
+}
+
+
+//  Without damping, each comb of a bank must match a MW_DSP_FBCF.  With damping, it must match an FBCF with a one-pole
+//  lowpass in its feedback path
+static int32_t MW_DSP_CombFilter_runBankTests()
+{
+    static float32_t bankMemory[400];
+    static float32_t combMemory[5][100];
+    static float32_t outputMemory[5][100];
+    MW_DSP_FBCFBank bank;
+    MW_DSP_FBCF combs[5];
+    float32_t *outputs[5];
+    int32_t N[5] = {100, 41, 9, 77, 53};
+    float32_t b0[5] = {1.f, 0.5f, 0.8f, -1.f, 0.3f};
+    float32_t am[5] = {0.7f, -0.6f, 0.5f, 0.84f, 0.2f};
+    float32_t damping[5] = {0.f, 0.2f, 0.5f, 0.9f, 0.1f};
+
+    if (!MW_DSP_FBCFBank_init(&bank, bankMemory, 400, N, b0, am, 5))
+        return 0;
+
+    for (int32_t k = 0; k < 5; ++k)
+    {
+        arm_fill_f32(0.f, combMemory[k], 100);
+        MW_DSP_FBCF_init(&combs[k], combMemory[k], N[k], b0[k], am[k]);
+        outputs[k] = outputMemory[k];
+    }
+
+    //  Summed output, then separate outputs
+    float32_t x[100];
+    float32_t y[100];
+    size_t blockSizes[] = {1, 5, 100, 37, 64};
+    int32_t t = 0;
+
+    for (int32_t b = 0; b < 5; ++b)
+    {
+        for (size_t n = 0; n < blockSizes[b]; ++n, ++t)
+            x[n] = y[n] = (t == 0) ? 1.f : 0.3f * arm_sin_f32(0.013f * 2.f * PI * t);
+
+        if (b < 3)
+            MW_DSP_FBCFBank_process(&bank, y, y, blockSizes[b]);
+        else
+            MW_DSP_FBCFBank_processOutputs(&bank, x, outputs, blockSizes[b]);
+
+        for (size_t n = 0; n < blockSizes[b]; ++n)
+        {
+            float32_t sum = 0.f;
+            for (int32_t k = 0; k < 5; ++k)
+            {
+                float32_t v = MW_DSP_FBCF_tick(&combs[k], x[n]);
+                sum += v;
+
+                if (b >= 3 && fabsf(outputs[k][n] - v) > 1e-6f)
+                    return 0;
+            }
+
+            if (b < 3 && fabsf(y[n] - sum) > 1e-5f)
+                return 0;
+        }
+    }
+
+    //  Damped combs against a reference
+    float32_t lowpassState[5] = {0.f};
+    int32_t ptrs[5] = {0};
+
+    for (int32_t k = 0; k < 5; ++k)
+    {
+        MW_DSP_FBCFBank_setDamping(&bank, k, damping[k]);
+        arm_fill_f32(0.f, combMemory[k], 100);
+    }
+    MW_DSP_FBCFBank_reset(&bank);
+
+    for (t = 0; t < 1000; t += 100)
+    {
+        for (int32_t n = 0; n < 100; ++n)
+            x[n] = (t + n == 0) ? 1.f : 0.3f * arm_sin_f32(0.021f * 2.f * PI * (t + n));
+
+        MW_DSP_FBCFBank_processOutputs(&bank, x, outputs, 100);
+
+        for (int32_t n = 0; n < 100; ++n)
+        {
+            for (int32_t k = 0; k < 5; ++k)
+            {
+                float32_t delayed = combMemory[k][ptrs[k]];
+                lowpassState[k] = ((1.f - damping[k]) * delayed) + (damping[k] * lowpassState[k]);
+                float32_t v = (x[n] * b0[k]) + (lowpassState[k] * am[k]);
+                combMemory[k][ptrs[k]] = v;
+                ptrs[k] = (ptrs[k] + 1) % N[k];
+
+                if (fabsf(outputs[k][n] - v) > 1e-5f)
+                    return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+
 int32_t MW_DSP_CombFilter_runUnitTests()
 {
     MW_DSP_CombFilter_runInitializationTests();
+
+    if (!MW_DSP_CombFilter_runPowerOfTwoTests())
+        return 0;
+
+    if (!MW_DSP_CombFilter_runQ15Tests())
+        return 0;
+
+    if (!MW_DSP_CombFilter_runBankInitializationTests())
+        return 0;
+
+    if (!MW_DSP_CombFilter_runBankTests())
+        return 0;
+
     return 1;
-}
\ No newline at end of file
+}
+
+
+
+/*
+ *  Compare a Freeverb style bank of combs run as separate MW_DSP_FBCF_tick() calls (summed) against a MW_DSP_FBCFBank with the
+ *  same combs.  The number of combs is doubled on every run, starting at 2 (up to 16; the Freeverb lengths are reused
+ *  for combs 9 to 16).  delayLineMemory must hold at least 2 * 16 * 1617 samples
+ *
+ *  Returns:
+ *    Number of results written (N is the number of combs)
+ */
+size_t MW_DSP_FBCFBank_runBenchmarks(float32_t *delayLineMemory, size_t memorySize, MW_UnitTest_BenchmarkResult *results, size_t maxResults)
+{
+    float32_t block[BENCHMARK_BLOCK_SIZE];
+    MW_DSP_FBCF combs[MW_DSP_FBCFBANK_MAX_COMBS];
+    MW_DSP_FBCFBank bank;
+    int32_t N[MW_DSP_FBCFBANK_MAX_COMBS];
+    float32_t b0[MW_DSP_FBCFBANK_MAX_COMBS];
+    float32_t am[MW_DSP_FBCFBANK_MAX_COMBS];
+    size_t numResults = 0;
+
+    for (int32_t k = 0; k < MW_DSP_FBCFBANK_MAX_COMBS; ++k)
+    {
+        N[k] = FREEVERB_COMB_LENGTHS[k % 8];
+        b0[k] = 0.015f;
+        am[k] = 0.84f;
+    }
+
+    for (int32_t numCombs = 2; numCombs <= MW_DSP_FBCFBANK_MAX_COMBS && numResults < maxResults; numCombs *= 2)
+    {
+        size_t bankMemorySize = MW_DSP_FBCFBank_calculateMemorySize(N, numCombs);
+        if (2 * bankMemorySize > memorySize)
+            break;
+
+        arm_fill_f32(0.f, delayLineMemory, bankMemorySize);
+        float32_t *delayLine = delayLineMemory;
+        for (int32_t k = 0; k < numCombs; ++k)
+        {
+            MW_DSP_FBCF_init(&combs[k], delayLine, N[k], b0[k], am[k]);
+            delayLine += N[k];
+        }
+
+        arm_fill_f32(0.5f, block, BENCHMARK_BLOCK_SIZE);
+
+        uint32_t start = MW_AFXUnit_Utils_getCycleCount();
+        for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+        {
+            for (int32_t i = 0; i < BENCHMARK_BLOCK_SIZE; ++i)
+            {
+                float32_t sum = 0.f;
+                for (int32_t k = 0; k < numCombs; ++k)
+                    sum += MW_DSP_FBCF_tick(&combs[k], block[i]);
+
+                block[i] = sum;
+            }
+        }
+        uint32_t tickCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        MW_DSP_FBCFBank_init(&bank, delayLineMemory + bankMemorySize, bankMemorySize, N, b0, am, numCombs);
+        arm_fill_f32(0.5f, block, BENCHMARK_BLOCK_SIZE);
+
+        start = MW_AFXUnit_Utils_getCycleCount();
+        for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+            MW_DSP_FBCFBank_process(&bank, block, block, BENCHMARK_BLOCK_SIZE);
+        uint32_t bankCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+        results[numResults].N = numCombs;
+        results[numResults].referenceCyclesPerSample = (float32_t)tickCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+        results[numResults].cyclesPerSample = (float32_t)bankCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+        numResults++;
+    }
+
+    return numResults;
+}
@@ -29,7 +29,9 @@
 
 #include "arm_math.h"
 #include "MW_DSP_CombFilter.h"
+#include "MW_UnitTestBenchmark.h"
 
 int32_t MW_DSP_CombFilter_runUnitTests();
+size_t  MW_DSP_FBCFBank_runBenchmarks(float32_t *delayLineMemory, size_t memorySize, MW_UnitTest_BenchmarkResult *results, size_t maxResults);
 
 #endif /* MW_DSP_COMBFILTERTESTS_H_ */
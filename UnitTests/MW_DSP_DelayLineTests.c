@@ -29,6 +29,8 @@
 
 
 #define NAN_VALUE 0x7FC00000
+#define BENCHMARK_BLOCK_SIZE 128
+#define BENCHMARK_NUM_BLOCKS 64
 
 
 static int32_t MW_DSP_DelayLine_StandardOperation()
@@ -111,6 +113,445 @@ static int32_t MW_DSP_DelayLine_MemoryAllocTest()
 }
 
 
+//  process() must give the same output as calling tick() on every sample
+//  Check block sizes that are smaller than, equal to and larger than the delay line, both in-place and out-of-place
+static int32_t MW_DSP_DelayLine_BlockProcessingTest()
+{
+  size_t delayLineSize = 7;
+  float32_t tickBuffer[7];
+  float32_t processBuffer[7];
+  size_t blockSizes[] = {1, 3, 7, 10, 2, 16};
+
+  float32_t input[16];
+  float32_t expected[16];
+  float32_t output[16];
+
+  MW_DSP_DelayLine tickDelayLine;
+  MW_DSP_DelayLine processDelayLine;
+
+  for (int32_t inPlace = 0; inPlace < 2; ++inPlace)
+  {
+    if (!MW_DSP_DelayLine_init(&tickDelayLine, tickBuffer, delayLineSize))
+      return 0;
+
+    if (!MW_DSP_DelayLine_init(&processDelayLine, processBuffer, delayLineSize))
+      return 0;
+
+    float32_t sampleValue = 1.f;
+
+    for (size_t block = 0; block < sizeof(blockSizes) / sizeof(blockSizes[0]); ++block)
+    {
+      size_t blockSize = blockSizes[block];
+
+      for (size_t i = 0; i < blockSize; ++i)
+      {
+        input[i] = sampleValue;
+        sampleValue += 1.f;
+        expected[i] = MW_DSP_DelayLine_tick(&tickDelayLine, input[i]);
+      }
+
+      if (inPlace)
+      {
+        arm_copy_f32(input, output, blockSize);
+        MW_DSP_DelayLine_process(&processDelayLine, output, output, blockSize);
+      }
+      else
+        MW_DSP_DelayLine_process(&processDelayLine, input, output, blockSize);
+
+      for (size_t i = 0; i < blockSize; ++i)
+        if (output[i] != expected[i])
+          return 0;
+
+      if (processDelayLine.currentPtr != tickDelayLine.currentPtr)
+        return 0;
+    }
+  }
+
+  return 1;
+}
+
+
+//  setDelayLength() must not clear the delay line, must give the same output through tick() and process() while
+//  crossfading and must settle on the new delay length once the crossfade is done
+static int32_t MW_DSP_DelayLine_SetDelayLengthTest()
+{
+  float32_t tickBuffer[64];
+  float32_t processBuffer[64];
+  float32_t pow2TickBuffer[64];
+  float32_t pow2ProcessBuffer[64];
+  float32_t delayLengths[] = {40.f, 7.f, 64.f, 1.f, 23.4f, 50.f};
+  size_t blockSizes[] = {5, 32, 1, 100, 17, 64};
+
+  float32_t input[100];
+  float32_t expected[100];
+  float32_t pow2Expected[100];
+  float32_t output[100];
+  float32_t pow2Output[100];
+
+  MW_DSP_DelayLine tickDelayLine;
+  MW_DSP_DelayLine processDelayLine;
+  MW_DSP_DelayLine pow2TickDelayLine;
+  MW_DSP_DelayLine pow2ProcessDelayLine;
+
+  for (size_t crossfadeLength = 0; crossfadeLength <= 45; crossfadeLength += 15)
+  {
+    if (!MW_DSP_DelayLine_init(&tickDelayLine, tickBuffer, 64))
+      return 0;
+
+    if (!MW_DSP_DelayLine_init(&processDelayLine, processBuffer, 64))
+      return 0;
+
+    if (!MW_DSP_DelayLine_init_pow2(&pow2TickDelayLine, pow2TickBuffer, 64, 64))
+      return 0;
+
+    if (!MW_DSP_DelayLine_init_pow2(&pow2ProcessDelayLine, pow2ProcessBuffer, 64, 64))
+      return 0;
+
+    MW_DSP_DelayLine_setCrossfadeLength(&tickDelayLine, crossfadeLength);
+    MW_DSP_DelayLine_setCrossfadeLength(&processDelayLine, crossfadeLength);
+    MW_DSP_DelayLine_setCrossfadeLength(&pow2TickDelayLine, crossfadeLength);
+    MW_DSP_DelayLine_setCrossfadeLength(&pow2ProcessDelayLine, crossfadeLength);
+
+    int32_t n = 0;
+    for (size_t change = 0; change < sizeof(delayLengths) / sizeof(delayLengths[0]); ++change)
+    {
+      MW_DSP_DelayLine_setDelayLength(&tickDelayLine, delayLengths[change]);
+      MW_DSP_DelayLine_setDelayLength(&processDelayLine, delayLengths[change]);
+      MW_DSP_DelayLine_setDelayLength(&pow2TickDelayLine, delayLengths[change]);
+      MW_DSP_DelayLine_setDelayLength(&pow2ProcessDelayLine, delayLengths[change]);
+
+      //  A change during a crossfade is queued until the crossfade completes
+      size_t delayLength = (size_t)(delayLengths[change] + 0.5f);
+      size_t requested = tickDelayLine.pendingN ? tickDelayLine.pendingN : tickDelayLine.N;
+      size_t pow2Requested = pow2TickDelayLine.pendingN ? pow2TickDelayLine.pendingN : pow2TickDelayLine.N;
+      if (requested != delayLength || pow2Requested != delayLength)
+        return 0;
+
+      //  Two blocks per delay length so that the second block is past the crossfade
+      for (int32_t block = 0; block < 2; ++block)
+      {
+        size_t blockSize = blockSizes[(2 * change + block) % (sizeof(blockSizes) / sizeof(blockSizes[0]))];
+        int32_t crossfadeDone = tickDelayLine.crossfadeRemaining == 0;
+
+        for (size_t i = 0; i < blockSize; ++i)
+        {
+          input[i] = (float32_t)(n + i + 1);
+          expected[i] = MW_DSP_DelayLine_tick(&tickDelayLine, input[i]);
+          pow2Expected[i] = MW_DSP_DelayLine_tick(&pow2TickDelayLine, input[i]);
+        }
+
+        MW_DSP_DelayLine_process(&processDelayLine, input, output, blockSize);
+        arm_copy_f32(input, pow2Output, blockSize);
+        MW_DSP_DelayLine_process(&pow2ProcessDelayLine, pow2Output, pow2Output, blockSize);
+
+        for (size_t i = 0; i < blockSize; ++i)
+        {
+          if (output[i] != expected[i] || pow2Output[i] != pow2Expected[i] || expected[i] != pow2Expected[i])
+            return 0;
+
+          //  The input is a ramp so once the crossfade is done the output is the sample index minus the delay
+          float32_t delayed = (n + (int32_t)i + 1 > (int32_t)delayLength) ? (float32_t)(n + (int32_t)i + 1 - (int32_t)delayLength) : 0.f;
+          if (crossfadeDone && expected[i] != delayed)
+            return 0;
+        }
+
+        n += blockSize;
+      }
+    }
+  }
+
+  return 1;
+}
+
+
+//  A crossfaded delay change must not jump further than the signal itself moves over the crossfade
+static int32_t MW_DSP_DelayLine_CrossfadeClickTest()
+{
+  float32_t buffer[1000];
+  MW_DSP_DelayLine delayLine;
+
+  for (int32_t crossfade = 0; crossfade < 2; ++crossfade)
+  {
+    if (!MW_DSP_DelayLine_init(&delayLine, buffer, 1000))
+      return 0;
+
+    MW_DSP_DelayLine_setCrossfadeLength(&delayLine, crossfade ? MW_DSP_DELAYLINE_DEFAULT_CROSSFADE_LENGTH : 0);
+
+    float32_t maxStep = 0.f;
+    float32_t previous = 0.f;
+    for (int32_t n = 0; n < 4000; ++n)
+    {
+      if (n == 2000)
+        MW_DSP_DelayLine_setDelayLength(&delayLine, 750.f);
+
+      float32_t y = MW_DSP_DelayLine_tick(&delayLine, arm_sin_f32(2.f * PI * 0.001f * n));
+      if (n > 1000 && fabsf(y - previous) > maxStep)
+        maxStep = fabsf(y - previous);
+
+      previous = y;
+    }
+
+    //  The sine moves by at most 2 * PI * 0.001 per sample and the crossfade adds at most sqrt(2) / 256 on top of that.
+    //  Jumping 250 samples (a quarter cycle) moves it by up to sqrt(2)
+    if (crossfade && maxStep > 0.015f)
+      return 0;
+
+    if (!crossfade && maxStep < 0.5f)
+      return 0;
+  }
+
+  return 1;
+}
+
+
+//  Changing the delay length again in the middle of a crossfade must not click either, and process() must still match tick()
+static int32_t MW_DSP_DelayLine_CrossfadeRetriggerTest()
+{
+  float32_t tickBuffer[1000];
+  float32_t processBuffer[1000];
+  float32_t block[48];
+  MW_DSP_DelayLine tickDelayLine;
+  MW_DSP_DelayLine processDelayLine;
+
+  if (!MW_DSP_DelayLine_init(&tickDelayLine, tickBuffer, 1000))
+    return 0;
+
+  if (!MW_DSP_DelayLine_init(&processDelayLine, processBuffer, 1000))
+    return 0;
+
+  float32_t maxStep = 0.f;
+  float32_t previous = 0.f;
+  for (int32_t n = 0; n < 4800; n += 48)
+  {
+    //  Each change lands 48 to 96 samples into the crossfade started by the one before
+    if (n == 1920 || n == 1968 || n == 2064 || n == 2112)
+    {
+      float32_t M = (n == 1920) ? 750.f : (n == 1968) ? 500.f : (n == 2064) ? 900.f : 600.f;
+      MW_DSP_DelayLine_setDelayLength(&tickDelayLine, M);
+      MW_DSP_DelayLine_setDelayLength(&processDelayLine, M);
+    }
+
+    for (int32_t i = 0; i < 48; ++i)
+      block[i] = arm_sin_f32(2.f * PI * 0.001f * (n + i));
+
+    MW_DSP_DelayLine_process(&processDelayLine, block, block, 48);
+
+    for (int32_t i = 0; i < 48; ++i)
+    {
+      float32_t y = MW_DSP_DelayLine_tick(&tickDelayLine, arm_sin_f32(2.f * PI * 0.001f * (n + i)));
+      if (y != block[i])
+        return 0;
+
+      if (n + i > 1000 && fabsf(y - previous) > maxStep)
+        maxStep = fabsf(y - previous);
+
+      previous = y;
+    }
+  }
+
+  //  The last change must have been applied once the queued crossfades completed
+  if (tickDelayLine.N != 600 || tickDelayLine.pendingN != 0 || processDelayLine.N != 600)
+    return 0;
+
+  return maxStep <= 0.015f;
+}
+
+
+//  Q15 delay lines must give the same output as float delay lines to within the Q15 quantization error, for both
+//  tick() and process(), and process() must match tick() to within one LSB
+static int32_t MW_DSP_DelayLine_Q15Test()
+{
+  size_t delayLineSize = 37;
+  float32_t floatBuffer[37];
+  q15_t tickBuffer[37];
+  q15_t processBuffer[37];
+  size_t blockSizes[] = {1, 3, 37, 100, 2, 64, 5};
+
+  float32_t input[100];
+  float32_t expected[100];
+  float32_t output[100];
+
+  MW_DSP_DelayLine floatDelayLine;
+  MW_DSP_DelayLine tickDelayLine;
+  MW_DSP_DelayLine processDelayLine;
+
+  if (MW_DSP_DelayLine_init_q15(NULL, tickBuffer, delayLineSize))
+    return 0;
+
+  if (MW_DSP_DelayLine_init_q15(&tickDelayLine, NULL, delayLineSize))
+    return 0;
+
+  if (MW_DSP_DelayLine_init_q15(&tickDelayLine, tickBuffer, 0))
+    return 0;
+
+  for (int32_t inPlace = 0; inPlace < 2; ++inPlace)
+  {
+    if (!MW_DSP_DelayLine_init(&floatDelayLine, floatBuffer, delayLineSize))
+      return 0;
+
+    if (!MW_DSP_DelayLine_init_q15(&tickDelayLine, tickBuffer, delayLineSize))
+      return 0;
+
+    if (!MW_DSP_DelayLine_init_q15(&processDelayLine, processBuffer, delayLineSize))
+      return 0;
+
+    if (tickDelayLine.buffer != NULL || tickDelayLine.bufferQ15 != tickBuffer)
+      return 0;
+
+    float32_t signalPower = 0.f;
+    float32_t noisePower = 0.f;
+    int32_t n = 0;
+
+    for (size_t block = 0; block < sizeof(blockSizes) / sizeof(blockSizes[0]); ++block)
+    {
+      size_t blockSize = blockSizes[block];
+
+      for (size_t i = 0; i < blockSize; ++i, ++n)
+      {
+        input[i] = 0.9f * arm_sin_f32(0.0123f * 2.f * PI * n) + 0.05f * arm_sin_f32(0.31f * 2.f * PI * n);
+
+        float32_t reference = MW_DSP_DelayLine_tick(&floatDelayLine, input[i]);
+        expected[i] = MW_DSP_DelayLine_tick(&tickDelayLine, input[i]);
+
+        signalPower += reference * reference;
+        noisePower += (expected[i] - reference) * (expected[i] - reference);
+      }
+
+      if (inPlace)
+      {
+        arm_copy_f32(input, output, blockSize);
+        MW_DSP_DelayLine_process(&processDelayLine, output, output, blockSize);
+      }
+      else
+        MW_DSP_DelayLine_process(&processDelayLine, input, output, blockSize);
+
+      for (size_t i = 0; i < blockSize; ++i)
+        if (fabsf(output[i] - expected[i]) > 1.f / 32768.f)
+          return 0;
+
+      if (processDelayLine.currentPtr != tickDelayLine.currentPtr)
+        return 0;
+    }
+
+    //  Rounding to Q15 is worth about 90 dB for a full scale signal
+    if (10.f * log10f(signalPower / noisePower) < 85.f)
+      return 0;
+
+    if (fabsf(MW_DSP_DelayLine_peek(&tickDelayLine) - MW_DSP_DelayLine_peek(&floatDelayLine)) > 1.f / 32768.f)
+      return 0;
+  }
+
+  //  Samples round to nearest, and out of range samples (even ones that overflow an int32_t, or NaN) saturate
+  float32_t values[] = {0.6f / 32768.f, -0.6f / 32768.f, 0.4f / 32768.f, 2.f, 1e12f, -1e12f, INFINITY, -INFINITY, NAN};
+  q15_t expectedQ15[] = {1, -1, 0, 32767, 32767, -32768, 32767, -32768, -32768};
+  for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i)
+    if (MW_DSP_DelayLine_floatToQ15(values[i]) != expectedQ15[i])
+      return 0;
+
+  return 1;
+}
+
+
+//  A power-of-two delay line must behave exactly like a regular delay line of the same length
+static int32_t MW_DSP_DelayLine_PowerOfTwoTest()
+{
+  size_t delayLineSize = 5;
+  size_t bufferSize = MW_DSP_DelayLine_nextPowerOfTwo(delayLineSize);
+  float32_t regularBuffer[5];
+  float32_t pow2Buffer[8];
+  size_t blockSizes[] = {1, 3, 4, 6, 11, 2};
+
+  float32_t block[11];
+  float32_t expected[11];
+
+  if (bufferSize != 8)
+    return 0;
+
+  MW_DSP_DelayLine regularDelayLine;
+  MW_DSP_DelayLine pow2DelayLine;
+
+  //  Invalid buffer sizes (not a power of two or smaller than the delay length)
+  if (MW_DSP_DelayLine_init_pow2(&pow2DelayLine, pow2Buffer, 6, delayLineSize))
+    return 0;
+
+  if (MW_DSP_DelayLine_init_pow2(&pow2DelayLine, pow2Buffer, 4, delayLineSize))
+    return 0;
+
+  if (!MW_DSP_DelayLine_init(&regularDelayLine, regularBuffer, delayLineSize))
+    return 0;
+
+  if (!MW_DSP_DelayLine_init_pow2(&pow2DelayLine, pow2Buffer, bufferSize, delayLineSize))
+    return 0;
+
+  //  tick()
+  for (int32_t i = 0; i < 20; ++i)
+  {
+    float32_t x = (float32_t)(i + 1);
+    if (MW_DSP_DelayLine_peek(&pow2DelayLine) != MW_DSP_DelayLine_peek(&regularDelayLine))
+      return 0;
+
+    if (MW_DSP_DelayLine_tick(&pow2DelayLine, x) != MW_DSP_DelayLine_tick(&regularDelayLine, x))
+      return 0;
+  }
+
+  //  process()
+  float32_t sampleValue = 100.f;
+  for (size_t n = 0; n < sizeof(blockSizes) / sizeof(blockSizes[0]); ++n)
+  {
+    size_t blockSize = blockSizes[n];
+
+    for (size_t i = 0; i < blockSize; ++i)
+    {
+      block[i] = sampleValue;
+      sampleValue += 1.f;
+      expected[i] = MW_DSP_DelayLine_tick(&regularDelayLine, block[i]);
+    }
+
+    MW_DSP_DelayLine_process(&pow2DelayLine, block, block, blockSize);
+
+    for (size_t i = 0; i < blockSize; ++i)
+      if (block[i] != expected[i])
+        return 0;
+  }
+
+  //  A delay that almost fills its buffer, processed in blocks longer than the buffer both in place and out of place
+  float32_t longRegularBuffer[120];
+  float32_t longPow2Buffer[128];
+  float32_t longInput[300];
+  float32_t longOutput[300];
+  size_t longBlockSizes[] = {300, 7, 129, 64, 250};
+
+  if (!MW_DSP_DelayLine_init(&regularDelayLine, longRegularBuffer, 120))
+    return 0;
+
+  if (!MW_DSP_DelayLine_init_pow2(&pow2DelayLine, longPow2Buffer, 128, 120))
+    return 0;
+
+  for (size_t n = 0; n < 2 * sizeof(longBlockSizes) / sizeof(longBlockSizes[0]); ++n)
+  {
+    size_t blockSize = longBlockSizes[n % (sizeof(longBlockSizes) / sizeof(longBlockSizes[0]))];
+
+    for (size_t i = 0; i < blockSize; ++i)
+    {
+      longInput[i] = sampleValue;
+      longOutput[i] = sampleValue;
+      sampleValue += 1.f;
+    }
+
+    if (n & 1)
+      MW_DSP_DelayLine_process(&pow2DelayLine, longOutput, longOutput, blockSize);
+    else
+      MW_DSP_DelayLine_process(&pow2DelayLine, longInput, longOutput, blockSize);
+
+    for (size_t i = 0; i < blockSize; ++i)
+      if (longOutput[i] != MW_DSP_DelayLine_tick(&regularDelayLine, longInput[i]))
+        return 0;
+  }
+
+  return 1;
+}
+
+
 #ifdef NO_OPTIMIZE
 static int32_t MW_DSP_DelayLine_DelayLineNonInitializedTest()
 {
@@ -242,6 +683,557 @@ int32_t MW_DSP_FractionalDelayLine_standardOperationTests()
 }
 
 
+//  The output of a fractional delay line set to a delay of M must be the input delayed by M samples
+//  tick() and process() must also agree with each other, including after the delay length is changed
+int32_t MW_DSP_FractionalDelayLine_delayLengthTests()
+{
+  MW_DSP_FractionalDelayLine tickDelay;
+  MW_DSP_FractionalDelayLine processDelay;
+  float32_t tickDelayBuffer[9];
+  float32_t processDelayBuffer[9];
+  float32_t block[32];
+  float32_t expected[32];
+  int32_t N = 9;
+
+  float32_t delayLengths[] = {3.f, 5.25f, 0.5f, 8.f};
+
+  if (!MW_DSP_FractionalDelayLine_init(&tickDelay, tickDelayBuffer, N, 0.f))
+    return 0;
+
+  if (!MW_DSP_FractionalDelayLine_init(&processDelay, processDelayBuffer, N, 0.f))
+    return 0;
+
+  for (size_t n = 0; n < sizeof(delayLengths) / sizeof(delayLengths[0]); ++n)
+  {
+    float32_t M = delayLengths[n];
+    MW_DSP_FractionalDelayLine_setDelayLength(&tickDelay, M);
+    MW_DSP_FractionalDelayLine_setDelayLength(&processDelay, M);
+
+    //  Flush the delay line and then push a ramp through it.  A ramp delayed by M is the ramp minus M
+    for (int32_t i = 0; i < 32; ++i)
+    {
+      block[i] = (float32_t)i;
+      expected[i] = MW_DSP_FractionalDelayLine_tick(&tickDelay, block[i]);
+    }
+
+    MW_DSP_FractionalDelayLine_process(&processDelay, block, 32);
+
+    for (int32_t i = 0; i < 32; ++i)
+    {
+      if (block[i] != expected[i])
+        return 0;
+
+      if (i >= N && (expected[i] < (float32_t)i - M - 0.001f || expected[i] > (float32_t)i - M + 0.001f))
+        return 0;
+    }
+  }
+
+  return 1;
+}
+
+
+//  The fractional delay line process() used to be a single per-sample loop with bounds checks on every sample
+//  It is kept here as a reference for the throughput regression test
+static void MW_DSP_FractionalDelayLine_referenceProcess(MW_DSP_FractionalDelayLine *delayLine, float32_t *buffer, size_t numSamples)
+{
+  for (size_t i = 0; i < numSamples; ++i)
+  {
+    delayLine->buffer[delayLine->writePtr--] = buffer[i];
+
+    if (delayLine->writePtr < 0)
+      delayLine->writePtr = delayLine->N - 1;
+
+    int32_t firstInterpolatingIndex = delayLine->readPtr--;
+    int32_t secondInterpolatingIndex = firstInterpolatingIndex + 1;
+    if (secondInterpolatingIndex >= delayLine->N)
+      secondInterpolatingIndex = 0;
+
+    buffer[i] = ((1.f - delayLine->MFrac) * delayLine->buffer[firstInterpolatingIndex]) + (delayLine->MFrac * delayLine->buffer[secondInterpolatingIndex]);
+
+    if (delayLine->readPtr < 0)
+      delayLine->readPtr = delayLine->N - 1;
+  }
+}
+
+
+/*
+ *  Compare the old per-sample fractional delay line loop against process() for total delay lengths of
+ *  16 up to 65536 samples (or up to memorySize, whichever is smaller).  The delay is set to N / 2 + 0.5
+ *
+ *  Returns:
+ *    Number of results written
+ */
+size_t MW_DSP_FractionalDelayLine_runBenchmarks(float32_t *delayLineMemory, size_t memorySize, MW_UnitTest_BenchmarkResult *results, size_t maxResults)
+{
+  float32_t block[BENCHMARK_BLOCK_SIZE];
+  MW_DSP_FractionalDelayLine delayLine;
+  size_t numResults = 0;
+
+  arm_fill_f32(0.5f, block, BENCHMARK_BLOCK_SIZE);
+
+  for (size_t N = 16; N <= 65536 && N <= memorySize && numResults < maxResults; N *= 2)
+  {
+    float32_t M = (float32_t)(N / 2) + 0.5f;
+
+    MW_DSP_FractionalDelayLine_init(&delayLine, delayLineMemory, N, M);
+
+    uint32_t start = MW_AFXUnit_Utils_getCycleCount();
+    for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+      MW_DSP_FractionalDelayLine_referenceProcess(&delayLine, block, BENCHMARK_BLOCK_SIZE);
+    uint32_t referenceCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+    MW_DSP_FractionalDelayLine_init(&delayLine, delayLineMemory, N, M);
+
+    start = MW_AFXUnit_Utils_getCycleCount();
+    for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+      MW_DSP_FractionalDelayLine_process(&delayLine, block, BENCHMARK_BLOCK_SIZE);
+    uint32_t processCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+    results[numResults].N = N;
+    results[numResults].referenceCyclesPerSample = (float32_t)referenceCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+    results[numResults].cyclesPerSample = (float32_t)processCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+    numResults++;
+  }
+
+  return numResults;
+}
+
+
+/*
+ *  32-bit indexing must not make small delay lines any slower than the old per-sample loop
+ *  This is a timing check, so it is run with the benchmarks rather than from MW_DSP_DelayLine_runUnitTests().  The best of
+ *  MW_UNITTEST_THROUGHPUT_NUM_RUNS runs is kept for both loops, and only a difference above MW_UNITTEST_THROUGHPUT_MARGIN
+ *  (3%) counts as slower (remember to call MW_AFXUnit_Utils_enableCycleCounter() first)
+ *
+ *  Returns:
+ *    0: if process() is more than MW_UNITTEST_THROUGHPUT_MARGIN times slower than the reference loop for any delay length
+ *    1: otherwise
+ */
+int32_t MW_DSP_FractionalDelayLine_runThroughputRegressionCheck()
+{
+  float32_t delayLineMemory[256];
+  MW_UnitTest_BenchmarkResult results[5];
+  float32_t referenceCycles[5];
+  float32_t processCycles[5];
+  size_t numResults = 0;
+
+  for (int32_t run = 0; run < MW_UNITTEST_THROUGHPUT_NUM_RUNS; ++run)
+  {
+    numResults = MW_DSP_FractionalDelayLine_runBenchmarks(delayLineMemory, 256, results, 5);
+
+    for (size_t i = 0; i < numResults; ++i)
+    {
+      if (run == 0 || results[i].referenceCyclesPerSample < referenceCycles[i])
+        referenceCycles[i] = results[i].referenceCyclesPerSample;
+
+      if (run == 0 || results[i].cyclesPerSample < processCycles[i])
+        processCycles[i] = results[i].cyclesPerSample;
+    }
+  }
+
+  for (size_t i = 0; i < numResults; ++i)
+    if (processCycles[i] > referenceCycles[i] * MW_UNITTEST_THROUGHPUT_MARGIN)
+      return 0;
+
+  return 1;
+}
+
+
+//  Every interpolation kernel must give the same output from tick() and process(), and must delay a ramp by M
+//  (the Thiran allpass only converges to the delayed ramp, so it gets a looser tolerance)
+int32_t MW_DSP_FractionalDelayLine_interpolationTests()
+{
+  MW_DSP_FractionalDelayLine tickDelay;
+  MW_DSP_FractionalDelayLine processDelay;
+  float32_t tickDelayBuffer[16];
+  float32_t processDelayBuffer[16];
+  float32_t block[48];
+  float32_t expected[48];
+  int32_t N = 16;
+
+  float32_t delayLengths[] = {3.f, 5.25f, 1.5f, 12.75f, 7.1f};
+
+  //  4-point kernels need one sample on either side of the linear interpolation taps
+  if (MW_DSP_FractionalDelayLine_init_interpolation(&tickDelay, tickDelayBuffer, N, 0.5f, MW_DSP_FRAC_DELAY_LAGRANGE3))
+    return 0;
+
+  if (MW_DSP_FractionalDelayLine_init_interpolation(&tickDelay, tickDelayBuffer, N, 14.f, MW_DSP_FRAC_DELAY_HERMITE))
+    return 0;
+
+  if (MW_DSP_FractionalDelayLine_init_interpolation(&tickDelay, tickDelayBuffer, N, 3.f, MW_DSP_FRAC_DELAY_NUM_INTERPOLATION_TYPES))
+    return 0;
+
+  for (int32_t type = 0; type < MW_DSP_FRAC_DELAY_NUM_INTERPOLATION_TYPES; ++type)
+  {
+    float32_t tolerance = (type == MW_DSP_FRAC_DELAY_THIRAN) ? 0.01f : 0.001f;
+
+    if (!MW_DSP_FractionalDelayLine_init_interpolation(&tickDelay, tickDelayBuffer, N, 1.f, type))
+      return 0;
+
+    if (!MW_DSP_FractionalDelayLine_init_interpolation(&processDelay, processDelayBuffer, N, 1.f, type))
+      return 0;
+
+    for (size_t n = 0; n < sizeof(delayLengths) / sizeof(delayLengths[0]); ++n)
+    {
+      float32_t M = delayLengths[n];
+      MW_DSP_FractionalDelayLine_setDelayLength(&tickDelay, M);
+      MW_DSP_FractionalDelayLine_setDelayLength(&processDelay, M);
+
+      for (int32_t i = 0; i < 48; ++i)
+      {
+        block[i] = (float32_t)i;
+        expected[i] = MW_DSP_FractionalDelayLine_tick(&tickDelay, block[i]);
+      }
+
+      MW_DSP_FractionalDelayLine_process(&processDelay, block, 48);
+
+      for (int32_t i = 0; i < 48; ++i)
+      {
+        if (block[i] != expected[i])
+          return 0;
+
+        if (i >= 2 * N && (expected[i] < (float32_t)i - M - tolerance || expected[i] > (float32_t)i - M + tolerance))
+          return 0;
+      }
+    }
+  }
+
+  return 1;
+}
+
+
+/*
+ *  Measure the gain (in dB) of a fractional delay line at fs / 4 with a delay of 10.5 samples.
+ *  A half sample delay is the worst case for the FIR kernels
+ */
+static float32_t MW_DSP_FractionalDelayLine_measureHighFrequencyLoss(float32_t *delayLineMemory, MW_DSP_FractionalDelayInterpolation interpolation)
+{
+  MW_DSP_FractionalDelayLine delayLine;
+  float32_t block[256];
+  float32_t inputPower = 0.f;
+  float32_t outputPower = 0.f;
+
+  MW_DSP_FractionalDelayLine_init_interpolation(&delayLine, delayLineMemory, 32, 10.5f, interpolation);
+
+  for (int32_t i = 0; i < 256; ++i)
+    block[i] = arm_sin_f32(PI * 0.5f * i + 0.25f);
+
+  for (int32_t i = 128; i < 256; ++i)
+    inputPower += block[i] * block[i];
+
+  MW_DSP_FractionalDelayLine_process(&delayLine, block, 256);
+
+  //  Only measure once the delay line is full and the Thiran transient has died out
+  for (int32_t i = 128; i < 256; ++i)
+    outputPower += block[i] * block[i];
+
+  return 10.f * log10f(outputPower / inputPower);
+}
+
+
+/*
+ *  Measure the cost of each interpolation kernel with a fixed delay of N / 2 + 0.5 samples and its high frequency loss.
+ *
+ *  Returns:
+ *    Number of results written
+ */
+size_t MW_DSP_FractionalDelayLine_runInterpolationBenchmarks(float32_t *delayLineMemory, size_t memorySize,
+                                                             MW_DSP_FractionalDelayLine_InterpolationBenchmarkResult *results, size_t maxResults)
+{
+  float32_t block[BENCHMARK_BLOCK_SIZE];
+  MW_DSP_FractionalDelayLine delayLine;
+  size_t numResults = 0;
+  size_t N = memorySize < 1024 ? memorySize : 1024;
+  float32_t M = (float32_t)(N / 2) + 0.5f;
+
+  if (N < 32)
+    return 0;
+
+  arm_fill_f32(0.5f, block, BENCHMARK_BLOCK_SIZE);
+
+  for (int32_t type = 0; type < MW_DSP_FRAC_DELAY_NUM_INTERPOLATION_TYPES && numResults < maxResults; ++type)
+  {
+    MW_DSP_FractionalDelayLine_init_interpolation(&delayLine, delayLineMemory, N, M, type);
+
+    //  Warm up the caches so the first kernel is not penalized
+    MW_DSP_FractionalDelayLine_process(&delayLine, block, BENCHMARK_BLOCK_SIZE);
+
+    uint32_t start = MW_AFXUnit_Utils_getCycleCount();
+    for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+      MW_DSP_FractionalDelayLine_process(&delayLine, block, BENCHMARK_BLOCK_SIZE);
+    uint32_t processCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+    results[numResults].interpolation = type;
+    results[numResults].cyclesPerSample = (float32_t)processCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+    results[numResults].highFrequencyLossDb = MW_DSP_FractionalDelayLine_measureHighFrequencyLoss(delayLineMemory, type);
+    numResults++;
+  }
+
+  return numResults;
+}
+
+
+//  Linear interpolation loses about 3 dB at fs / 4 with a half sample delay.  The higher order kernels must do better
+//  and the Thiran allpass must be (close to) flat
+int32_t MW_DSP_FractionalDelayLine_highFrequencyLossTest()
+{
+  float32_t delayLineMemory[32];
+
+  float32_t linearLoss = MW_DSP_FractionalDelayLine_measureHighFrequencyLoss(delayLineMemory, MW_DSP_FRAC_DELAY_LINEAR);
+  if (linearLoss > -2.9f || linearLoss < -3.1f)
+    return 0;
+
+  if (MW_DSP_FractionalDelayLine_measureHighFrequencyLoss(delayLineMemory, MW_DSP_FRAC_DELAY_LAGRANGE3) <= linearLoss)
+    return 0;
+
+  if (MW_DSP_FractionalDelayLine_measureHighFrequencyLoss(delayLineMemory, MW_DSP_FRAC_DELAY_HERMITE) <= linearLoss)
+    return 0;
+
+  float32_t thiranLoss = MW_DSP_FractionalDelayLine_measureHighFrequencyLoss(delayLineMemory, MW_DSP_FRAC_DELAY_THIRAN);
+  if (thiranLoss < -0.1f || thiranLoss > 0.1f)
+    return 0;
+
+  return 1;
+}
+
+
+//  processModulated() must give exactly the same output as setting the delay length and calling tick() on every sample
+//  The delay sweeps close to N so segments get cut short to avoid overwriting samples that are still to be read
+int32_t MW_DSP_FractionalDelayLine_modulatedTests()
+{
+  MW_DSP_FractionalDelayLine tickDelay;
+  MW_DSP_FractionalDelayLine processDelay;
+  float32_t tickDelayBuffer[64];
+  float32_t processDelayBuffer[64];
+  float32_t block[200];
+  float32_t expected[200];
+  float32_t delayTimes[200];
+  int32_t N = 64;
+
+  for (int32_t type = 0; type < MW_DSP_FRAC_DELAY_NUM_INTERPOLATION_TYPES; ++type)
+  {
+    if (!MW_DSP_FractionalDelayLine_init_interpolation(&tickDelay, tickDelayBuffer, N, 31.f, type))
+      return 0;
+
+    if (!MW_DSP_FractionalDelayLine_init_interpolation(&processDelay, processDelayBuffer, N, 31.f, type))
+      return 0;
+
+    for (int32_t i = 0; i < 200; ++i)
+    {
+      block[i] = arm_sin_f32(0.3f * i) + (0.01f * i);
+      delayTimes[i] = 31.f + (29.f * arm_sin_f32(0.05f * i));
+
+      MW_DSP_FractionalDelayLine_setDelayLength(&tickDelay, delayTimes[i]);
+      expected[i] = MW_DSP_FractionalDelayLine_tick(&tickDelay, block[i]);
+    }
+
+    //  Uneven block sizes so the write pointer wraps in the middle of a block
+    MW_DSP_FractionalDelayLine_processModulated(&processDelay, block, delayTimes, 37);
+    MW_DSP_FractionalDelayLine_processModulated(&processDelay, &block[37], &delayTimes[37], 163);
+
+    for (int32_t i = 0; i < 200; ++i)
+      if (block[i] != expected[i])
+        return 0;
+
+    //  Both delay lines must be left in the same state
+    if (MW_DSP_FractionalDelayLine_tick(&tickDelay, 1.f) != MW_DSP_FractionalDelayLine_tick(&processDelay, 1.f))
+      return 0;
+  }
+
+  return 1;
+}
+
+
+//  A guarded delay line must give exactly the same output as a regular one through tick(), process() and processModulated()
+int32_t MW_DSP_FractionalDelayLine_guardedTests()
+{
+  MW_DSP_FractionalDelayLine delay;
+  MW_DSP_FractionalDelayLine guardedDelay;
+  float32_t delayBuffer[16];
+  float32_t guardedDelayBuffer[MW_DSP_RINGBUFFER_MEMORY_SIZE(16, MW_DSP_FRAC_DELAY_GUARD_SIZE)];
+  float32_t block[40];
+  float32_t expected[40];
+  float32_t delayTimes[40];
+  int32_t N = 16;
+
+  for (int32_t type = 0; type < MW_DSP_FRAC_DELAY_NUM_INTERPOLATION_TYPES; ++type)
+  {
+    if (!MW_DSP_FractionalDelayLine_init_interpolation(&delay, delayBuffer, N, 12.5f, type))
+      return 0;
+
+    if (!MW_DSP_FractionalDelayLine_init_guarded(&guardedDelay, guardedDelayBuffer, N, 12.5f, type))
+      return 0;
+
+    for (int32_t n = 0; n < 4; ++n)
+    {
+      for (int32_t i = 0; i < 40; ++i)
+      {
+        block[i] = arm_sin_f32(0.7f * (i + 40 * n));
+        expected[i] = block[i];
+        delayTimes[i] = 7.f + 5.5f * arm_sin_f32(0.2f * (i + 40 * n));
+      }
+
+      //  Alternate between the three processing paths
+      if (n == 0)
+      {
+        for (int32_t i = 0; i < 40; ++i)
+        {
+          expected[i] = MW_DSP_FractionalDelayLine_tick(&delay, expected[i]);
+          block[i] = MW_DSP_FractionalDelayLine_tick(&guardedDelay, block[i]);
+        }
+      }
+      else if (n == 1)
+      {
+        MW_DSP_FractionalDelayLine_process(&delay, expected, 40);
+        MW_DSP_FractionalDelayLine_process(&guardedDelay, block, 40);
+      }
+      else
+      {
+        MW_DSP_FractionalDelayLine_processModulated(&delay, expected, delayTimes, 40);
+        MW_DSP_FractionalDelayLine_processModulated(&guardedDelay, block, delayTimes, 40);
+      }
+
+      for (int32_t i = 0; i < 40; ++i)
+        if (block[i] != expected[i])
+          return 0;
+    }
+  }
+
+  return 1;
+}
+
+
+//  peekAt() must read the same samples as a chain of tick() calls
+static int32_t MW_DSP_DelayLine_PeekAtTest()
+{
+  float32_t buffer[10];
+  float32_t pow2Buffer[16];
+  MW_DSP_DelayLine delayLine;
+  MW_DSP_DelayLine pow2DelayLine;
+
+  if (!MW_DSP_DelayLine_init(&delayLine, buffer, 10))
+    return 0;
+
+  if (!MW_DSP_DelayLine_init_pow2(&pow2DelayLine, pow2Buffer, 16, 10))
+    return 0;
+
+  for (int32_t n = 1; n <= 40; ++n)
+  {
+    MW_DSP_DelayLine_tick(&delayLine, (float32_t)n);
+    MW_DSP_DelayLine_tick(&pow2DelayLine, (float32_t)n);
+
+    for (int32_t delay = 1; delay <= 10; ++delay)
+    {
+      float32_t expected = (n - delay + 1 > 0) ? (float32_t)(n - delay + 1) : 0.f;
+      if (MW_DSP_DelayLine_peekAt(&delayLine, delay) != expected || MW_DSP_DelayLine_peekAt(&pow2DelayLine, delay) != expected)
+        return 0;
+    }
+
+    if (MW_DSP_DelayLine_peekAt(&delayLine, 10) != MW_DSP_DelayLine_peek(&delayLine))
+      return 0;
+  }
+
+  return 1;
+}
+
+
+int32_t MW_DSP_MultiTapDelayLine_initializationTests()
+{
+  MW_DSP_MultiTapDelayLine delay;
+  float32_t buffer[MW_DSP_RINGBUFFER_MEMORY_SIZE(16, MW_DSP_MULTITAP_GUARD_SIZE)];
+  float32_t tapDelays[] = {0.f, 3.5f, 14.9f};
+  float32_t badTapDelays[] = {0.f, 15.f};
+
+  if (MW_DSP_MultiTapDelayLine_init(NULL, buffer, 16, tapDelays, 3))
+    return 0;
+
+  if (MW_DSP_MultiTapDelayLine_init(&delay, NULL, 16, tapDelays, 3))
+    return 0;
+
+  if (MW_DSP_MultiTapDelayLine_init(&delay, buffer, 16, NULL, 3))
+    return 0;
+
+  if (MW_DSP_MultiTapDelayLine_init(&delay, buffer, 16, tapDelays, 0))
+    return 0;
+
+  if (MW_DSP_MultiTapDelayLine_init(&delay, buffer, 16, tapDelays, MW_DSP_MULTITAP_MAX_TAPS + 1))
+    return 0;
+
+  //  The interpolator reads one sample past the tap delay, so tap delays must be less than N - 1
+  if (MW_DSP_MultiTapDelayLine_init(&delay, buffer, 16, badTapDelays, 2))
+    return 0;
+
+  if (!MW_DSP_MultiTapDelayLine_init(&delay, buffer, 16, tapDelays, 3))
+    return 0;
+
+  if (delay.numTaps != 3 || delay.N != 16 || delay.writePtr != 15)
+    return 0;
+
+  if (delay.tapInt[1] != 3 || delay.tapFrac[1] != 0.5f || delay.tapInt[2] != 14)
+    return 0;
+
+  return 1;
+}
+
+
+//  Integer taps must output the delayed input, fractional taps must interpolate between the two neighbouring samples and
+//  process() must give the same output as tick() for any block size
+int32_t MW_DSP_MultiTapDelayLine_tapTests()
+{
+  MW_DSP_MultiTapDelayLine tickDelay;
+  MW_DSP_MultiTapDelayLine processDelay;
+  float32_t tickBuffer[MW_DSP_RINGBUFFER_MEMORY_SIZE(24, MW_DSP_MULTITAP_GUARD_SIZE)];
+  float32_t processBuffer[MW_DSP_RINGBUFFER_MEMORY_SIZE(24, MW_DSP_MULTITAP_GUARD_SIZE)];
+  float32_t tapDelays[] = {0.f, 5.f, 22.f, 7.25f, 19.5f};
+  size_t blockSizes[] = {1, 7, 50, 23, 2, 24, 13};
+
+  float32_t input[50];
+  float32_t tapOutputMemory[5][50];
+  float32_t *tapOutputs[5] = {tapOutputMemory[0], tapOutputMemory[1], tapOutputMemory[2], tapOutputMemory[3], tapOutputMemory[4]};
+  float32_t expected[5];
+
+  if (!MW_DSP_MultiTapDelayLine_init(&tickDelay, tickBuffer, 24, tapDelays, 5))
+    return 0;
+
+  if (!MW_DSP_MultiTapDelayLine_init(&processDelay, processBuffer, 24, tapDelays, 5))
+    return 0;
+
+  int32_t n = 0;
+  for (size_t block = 0; block < 3 * sizeof(blockSizes) / sizeof(blockSizes[0]); ++block)
+  {
+    size_t blockSize = blockSizes[block % (sizeof(blockSizes) / sizeof(blockSizes[0]))];
+
+    for (size_t i = 0; i < blockSize; ++i)
+      input[i] = (float32_t)(n + i + 1);
+
+    MW_DSP_MultiTapDelayLine_process(&processDelay, input, tapOutputs, blockSize);
+
+    for (size_t i = 0; i < blockSize; ++i, ++n)
+    {
+      MW_DSP_MultiTapDelayLine_tick(&tickDelay, input[i], expected);
+
+      for (int32_t tap = 0; tap < 5; ++tap)
+      {
+        if (tapOutputs[tap][i] != expected[tap])
+          return 0;
+
+        //  The input is a ramp, so every tap (integer or fractional) outputs the sample index minus its delay
+        float32_t delayed = (float32_t)(n + 1) - tapDelays[tap];
+        if (n + 1 > (int32_t)tapDelays[tap] + 1 && fabsf(expected[tap] - delayed) > 1e-4f)
+          return 0;
+      }
+    }
+  }
+
+  MW_DSP_MultiTapDelayLine_reset(&processDelay);
+  MW_DSP_MultiTapDelayLine_process(&processDelay, input, tapOutputs, 1);
+  if (tapOutputs[0][0] != input[0] || tapOutputs[1][0] != 0.f)
+    return 0;
+
+  return 1;
+}
+
+
 int32_t MW_DSP_DelayLine_runUnitTests()
 {
   if (!MW_DSP_DelayLine_StandardOperation())
@@ -250,6 +1242,24 @@ int32_t MW_DSP_DelayLine_runUnitTests()
   if (!MW_DSP_DelayLine_MemoryAllocTest())
     return 0;
 
+  if (!MW_DSP_DelayLine_BlockProcessingTest())
+    return 0;
+
+  if (!MW_DSP_DelayLine_PowerOfTwoTest())
+    return 0;
+
+  if (!MW_DSP_DelayLine_Q15Test())
+    return 0;
+
+  if (!MW_DSP_DelayLine_SetDelayLengthTest())
+    return 0;
+
+  if (!MW_DSP_DelayLine_CrossfadeClickTest())
+    return 0;
+
+  if (!MW_DSP_DelayLine_CrossfadeRetriggerTest())
+    return 0;
+
 #ifdef NO_OPTIMIZE
   if (!MW_DSP_DelayLine_DelayLineNonInitializedTest())
     return 0;
@@ -261,5 +1271,141 @@ if (!MW_DSP_FractionalDelayLine_initializationTests())
 if (!MW_DSP_FractionalDelayLine_standardOperationTests())
   return 0;
 
+if (!MW_DSP_FractionalDelayLine_delayLengthTests())
+  return 0;
+
+if (!MW_DSP_FractionalDelayLine_interpolationTests())
+  return 0;
+
+if (!MW_DSP_FractionalDelayLine_highFrequencyLossTest())
+  return 0;
+
+if (!MW_DSP_FractionalDelayLine_modulatedTests())
+  return 0;
+
+if (!MW_DSP_FractionalDelayLine_guardedTests())
+  return 0;
+
+  if (!MW_DSP_DelayLine_PeekAtTest())
+    return 0;
+
+  if (!MW_DSP_MultiTapDelayLine_initializationTests())
+    return 0;
+
+  if (!MW_DSP_MultiTapDelayLine_tapTests())
+    return 0;
+
   return 1;
 }
+
+
+/*
+ *  Compare the cost of looping tick() over a block against process() for delay lengths of 16 up to 65536 samples
+ *  (or up to memorySize, whichever is smaller).  Delay lengths are doubled on every run.
+ *  Use MW_UNITTEST_CYCLES_TO_NS() to convert the results into ns/sample
+ *
+ *  Inputs:
+ *    delayLineMemory:  Scratch memory for the delay line
+ *    memorySize:       Number of samples delayLineMemory can hold
+ *    results:          Array to hold the benchmark results
+ *    maxResults:       Size of results
+ *
+ *  Returns:
+ *    Number of results written
+ */
+size_t MW_DSP_DelayLine_runBenchmarks(float32_t *delayLineMemory, size_t memorySize, MW_UnitTest_BenchmarkResult *results, size_t maxResults)
+{
+  float32_t block[BENCHMARK_BLOCK_SIZE];
+  MW_DSP_DelayLine delayLine;
+  size_t numResults = 0;
+
+  arm_fill_f32(0.5f, block, BENCHMARK_BLOCK_SIZE);
+
+  for (size_t N = 16; N <= 65536 && N <= memorySize && numResults < maxResults; N *= 2)
+  {
+    MW_DSP_DelayLine_init(&delayLine, delayLineMemory, N);
+
+    uint32_t start = MW_AFXUnit_Utils_getCycleCount();
+    for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+      for (int32_t i = 0; i < BENCHMARK_BLOCK_SIZE; ++i)
+        block[i] = MW_DSP_DelayLine_tick(&delayLine, block[i]);
+    uint32_t tickCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+    MW_DSP_DelayLine_init(&delayLine, delayLineMemory, N);
+
+    start = MW_AFXUnit_Utils_getCycleCount();
+    for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+      MW_DSP_DelayLine_process(&delayLine, block, block, BENCHMARK_BLOCK_SIZE);
+    uint32_t processCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+    results[numResults].N = N;
+    results[numResults].referenceCyclesPerSample = (float32_t)tickCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+    results[numResults].cyclesPerSample = (float32_t)processCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+    numResults++;
+  }
+
+  return numResults;
+}
+
+
+
+/*
+ *  Compare a multi-tap echo built from a chain of MW_DSP_DelayLine instances (one per tap, each copying every sample into the
+ *  next) against a MW_DSP_MultiTapDelayLine with the same taps.  Tap spacing is doubled on every run, starting at 16 samples.
+ *  Both produce MW_UNITTEST_MULTITAP_NUM_TAPS output vectors.  delayLineMemory must hold at least
+ *  2 * (MW_UNITTEST_MULTITAP_NUM_TAPS * spacing + 129) samples
+ *
+ *  Returns:
+ *    Number of results written (N is the tap spacing)
+ */
+size_t MW_DSP_MultiTapDelayLine_runBenchmarks(float32_t *delayLineMemory, size_t memorySize, MW_UnitTest_BenchmarkResult *results, size_t maxResults)
+{
+  float32_t block[BENCHMARK_BLOCK_SIZE];
+  float32_t tapOutputMemory[MW_UNITTEST_MULTITAP_NUM_TAPS][BENCHMARK_BLOCK_SIZE];
+  float32_t *tapOutputs[MW_UNITTEST_MULTITAP_NUM_TAPS];
+  float32_t tapDelays[MW_UNITTEST_MULTITAP_NUM_TAPS];
+  MW_DSP_DelayLine chain[MW_UNITTEST_MULTITAP_NUM_TAPS];
+  MW_DSP_MultiTapDelayLine multiTap;
+  size_t numResults = 0;
+
+  for (int32_t tap = 0; tap < MW_UNITTEST_MULTITAP_NUM_TAPS; ++tap)
+    tapOutputs[tap] = tapOutputMemory[tap];
+
+  arm_fill_f32(0.5f, block, BENCHMARK_BLOCK_SIZE);
+
+  for (size_t spacing = 16; numResults < maxResults; spacing *= 2)
+  {
+    size_t N = MW_UNITTEST_MULTITAP_NUM_TAPS * spacing + BENCHMARK_BLOCK_SIZE + 1;
+    if (2 * N > memorySize)
+      break;
+
+    for (int32_t tap = 0; tap < MW_UNITTEST_MULTITAP_NUM_TAPS; ++tap)
+    {
+      MW_DSP_DelayLine_init(&chain[tap], delayLineMemory + tap * spacing, spacing);
+      tapDelays[tap] = (float32_t)((tap + 1) * spacing);
+    }
+
+    uint32_t start = MW_AFXUnit_Utils_getCycleCount();
+    for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+    {
+      MW_DSP_DelayLine_process(&chain[0], block, tapOutputs[0], BENCHMARK_BLOCK_SIZE);
+      for (int32_t tap = 1; tap < MW_UNITTEST_MULTITAP_NUM_TAPS; ++tap)
+        MW_DSP_DelayLine_process(&chain[tap], tapOutputs[tap - 1], tapOutputs[tap], BENCHMARK_BLOCK_SIZE);
+    }
+    uint32_t chainCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+    MW_DSP_MultiTapDelayLine_init(&multiTap, delayLineMemory + N, N, tapDelays, MW_UNITTEST_MULTITAP_NUM_TAPS);
+
+    start = MW_AFXUnit_Utils_getCycleCount();
+    for (int32_t n = 0; n < BENCHMARK_NUM_BLOCKS; ++n)
+      MW_DSP_MultiTapDelayLine_process(&multiTap, block, tapOutputs, BENCHMARK_BLOCK_SIZE);
+    uint32_t multiTapCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+    results[numResults].N = spacing;
+    results[numResults].referenceCyclesPerSample = (float32_t)chainCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+    results[numResults].cyclesPerSample = (float32_t)multiTapCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+    numResults++;
+  }
+
+  return numResults;
+}
@@ -29,7 +29,33 @@
 
 #include "arm_math.h"
 #include "MW_DSP_DelayLine.h"
+#include "MW_UnitTestBenchmark.h"
+
+//  Cost and high frequency loss (gain at fs / 4 with a half sample delay) of a fractional delay line interpolator
+typedef struct
+{
+  MW_DSP_FractionalDelayInterpolation interpolation;
+  float32_t                           cyclesPerSample;
+  float32_t                           highFrequencyLossDb;
+}MW_DSP_FractionalDelayLine_InterpolationBenchmarkResult;
+
+//  Number of taps used by MW_DSP_MultiTapDelayLine_runBenchmarks()
+#define MW_UNITTEST_MULTITAP_NUM_TAPS 4
+
+//  Number of runs MW_DSP_FractionalDelayLine_runThroughputRegressionCheck() keeps the best of
+#define MW_UNITTEST_THROUGHPUT_NUM_RUNS 5
+
+//  How much slower than the reference loop process() may measure before MW_DSP_FractionalDelayLine_runThroughputRegressionCheck()
+//  fails (timer noise on the best of the runs)
+#define MW_UNITTEST_THROUGHPUT_MARGIN 1.03f
 
 int32_t MW_DSP_DelayLine_runUnitTests();
+size_t  MW_DSP_DelayLine_runBenchmarks(float32_t *delayLineMemory, size_t memorySize, MW_UnitTest_BenchmarkResult *results, size_t maxResults);
+size_t  MW_DSP_FractionalDelayLine_runBenchmarks(float32_t *delayLineMemory, size_t memorySize, MW_UnitTest_BenchmarkResult *results, size_t maxResults);
+int32_t MW_DSP_FractionalDelayLine_runThroughputRegressionCheck();
+
+size_t  MW_DSP_FractionalDelayLine_runInterpolationBenchmarks(float32_t *delayLineMemory, size_t memorySize,
+                                                             MW_DSP_FractionalDelayLine_InterpolationBenchmarkResult *results, size_t maxResults);
+size_t  MW_DSP_MultiTapDelayLine_runBenchmarks(float32_t *delayLineMemory, size_t memorySize, MW_UnitTest_BenchmarkResult *results, size_t maxResults);
 
 #endif /* MW_DSP_DELAYLINETESTS_H_ */
@@ -26,6 +26,10 @@
 
 
 #include "MW_DSP_OPFTests.h"
+#include "MW_AFXUnit_MiscUtils.h"
+
+#define BENCHMARK_BLOCK_SIZE 128
+#define BENCHMARK_NUM_BLOCKS 64
 
 
 static int32_t MW_DSP_OPF_initializationTests()
@@ -41,10 +45,15 @@ static int32_t MW_DSP_OPF_initializationTests()
     return 0;
 
   //  Initialize filter with valid parameters
+  filter.stateVariable = 123.f;
   success = MW_DSP_OPF_init(&filter, b0, a1);
   if (!success)
     return 0;
 
+  //  The filter starts from rest
+  if (filter.stateVariable != 0.f)
+    return 0;
+
   return 1;
 }
 
@@ -80,6 +89,113 @@ static int32_t MW_DSP_OPF_standardOperationTests()
 }
 
 
+//  MW_DSP_OPF_process() (which filters long buffers in chunks) must match MW_DSP_OPF_tick() for every buffer size, including
+//  when a1 is changed between buffers
+static int32_t MW_DSP_OPF_processTests()
+{
+  MW_DSP_OPF tickedFilter;
+  MW_DSP_OPF processedFilter;
+  float32_t buffer[100];
+  size_t bufferSizes[] = {1, 31, 32, 33, 64, 100, 7, 96};
+  float32_t a1s[] = {0.99f, -0.5f, 0.3f, 0.999f};
+  int32_t t = 0;
+
+  for (int32_t i = 0; i < 4; ++i)
+  {
+    if (i == 0)
+    {
+      MW_DSP_OPF_init(&tickedFilter, 0.01f, a1s[i]);
+      MW_DSP_OPF_init(&processedFilter, 0.01f, a1s[i]);
+    }
+    else
+    {
+      tickedFilter.a1 = processedFilter.a1 = a1s[i];
+      tickedFilter.b0 = processedFilter.b0 = 1.f - fabsf(a1s[i]);
+    }
+
+    for (int32_t b = 0; b < 8; ++b)
+    {
+      for (size_t n = 0; n < bufferSizes[b]; ++n, ++t)
+        buffer[n] = (t % 50 < 25 ? 1.f : -0.5f) + 0.2f * arm_sin_f32(0.05f * 2.f * PI * t);
+
+      MW_DSP_OPF_process(&processedFilter, buffer, bufferSizes[b]);
+
+      for (size_t n = 0; n < bufferSizes[b]; ++n)
+      {
+        float32_t x = (t - bufferSizes[b] + n) % 50 < 25 ? 1.f : -0.5f;
+        float32_t y = MW_DSP_OPF_tick(&tickedFilter, x + 0.2f * arm_sin_f32(0.05f * 2.f * PI * (t - bufferSizes[b] + n)));
+
+        if (fabsf(y - buffer[n]) > 1e-5f)
+          return 0;
+      }
+    }
+  }
+
+  return 1;
+}
+
+
+//  Every channel of a bank must match its own MW_DSP_OPF, for interleaved and planar input
+static int32_t MW_DSP_OPF_bankTests()
+{
+  MW_DSP_OPFBank bank;
+  MW_DSP_OPF filters[5];
+  float32_t interleaved[40 * 5];
+  float32_t planarMemory[5][40];
+  float32_t *planar[5];
+
+  if (MW_DSP_OPFBank_init(NULL, 5, 0.1f, 0.9f))
+    return 0;
+
+  if (MW_DSP_OPFBank_init(&bank, 0, 0.1f, 0.9f) || MW_DSP_OPFBank_init(&bank, MW_DSP_OPFBANK_MAX_CHANNELS + 1, 0.1f, 0.9f))
+    return 0;
+
+  if (!MW_DSP_OPFBank_init(&bank, 5, 0.1f, 0.9f))
+    return 0;
+
+  if (MW_DSP_OPFBank_setCoefficients(&bank, 5, 0.5f, 0.5f) || MW_DSP_OPFBank_setCoefficients(&bank, -2, 0.5f, 0.5f))
+    return 0;
+
+  for (int32_t i = 0; i < 5; ++i)
+  {
+    float32_t a1 = 0.5f + 0.1f * i;
+    if (!MW_DSP_OPFBank_setCoefficients(&bank, i, 1.f - a1, a1))
+      return 0;
+
+    MW_DSP_OPF_init(&filters[i], 1.f - a1, a1);
+    planar[i] = planarMemory[i];
+  }
+
+  for (int32_t n = 0; n < 40; ++n)
+    for (int32_t i = 0; i < 5; ++i)
+      interleaved[n * 5 + i] = planarMemory[i][n] = (n < 20) ? (float32_t)(i + 1) : -0.5f;
+
+  MW_DSP_OPFBank_processInterleaved(&bank, interleaved, 40);
+
+  for (int32_t n = 0; n < 40; ++n)
+    for (int32_t i = 0; i < 5; ++i)
+      if (interleaved[n * 5 + i] != MW_DSP_OPF_tick(&filters[i], planarMemory[i][n]))
+        return 0;
+
+  //  Planar input continues from the same states
+  for (int32_t i = 0; i < 5; ++i)
+    arm_copy_f32(planarMemory[i], interleaved + i * 40, 40);
+
+  MW_DSP_OPFBank_processPlanar(&bank, planar, 40);
+
+  for (int32_t i = 0; i < 5; ++i)
+    for (int32_t n = 0; n < 40; ++n)
+      if (planarMemory[i][n] != MW_DSP_OPF_tick(&filters[i], interleaved[i * 40 + n]))
+        return 0;
+
+  MW_DSP_OPFBank_reset(&bank);
+  if (bank.stateVariables[4] != 0.f)
+    return 0;
+
+  return 1;
+}
+
+
 int32_t MW_DSP_OPF_runUnitTests()
 {
   if (!MW_DSP_OPF_initializationTests())
@@ -88,5 +204,109 @@ int32_t MW_DSP_OPF_runUnitTests()
   if (!MW_DSP_OPF_standardOperationTests())
     return 0;
 
+  if (!MW_DSP_OPF_processTests())
+    return 0;
+
+  if (!MW_DSP_OPF_bankTests())
+    return 0;
+
   return 1;
 }
+
+
+
+/*
+ *  Compare a serial MW_DSP_OPF_tick() loop against MW_DSP_OPF_process() for buffer sizes from 8 samples, doubling on every run.
+ *  Buffers shorter than MW_DSP_OPF_SCAN_BLOCK_SIZE take the serial path in both
+ *
+ *  Returns:
+ *    Number of results written (N is the buffer size)
+ */
+size_t MW_DSP_OPF_runBenchmarks(MW_UnitTest_BenchmarkResult *results, size_t maxResults)
+{
+  float32_t block[BENCHMARK_BLOCK_SIZE];
+  MW_DSP_OPF filter;
+  size_t numResults = 0;
+
+  for (size_t N = 8; N <= BENCHMARK_BLOCK_SIZE && numResults < maxResults; N *= 2)
+  {
+    int32_t numBlocks = BENCHMARK_NUM_BLOCKS * BENCHMARK_BLOCK_SIZE / N;
+
+    arm_fill_f32(0.5f, block, BENCHMARK_BLOCK_SIZE);
+    MW_DSP_OPF_init(&filter, 0.01f, 0.99f);
+
+    uint32_t start = MW_AFXUnit_Utils_getCycleCount();
+    for (int32_t n = 0; n < numBlocks; ++n)
+      for (size_t i = 0; i < N; ++i)
+        block[i] = MW_DSP_OPF_tick(&filter, block[i]);
+    uint32_t tickCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+    arm_fill_f32(0.5f, block, BENCHMARK_BLOCK_SIZE);
+    MW_DSP_OPF_init(&filter, 0.01f, 0.99f);
+
+    start = MW_AFXUnit_Utils_getCycleCount();
+    for (int32_t n = 0; n < numBlocks; ++n)
+      MW_DSP_OPF_process(&filter, block, N);
+    uint32_t processCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+    results[numResults].N = N;
+    results[numResults].referenceCyclesPerSample = (float32_t)tickCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+    results[numResults].cyclesPerSample = (float32_t)processCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS);
+    numResults++;
+  }
+
+  return numResults;
+}
+
+
+
+/*
+ *  Compare smoothing N control signals with one MW_DSP_OPF_process() call per signal against a MW_DSP_OPFBank running them
+ *  in lockstep (planar input).  Each control block is 16 samples.  N is doubled on every run, starting at 4.
+ *  memory must hold at least 16 * MW_DSP_OPFBANK_MAX_CHANNELS samples
+ *
+ *  Returns:
+ *    Number of results written (N is the number of channels)
+ */
+size_t MW_DSP_OPFBank_runBenchmarks(float32_t *memory, size_t memorySize, MW_UnitTest_BenchmarkResult *results, size_t maxResults)
+{
+  MW_DSP_OPF filters[MW_DSP_OPFBANK_MAX_CHANNELS];
+  MW_DSP_OPFBank bank;
+  float32_t *buffers[MW_DSP_OPFBANK_MAX_CHANNELS];
+  size_t numResults = 0;
+  size_t controlBlockSize = 16;
+
+  for (int32_t N = 4; N <= MW_DSP_OPFBANK_MAX_CHANNELS && N * controlBlockSize <= memorySize && numResults < maxResults; N *= 2)
+  {
+    int32_t numBlocks = BENCHMARK_NUM_BLOCKS * BENCHMARK_BLOCK_SIZE / controlBlockSize;
+
+    arm_fill_f32(0.5f, memory, N * controlBlockSize);
+    for (int32_t i = 0; i < N; ++i)
+    {
+      MW_DSP_OPF_init(&filters[i], 0.01f, 0.99f);
+      buffers[i] = memory + i * controlBlockSize;
+    }
+
+    uint32_t start = MW_AFXUnit_Utils_getCycleCount();
+    for (int32_t n = 0; n < numBlocks; ++n)
+      for (int32_t i = 0; i < N; ++i)
+        MW_DSP_OPF_process(&filters[i], buffers[i], controlBlockSize);
+    uint32_t filterCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+    arm_fill_f32(0.5f, memory, N * controlBlockSize);
+    MW_DSP_OPFBank_init(&bank, N, 0.01f, 0.99f);
+
+    start = MW_AFXUnit_Utils_getCycleCount();
+    for (int32_t n = 0; n < numBlocks; ++n)
+      MW_DSP_OPFBank_processPlanar(&bank, buffers, controlBlockSize);
+    uint32_t bankCycles = MW_AFXUnit_Utils_getCycleCount() - start;
+
+    //  Cycles per sample of every channel
+    results[numResults].N = N;
+    results[numResults].referenceCyclesPerSample = (float32_t)filterCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS * N);
+    results[numResults].cyclesPerSample = (float32_t)bankCycles / (BENCHMARK_BLOCK_SIZE * BENCHMARK_NUM_BLOCKS * N);
+    numResults++;
+  }
+
+  return numResults;
+}
@@ -28,8 +28,11 @@
 #define MW_DSP_OPFTESTS_H_
 
 #include "MW_DSP_OPF.h"
+#include "MW_UnitTestBenchmark.h"
 
 
 int32_t MW_DSP_OPF_runUnitTests();
+size_t  MW_DSP_OPF_runBenchmarks(MW_UnitTest_BenchmarkResult *results, size_t maxResults);
+size_t  MW_DSP_OPFBank_runBenchmarks(float32_t *memory, size_t memorySize, MW_UnitTest_BenchmarkResult *results, size_t maxResults);
 
 #endif /* MW_DSP_OPFTESTS_H_ */
@@ -0,0 +1,123 @@
+//  Copyright 2021 Allen Lee
+//
+//  Author:  Allen Lee (alee@meoworkshop.org)
+//  
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//  For more information, please refer to https://opensource.org/licenses/mit-license.php
+//
+//  ------------------------------------------------------------------------------------------------  //
+
+
+
+#include "MW_DSP_RingBufferTests.h"
+
+
+static int32_t MW_DSP_RingBuffer_initializationTests()
+{
+  MW_DSP_RingBuffer ringBuffer;
+  float32_t bufferMemory[MW_DSP_RINGBUFFER_MEMORY_SIZE(8, 3)];
+
+  //  Invalid arguments
+  if (MW_DSP_RingBuffer_init(NULL, bufferMemory, 8, 3))
+    return 0;
+
+  if (MW_DSP_RingBuffer_init(&ringBuffer, NULL, 8, 3))
+    return 0;
+
+  if (MW_DSP_RingBuffer_init(&ringBuffer, bufferMemory, 0, 3))
+    return 0;
+
+  if (MW_DSP_RingBuffer_init(&ringBuffer, bufferMemory, 8, -1))
+    return 0;
+
+  //  The guard cannot be larger than the buffer it mirrors
+  if (MW_DSP_RingBuffer_init(&ringBuffer, bufferMemory, 2, 3))
+    return 0;
+
+  arm_fill_f32(1.f, bufferMemory, MW_DSP_RINGBUFFER_MEMORY_SIZE(8, 3));
+
+  if (!MW_DSP_RingBuffer_init(&ringBuffer, bufferMemory, 8, 3))
+    return 0;
+
+  if (ringBuffer.buffer != bufferMemory || ringBuffer.N != 8 || ringBuffer.guardSize != 3)
+    return 0;
+
+  //  The guard zone must be cleared too
+  for (int32_t i = 0; i < MW_DSP_RINGBUFFER_MEMORY_SIZE(8, 3); ++i)
+    if (bufferMemory[i] != 0.f)
+      return 0;
+
+  return 1;
+}
+
+
+//  After any sequence of writes the guard zone must hold a copy of the first guardSize samples
+static int32_t MW_DSP_RingBuffer_guardTests()
+{
+  MW_DSP_RingBuffer ringBuffer;
+  float32_t bufferMemory[MW_DSP_RINGBUFFER_MEMORY_SIZE(8, 3)];
+  float32_t block[6] = {1.f, 2.f, 3.f, 4.f, 5.f, 6.f};
+
+  if (!MW_DSP_RingBuffer_init(&ringBuffer, bufferMemory, 8, 3))
+    return 0;
+
+  //  Single sample writes
+  for (int32_t i = 0; i < 8; ++i)
+    MW_DSP_RingBuffer_write(&ringBuffer, i, (float32_t)(10 + i));
+
+  for (int32_t i = 0; i < 3; ++i)
+    if (bufferMemory[8 + i] != bufferMemory[i])
+      return 0;
+
+  //  Block write that wraps around the end of the buffer
+  MW_DSP_RingBuffer_writeBlock(&ringBuffer, 5, block, 6);
+
+  float32_t expected[] = {4.f, 5.f, 6.f, 13.f, 14.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f};
+  for (int32_t i = 0; i < MW_DSP_RINGBUFFER_MEMORY_SIZE(8, 3); ++i)
+    if (bufferMemory[i] != expected[i])
+      return 0;
+
+  //  Direct writes followed by updateGuard()
+  bufferMemory[1] = -1.f;
+  bufferMemory[2] = -2.f;
+  MW_DSP_RingBuffer_updateGuard(&ringBuffer, 1, 4);
+
+  if (bufferMemory[9] != -1.f || bufferMemory[10] != -2.f || bufferMemory[8] != 4.f)
+    return 0;
+
+  MW_DSP_RingBuffer_reset(&ringBuffer);
+  for (int32_t i = 0; i < MW_DSP_RINGBUFFER_MEMORY_SIZE(8, 3); ++i)
+    if (bufferMemory[i] != 0.f)
+      return 0;
+
+  return 1;
+}
+
+
+int32_t MW_DSP_RingBuffer_runUnitTests()
+{
+  if (!MW_DSP_RingBuffer_initializationTests())
+    return 0;
+
+  if (!MW_DSP_RingBuffer_guardTests())
+    return 0;
+
+  return 1;
+}
@@ -0,0 +1,50 @@
+//  Copyright 2021 Allen Lee
+//
+//  Author:  Allen Lee (alee@meoworkshop.org)
+//  
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+//  For more information, please refer to https://opensource.org/licenses/mit-license.php
+//
+//  ------------------------------------------------------------------------------------------------  //
+
+#ifndef MW_UNITTESTBENCHMARK_H_
+#define MW_UNITTESTBENCHMARK_H_
+
+#include "arm_math.h"
+#include "MW_AFXUnit_MiscUtils.h"
+
+//  Convert a cycle count into nanoseconds for a given core clock frequency (Hz)
+#define MW_UNITTEST_CYCLES_TO_NS(cycles, coreClockHz) ((cycles) * 1.0e9f / (coreClockHz))
+
+
+/*
+ *  Result of a single benchmark run
+ *  Benchmarks compare an existing (reference) implementation against the implementation under test.
+ *  Remember to call MW_AFXUnit_Utils_enableCycleCounter() before running any benchmarks
+ */
+typedef struct
+{
+    size_t      N;                          //  Size being benchmarked (delay length, number of stages etc.)
+    float32_t   referenceCyclesPerSample;
+    float32_t   cyclesPerSample;
+}MW_UnitTest_BenchmarkResult;
+
+
+#endif /* MW_UNITTESTBENCHMARK_H_ */